@@ -0,0 +1,198 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+/**
+* Replaces the global allocation functions in order to count the heap allocations of a benchmark executable.
+* All the forms of operator new are counted : single object, array, nothrow and, from C++17, aligned.
+* The replacement functions are not inline, as the standard requires : include this header in a single source file of the executable.
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#if defined(__cpp_aligned_new) && defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace fetpapi_benchmark {
+	/// The count of the calls to any form of operator new since the start of the executable
+	std::atomic<uint64_t> allocationCount{ 0 };
+	/// The count of bytes requested to any form of operator new since the start of the executable
+	std::atomic<uint64_t> allocatedByteCount{ 0 };
+
+	/**
+	* @return The allocated memory or nullptr if there is not enough memory.
+	*/
+	void* countAndAllocate(std::size_t size)
+	{
+		++allocationCount;
+		allocatedByteCount += size;
+		return std::malloc(size == 0 ? 1 : size);
+	}
+
+#ifdef __cpp_aligned_new
+	/**
+	* @return The allocated memory, to be freed by deallocateAligned, or nullptr if there is not enough memory.
+	*/
+	void* countAndAllocateAligned(std::size_t size, std::align_val_t alignment)
+	{
+		++allocationCount;
+		allocatedByteCount += size;
+		const std::size_t byteAlignment = static_cast<std::size_t>(alignment) < sizeof(void*) ? sizeof(void*) : static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+		return _aligned_malloc(size == 0 ? 1 : size, byteAlignment);
+#else
+		void* result = nullptr;
+		return posix_memalign(&result, byteAlignment, size == 0 ? 1 : size) == 0 ? result : nullptr;
+#endif
+	}
+
+	void deallocateAligned(void* ptr)
+	{
+#ifdef _WIN32
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	}
+#endif
+}
+
+void* operator new(std::size_t size)
+{
+	void* result = fetpapi_benchmark::countAndAllocate(size);
+	if (result == nullptr) {
+		throw std::bad_alloc();
+	}
+	return result;
+}
+
+void* operator new[](std::size_t size)
+{
+	void* result = fetpapi_benchmark::countAndAllocate(size);
+	if (result == nullptr) {
+		throw std::bad_alloc();
+	}
+	return result;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return fetpapi_benchmark::countAndAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return fetpapi_benchmark::countAndAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	std::free(ptr);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+#endif
+
+#ifdef __cpp_aligned_new
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	void* result = fetpapi_benchmark::countAndAllocateAligned(size, alignment);
+	if (result == nullptr) {
+		throw std::bad_alloc();
+	}
+	return result;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	void* result = fetpapi_benchmark::countAndAllocateAligned(size, alignment);
+	if (result == nullptr) {
+		throw std::bad_alloc();
+	}
+	return result;
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return fetpapi_benchmark::countAndAllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return fetpapi_benchmark::countAndAllocateAligned(size, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+	fetpapi_benchmark::deallocateAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+	fetpapi_benchmark::deallocateAligned(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	fetpapi_benchmark::deallocateAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	fetpapi_benchmark::deallocateAligned(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+	fetpapi_benchmark::deallocateAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+	fetpapi_benchmark::deallocateAligned(ptr);
+}
+#endif
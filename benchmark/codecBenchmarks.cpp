@@ -0,0 +1,504 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+
+/**
+* Measures the Avro encoding and decoding costs of each ETP message type, independently of the network.
+* Each message is encoded the same way as AbstractSession::encode does (a message header followed by the message body)
+* and decoded the same way as the protocol handlers do (a recycled decoder and a recycled message body).
+* The messages which have some variable size content are filled in with a configurable count of synthetic items :
+* resources, data objects, array elements, dataspaces, channel data items, etc...
+*
+* Usage : codecBenchmarks [--sizes 1,100,10000] [--object-bytes 1024] [--min-time-ms 200] [--filter GetResources] [--json]
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include "etp/ProtocolHandlers/ProtocolHandlers.h"
+
+#include "AllocationCounter.h"
+
+namespace {
+	struct Options {
+		std::vector<size_t> sizes = { 1, 100, 10000 };
+		size_t objectByteCount = 1024;
+		double minTimeMilliseconds = 200;
+		std::string filter;
+		bool json = false;
+	};
+
+	Options options;
+
+	/*************************
+	*** SYNTHETIC MESSAGES ***
+	*************************/
+
+	std::string makeUri(size_t index)
+	{
+		return "eml:///dataspace('demo/Volve')/resqml20.obj_IjkGridRepresentation(" + std::to_string(1000000 + index) + "-0000-4000-8000-000000000000)";
+	}
+
+	Energistics::Etp::v12::Datatypes::Object::Resource makeResource(size_t index)
+	{
+		Energistics::Etp::v12::Datatypes::Object::Resource result;
+		result.uri = makeUri(index);
+		result.name = "Grid " + std::to_string(index);
+		result.sourceCount = 2;
+		result.targetCount = 3;
+		result.lastChanged = 1600000000000000 + index;
+		result.storeLastWrite = result.lastChanged;
+		result.storeCreated = result.lastChanged;
+		return result;
+	}
+
+	Energistics::Etp::v12::Datatypes::Object::DataObject makeDataObject(size_t index)
+	{
+		Energistics::Etp::v12::Datatypes::Object::DataObject result;
+		result.resource = makeResource(index);
+		result.format = "xml";
+		result.data = std::string(options.objectByteCount, 'x');
+		return result;
+	}
+
+	Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray makeDataArray(size_t elementCount)
+	{
+		Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray result;
+		result.dimensions.push_back(elementCount);
+		Energistics::Etp::v12::Datatypes::ArrayOfDouble values;
+		values.values.resize(elementCount);
+		for (size_t i = 0; i < elementCount; ++i) {
+			values.values[i] = i * 0.5;
+		}
+		result.data.item.set_ArrayOfDouble(values);
+		return result;
+	}
+
+	Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier makeDataArrayIdentifier()
+	{
+		Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier result;
+		result.uri = makeUri(0);
+		result.pathInResource = "/RESQML/" + std::to_string(1000000) + "-0000-4000-8000-000000000000/points_patch0";
+		return result;
+	}
+
+	Energistics::Etp::v12::Datatypes::SupportedProtocol makeSupportedProtocol(size_t index)
+	{
+		Energistics::Etp::v12::Datatypes::SupportedProtocol result;
+		result.protocol = static_cast<int32_t>(index % 25);
+		result.protocolVersion.major = 1;
+		result.protocolVersion.minor = 2;
+		result.role = "store";
+		return result;
+	}
+
+	/**
+	* Fill in a message with a given count of synthetic items.
+	* This default overload is used for the messages which have a fixed size content : it leaves them default constructed.
+	*
+	* @return True if the message content size depends on the item count.
+	*/
+	template<typename T> bool fill(T&, size_t) { return false; }
+
+	bool fill(Energistics::Etp::v12::Protocol::Core::RequestSession& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) msg.requestedProtocols.push_back(makeSupportedProtocol(i));
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::Core::OpenSession& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) msg.supportedProtocols.push_back(makeSupportedProtocol(i));
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::Core::ProtocolException& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			Energistics::Etp::v12::Datatypes::ErrorInfo& error = msg.errors[std::to_string(i)];
+			error.code = 11;
+			error.message = "The data object " + makeUri(i) + " does not exist.";
+		}
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::Discovery::GetResourcesResponse& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) msg.resources.push_back(makeResource(i));
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::Discovery::GetResourcesEdgesResponse& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			Energistics::Etp::v12::Datatypes::Object::Edge edge;
+			edge.sourceUri = makeUri(i);
+			edge.targetUri = makeUri(i + 1);
+			msg.edges.push_back(edge);
+		}
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::Discovery::GetDeletedResourcesResponse& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			Energistics::Etp::v12::Datatypes::Object::DeletedResource deletedResource;
+			deletedResource.uri = makeUri(i);
+			deletedResource.deletedTime = 1600000000000000 + i;
+			msg.deletedResources.push_back(deletedResource);
+		}
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::DiscoveryQuery::FindResourcesResponse& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) msg.resources.push_back(makeResource(i));
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::Store::GetDataObjects& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) msg.uris[std::to_string(i)] = makeUri(i);
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::Store::DeleteDataObjects& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) msg.uris[std::to_string(i)] = makeUri(i);
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::Store::GetDataObjectsResponse& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) msg.dataObjects[std::to_string(i)] = makeDataObject(i);
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::Store::PutDataObjects& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) msg.dataObjects[std::to_string(i)] = makeDataObject(i);
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::Store::PutDataObjectsResponse& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) msg.success[std::to_string(i)];
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::StoreQuery::FindDataObjectsResponse& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) msg.dataObjects.push_back(makeDataObject(i));
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::StoreNotification::ObjectChanged& msg, size_t count) {
+		// The item count is the count of data object payload bytes here since an ObjectChanged carries a single data object.
+		msg.change.dataObject = makeDataObject(0);
+		msg.change.dataObject.data = std::string(count, 'x');
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::StoreNotification::SubscribeNotifications& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) msg.request[std::to_string(i)].context.uri = makeUri(i);
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::DataArray::GetDataArrays& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) msg.dataArrays[std::to_string(i)] = makeDataArrayIdentifier();
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::DataArray::GetDataArraysResponse& msg, size_t count) {
+		msg.dataArrays["0"] = makeDataArray(count);
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::DataArray::GetDataSubarraysResponse& msg, size_t count) {
+		msg.dataSubarrays["0"] = makeDataArray(count);
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::DataArray::PutDataArrays& msg, size_t count) {
+		Energistics::Etp::v12::Datatypes::DataArrayTypes::PutDataArraysType& putDataArraysType = msg.dataArrays["0"];
+		putDataArraysType.uid = makeDataArrayIdentifier();
+		putDataArraysType.array = makeDataArray(count);
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::DataArray::PutDataSubarrays& msg, size_t count) {
+		Energistics::Etp::v12::Datatypes::DataArrayTypes::PutDataSubarraysType& putDataSubarraysType = msg.dataSubarrays["0"];
+		putDataSubarraysType.uid = makeDataArrayIdentifier();
+		putDataSubarraysType.data = makeDataArray(count).data;
+		putDataSubarraysType.starts.push_back(0);
+		putDataSubarraysType.counts.push_back(count);
+		return true;
+	}
+	bool fill(Energistics::Etp::v12::Protocol::Dataspace::GetDataspacesResponse& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			Energistics::Etp::v12::Datatypes::Object::Dataspace dataspace;
+			dataspace.uri = "eml:///dataspace('demo/" + std::to_string(i) + "')";
+			dataspace.path = "demo/" + std::to_string(i);
+			msg.dataspaces.push_back(dataspace);
+		}
+		return true;
+	}
+
+	/**
+	* The ChannelStreaming and ChannelSubscribe protocols are not generated in EtpMessages.h.
+	* Their ChannelData message is a list of data items : this is what is measured instead of the message itself.
+	*/
+	struct ChannelData {
+		std::vector<Energistics::Etp::v12::Datatypes::ChannelData::DataItem> data;
+		static constexpr int messageTypeId = 4;
+		static constexpr int protocolId = static_cast<int>(Energistics::Etp::v12::Datatypes::Protocol::ChannelStreaming);
+	};
+	bool fill(ChannelData& msg, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			Energistics::Etp::v12::Datatypes::ChannelData::DataItem item;
+			item.channelId = i % 16;
+			Energistics::Etp::v12::Datatypes::IndexValue index;
+			index.item.set_long(static_cast<int64_t>(1600000000000000 + i));
+			item.indexes.push_back(index);
+			item.value.item.set_double(i * 0.5);
+			msg.data.push_back(item);
+		}
+		return true;
+	}
+}
+
+namespace avro {
+	template<> struct codec_traits<ChannelData> {
+		static void encode(Encoder& e, const ChannelData& v) {
+			avro::encode(e, v.data);
+		}
+		static void decode(Decoder& e, ChannelData& v) {
+			avro::decode(e, v.data);
+		}
+	};
+}
+
+namespace {
+	/******************
+	*** MEASUREMENT ***
+	******************/
+
+	struct Result {
+		std::string name;
+		size_t itemCount = 0;
+		size_t byteCount = 0;
+		double encodeNanoseconds = 0;
+		double decodeNanoseconds = 0;
+		double encodeAllocations = 0;
+		double decodeAllocations = 0;
+		double encodeAllocatedBytes = 0;
+		double decodeAllocatedBytes = 0;
+	};
+
+	std::vector<Result> results;
+
+	/**
+	* Repeats an operation until the minimum measurement time is reached.
+	*
+	* @return The average nanoseconds, allocations and allocated bytes per operation.
+	*/
+	template<typename Operation> void measure(Operation operation, double& nanoseconds, double& allocations, double& allocatedBytes)
+	{
+		// Warm up the caches and the recycled message bodies
+		operation();
+
+		size_t iterationCount = 0;
+		const uint64_t startAllocationCount = fetpapi_benchmark::allocationCount;
+		const uint64_t startAllocatedByteCount = fetpapi_benchmark::allocatedByteCount;
+		const auto start = std::chrono::steady_clock::now();
+		std::chrono::duration<double, std::milli> elapsed(0);
+		for (size_t batchSize = 1; elapsed.count() < options.minTimeMilliseconds; batchSize *= 2) {
+			for (size_t i = 0; i < batchSize; ++i) {
+				operation();
+			}
+			iterationCount += batchSize;
+			elapsed = std::chrono::steady_clock::now() - start;
+		}
+
+		nanoseconds = elapsed.count() * 1e6 / iterationCount;
+		allocations = static_cast<double>(fetpapi_benchmark::allocationCount - startAllocationCount) / iterationCount;
+		allocatedBytes = static_cast<double>(fetpapi_benchmark::allocatedByteCount - startAllocatedByteCount) / iterationCount;
+	}
+
+	template<typename T> void benchmark(const std::string& name)
+	{
+		if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+			return;
+		}
+
+		T sizeProbe;
+		const bool isSized = fill(sizeProbe, 0);
+		for (size_t itemCount : options.sizes) {
+			T mb;
+			fill(mb, itemCount);
+
+			Energistics::Etp::v12::Datatypes::MessageHeader mh;
+			mh.protocol = mb.protocolId;
+			mh.messageType = mb.messageTypeId;
+			mh.messageId = 2;
+			mh.messageFlags = 0x02;
+
+			Result result;
+			result.name = name;
+			result.itemCount = isSized ? itemCount : 0;
+
+			// Same as AbstractSession::encode
+			std::vector<uint8_t> encoded;
+			measure([&]() {
+				avro::OutputStreamPtr out = avro::memoryOutputStream();
+				avro::EncoderPtr e = avro::binaryEncoder();
+				e->init(*out);
+				avro::encode(*e, mh);
+				avro::encode(*e, mb);
+				e->flush();
+				encoded = *avro::snapshot(*out).get();
+			}, result.encodeNanoseconds, result.encodeAllocations, result.encodeAllocatedBytes);
+			result.byteCount = encoded.size();
+
+			// Same as AbstractSession::on_read and the protocol handlers
+			avro::DecoderPtr d = avro::binaryDecoder();
+			Energistics::Etp::v12::Datatypes::MessageHeader receivedMh;
+			measure([&]() {
+				avro::InputStreamPtr in = avro::memoryInputStream(encoded.data(), encoded.size());
+				d->init(*in);
+				avro::decode(*d, receivedMh);
+				ETP_NS::decodeRecycled<T>(*d);
+			}, result.decodeNanoseconds, result.decodeAllocations, result.decodeAllocatedBytes);
+
+			results.push_back(result);
+
+			if (!isSized) {
+				break;
+			}
+		}
+	}
+
+	void printResults()
+	{
+		if (options.json) {
+			std::cout << '[';
+			for (size_t i = 0; i < results.size(); ++i) {
+				const Result& result = results[i];
+				std::cout << (i == 0 ? "" : ",") << "\n{\"message\":\"" << result.name << "\",\"itemCount\":" << result.itemCount
+					<< ",\"byteCount\":" << result.byteCount
+					<< ",\"encodeNs\":" << result.encodeNanoseconds << ",\"encodeMegabytesPerSecond\":" << result.byteCount * 1e3 / result.encodeNanoseconds
+					<< ",\"encodeAllocations\":" << result.encodeAllocations << ",\"encodeAllocatedBytes\":" << result.encodeAllocatedBytes
+					<< ",\"decodeNs\":" << result.decodeNanoseconds << ",\"decodeMegabytesPerSecond\":" << result.byteCount * 1e3 / result.decodeNanoseconds
+					<< ",\"decodeAllocations\":" << result.decodeAllocations << ",\"decodeAllocatedBytes\":" << result.decodeAllocatedBytes << '}';
+			}
+			std::cout << "\n]" << std::endl;
+			return;
+		}
+
+		std::cout << "message\titems\tbytes\tencode ns\tencode MB/s\tencode allocs\tdecode ns\tdecode MB/s\tdecode allocs" << std::endl;
+		for (const Result& result : results) {
+			std::cout << result.name << '\t' << result.itemCount << '\t' << result.byteCount
+				<< '\t' << result.encodeNanoseconds << '\t' << result.byteCount * 1e3 / result.encodeNanoseconds << '\t' << result.encodeAllocations
+				<< '\t' << result.decodeNanoseconds << '\t' << result.byteCount * 1e3 / result.decodeNanoseconds << '\t' << result.decodeAllocations << std::endl;
+		}
+	}
+
+	std::vector<size_t> parseSizes(const std::string& list)
+	{
+		std::vector<size_t> result;
+		std::istringstream iss(list);
+		std::string item;
+		while (std::getline(iss, item, ',')) {
+			if (!item.empty()) {
+				result.push_back(std::stoull(item));
+			}
+		}
+		return result;
+	}
+}
+
+#define ETP_CODEC_BENCHMARK(PROTOCOL, MESSAGE) benchmark<Energistics::Etp::v12::Protocol::PROTOCOL::MESSAGE>(#PROTOCOL "." #MESSAGE)
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "--json") {
+			options.json = true;
+			continue;
+		}
+		if (i + 1 >= argc) {
+			std::cerr << "The argument " << arg << " has no value." << std::endl;
+			return 1;
+		}
+		const std::string value = argv[++i];
+		if (arg == "--sizes") options.sizes = parseSizes(value);
+		else if (arg == "--object-bytes") options.objectByteCount = std::stoull(value);
+		else if (arg == "--min-time-ms") options.minTimeMilliseconds = std::stod(value);
+		else if (arg == "--filter") options.filter = value;
+		else {
+			std::cerr << "Unknown argument " << arg << std::endl;
+			return 1;
+		}
+	}
+	if (options.sizes.empty()) {
+		std::cerr << "At least one size is required." << std::endl;
+		return 1;
+	}
+
+	ETP_CODEC_BENCHMARK(Core, RequestSession);
+	ETP_CODEC_BENCHMARK(Core, OpenSession);
+	ETP_CODEC_BENCHMARK(Core, CloseSession);
+	ETP_CODEC_BENCHMARK(Core, Authorize);
+	ETP_CODEC_BENCHMARK(Core, AuthorizeResponse);
+	ETP_CODEC_BENCHMARK(Core, Ping);
+	ETP_CODEC_BENCHMARK(Core, Pong);
+	ETP_CODEC_BENCHMARK(Core, Acknowledge);
+	ETP_CODEC_BENCHMARK(Core, ProtocolException);
+
+	ETP_CODEC_BENCHMARK(Discovery, GetResources);
+	ETP_CODEC_BENCHMARK(Discovery, GetResourcesResponse);
+	ETP_CODEC_BENCHMARK(Discovery, GetResourcesEdgesResponse);
+	ETP_CODEC_BENCHMARK(Discovery, GetDeletedResources);
+	ETP_CODEC_BENCHMARK(Discovery, GetDeletedResourcesResponse);
+	ETP_CODEC_BENCHMARK(DiscoveryQuery, FindResources);
+	ETP_CODEC_BENCHMARK(DiscoveryQuery, FindResourcesResponse);
+
+	ETP_CODEC_BENCHMARK(Store, GetDataObjects);
+	ETP_CODEC_BENCHMARK(Store, GetDataObjectsResponse);
+	ETP_CODEC_BENCHMARK(Store, PutDataObjects);
+	ETP_CODEC_BENCHMARK(Store, PutDataObjectsResponse);
+	ETP_CODEC_BENCHMARK(Store, DeleteDataObjects);
+	ETP_CODEC_BENCHMARK(Store, DeleteDataObjectsResponse);
+	ETP_CODEC_BENCHMARK(Store, Chunk);
+	ETP_CODEC_BENCHMARK(StoreQuery, FindDataObjects);
+	ETP_CODEC_BENCHMARK(StoreQuery, FindDataObjectsResponse);
+	ETP_CODEC_BENCHMARK(StoreQuery, Chunk);
+
+	ETP_CODEC_BENCHMARK(StoreNotification, SubscribeNotifications);
+	ETP_CODEC_BENCHMARK(StoreNotification, SubscribeNotificationsResponse);
+	ETP_CODEC_BENCHMARK(StoreNotification, UnsubscribeNotifications);
+	ETP_CODEC_BENCHMARK(StoreNotification, UnsolicitedStoreNotifications);
+	ETP_CODEC_BENCHMARK(StoreNotification, SubscriptionEnded);
+	ETP_CODEC_BENCHMARK(StoreNotification, ObjectChanged);
+	ETP_CODEC_BENCHMARK(StoreNotification, ObjectDeleted);
+	ETP_CODEC_BENCHMARK(StoreNotification, ObjectAccessRevoked);
+	ETP_CODEC_BENCHMARK(StoreNotification, ObjectActiveStatusChanged);
+	ETP_CODEC_BENCHMARK(StoreNotification, Chunk);
+
+	ETP_CODEC_BENCHMARK(DataArray, GetDataArrays);
+	ETP_CODEC_BENCHMARK(DataArray, GetDataArraysResponse);
+	ETP_CODEC_BENCHMARK(DataArray, GetDataSubarrays);
+	ETP_CODEC_BENCHMARK(DataArray, GetDataSubarraysResponse);
+	ETP_CODEC_BENCHMARK(DataArray, GetDataArrayMetadata);
+	ETP_CODEC_BENCHMARK(DataArray, GetDataArrayMetadataResponse);
+	ETP_CODEC_BENCHMARK(DataArray, PutDataArrays);
+	ETP_CODEC_BENCHMARK(DataArray, PutDataArraysResponse);
+	ETP_CODEC_BENCHMARK(DataArray, PutDataSubarrays);
+	ETP_CODEC_BENCHMARK(DataArray, PutDataSubarraysResponse);
+	ETP_CODEC_BENCHMARK(DataArray, PutUninitializedDataArrays);
+	ETP_CODEC_BENCHMARK(DataArray, PutUninitializedDataArraysResponse);
+
+	ETP_CODEC_BENCHMARK(Dataspace, GetDataspaces);
+	ETP_CODEC_BENCHMARK(Dataspace, GetDataspacesResponse);
+	ETP_CODEC_BENCHMARK(Dataspace, PutDataspaces);
+	ETP_CODEC_BENCHMARK(Dataspace, PutDataspacesResponse);
+	ETP_CODEC_BENCHMARK(Dataspace, DeleteDataspaces);
+	ETP_CODEC_BENCHMARK(Dataspace, DeleteDataspacesResponse);
+
+	ETP_CODEC_BENCHMARK(Transaction, StartTransaction);
+	ETP_CODEC_BENCHMARK(Transaction, StartTransactionResponse);
+	ETP_CODEC_BENCHMARK(Transaction, CommitTransaction);
+	ETP_CODEC_BENCHMARK(Transaction, CommitTransactionResponse);
+	ETP_CODEC_BENCHMARK(Transaction, RollbackTransaction);
+	ETP_CODEC_BENCHMARK(Transaction, RollbackTransactionResponse);
+
+	benchmark<ChannelData>("ChannelStreaming.ChannelData");
+
+	printResults();
+}
@@ -0,0 +1,104 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+
+/**
+* Counts the heap allocations needed to decode some received messages
+* with a fresh decoder and message body for each message (as before the recycling of the decoded messages)
+* and with the decoder and message body recycling used by the protocol handlers.
+*/
+
+#include <iostream>
+
+#include "etp/ProtocolHandlers/ProtocolHandlers.h"
+
+#include "AllocationCounter.h"
+
+namespace {
+	const size_t ITERATION_COUNT = 1000;
+
+	template<typename T> std::vector<uint8_t> encodeMessage(const T& mb)
+	{
+		avro::OutputStreamPtr out = avro::memoryOutputStream();
+		avro::EncoderPtr e = avro::binaryEncoder();
+		e->init(*out);
+		avro::encode(*e, mb);
+		e->flush();
+		return *avro::snapshot(*out).get();
+	}
+
+	template<typename T> void benchmark(const std::string& name, const T& mb)
+	{
+		const std::vector<uint8_t> encoded = encodeMessage(mb);
+
+		// Before : one decoder and one message body per received message
+		uint64_t start = fetpapi_benchmark::allocationCount;
+		for (size_t i = 0; i < ITERATION_COUNT; ++i) {
+			avro::InputStreamPtr in = avro::memoryInputStream(encoded.data(), encoded.size());
+			avro::DecoderPtr d = avro::binaryDecoder();
+			d->init(*in);
+			T msg;
+			avro::decode(*d, msg);
+		}
+		const double fresh = static_cast<double>(fetpapi_benchmark::allocationCount - start) / ITERATION_COUNT;
+
+		// After : the decoder and the message body are recycled from one received message to the other
+		avro::DecoderPtr d = avro::binaryDecoder();
+		start = fetpapi_benchmark::allocationCount;
+		for (size_t i = 0; i < ITERATION_COUNT; ++i) {
+			avro::InputStreamPtr in = avro::memoryInputStream(encoded.data(), encoded.size());
+			d->init(*in);
+			ETP_NS::decodeRecycled<T>(*d);
+		}
+		const double recycled = static_cast<double>(fetpapi_benchmark::allocationCount - start) / ITERATION_COUNT;
+
+		std::cout << name << " (" << encoded.size() << " bytes) : " << fresh << " allocations per message before, " << recycled << " after." << std::endl;
+	}
+}
+
+int main()
+{
+	benchmark("Core.Ping", Energistics::Etp::v12::Protocol::Core::Ping());
+
+	Energistics::Etp::v12::Protocol::Discovery::GetResourcesResponse getResourcesResponse;
+	for (size_t i = 0; i < 100; ++i) {
+		Energistics::Etp::v12::Datatypes::Object::Resource resource;
+		resource.uri = "eml:///dataspace('demo/Volve')/resqml20.obj_IjkGridRepresentation(" + std::to_string(i) + ")";
+		resource.name = "Grid " + std::to_string(i);
+		getResourcesResponse.resources.push_back(resource);
+	}
+	benchmark("Discovery.GetResourcesResponse", getResourcesResponse);
+
+	Energistics::Etp::v12::Protocol::Store::GetDataObjectsResponse getDataObjectsResponse;
+	for (size_t i = 0; i < 10; ++i) {
+		Energistics::Etp::v12::Datatypes::Object::DataObject dataObject;
+		dataObject.resource.uri = "eml:///resqml20.obj_IjkGridRepresentation(" + std::to_string(i) + ")";
+		dataObject.data = std::string(2000, 'x');
+		getDataObjectsResponse.dataObjects[std::to_string(i)] = dataObject;
+	}
+	benchmark("Store.GetDataObjectsResponse", getDataObjectsResponse);
+
+	Energistics::Etp::v12::Protocol::DataArray::GetDataSubarraysResponse getDataSubarraysResponse;
+	Energistics::Etp::v12::Datatypes::ArrayOfDouble values;
+	values.values.resize(10000, 1.0);
+	Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray dataArray;
+	dataArray.dimensions.push_back(values.values.size());
+	dataArray.data.item.set_ArrayOfDouble(values);
+	getDataSubarraysResponse.dataSubarrays["0"] = dataArray;
+	benchmark("DataArray.GetDataSubarraysResponse", getDataSubarraysResponse);
+}
@@ -0,0 +1,844 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+
+/**
+* End to end benchmark of a loopback ETP connection.
+* It starts a Server backed by the InMemoryStore reference store on localhost, connects some client sessions to it and measures :
+* - GetDataObjects operations per second and latency percentiles according to the data object size,
+* - DataArray put and get throughputs according to the array size and element type,
+* - Discovery (GetResources) according to the count of resources in a dataspace,
+* - the rate at which a store notification is fanned out to several subscribers,
+* - the rate at which several concurrent clients open and close their sessions (HTTP pre-flight, WebSocket upgrade and RequestSession),
+* - the aggregated GetDataObjects throughput of several concurrent clients.
+* The two last scenarios compare the server threading models when run with and without --io-context-per-thread.
+* By default each client session runs on its own thread. --client-threads multiplexes all the client sessions on an IoContextPool of this count of threads.
+* --preflight tells how the client sessions get the HTTP server capabilities : "always" gets them (and resolves the host) for each session,
+* "cached" gets them once thanks to the EndpointCache and "none" does not get them at all.
+* The results are written as JSON on the standard output or in the file given by --output.
+*
+* Usage : fetpapi_bench [--port 8091] [--server-threads 1] [--iterations 200] [--object-sizes 1024,16384,262144,1048576]
+*			[--array-sizes 1000,100000,1000000] [--resource-counts 10,100,1000,10000] [--subscribers 4] [--notifications 1000]
+*			[--clients 8] [--handshakes 400] [--io-context-per-thread 0] [--cpu-affinity 0] [--client-threads 0] [--preflight always] [--frame-size 4096] [--output result.json] [--cert cert.pem --key key.pem --dh dh.pem] [--tls-resumption 1]
+* Giving a certificate, a key and some DH parameters makes the benchmark use SslClientSession instead of PlainClientSession.
+* The client and the server then resume the TLS sessions unless --tls-resumption is 0 : the handshakes scenario reports how many TLS handshakes were full or resumed.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/uuid/random_generator.hpp>
+
+#include "etp/ClientSessionLaunchers.h"
+#include "etp/EtpHelpers.h"
+#include "etp/IoContextPool.h"
+#include "etp/Server.h"
+#include "etp/ProtocolHandlers/StoreNotificationHandlers.h"
+#include "etp/store/InMemoryStoreHandlers.h"
+
+using namespace ETP_NS;
+
+namespace {
+	typedef std::chrono::steady_clock Clock;
+
+	/**************************
+	*** BENCHMARK ARGUMENTS ***
+	**************************/
+
+	struct Options {
+		unsigned short port = 8091;
+		int serverThreadCount = 1;
+		size_t iterationCount = 200;
+		std::vector<size_t> objectSizes = { 1024, 16384, 262144, 1048576 };
+		std::vector<size_t> arraySizes = { 1000, 100000, 1000000 };
+		std::vector<size_t> resourceCounts = { 10, 100, 1000, 10000 };
+		size_t subscriberCount = 4;
+		size_t notificationCount = 1000;
+		size_t clientCount = 8;
+		size_t handshakeCount = 400;
+		bool ioContextPerThread = false;
+		bool cpuAffinity = false;
+		size_t clientThreadCount = 0;
+		/// The io context shared by the client sessions if clientThreadCount > 0
+		std::shared_ptr<boost::asio::io_context> clientIoContext;
+		std::string preflight = "always";
+		size_t frameSize = 4096;
+		std::string output;
+		std::string cert;
+		std::string key;
+		std::string dh;
+		bool tlsResumption = true;
+	};
+
+	std::vector<size_t> parseSizes(const std::string& list)
+	{
+		std::vector<size_t> result;
+		std::istringstream iss(list);
+		std::string item;
+		while (std::getline(iss, item, ',')) {
+			if (!item.empty()) {
+				result.push_back(std::stoull(item));
+			}
+		}
+		return result;
+	}
+
+	std::string readFile(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			throw std::invalid_argument("Cannot read the file " + path);
+		}
+		std::ostringstream oss;
+		oss << file.rdbuf();
+		return oss.str();
+	}
+
+	Options parseOptions(int argc, char** argv)
+	{
+		Options result;
+		for (int i = 1; i < argc; ++i) {
+			const std::string arg = argv[i];
+			if (i + 1 >= argc) {
+				throw std::invalid_argument("The argument " + arg + " has no value.");
+			}
+			const std::string value = argv[++i];
+			if (arg == "--port") result.port = static_cast<unsigned short>(std::stoul(value));
+			else if (arg == "--server-threads") result.serverThreadCount = std::stoi(value);
+			else if (arg == "--iterations") result.iterationCount = std::stoull(value);
+			else if (arg == "--object-sizes") result.objectSizes = parseSizes(value);
+			else if (arg == "--array-sizes") result.arraySizes = parseSizes(value);
+			else if (arg == "--resource-counts") result.resourceCounts = parseSizes(value);
+			else if (arg == "--subscribers") result.subscriberCount = std::stoull(value);
+			else if (arg == "--notifications") result.notificationCount = std::stoull(value);
+			else if (arg == "--clients") result.clientCount = std::stoull(value);
+			else if (arg == "--handshakes") result.handshakeCount = std::stoull(value);
+			else if (arg == "--io-context-per-thread") result.ioContextPerThread = std::stoi(value) != 0;
+			else if (arg == "--cpu-affinity") result.cpuAffinity = std::stoi(value) != 0;
+			else if (arg == "--client-threads") result.clientThreadCount = std::stoull(value);
+			else if (arg == "--preflight") result.preflight = value;
+			else if (arg == "--frame-size") result.frameSize = std::stoull(value);
+			else if (arg == "--output") result.output = value;
+			else if (arg == "--cert") result.cert = readFile(value);
+			else if (arg == "--key") result.key = readFile(value);
+			else if (arg == "--dh") result.dh = readFile(value);
+			else if (arg == "--tls-resumption") result.tlsResumption = std::stoi(value) != 0;
+			else throw std::invalid_argument("Unknown argument " + arg);
+		}
+		if (result.iterationCount == 0) {
+			throw std::invalid_argument("The iteration count must be strictly positive.");
+		}
+		if (result.clientCount == 0) {
+			throw std::invalid_argument("The client count must be strictly positive.");
+		}
+		if (result.preflight != "always" && result.preflight != "cached" && result.preflight != "none") {
+			throw std::invalid_argument("The preflight must be always, cached or none.");
+		}
+		return result;
+	}
+
+	/**************
+	*** SERVER ***
+	**************/
+
+	int64_t nowInMicroseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+
+	/**
+	* The in-memory reference store handlers which also fan out the put data objects to the subscribed sessions.
+	*/
+	class NotifyingStoreHandlers : public InMemoryStoreHandlers
+	{
+	public:
+		NotifyingStoreHandlers(AbstractSession* mySession, std::shared_ptr<InMemoryStore> store, std::shared_ptr<InMemoryStore::Transaction> transaction, Server& server) :
+			InMemoryStoreHandlers(mySession, store, transaction), server(server) {}
+
+		void on_PutDataObjects(const Energistics::Etp::v12::Protocol::Store::PutDataObjects& msg, int64_t correlationId) override
+		{
+			InMemoryStoreHandlers::on_PutDataObjects(msg, correlationId);
+
+			for (const auto& entry : msg.dataObjects) {
+				notify(entry.second);
+			}
+		}
+
+	private:
+		void notify(const Energistics::Etp::v12::Datatypes::Object::DataObject& dataObject)
+		{
+			const std::string& uri = dataObject.resource.uri;
+			for (const auto& subscriber : server.getSessions()) {
+				if (subscriber->isEtpSessionClosed()) {
+					continue;
+				}
+				for (const auto& subscription : subscriber->subscriptions) {
+					const std::string& contextUri = subscription.second.context.uri;
+					if (contextUri == "eml:///" || uri.compare(0, contextUri.size(), contextUri) == 0) {
+						Energistics::Etp::v12::Protocol::StoreNotification::ObjectChanged objectChanged;
+						objectChanged.change.changeKind = Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::update;
+						objectChanged.change.changeTime = nowInMicroseconds();
+						if (subscription.second.includeObjectData) {
+							objectChanged.change.dataObject = dataObject;
+						}
+						else {
+							objectChanged.change.dataObject.resource = dataObject.resource;
+						}
+						objectChanged.requestUuid = subscription.second.requestUuid;
+						subscriber->send(objectChanged, 0, 0x02);
+					}
+				}
+			}
+		}
+
+		Server& server;
+	};
+
+	class StoreNotificationServerHandlers : public StoreNotificationHandlers
+	{
+	public:
+		StoreNotificationServerHandlers(AbstractSession* mySession) : StoreNotificationHandlers(mySession) {}
+
+		void on_SubscribeNotifications(const Energistics::Etp::v12::Protocol::StoreNotification::SubscribeNotifications& msg, int64_t messageId) override
+		{
+			Energistics::Etp::v12::Protocol::StoreNotification::SubscribeNotificationsResponse response;
+			for (const auto& entry : msg.request) {
+				session->subscriptions[messageId] = entry.second;
+				response.success[entry.first];
+			}
+			session->send(response, messageId, 0x02);
+		}
+	};
+
+	class BenchServerInitializationParameters : public InMemoryStoreServerInitializationParameters
+	{
+	public:
+		BenchServerInitializationParameters(unsigned short port, Server& server) :
+			InMemoryStoreServerInitializationParameters(boost::uuids::random_generator()(), "127.0.0.1", port), server(server) {}
+
+		std::vector<Energistics::Etp::v12::Datatypes::SupportedProtocol> makeSupportedProtocols() const override
+		{
+			return ServerInitializationParameters::makeSupportedProtocols();
+		}
+
+		void postSessionCreationOperation(AbstractSession* session) const override
+		{
+			ServerInitializationParameters::postSessionCreationOperation(session);
+			auto transaction = std::make_shared<InMemoryStore::Transaction>();
+			session->setStoreProtocolHandlers(std::make_shared<NotifyingStoreHandlers>(session, getStore(), transaction, server));
+			session->setDiscoveryProtocolHandlers(std::make_shared<InMemoryDiscoveryHandlers>(session, getStore()));
+			session->setDataArrayProtocolHandlers(std::make_shared<InMemoryDataArrayHandlers>(session, getStore(), transaction));
+			session->setStoreNotificationProtocolHandlers(std::make_shared<StoreNotificationServerHandlers>(session));
+		}
+
+	private:
+		Server& server;
+	};
+
+	/**
+	* Create the dataspaces the benchmarks write in.
+	*/
+	void createDataspaces(InMemoryStore& store, const Options& options)
+	{
+		std::vector<std::string> dataspaceUris = { "eml:///dataspace('bench/getDataObjects')", "eml:///dataspace('bench/dataArrays')", "eml:///dataspace('bench/notifications')" };
+		for (size_t resourceCount : options.resourceCounts) {
+			dataspaceUris.push_back("eml:///dataspace('bench/discovery" + std::to_string(resourceCount) + "')");
+		}
+		for (const auto& dataspaceUri : dataspaceUris) {
+			Energistics::Etp::v12::Datatypes::Object::Dataspace dataspace;
+			dataspace.uri = dataspaceUri;
+			store.putDataspace(dataspace);
+		}
+	}
+
+	/**************
+	*** CLIENTS ***
+	**************/
+
+	/**
+	* Counts the received ObjectChanged notifications and remembers when the last one has been received.
+	*/
+	class CountingStoreNotificationHandlers : public StoreNotificationHandlers
+	{
+	public:
+		CountingStoreNotificationHandlers(AbstractSession* mySession) : StoreNotificationHandlers(mySession) {}
+
+		void on_ObjectChanged(const Energistics::Etp::v12::Protocol::StoreNotification::ObjectChanged&, int64_t) override
+		{
+			lastReceptionTime = Clock::now().time_since_epoch().count();
+			++receivedCount;
+		}
+
+		std::atomic<uint64_t> receivedCount{ 0 };
+		std::atomic<Clock::rep> lastReceptionTime{ 0 };
+	};
+
+	class BenchClientInitializationParameters : public InitializationParameters
+	{
+	public:
+		BenchClientInitializationParameters(unsigned short port) :
+			InitializationParameters(boost::uuids::random_generator()(), "127.0.0.1", port) {}
+
+		void postSessionCreationOperation(AbstractSession* session) const override
+		{
+			InitializationParameters::postSessionCreationOperation(session);
+			session->setStoreProtocolHandlers(std::make_shared<StoreHandlers>(session));
+			session->setDiscoveryProtocolHandlers(std::make_shared<DiscoveryHandlers>(session));
+			session->setDataArrayProtocolHandlers(std::make_shared<DataArrayHandlers>(session));
+			notificationHandlers = std::make_shared<CountingStoreNotificationHandlers>(session);
+			session->setStoreNotificationProtocolHandlers(notificationHandlers);
+		}
+
+		/// The store notification handlers of the latest created session
+		mutable std::shared_ptr<CountingStoreNotificationHandlers> notificationHandlers;
+	};
+
+	/**
+	* A connected client session and the thread running its io context, if it does not share the io context of the other client sessions.
+	*/
+	struct Client {
+		std::shared_ptr<AbstractSession> session;
+		std::shared_ptr<CountingStoreNotificationHandlers> notificationHandlers;
+		std::thread thread;
+	};
+
+	void stopClient(Client& client)
+	{
+		client.session->close();
+		if (client.thread.joinable()) {
+			client.thread.join();
+		}
+		else {
+			const auto start = Clock::now();
+			while (!client.session->isWebSocketSessionClosed() && Clock::now() - start < std::chrono::seconds(10)) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+	}
+
+	template<class SessionType> Client startClient(std::shared_ptr<SessionType> session, bool sharedIoContext)
+	{
+		if (session == nullptr) {
+			throw std::runtime_error("Cannot connect a client session to the benchmark server.");
+		}
+		Client result;
+		result.session = session;
+		if (sharedIoContext) {
+			std::shared_ptr<std::promise<bool>> ready = std::make_shared<std::promise<bool>>();
+			std::future<bool> readyFuture = ready->get_future();
+			session->asyncConnect([ready](AbstractSession&, bool opened) { ready->set_value(opened); });
+			if (readyFuture.wait_for(std::chrono::seconds(10)) != std::future_status::ready || !readyFuture.get()) {
+				stopClient(result);
+				throw std::runtime_error("Cannot open a client session.");
+			}
+			return result;
+		}
+		result.thread = std::thread([session] { session->run(); });
+
+		const auto start = Clock::now();
+		while (session->isEtpSessionClosed()) {
+			if (Clock::now() - start > std::chrono::seconds(10)) {
+				session->close();
+				result.thread.join();
+				throw std::runtime_error("Time out waiting for the opening of a client session.");
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return result;
+	}
+
+	Client connectClient(const Options& options)
+	{
+		BenchClientInitializationParameters params(options.port);
+		params.setMaxWebSocketMessagePayloadSize((std::numeric_limits<int32_t>::max)());
+		if (options.preflight == "always") {
+			params.setEndpointCache(nullptr);
+		}
+		else if (options.preflight == "none") {
+			params.setServerCapabilitiesPreflight(false);
+		}
+		Client result;
+#ifdef WITH_ETP_SSL
+		if (!options.dh.empty()) {
+			result = startClient(ClientSessionLaunchers::createWssClientSession(&params, "", {}, options.frameSize, options.cert, options.clientIoContext),
+				options.clientIoContext != nullptr);
+		}
+		else
+#endif
+		result = startClient(ClientSessionLaunchers::createWsClientSession(&params, "", {}, options.frameSize, options.clientIoContext),
+			options.clientIoContext != nullptr);
+		result.notificationHandlers = params.notificationHandlers;
+		return result;
+	}
+
+	/*****************
+	*** STATISTICS ***
+	*****************/
+
+	struct LatencyStatistics {
+		size_t iterationCount = 0;
+		double totalSeconds = 0;
+		double p50Milliseconds = 0;
+		double p99Milliseconds = 0;
+	};
+
+	/**
+	* Calls operation a given count of times and computes the total elapsed time and the latency percentiles.
+	*/
+	template<typename Operation> LatencyStatistics measure(size_t iterationCount, Operation operation)
+	{
+		std::vector<double> latencies;
+		latencies.reserve(iterationCount);
+		const auto start = Clock::now();
+		for (size_t i = 0; i < iterationCount; ++i) {
+			const auto operationStart = Clock::now();
+			operation();
+			latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - operationStart).count());
+		}
+
+		LatencyStatistics result;
+		result.iterationCount = iterationCount;
+		result.totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+		std::sort(latencies.begin(), latencies.end());
+		// Nearest rank percentiles
+		auto percentile = [&latencies](double p) {
+			const size_t rank = static_cast<size_t>(std::ceil(p * latencies.size()));
+			return latencies[rank == 0 ? 0 : rank - 1];
+		};
+		result.p50Milliseconds = percentile(0.5);
+		result.p99Milliseconds = percentile(0.99);
+		return result;
+	}
+
+	/**
+	* Avoids spending minutes on the largest payloads while keeping enough samples on the smallest ones.
+	*/
+	size_t getIterationCount(const Options& options, size_t byteCount)
+	{
+		const size_t maxByteCountPerScenario = 1 << 28;
+		return (std::max)(static_cast<size_t>(5), (std::min)(options.iterationCount, maxByteCountPerScenario / (std::max)(byteCount, static_cast<size_t>(1))));
+	}
+
+	void writeLatencyStatistics(std::ostream& os, const LatencyStatistics& statistics)
+	{
+		os << "\"iterations\":" << statistics.iterationCount
+			<< ",\"opsPerSecond\":" << statistics.iterationCount / statistics.totalSeconds
+			<< ",\"p50LatencyMs\":" << statistics.p50Milliseconds
+			<< ",\"p99LatencyMs\":" << statistics.p99Milliseconds;
+	}
+
+	/*****************
+	*** SCENARIOS ***
+	*****************/
+
+	std::string makeDataObjectUri(const std::string& dataspaceUri, size_t index)
+	{
+		std::ostringstream oss;
+		oss << dataspaceUri << "/resqml20.obj_IjkGridRepresentation(" << std::hex << std::setfill('0') << std::setw(8) << index
+			<< "-0000-4000-8000-000000000000)";
+		return oss.str();
+	}
+
+	Energistics::Etp::v12::Datatypes::Object::DataObject makeDataObject(const std::string& uri, size_t byteCount)
+	{
+		Energistics::Etp::v12::Datatypes::Object::DataObject result;
+		result.resource.uri = uri;
+		result.resource.name = "Benchmark grid";
+		result.resource.lastChanged = nowInMicroseconds();
+		result.resource.storeLastWrite = result.resource.lastChanged;
+		result.format = "xml";
+		result.data = std::string(byteCount, 'x');
+		return result;
+	}
+
+	void benchmarkGetDataObjects(std::ostream& os, const Options& options, AbstractSession& session)
+	{
+		os << "\"getDataObjects\":[";
+		for (size_t i = 0; i < options.objectSizes.size(); ++i) {
+			const size_t objectSize = options.objectSizes[i];
+			const std::string uri = makeDataObjectUri("eml:///dataspace('bench/getDataObjects')", i);
+			session.putDataObjects({ { "0", makeDataObject(uri, objectSize) } });
+
+			const std::map<std::string, std::string> uris = { { "0", uri } };
+			const LatencyStatistics statistics = measure(getIterationCount(options, objectSize), [&session, &uris]() {
+				if (session.getDataObjects(uris).size() != 1) {
+					throw std::runtime_error("The data object has not been received.");
+				}
+			});
+
+			os << (i == 0 ? "" : ",") << "{\"objectSize\":" << objectSize << ',';
+			writeLatencyStatistics(os, statistics);
+			os << ",\"megabytesPerSecond\":" << objectSize * statistics.iterationCount / statistics.totalSeconds / 1e6 << '}';
+		}
+		os << ']';
+	}
+
+	void setValues(Energistics::Etp::v12::Datatypes::AnyArray& anyArray, size_t count, double) {
+		Energistics::Etp::v12::Datatypes::ArrayOfDouble values;
+		values.values.assign(count, 1.0);
+		anyArray.item.set_ArrayOfDouble(values);
+	}
+	void setValues(Energistics::Etp::v12::Datatypes::AnyArray& anyArray, size_t count, float) {
+		Energistics::Etp::v12::Datatypes::ArrayOfFloat values;
+		values.values.assign(count, 1.0f);
+		anyArray.item.set_ArrayOfFloat(values);
+	}
+	void setValues(Energistics::Etp::v12::Datatypes::AnyArray& anyArray, size_t count, int32_t) {
+		Energistics::Etp::v12::Datatypes::ArrayOfInt values;
+		values.values.assign(count, 1);
+		anyArray.item.set_ArrayOfInt(values);
+	}
+	void setValues(Energistics::Etp::v12::Datatypes::AnyArray& anyArray, size_t count, int64_t) {
+		Energistics::Etp::v12::Datatypes::ArrayOfLong values;
+		values.values.assign(count, 1);
+		anyArray.item.set_ArrayOfLong(values);
+	}
+
+	template<typename T> void benchmarkDataArray(std::ostream& os, const Options& options, AbstractSession& session, const std::string& elementType, bool& first)
+	{
+		for (size_t elementCount : options.arraySizes) {
+			Energistics::Etp::v12::Protocol::DataArray::PutDataArrays putDataArrays;
+			Energistics::Etp::v12::Datatypes::DataArrayTypes::PutDataArraysType& putDataArraysType = putDataArrays.dataArrays["0"];
+			putDataArraysType.uid.uri = makeDataObjectUri("eml:///dataspace('bench/dataArrays')", 0);
+			putDataArraysType.uid.pathInResource = "/RESQML/" + elementType + '/' + std::to_string(elementCount);
+			putDataArraysType.array.dimensions.push_back(elementCount);
+			setValues(putDataArraysType.array.data, elementCount, T());
+
+			Energistics::Etp::v12::Protocol::DataArray::GetDataArrays getDataArrays;
+			getDataArrays.dataArrays["0"] = putDataArraysType.uid;
+
+			const size_t byteCount = elementCount * sizeof(T);
+			const size_t iterationCount = getIterationCount(options, byteCount);
+			const LatencyStatistics putStatistics = measure(iterationCount, [&session, &putDataArrays]() { session.sendAndBlock(putDataArrays, 0, 0x02); });
+			const LatencyStatistics getStatistics = measure(iterationCount, [&session, &getDataArrays]() { session.sendAndBlock(getDataArrays, 0, 0x02); });
+
+			os << (first ? "" : ",") << "{\"elementType\":\"" << elementType << "\",\"elementCount\":" << elementCount << ",\"byteCount\":" << byteCount
+				<< ",\"iterations\":" << iterationCount
+				<< ",\"putGigabytesPerSecond\":" << byteCount * iterationCount / putStatistics.totalSeconds / 1e9
+				<< ",\"getGigabytesPerSecond\":" << byteCount * iterationCount / getStatistics.totalSeconds / 1e9
+				<< ",\"putP50LatencyMs\":" << putStatistics.p50Milliseconds
+				<< ",\"getP50LatencyMs\":" << getStatistics.p50Milliseconds << '}';
+			first = false;
+		}
+	}
+
+	void benchmarkDataArrays(std::ostream& os, const Options& options, AbstractSession& session)
+	{
+		os << "\"dataArrays\":[";
+		bool first = true;
+		benchmarkDataArray<double>(os, options, session, "double", first);
+		benchmarkDataArray<float>(os, options, session, "float", first);
+		benchmarkDataArray<int64_t>(os, options, session, "long", first);
+		benchmarkDataArray<int32_t>(os, options, session, "int", first);
+		os << ']';
+	}
+
+	void benchmarkDiscovery(std::ostream& os, const Options& options, AbstractSession& session)
+	{
+		os << "\"discovery\":[";
+		for (size_t i = 0; i < options.resourceCounts.size(); ++i) {
+			const size_t resourceCount = options.resourceCounts[i];
+			const std::string dataspaceUri = "eml:///dataspace('bench/discovery" + std::to_string(resourceCount) + "')";
+
+			// Fill in the dataspace by batches in order to keep the PutDataObjects messages reasonably sized.
+			std::map<std::string, Energistics::Etp::v12::Datatypes::Object::DataObject> batch;
+			for (size_t index = 0; index < resourceCount; ++index) {
+				batch[std::to_string(index)] = makeDataObject(makeDataObjectUri(dataspaceUri, index), 64);
+				if (batch.size() == 1000 || index + 1 == resourceCount) {
+					session.putDataObjects(batch);
+					batch.clear();
+				}
+			}
+
+			Energistics::Etp::v12::Datatypes::Object::ContextInfo context;
+			context.uri = dataspaceUri;
+			const LatencyStatistics statistics = measure(getIterationCount(options, resourceCount * 256), [&session, &context, resourceCount]() {
+				if (session.getResources(context, Energistics::Etp::v12::Datatypes::Object::ContextScopeKind::targets).size() != resourceCount) {
+					throw std::runtime_error("The discovered resource count is not the expected one.");
+				}
+			});
+
+			os << (i == 0 ? "" : ",") << "{\"resourceCount\":" << resourceCount << ',';
+			writeLatencyStatistics(os, statistics);
+			os << ",\"resourcesPerSecond\":" << resourceCount * statistics.iterationCount / statistics.totalSeconds << '}';
+		}
+		os << ']';
+	}
+
+	void benchmarkNotifications(std::ostream& os, const Options& options, AbstractSession& publisher)
+	{
+		const std::string dataspaceUri = "eml:///dataspace('bench/notifications')";
+
+		std::vector<Client> subscribers;
+		for (size_t i = 0; i < options.subscriberCount; ++i) {
+			subscribers.push_back(connectClient(options));
+
+			Energistics::Etp::v12::Protocol::StoreNotification::SubscribeNotifications subscribeNotifications;
+			Energistics::Etp::v12::Datatypes::Object::SubscriptionInfo& subscriptionInfo = subscribeNotifications.request["0"];
+			subscriptionInfo.context.uri = dataspaceUri;
+			subscriptionInfo.includeObjectData = true;
+			const boost::uuids::uuid requestUuid = boost::uuids::random_generator()();
+			std::copy(std::begin(requestUuid.data), std::end(requestUuid.data), subscriptionInfo.requestUuid.array.begin());
+			subscribers.back().session->sendAndBlock(subscribeNotifications, 0, 0x02);
+		}
+
+		const std::map<std::string, Energistics::Etp::v12::Datatypes::Object::DataObject> dataObjects = {
+			{ "0", makeDataObject(makeDataObjectUri(dataspaceUri, 0), 1024) } };
+		const auto start = Clock::now();
+		for (size_t i = 0; i < options.notificationCount; ++i) {
+			publisher.putDataObjects(dataObjects);
+		}
+
+		// Wait for all subscribers to have received all notifications
+		const uint64_t expectedCount = options.notificationCount;
+		uint64_t receivedCount = 0;
+		Clock::rep lastReceptionTime = start.time_since_epoch().count();
+		for (const auto& subscriber : subscribers) {
+			const auto& handlers = subscriber.notificationHandlers;
+			const auto waitStart = Clock::now();
+			while (handlers->receivedCount < expectedCount && Clock::now() - waitStart < std::chrono::seconds(10)) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			receivedCount += handlers->receivedCount;
+			lastReceptionTime = (std::max)(lastReceptionTime, handlers->lastReceptionTime.load());
+		}
+		const double elapsedSeconds = std::chrono::duration<double>(Clock::duration(lastReceptionTime) - start.time_since_epoch()).count();
+
+		os << "\"notifications\":{\"subscriberCount\":" << options.subscriberCount
+			<< ",\"publishedCount\":" << options.notificationCount
+			<< ",\"expectedCount\":" << expectedCount * options.subscriberCount
+			<< ",\"receivedCount\":" << receivedCount
+			<< ",\"notificationsPerSecond\":" << (elapsedSeconds > 0 ? receivedCount / elapsedSeconds : 0) << '}';
+
+		for (auto& subscriber : subscribers) {
+			stopClient(subscriber);
+		}
+	}
+
+	/**
+	* Runs operation(clientIndex) on one thread per client and rethrows the first failure, if any.
+	*/
+	template<typename Operation> void runConcurrently(size_t clientCount, Operation operation)
+	{
+		std::vector<std::thread> threads;
+		std::vector<std::exception_ptr> failures(clientCount);
+		for (size_t clientIndex = 0; clientIndex < clientCount; ++clientIndex) {
+			threads.emplace_back([&operation, &failures, clientIndex]() {
+				try {
+					operation(clientIndex);
+				}
+				catch (...) {
+					failures[clientIndex] = std::current_exception();
+				}
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		for (const auto& failure : failures) {
+			if (failure) {
+				std::rethrow_exception(failure);
+			}
+		}
+	}
+
+	/**
+	* Writes the aggregated throughput of the concurrent clients, the mean of their median latencies and the worst of their p99 latencies.
+	*/
+	void writeConcurrentStatistics(std::ostream& os, const std::vector<LatencyStatistics>& statistics, double elapsedSeconds)
+	{
+		size_t iterationCount = 0;
+		double p50Milliseconds = 0;
+		double p99Milliseconds = 0;
+		for (const auto& clientStatistics : statistics) {
+			iterationCount += clientStatistics.iterationCount;
+			p50Milliseconds += clientStatistics.p50Milliseconds / statistics.size();
+			p99Milliseconds = (std::max)(p99Milliseconds, clientStatistics.p99Milliseconds);
+		}
+		os << "\"clientCount\":" << statistics.size()
+			<< ",\"iterations\":" << iterationCount
+			<< ",\"opsPerSecond\":" << iterationCount / elapsedSeconds
+			<< ",\"meanP50LatencyMs\":" << p50Milliseconds
+			<< ",\"maxP99LatencyMs\":" << p99Milliseconds;
+	}
+
+	void benchmarkHandshakes(std::ostream& os, const Options& options)
+	{
+		const size_t handshakeCountPerClient = (std::max)(static_cast<size_t>(1), options.handshakeCount / options.clientCount);
+#ifdef WITH_ETP_SSL
+		// Only count the TLS handshakes of this scenario
+		uint64_t fullTlsHandshakeCount = 0;
+		uint64_t resumedTlsHandshakeCount = 0;
+		if (!options.dh.empty()) {
+			const std::shared_ptr<ClientTlsContext> tlsContext = ClientTlsContext::getInstance(options.cert);
+			fullTlsHandshakeCount = tlsContext->getFullHandshakeCount();
+			resumedTlsHandshakeCount = tlsContext->getResumedHandshakeCount();
+		}
+#endif
+		std::vector<LatencyStatistics> statistics(options.clientCount);
+		const auto start = Clock::now();
+		runConcurrently(options.clientCount, [&options, &statistics, handshakeCountPerClient](size_t clientIndex) {
+			statistics[clientIndex] = measure(handshakeCountPerClient, [&options]() {
+				Client client = connectClient(options);
+				stopClient(client);
+			});
+		});
+		const double elapsedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		os << "\"handshakes\":{";
+		writeConcurrentStatistics(os, statistics, elapsedSeconds);
+#ifdef WITH_ETP_SSL
+		if (!options.dh.empty()) {
+			const std::shared_ptr<ClientTlsContext> tlsContext = ClientTlsContext::getInstance(options.cert);
+			os << ",\"tlsResumption\":" << (options.tlsResumption ? "true" : "false")
+				<< ",\"fullTlsHandshakes\":" << tlsContext->getFullHandshakeCount() - fullTlsHandshakeCount
+				<< ",\"resumedTlsHandshakes\":" << tlsContext->getResumedHandshakeCount() - resumedTlsHandshakeCount;
+		}
+#endif
+		os << '}';
+	}
+
+	void benchmarkConcurrentGetDataObjects(std::ostream& os, const Options& options, AbstractSession& session)
+	{
+		const size_t objectSize = 1024;
+		const std::string uri = makeDataObjectUri("eml:///dataspace('bench/getDataObjects')", options.objectSizes.size());
+		session.putDataObjects({ { "0", makeDataObject(uri, objectSize) } });
+		const std::map<std::string, std::string> uris = { { "0", uri } };
+
+		std::vector<Client> clients;
+		for (size_t i = 0; i < options.clientCount; ++i) {
+			clients.push_back(connectClient(options));
+		}
+
+		std::vector<LatencyStatistics> statistics(options.clientCount);
+		const auto start = Clock::now();
+		runConcurrently(options.clientCount, [&options, &clients, &statistics, &uris](size_t clientIndex) {
+			AbstractSession& clientSession = *clients[clientIndex].session;
+			statistics[clientIndex] = measure(options.iterationCount, [&clientSession, &uris]() {
+				if (clientSession.getDataObjects(uris).size() != 1) {
+					throw std::runtime_error("The data object has not been received.");
+				}
+			});
+		});
+		const double elapsedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		for (auto& client : clients) {
+			stopClient(client);
+		}
+
+		os << "\"concurrentGetDataObjects\":{\"objectSize\":" << objectSize << ',';
+		writeConcurrentStatistics(os, statistics, elapsedSeconds);
+		os << '}';
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	try {
+		options = parseOptions(argc, argv);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	// Start the server on its own thread. It is stopped at the end the same way as a user would do : with SIGINT.
+	Server server;
+	BenchServerInitializationParameters serverParams(options.port, server);
+	createDataspaces(*serverParams.getStore(), options);
+	serverParams.setMaxWebSocketMessagePayloadSize((std::numeric_limits<int32_t>::max)());
+	serverParams.setIoContextPerThread(options.ioContextPerThread);
+	serverParams.setCpuAffinity(options.cpuAffinity);
+	serverParams.setTlsSessionCacheSize(options.tlsResumption ? 20480 : 0);
+#ifdef WITH_ETP_SSL
+	if (!options.dh.empty()) {
+		ClientTlsContext::getInstance(options.cert)->setSessionResumption(options.tlsResumption);
+	}
+#endif
+	std::thread serverThread([&]() {
+#ifdef WITH_ETP_SSL
+		server.listen(&serverParams, options.serverThreadCount, options.cert, options.key, options.dh);
+#else
+		server.listen(&serverParams, options.serverThreadCount);
+#endif
+	});
+	// Let the server open its listening port.
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+	std::unique_ptr<IoContextPool> clientPool;
+	if (options.clientThreadCount > 0) {
+		clientPool.reset(new IoContextPool(options.clientThreadCount));
+		options.clientIoContext = clientPool->getIoContext();
+	}
+
+	int result = 0;
+	std::ostringstream json;
+	try {
+		Client client = connectClient(options);
+
+		json << "{\"transport\":\"" << (options.dh.empty() ? "ws" : "wss") << "\",\"serverThreads\":" << options.serverThreadCount
+			<< ",\"ioContextPerThread\":" << (options.ioContextPerThread ? "true" : "false")
+			<< ",\"cpuAffinity\":" << (options.cpuAffinity ? "true" : "false")
+			<< ",\"clientThreads\":" << options.clientThreadCount
+			<< ",\"preflight\":\"" << options.preflight << "\",";
+		benchmarkGetDataObjects(json, options, *client.session);
+		json << ',';
+		benchmarkDataArrays(json, options, *client.session);
+		json << ',';
+		benchmarkDiscovery(json, options, *client.session);
+		json << ',';
+		benchmarkNotifications(json, options, *client.session);
+		json << ',';
+		benchmarkHandshakes(json, options);
+		json << ',';
+		benchmarkConcurrentGetDataObjects(json, options, *client.session);
+		json << "}\n";
+
+		stopClient(client);
+	}
+	catch (const std::exception& e) {
+		std::cerr << "The benchmark failed : " << e.what() << std::endl;
+		result = 1;
+	}
+
+	std::raise(SIGINT);
+	serverThread.join();
+
+	if (result == 0) {
+		if (options.output.empty()) {
+			std::cout << json.str();
+		}
+		else {
+			std::ofstream(options.output) << json.str();
+		}
+	}
+	return result;
+}
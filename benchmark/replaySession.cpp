@@ -0,0 +1,318 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+
+/**
+* Replays the client requests of a recording made with a SessionRecorder (see AbstractSession::setRecorder) against a server
+* and reports the replay throughput and the latency of the responses as JSON.
+*
+* The recording may have been made on the client side or on the server side : the replayed messages are the ones
+* which have been sent by a client (even message ids), which are not Core messages and which are not responses (zero correlation id).
+* Each recorded session is replayed on its own client session, the Core messages being generated again by the new client sessions.
+*
+* Usage : fetpapi_replay --recording traffic.rec [--url ws://127.0.0.1:8080/] [--speed 1] [--authorization "Bearer ..."] [--output result.json]
+* A speed of 1 respects the original pace, 2 replays twice as fast and 0 replays as fast as possible.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/uuid/random_generator.hpp>
+
+#include "etp/ClientSessionLaunchers.h"
+#include "etp/SessionRecorder.h"
+
+using namespace ETP_NS;
+
+namespace {
+	typedef std::chrono::steady_clock Clock;
+
+	struct Options {
+		std::string recording;
+		std::string url = "ws://127.0.0.1:8080/";
+		double speed = 1;
+		std::string authorization;
+		std::string output;
+	};
+
+	/**
+	* Measures the time between the queuing of each replayed request and the reception of its final response.
+	*/
+	class LatencyTracer : public Tracer
+	{
+	public:
+		void record(const TraceRecord& traceRecord) final
+		{
+			const std::lock_guard<std::mutex> lock(mutex);
+			if (traceRecord.event == TraceEvent::MessageQueued) {
+				if (traceRecord.correlationId == 0 && traceRecord.protocol != static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::Core)) {
+					pendingRequests[traceRecord.messageId] = traceRecord.time;
+				}
+			}
+			else if (traceRecord.event == TraceEvent::MessageReceived) {
+				receivedByteCount += traceRecord.byteCount;
+				if (traceRecord.messageType == Energistics::Etp::v12::Protocol::Core::ProtocolException::messageTypeId) {
+					++protocolExceptionCount;
+				}
+				if ((traceRecord.messageFlags & 0x02) != 0) {
+					auto it = pendingRequests.find(traceRecord.correlationId);
+					if (it != pendingRequests.end()) {
+						latencies.push_back(std::chrono::duration<double, std::milli>(traceRecord.time - it->second).count());
+						lastResponseTime = (std::max)(lastResponseTime, traceRecord.time);
+						pendingRequests.erase(it);
+					}
+				}
+			}
+		}
+
+		std::size_t getPendingRequestCount() {
+			const std::lock_guard<std::mutex> lock(mutex);
+			return pendingRequests.size();
+		}
+
+		std::mutex mutex;
+		std::map<int64_t, Clock::time_point> pendingRequests;
+		std::vector<double> latencies;
+		Clock::time_point lastResponseTime;
+		std::size_t receivedByteCount = 0;
+		std::size_t protocolExceptionCount = 0;
+	};
+
+	/**
+	* The responses to the replayed requests are not decoded : only their reception matters.
+	*/
+	class DiscardingHandlers : public ProtocolHandlers
+	{
+	public:
+		DiscardingHandlers(AbstractSession* mySession) : ProtocolHandlers(mySession) {}
+
+		void decodeMessageBody(const Energistics::Etp::v12::Datatypes::MessageHeader&, avro::DecoderPtr) final {}
+	};
+
+	struct ReplayedStream {
+		std::vector<RecordedMessage> requests;
+		std::shared_ptr<AbstractSession> session;
+		std::shared_ptr<LatencyTracer> tracer;
+		std::thread thread;
+	};
+
+	Options parseOptions(int argc, char** argv)
+	{
+		Options result;
+		for (int i = 1; i < argc; ++i) {
+			const std::string arg = argv[i];
+			if (i + 1 >= argc) {
+				throw std::invalid_argument("The argument " + arg + " has no value.");
+			}
+			const std::string value = argv[++i];
+			if (arg == "--recording") result.recording = value;
+			else if (arg == "--url") result.url = value;
+			else if (arg == "--speed") result.speed = std::stod(value);
+			else if (arg == "--authorization") result.authorization = value;
+			else if (arg == "--output") result.output = value;
+			else throw std::invalid_argument("Unknown argument " + arg);
+		}
+		if (result.recording.empty()) {
+			throw std::invalid_argument("The --recording argument is mandatory.");
+		}
+		if (result.speed < 0) {
+			throw std::invalid_argument("The speed cannot be negative.");
+		}
+		return result;
+	}
+
+	/**
+	* @return The recorded client requests grouped by recorded session.
+	*/
+	std::map<uint32_t, ReplayedStream> readRequests(const std::string& recording)
+	{
+		std::map<uint32_t, ReplayedStream> result;
+		SessionRecordingReader reader(recording);
+		RecordedMessage recordedMessage;
+		while (reader.next(recordedMessage)) {
+			avro::InputStreamPtr in = avro::memoryInputStream(recordedMessage.data.data(), recordedMessage.data.size());
+			avro::DecoderPtr d = avro::binaryDecoder();
+			d->init(*in);
+			Energistics::Etp::v12::Datatypes::MessageHeader mh;
+			avro::decode(*d, mh);
+
+			if (mh.messageId % 2 == 0 && mh.correlationId == 0 && mh.protocol != static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::Core)) {
+				result[recordedMessage.stream].requests.push_back(recordedMessage);
+			}
+		}
+		return result;
+	}
+
+	template<class SessionType> void startSession(ReplayedStream& stream, std::shared_ptr<SessionType> session)
+	{
+		if (session == nullptr) {
+			throw std::runtime_error("Cannot connect a client session to the server.");
+		}
+		stream.tracer = std::make_shared<LatencyTracer>();
+		session->setTracer(stream.tracer);
+		stream.session = session;
+		stream.thread = std::thread([session] { session->run(); });
+
+		const auto start = Clock::now();
+		while (session->isEtpSessionClosed()) {
+			if (Clock::now() - start > std::chrono::seconds(10)) {
+				throw std::runtime_error("Time out waiting for the opening of a client session.");
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	void connect(ReplayedStream& stream, const Options& options)
+	{
+		InitializationParameters params{ boost::uuids::random_generator()(), options.url };
+#ifdef WITH_ETP_SSL
+		if (options.url.compare(0, 6, "wss://") == 0) {
+			startSession(stream, ClientSessionLaunchers::createWssClientSession(&params, options.authorization));
+			return;
+		}
+#endif
+		startSession(stream, ClientSessionLaunchers::createWsClientSession(&params, options.authorization));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	std::map<uint32_t, ReplayedStream> streams;
+	try {
+		options = parseOptions(argc, argv);
+		streams = readRequests(options.recording);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	if (streams.empty()) {
+		std::cerr << "The recording does not contain any client request to replay." << std::endl;
+		return 1;
+	}
+
+	int result = 0;
+	std::ostringstream json;
+	try {
+		for (auto& stream : streams) {
+			connect(stream.second, options);
+		}
+
+		// Merge the streams in their recording order
+		std::vector<std::pair<RecordedMessage*, ReplayedStream*>> schedule;
+		for (auto& stream : streams) {
+			for (auto& request : stream.second.requests) {
+				schedule.push_back(std::make_pair(&request, &stream.second));
+			}
+		}
+		std::stable_sort(schedule.begin(), schedule.end(),
+			[](const std::pair<RecordedMessage*, ReplayedStream*>& a, const std::pair<RecordedMessage*, ReplayedStream*>& b) { return a.first->time < b.first->time; });
+
+		std::size_t sentByteCount = 0;
+		const std::chrono::nanoseconds firstTime = schedule.front().first->time;
+		const auto start = Clock::now();
+		for (const auto& scheduled : schedule) {
+			if (options.speed > 0) {
+				std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>((scheduled.first->time - firstTime) / options.speed));
+			}
+			AbstractSession* session = scheduled.second->session.get();
+			session->sendEncodedMessage(scheduled.first->data, std::make_shared<DiscardingHandlers>(session));
+			sentByteCount += scheduled.first->data.size();
+		}
+		const auto sendingEnd = Clock::now();
+
+		// Wait for the final responses
+		std::size_t pendingRequestCount = 0;
+		for (auto& stream : streams) {
+			const auto waitStart = Clock::now();
+			while (stream.second.tracer->getPendingRequestCount() > 0 && Clock::now() - waitStart < std::chrono::seconds(30)) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			pendingRequestCount += stream.second.tracer->getPendingRequestCount();
+		}
+
+		std::vector<double> latencies;
+		Clock::time_point end = sendingEnd;
+		std::size_t receivedByteCount = 0;
+		std::size_t protocolExceptionCount = 0;
+		for (auto& stream : streams) {
+			const std::lock_guard<std::mutex> lock(stream.second.tracer->mutex);
+			latencies.insert(latencies.end(), stream.second.tracer->latencies.begin(), stream.second.tracer->latencies.end());
+			end = (std::max)(end, stream.second.tracer->lastResponseTime);
+			receivedByteCount += stream.second.tracer->receivedByteCount;
+			protocolExceptionCount += stream.second.tracer->protocolExceptionCount;
+		}
+		std::sort(latencies.begin(), latencies.end());
+		// Nearest rank percentiles
+		auto percentile = [&latencies](double p) {
+			if (latencies.empty()) return 0.0;
+			const std::size_t rank = static_cast<std::size_t>(std::ceil(p * latencies.size()));
+			return latencies[rank == 0 ? 0 : rank - 1];
+		};
+		const double elapsedSeconds = std::chrono::duration<double>(end - start).count();
+
+		json << "{\"recording\":\"" << options.recording << "\",\"speed\":" << options.speed
+			<< ",\"sessionCount\":" << streams.size()
+			<< ",\"replayedMessageCount\":" << schedule.size()
+			<< ",\"replayedByteCount\":" << sentByteCount
+			<< ",\"receivedByteCount\":" << receivedByteCount
+			<< ",\"recordedSeconds\":" << std::chrono::duration<double>(schedule.back().first->time - firstTime).count()
+			<< ",\"elapsedSeconds\":" << elapsedSeconds
+			<< ",\"messagesPerSecond\":" << schedule.size() / elapsedSeconds
+			<< ",\"megabytesPerSecond\":" << (sentByteCount + receivedByteCount) / elapsedSeconds / 1e6
+			<< ",\"responseCount\":" << latencies.size()
+			<< ",\"missingResponseCount\":" << pendingRequestCount
+			<< ",\"protocolExceptionCount\":" << protocolExceptionCount
+			<< ",\"p50LatencyMs\":" << percentile(0.5)
+			<< ",\"p90LatencyMs\":" << percentile(0.9)
+			<< ",\"p99LatencyMs\":" << percentile(0.99)
+			<< ",\"maxLatencyMs\":" << (latencies.empty() ? 0 : latencies.back()) << "}\n";
+	}
+	catch (const std::exception& e) {
+		std::cerr << "The replay failed : " << e.what() << std::endl;
+		result = 1;
+	}
+
+	for (auto& stream : streams) {
+		if (stream.second.session) {
+			stream.second.session->close();
+		}
+		if (stream.second.thread.joinable()) {
+			stream.second.thread.join();
+		}
+	}
+
+	if (result == 0) {
+		if (options.output.empty()) {
+			std::cout << json.str();
+		}
+		else {
+			std::ofstream(options.output) << json.str();
+		}
+	}
+	return result;
+}
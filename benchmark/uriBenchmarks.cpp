@@ -0,0 +1,167 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+
+/**
+* Compares the validation of data object URIs by the std::regex expressions EtpHelpers used to construct on each call,
+* by the same expressions compiled once, and by the single pass EtpHelpers::parseUri parser.
+* The URIs are a mix of data object URIs with and without dataspace, with and without object version, from several domains.
+*
+* Constructing the expressions on each call costs about a thousand times more than the other validators :
+* it is only measured on the first URIs, given by --regex-per-call-count, in order to keep the benchmark short.
+*
+* Usage : uriBenchmarks [--count 1000000] [--regex-per-call-count 10000] [--json]
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <vector>
+
+#include "etp/EtpHelpers.h"
+
+#include "AllocationCounter.h"
+
+namespace {
+	typedef std::chrono::steady_clock Clock;
+
+	// The expressions EtpHelpers::validateDataObjectUri used before EtpHelpers::parseUri
+	const char* const v20Expression = "^eml:///(dataspace[(]'.*'[)]/)?(resqml20|eml20)\\.obj_[a-zA-Z0-9]+[(][a-fA-F0-9]{8}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{12}(,.*)?[)]";
+	const char* const expression = "^eml:///(dataspace[(]'.*'[)]/)?(witsml|resqml|prodml|eml)([0-9]{2})\\.[a-zA-Z0-9]+[(][a-fA-F0-9]{8}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{12}(,.*)?[)]";
+
+	bool isV20(const std::string& uri)
+	{
+		return uri.find("resqml20") != std::string::npos || uri.find("eml20") != std::string::npos;
+	}
+
+	std::vector<std::string> makeUris(size_t count)
+	{
+		std::vector<std::string> result;
+		result.reserve(count);
+		for (size_t i = 0; i < count; ++i) {
+			std::ostringstream uuid;
+			uuid << std::hex << std::setfill('0') << std::setw(8) << i << "-0000-4000-8000-000000000000";
+			switch (i % 4) {
+			case 0: result.push_back("eml:///resqml20.obj_IjkGridRepresentation(" + uuid.str() + ")"); break;
+			case 1: result.push_back("eml:///dataspace('demo/Volve')/resqml20.obj_IjkGridRepresentation(" + uuid.str() + ")"); break;
+			case 2: result.push_back("eml:///dataspace('demo/Volve')/witsml20.Wellbore(" + uuid.str() + ",2.1)"); break;
+			default: result.push_back("eml:///dataspace('demo/Volve')/eml23.PropertyKind(" + uuid.str() + ")"); break;
+			}
+		}
+		return result;
+	}
+
+	struct Result {
+		std::string name;
+		double nanoseconds = 0;
+		double allocations = 0;
+		size_t uriCount = 0;
+		size_t validCount = 0;
+	};
+
+	template<typename Validator> Result measure(const std::string& name, const std::vector<std::string>& uris, Validator validator)
+	{
+		Result result;
+		result.name = name;
+		result.uriCount = uris.size();
+		const uint64_t startAllocationCount = fetpapi_benchmark::allocationCount;
+		const auto start = Clock::now();
+		for (const auto& uri : uris) {
+			if (validator(uri)) {
+				++result.validCount;
+			}
+		}
+		result.nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / uris.size();
+		result.allocations = static_cast<double>(fetpapi_benchmark::allocationCount - startAllocationCount) / uris.size();
+		return result;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	size_t count = 1000000;
+	size_t regexPerCallCount = 10000;
+	bool json = false;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "--json") {
+			json = true;
+		}
+		else if (arg == "--count" && i + 1 < argc) {
+			count = std::stoull(argv[++i]);
+		}
+		else if (arg == "--regex-per-call-count" && i + 1 < argc) {
+			regexPerCallCount = std::stoull(argv[++i]);
+		}
+		else {
+			std::cerr << "Unknown argument " << arg << std::endl;
+			return 1;
+		}
+	}
+	if (count == 0 || regexPerCallCount == 0) {
+		std::cerr << "The URI counts must be strictly positive." << std::endl;
+		return 1;
+	}
+
+	const std::vector<std::string> uris = makeUris(count);
+	std::vector<Result> results;
+
+	const std::vector<std::string> regexPerCallUris(uris.begin(), uris.begin() + (std::min)(count, regexPerCallCount));
+	results.push_back(measure("regexPerCall", regexPerCallUris, [](const std::string& uri) {
+		return std::regex_match(uri, std::regex(isV20(uri) ? v20Expression : expression, std::regex::ECMAScript));
+	}));
+
+	const std::regex compiledV20Expression(v20Expression, std::regex::ECMAScript);
+	const std::regex compiledExpression(expression, std::regex::ECMAScript);
+	results.push_back(measure("precompiledRegex", uris, [&](const std::string& uri) {
+		return std::regex_match(uri, isV20(uri) ? compiledV20Expression : compiledExpression);
+	}));
+
+	results.push_back(measure("parseUri", uris, [](const std::string& uri) {
+		ETP_NS::EtpHelpers::UriView view;
+		return ETP_NS::EtpHelpers::parseUri(uri, view) && !view.hasQuery && view.isDataObject();
+	}));
+
+	results.push_back(measure("validateDataObjectUri", uris, [](const std::string& uri) {
+		return ETP_NS::EtpHelpers::validateDataObjectUri(uri).code == -1;
+	}));
+
+	if (json) {
+		std::cout << '[';
+		for (size_t i = 0; i < results.size(); ++i) {
+			std::cout << (i == 0 ? "" : ",") << "\n{\"validator\":\"" << results[i].name << "\",\"uriCount\":" << results[i].uriCount
+				<< ",\"validCount\":" << results[i].validCount
+				<< ",\"nsPerUri\":" << results[i].nanoseconds
+				<< ",\"urisPerSecond\":" << 1e9 / results[i].nanoseconds
+				<< ",\"allocationsPerUri\":" << results[i].allocations << '}';
+		}
+		std::cout << "\n]" << std::endl;
+		return 0;
+	}
+
+	std::cout << "validator\turis\tvalid\tns/uri\turis/s\tallocs/uri" << std::endl;
+	for (const Result& result : results) {
+		std::cout << result.name << '\t' << result.uriCount << '\t' << result.validCount << '\t' << result.nanoseconds
+			<< '\t' << 1e9 / result.nanoseconds << '\t' << result.allocations << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,222 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+
+/**
+* Compares the building, the encoding, the decoding and the matching of the uris map of a GetDataObjects message
+* keyed by the URIs themselves, as most callers do, and keyed by compact keys with the URIs interned in a UriTable (see UriTable::fillUriMap).
+* The matching step gets back the identifier of the requested URI of each decoded entry, as a client does when receiving the response.
+*
+* Usage : uriMapBenchmarks [--count 100000] [--iterations 10] [--json]
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "etp/UriTable.h"
+#include "etp/ProtocolHandlers/ProtocolHandlers.h"
+
+#include "AllocationCounter.h"
+
+namespace {
+	typedef std::chrono::steady_clock Clock;
+
+	std::vector<std::string> makeUris(size_t count)
+	{
+		std::vector<std::string> result;
+		result.reserve(count);
+		for (size_t i = 0; i < count; ++i) {
+			std::ostringstream uuid;
+			uuid << std::hex << std::setfill('0') << std::setw(8) << i << "-0000-4000-8000-000000000000";
+			result.push_back("eml:///dataspace('demo/Volve')/resqml20.obj_IjkGridRepresentation(" + uuid.str() + ")");
+		}
+		return result;
+	}
+
+	struct Step {
+		double nanoseconds = 0;
+		double allocations = 0;
+	};
+
+	struct Result {
+		std::string name;
+		size_t entryCount = 0;
+		size_t byteCount = 0;
+		size_t matchedCount = 0;
+		Step build;
+		Step encode;
+		Step decode;
+		Step match;
+	};
+
+	/**
+	* Measure the average time and allocations per map entry of a step repeated on several iterations.
+	*/
+	void measure(size_t iterations, size_t entryCount, const std::function<void()>& step, Step& result)
+	{
+		const uint64_t startAllocationCount = fetpapi_benchmark::allocationCount;
+		const auto start = Clock::now();
+		for (size_t i = 0; i < iterations; ++i) {
+			step();
+		}
+		result.nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (iterations * entryCount);
+		result.allocations = static_cast<double>(fetpapi_benchmark::allocationCount - startAllocationCount) / (iterations * entryCount);
+	}
+
+	/**
+	* @param build	Fills the uris map of a GetDataObjects message.
+	* @param match	Returns true if a key and a value of the decoded map are matched back to a requested URI.
+	*/
+	Result measureMap(const std::string& name, size_t entryCount, size_t iterations,
+		const std::function<void(Energistics::Etp::v12::Protocol::Store::GetDataObjects&)>& build,
+		const std::function<bool(const std::string&, const std::string&)>& match)
+	{
+		Result result;
+		result.name = name;
+		result.entryCount = entryCount;
+
+		Energistics::Etp::v12::Protocol::Store::GetDataObjects msg;
+		measure(iterations, entryCount, [&]() { build(msg); }, result.build);
+
+		// Same as AbstractSession::encode
+		std::vector<uint8_t> encoded;
+		measure(iterations, entryCount, [&]() {
+			avro::OutputStreamPtr out = avro::memoryOutputStream();
+			avro::EncoderPtr e = avro::binaryEncoder();
+			e->init(*out);
+			avro::encode(*e, msg);
+			e->flush();
+			encoded = *avro::snapshot(*out).get();
+		}, result.encode);
+		result.byteCount = encoded.size();
+
+		// Same as AbstractSession::on_read and the protocol handlers
+		avro::DecoderPtr d = avro::binaryDecoder();
+		const Energistics::Etp::v12::Protocol::Store::GetDataObjects* decoded = &msg;
+		measure(iterations, entryCount, [&]() {
+			avro::InputStreamPtr in = avro::memoryInputStream(encoded.data(), encoded.size());
+			d->init(*in);
+			decoded = &ETP_NS::decodeRecycled<Energistics::Etp::v12::Protocol::Store::GetDataObjects>(*d);
+		}, result.decode);
+		if (decoded->uris.empty()) {
+			// The decoder does not give back the map : match the built one.
+			decoded = &msg;
+		}
+
+		measure(iterations, entryCount, [&]() {
+			result.matchedCount = 0;
+			for (const auto& entry : decoded->uris) {
+				if (match(entry.first, entry.second)) {
+					++result.matchedCount;
+				}
+			}
+		}, result.match);
+
+		return result;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	size_t count = 100000;
+	size_t iterations = 10;
+	bool json = false;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "--json") {
+			json = true;
+		}
+		else if (arg == "--count" && i + 1 < argc) {
+			count = std::stoull(argv[++i]);
+		}
+		else if (arg == "--iterations" && i + 1 < argc) {
+			iterations = std::stoull(argv[++i]);
+		}
+		else {
+			std::cerr << "Unknown argument " << arg << std::endl;
+			return 1;
+		}
+	}
+	if (count == 0 || iterations == 0) {
+		std::cerr << "The count and the iterations must be strictly positive." << std::endl;
+		return 1;
+	}
+
+	const std::vector<std::string> uris = makeUris(count);
+	// The URIs are interned once per session, not once per request.
+	ETP_NS::UriTable uriTable;
+	std::vector<ETP_NS::UriTable::Id> ids;
+	ids.reserve(count);
+	for (const auto& uri : uris) {
+		ids.push_back(uriTable.intern(uri));
+	}
+
+	std::vector<Result> results;
+	results.push_back(measureMap("uriKeys", count, iterations,
+		[&](Energistics::Etp::v12::Protocol::Store::GetDataObjects& msg) {
+			msg.uris.clear();
+			for (const auto& uri : uris) {
+				msg.uris[uri] = uri;
+			}
+		},
+		[&](const std::string& key, const std::string&) {
+			ETP_NS::UriTable::Id id;
+			return uriTable.find(key, id);
+		}));
+
+	results.push_back(measureMap("compactKeys", count, iterations,
+		[&](Energistics::Etp::v12::Protocol::Store::GetDataObjects& msg) {
+			uriTable.fillUriMap(ids, msg.uris);
+		},
+		[&](const std::string& key, const std::string&) {
+			size_t index;
+			return ETP_NS::parseCompactKey(key, index) && index < ids.size();
+		}));
+
+	if (json) {
+		std::cout << '[';
+		for (size_t i = 0; i < results.size(); ++i) {
+			const Result& result = results[i];
+			std::cout << (i == 0 ? "" : ",") << "\n{\"keys\":\"" << result.name << "\",\"entryCount\":" << result.entryCount
+				<< ",\"byteCount\":" << result.byteCount << ",\"matchedCount\":" << result.matchedCount
+				<< ",\"buildNsPerEntry\":" << result.build.nanoseconds << ",\"buildAllocationsPerEntry\":" << result.build.allocations
+				<< ",\"encodeNsPerEntry\":" << result.encode.nanoseconds << ",\"encodeAllocationsPerEntry\":" << result.encode.allocations
+				<< ",\"decodeNsPerEntry\":" << result.decode.nanoseconds << ",\"decodeAllocationsPerEntry\":" << result.decode.allocations
+				<< ",\"matchNsPerEntry\":" << result.match.nanoseconds << ",\"matchAllocationsPerEntry\":" << result.match.allocations << '}';
+		}
+		std::cout << "\n]" << std::endl;
+		return 0;
+	}
+
+	std::cout << "keys\tentries\tbytes\tmatched\tbuild ns\tbuild allocs\tencode ns\tencode allocs\tdecode ns\tdecode allocs\tmatch ns\tmatch allocs" << std::endl;
+	for (const Result& result : results) {
+		std::cout << result.name << '\t' << result.entryCount << '\t' << result.byteCount << '\t' << result.matchedCount
+			<< '\t' << result.build.nanoseconds << '\t' << result.build.allocations
+			<< '\t' << result.encode.nanoseconds << '\t' << result.encode.allocations
+			<< '\t' << result.decode.nanoseconds << '\t' << result.decode.allocations
+			<< '\t' << result.match.nanoseconds << '\t' << result.match.allocations << std::endl;
+	}
+	std::cout << "Times and allocations are per map entry." << std::endl;
+	return 0;
+}
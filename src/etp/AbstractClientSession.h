@@ -20,9 +20,12 @@ under the License.
 
 #include "AbstractSession.h"
 
+#include <functional>
 #include <thread>
 
+#include <boost/asio/bind_executor.hpp>
 #include <boost/asio/connect.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/uuid/random_generator.hpp>
 #include <boost/uuid/uuid_io.hpp>
 
@@ -43,6 +46,10 @@ namespace ETP_NS
 			return ioc;
 		}
 
+		void dispatch(std::function<void()> task) override {
+			boost::asio::post(derived().ws().get_executor(), task);
+		}
+
 		const std::string& getHost() const { return host; }
 		const std::string& getPort() const { return port; }
 		const std::string& getTarget() const { return target; }
@@ -53,20 +60,12 @@ namespace ETP_NS
 		* Everything related to this session (including the completion handlers) will operate on the current thread in a single event loop.
 		* Since this is a loop, you may want to operate this method on a dedicated thread not to block your program.
 		* This method returns only when the session is closed.
+		* It must not be called on a session sharing its io context with other sessions : use asyncConnect instead.
 		*/
 		bool run() {
-			successfulConnection = false;
-
 			// Look up the domain name before to run the session
 			// It is important to do this before to run the io context. Otherwise running the io context would return immediately if nothing has to be done.
-			resolver.async_resolve(
-				host,
-				port,
-				std::bind(
-					&AbstractClientSession::on_resolve,
-					std::static_pointer_cast<AbstractClientSession>(shared_from_this()),
-					std::placeholders::_1,
-					std::placeholders::_2));
+			asyncConnect(nullptr);
 
 			// Run the io_context to perform the resolver and all other binding functions
 			// Run will return only when there will no more be any uncomplete operations (such as a reading operation for example)
@@ -75,9 +74,58 @@ namespace ETP_NS
 			return successfulConnection;
 		}
 
+		/**
+		* Start to open the websocket and then the ETP session without blocking, on the io context of this session.
+		* This is the way to open a session sharing its io context with other sessions (see IoContextPool) : the threads running the io context
+		* are the ones processing the session, instead of a thread per session blocked in run().
+		*
+		* @param onReady	Called on an io context thread once the ETP session is opened (true) or once the opening failed (false), whatever the step which failed.
+		*					It may be nullptr.
+		*/
+		void asyncConnect(std::function<void(AbstractSession&, bool)> onReady) {
+			successfulConnection = false;
+			readyCallback = onReady;
+
+			tcp::resolver::results_type endpoints;
+			if (endpointCache != nullptr && endpointCache->findEndpoints(host, port, endpoints)) {
+				// Still posted so that the completion handlers always operate on the io context, through the strand of the websocket.
+				boost::asio::post(derived().ws().get_executor(),
+					std::bind(
+						&AbstractClientSession::on_resolve,
+						std::static_pointer_cast<AbstractClientSession>(shared_from_this()),
+						boost::system::error_code(),
+						endpoints));
+				return;
+			}
+
+			// The resolver does not belong to the strand of the websocket : bind the completion handler to it.
+			resolver.async_resolve(
+				host,
+				port,
+				boost::asio::bind_executor(derived().ws().get_executor(),
+					std::bind(
+						&AbstractClientSession::on_lookup,
+						std::static_pointer_cast<AbstractClientSession>(shared_from_this()),
+						std::placeholders::_1,
+						std::placeholders::_2)));
+		}
+
+		void on_lookup(boost::system::error_code ec, tcp::resolver::results_type results) {
+			if (!ec && endpointCache != nullptr) {
+				endpointCache->putEndpoints(host, port, results);
+			}
+			on_resolve(ec, results);
+		}
+
 		void on_connect(boost::system::error_code ec) {
 			if (ec) {
 				std::cerr << "on_connect : " << ec.message() << std::endl;
+				// The cached endpoints may be stale : look the host up again next time.
+				if (endpointCache != nullptr) {
+					endpointCache->eraseEndpoints(host, port);
+				}
+				notifyReady(false);
+				return;
 			}
 
 #if BOOST_VERSION < 107000
@@ -130,11 +178,21 @@ namespace ETP_NS
 					shared_from_this(),
 					std::placeholders::_1));
 		}
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT void do_abort() {
+			boost::system::error_code ec;
+#if BOOST_VERSION < 107000
+			derived().ws().lowest_layer().close(ec);
+#else
+			boost::beast::get_lowest_layer(derived().ws()).close(ec);
+#endif
+			setWebSocketSessionClosed(true);
+		}
 		
 		FETPAPI_DLL_IMPORT_OR_EXPORT void do_read()
 		{
 			if (webSocketSessionClosed) {
-				fesapi_log("CLOSED : NOTHING MORE TO DO");
+				FETPAPI_LOG(this, Debug, "CLOSED : NOTHING MORE TO DO");
 				return;
 			}
 
@@ -155,6 +213,7 @@ namespace ETP_NS
 			if (ec) {
 				std::cerr << "on_handshake : " << ec.message() << std::endl;
 				std::cerr << "Sometimes some ETP server require a trailing slash at the end of their URL" << std::endl;
+				notifyReady(false);
 				return;
 			}
 
@@ -163,7 +222,7 @@ namespace ETP_NS
 				std::cerr << "The client MUST specify the Sec-Websocket-Protocol header value of etp12.energistics.org, and the server MUST reply with the same" << std::endl;
 
 			successfulConnection = true;
-			webSocketSessionClosed = false;
+			setWebSocketSessionClosed(false);
 
 			send(requestSession, 0, 0x02);
 			do_read();
@@ -175,8 +234,12 @@ namespace ETP_NS
 		}
 
 	protected:
-		boost::asio::io_context ioc;
+		/// Keeps the io context of this session alive, whether it is owned by this session only or shared with other sessions.
+		std::shared_ptr<boost::asio::io_context> iocOwner;
+		boost::asio::io_context& ioc;
 		tcp::resolver resolver;
+		/// Where the resolved endpoints of the host are cached. It may be nullptr.
+		std::shared_ptr<EndpointCache> endpointCache;
 		std::string host;
 		std::string port;
 		std::string target;
@@ -185,12 +248,15 @@ namespace ETP_NS
 		websocket::response_type responseType; // In order to check handshake sec_websocket_protocol
 		Energistics::Etp::v12::Protocol::Core::RequestSession requestSession;
 		bool successfulConnection = false;
+		/// Called once the ETP session is opened or once its opening failed. nullptr once called.
+		std::function<void(AbstractSession&, bool)> readyCallback;
 
 		// Access the derived class, this is part of the Curiously Recurring Template Pattern idiom.
 		Derived& derived() { return static_cast<Derived&>(*this); }
 
 		AbstractClientSession() :
-			ioc(4),
+			iocOwner(std::make_shared<boost::asio::io_context>(4)),
+			ioc(*iocOwner),
 			resolver(ioc) {
 			messageId = 2; // The client side of the connection MUST use ONLY non-zero even-numbered messageIds. 
 		}
@@ -199,11 +265,16 @@ namespace ETP_NS
 		 * @param initializationParams  The initialization parameters of the session including IP host, port, requestedProtocols, supportedDataObjects
 		 * @param target				usually "/" but a server can decide to serve etp on a particular target
 		 * @param authorization			The HTTP authorization attribute to send to the server. It may be empty if not needed.
+		 * @param ioContext				The io context processing this session, which may be shared with other sessions.
+		 *								nullptr (default) means that the session owns an io context, run by run().
 		 */
 		AbstractClientSession(
-			InitializationParameters* initializationParams, const std::string & target, const std::string & authorization) :
-			ioc(4),
+			InitializationParameters* initializationParams, const std::string & target, const std::string & authorization,
+			std::shared_ptr<boost::asio::io_context> ioContext = nullptr) :
+			iocOwner(ioContext != nullptr ? ioContext : std::make_shared<boost::asio::io_context>(4)),
+			ioc(*iocOwner),
 			resolver(ioc),
+			endpointCache(initializationParams->getEndpointCache()),
 			host(initializationParams->getHost()),
 			port(std::to_string(initializationParams->getPort())),
 			target(target),
@@ -211,6 +282,8 @@ namespace ETP_NS
 		{
 			messageId = 2; // The client side of the connection MUST use ONLY non-zero even-numbered messageIds. 
 
+			setMetricsRegistry(initializationParams->getMetricsRegistry());
+			setHeartbeat(initializationParams->getHeartbeatInterval(), initializationParams->getMaxMissedPongs());
 			initializationParams->postSessionCreationOperation(this);
 
 			// Build the request session
@@ -219,33 +292,51 @@ namespace ETP_NS
 
 			std::copy(std::begin(initializationParams->getInstanceId().data), std::end(initializationParams->getInstanceId().data), requestSession.clientInstanceId.array.begin());
 
-			requestSession.requestedProtocols = initializationParams->makeSupportedProtocols();
-			requestSession.supportedDataObjects = initializationParams->makeSupportedDataObjects();
+			const std::shared_ptr<const SessionCapabilities> capabilities = initializationParams->getSessionCapabilities();
+			requestSession.requestedProtocols = capabilities->getSupportedProtocols();
+			requestSession.supportedDataObjects = capabilities->getSupportedDataObjects();
 			requestSession.supportedFormats.push_back("xml");
 			requestSession.currentDateTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 
-			auto caps = initializationParams->makeEndpointCapabilities();
-			if (!caps.empty()) {
-				requestSession.endpointCapabilities = caps;
-			}
+			requestSession.endpointCapabilities = capabilities->getEndpointCapabilities();
 
 			maxWebSocketMessagePayloadSize = initializationParams->getMaxWebSocketMessagePayloadSize();
+
+			// A websocket session which closes before the ETP session is opened is a failed connection.
+			addClosedCallback([](AbstractSession& session) {
+				static_cast<AbstractClientSession&>(session).notifyReady(false);
+			});
+		}
+
+		/**
+		* Call the ready callback, if any, only once.
+		*/
+		void notifyReady(bool ready) {
+			std::function<void(AbstractSession&, bool)> callback;
+			callback.swap(readyCallback);
+			if (callback) {
+				callback(*this, ready);
+			}
+		}
+
+		void on_etpSessionOpened() override {
+			notifyReady(true);
 		}
 
 		void do_write() {
 			const std::lock_guard<std::mutex> specificProtocolHandlersLock(specificProtocolHandlersMutex);
 			if (sendingQueue.empty()) {
-				fesapi_log("The sending queue is empty.");
+				FETPAPI_LOG(this, Trace, "The sending queue is empty.");
 				return;
 			}
 
 			bool previousSentMessageCompleted = specificProtocolHandlers.find(std::get<0>(sendingQueue.front())) == specificProtocolHandlers.end();
 
 			if (!previousSentMessageCompleted) {
-				fesapi_log("Cannot send Message id :", std::to_string(std::get<0>(sendingQueue.front())), "because the previous message has not finished to be sent.");
+				FETPAPI_LOG(this, Trace, "Cannot send Message id :", std::get<0>(sendingQueue.front()), "because the previous message has not finished to be sent.");
 			}
 			else {
-				fesapi_log("Sending Message id :", std::to_string(std::get<0>(sendingQueue.front())));
+				FETPAPI_LOG(this, Trace, "Sending Message id :", std::get<0>(sendingQueue.front()));
 
 				derived().ws().async_write(
 					boost::asio::buffer(std::get<1>(sendingQueue.front())),
@@ -48,14 +48,14 @@ namespace ETP_NS
 
 		void do_write() {
 			if (sendingQueue.empty()) {
-				fesapi_log("The sending queue is empty.");
+				FETPAPI_LOG(this, Trace, "The sending queue is empty.");
 				return;
 			}
 
 			bool previousSentMessageCompleted = specificProtocolHandlers.find(std::get<0>(sendingQueue.front())) == specificProtocolHandlers.end();
 
 			if (!previousSentMessageCompleted) {
-				fesapi_log("Cannot send Message id :", std::to_string(std::get<0>(sendingQueue.front())), " because the previous messgae has not finished to be sent.");
+				FETPAPI_LOG(this, Trace, "Cannot send Message id :", std::get<0>(sendingQueue.front()), "because the previous message has not finished to be sent.");
 			}
 			else {
 				derived().ws().async_write(
@@ -81,6 +81,9 @@ namespace ETP_NS
 			messageId = 1; // The client side of the connection MUST use ONLY non-zero even-numbered messageIds.
 			boost::uuids::random_generator gen;
 			identifier = gen();
+			setMetricsRegistry(serverInitializationParams->getMetricsRegistry());
+			setHeartbeat(serverInitializationParams->getHeartbeatInterval(), serverInitializationParams->getMaxMissedPongs());
+			setIdleTimeOut(serverInitializationParams->getIdleTimeOut());
 		}
 
 		virtual ~AbstractPlainOrSslServerSession() = default;
@@ -89,6 +92,10 @@ namespace ETP_NS
 			return static_cast<boost::asio::io_context&> (derived().ws().get_executor().context());
 		}
 
+		void dispatch(std::function<void()> task) override {
+			boost::asio::dispatch(strand, task);
+		}
+
 		ServerInitializationParameters const* getServerInitializationParameters() const { return serverInitializationParams_; }
 
 		/**
@@ -168,12 +175,26 @@ namespace ETP_NS
 						std::placeholders::_1)));
 		 }
 
+		void do_abort() {
+			boost::system::error_code ec;
+#if BOOST_VERSION < 107000
+			derived().ws().lowest_layer().close(ec);
+#else
+			boost::beast::get_lowest_layer(derived().ws()).close(ec);
+#endif
+			setWebSocketSessionClosed(true);
+		}
+
 		 void on_accept(boost::system::error_code ec) {
+			 std::shared_ptr<MetricsRegistry> metricsRegistry = serverInitializationParams_->getMetricsRegistry();
+			 if (metricsRegistry) {
+				 metricsRegistry->recordHandshake(!ec);
+			 }
 			 if (ec) {
 				 std::cerr << "on_accept : " << ec.message() << std::endl;
 			 }
 
-			 webSocketSessionClosed = false;
+			 setWebSocketSessionClosed(false);
 
 			 // Read a message
 			 do_read();
@@ -182,7 +203,7 @@ namespace ETP_NS
 		void do_read()
 		{
 			if (webSocketSessionClosed) {
-				fesapi_log("CLOSED : NOTHING MORE TO DO");
+				FETPAPI_LOG(this, Debug, "CLOSED : NOTHING MORE TO DO");
 				return;
 			}
 
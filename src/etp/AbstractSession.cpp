@@ -28,12 +28,8 @@ Energistics::Etp::v12::Datatypes::MessageHeader AbstractSession::decodeMessageHe
 	Energistics::Etp::v12::Datatypes::MessageHeader receivedMh;
 	avro::decode(*decoder, receivedMh);
 
-	fesapi_log("Message Header received :");
-	fesapi_log("protocol :", std::to_string(receivedMh.protocol));
-	fesapi_log("type :", std::to_string(receivedMh.messageType));
-	fesapi_log("id :", std::to_string(receivedMh.messageId));
-	fesapi_log("correlation id :", std::to_string(receivedMh.correlationId));
-	fesapi_log("flags :", std::to_string(receivedMh.messageFlags));
+	FETPAPI_LOG(this, Trace, "Message Header received : protocol :", receivedMh.protocol, "type :", receivedMh.messageType,
+		"id :", receivedMh.messageId, "correlation id :", receivedMh.correlationId, "flags :", receivedMh.messageFlags);
 
 	return receivedMh;
 }
@@ -46,13 +42,15 @@ void AbstractSession::on_read(boost::system::error_code ec, std::size_t bytes_tr
 
 		if (ec == websocket::error::closed) {
 			// This indicates that the web socket (and consequently etp) session was closed
-			fesapi_log("The other endpoint closed the web socket (and consequently etp) connection.");
-			webSocketSessionClosed = true;
+			FETPAPI_LOG(this, Info, "The other endpoint closed the web socket (and consequently etp) connection.");
+			setWebSocketSessionClosed(true);
 			flushReceivingBuffer();
 		}
 		else {
 			// This indicates an unexpected error
-			fesapi_log("on_read : error code number", ec.value(), "->", ec.message());
+			FETPAPI_LOG(this, Error, "on_read : error code number", ec.value(), "->", ec.message());
+			// No more message will be read on this websocket.
+			setWebSocketSessionClosed(true);
 		}
 
 		return;
@@ -62,9 +60,15 @@ void AbstractSession::on_read(boost::system::error_code ec, std::size_t bytes_tr
 		return;
 	}
 
-	fesapi_log("Receiving", std::to_string(bytes_transferred), "bytes");
+	FETPAPI_LOG(this, Trace, "Receiving", bytes_transferred, "bytes");
+	if (recorder) {
+		recorder->record(this, RecordedDirection::Received, static_cast<const uint8_t*>(receivedBuffer.data().data()), bytes_transferred);
+	}
 	avro::InputStreamPtr in = avro::memoryInputStream(static_cast<const uint8_t*>(receivedBuffer.data().data()), bytes_transferred);
-	avro::DecoderPtr d = avro::binaryDecoder();
+	if (receivedMessageDecoder == nullptr) {
+		receivedMessageDecoder = avro::binaryDecoder();
+	}
+	avro::DecoderPtr d = receivedMessageDecoder;
 	d->init(*in);
 
 	Energistics::Etp::v12::Datatypes::MessageHeader receivedMh;
@@ -79,6 +83,21 @@ void AbstractSession::on_read(boost::system::error_code ec, std::size_t bytes_tr
 		return;
 	}
 
+	if (metrics) {
+		metrics->recordReceivedMessage(receivedMh.protocol, receivedMh.messageType, receivedMh.correlationId, receivedMh.messageFlags, bytes_transferred);
+	}
+	if (receivedMh.protocol == static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::Core) &&
+		receivedMh.messageType == Energistics::Etp::v12::Protocol::Core::Pong::messageTypeId) {
+		on_pongReceived(receivedMh.correlationId);
+	}
+	else if (idleTimeOut.count() > 0) {
+		lastActivityTime = std::chrono::steady_clock::now();
+	}
+	const std::chrono::steady_clock::time_point receptionTime = tracer ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+	if (tracer) {
+		trace(TraceEvent::MessageReceived, receivedMh, bytes_transferred, receptionTime);
+	}
+
 	// Request for Acknowledge
 	if ((receivedMh.messageFlags & 0x10) != 0) {
 		Energistics::Etp::v12::Protocol::Core::Acknowledge acknowledge;
@@ -86,6 +105,50 @@ void AbstractSession::on_read(boost::system::error_code ec, std::size_t bytes_tr
 		send(acknowledge, receivedMh.messageId, 0x02);
 	}
 
+	// The session management messages of the Core protocol (RequestSession, OpenSession, CloseSession, Ping, Pong...) are processed on the io context thread.
+	// A ProtocolException or an Acknowledge may be sent with the Core protocol id whereas it answers a request of another protocol :
+	// it must follow the previous parts of the response on the same ordering key, otherwise it could end the response before them.
+	const bool isSessionManagementMessage = receivedMh.protocol == static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::Core) &&
+		receivedMh.messageType != Energistics::Etp::v12::Protocol::Core::ProtocolException::messageTypeId &&
+		receivedMh.messageType != Energistics::Etp::v12::Protocol::Core::Acknowledge::messageTypeId;
+	if (handlerDispatcher != nullptr && !isSessionManagementMessage) {
+		// Copy the message out of the receiving buffer so that the next message can be read while the handlers are working.
+		const uint8_t* data = static_cast<const uint8_t*>(receivedBuffer.data().data());
+		std::shared_ptr<std::vector<uint8_t>> message = std::make_shared<std::vector<uint8_t>>(data, data + bytes_transferred);
+		flushReceivingBuffer();
+
+		// Answers to the same request, or uncorrelated messages of the same protocol, must be processed in their reception order.
+		// Message ids are positive, consequently negative keys are used for protocols.
+		const int64_t orderingKey = receivedMh.correlationId != 0 ? receivedMh.correlationId : -1 - receivedMh.protocol;
+		std::shared_ptr<AbstractSession> self = shared_from_this();
+		handlerDispatcher->post(this, orderingKey, [self, message, receivedMh, receptionTime]() {
+			avro::InputStreamPtr in = avro::memoryInputStream(message->data(), message->size());
+			avro::DecoderPtr d = avro::binaryDecoder();
+			d->init(*in);
+			// Skip the header which has already been decoded on the io context thread
+			Energistics::Etp::v12::Datatypes::MessageHeader mh;
+			avro::decode(*d, mh);
+			setDecodedMessageByteCount(message->size());
+			self->processMessageBody(receivedMh, d);
+			if (self->tracer) {
+				self->trace(TraceEvent::HandlerCompleted, receivedMh, message->size(), receptionTime);
+			}
+		});
+	}
+	else {
+		setDecodedMessageByteCount(bytes_transferred);
+		processMessageBody(receivedMh, d);
+		flushReceivingBuffer();
+		if (tracer) {
+			trace(TraceEvent::HandlerCompleted, receivedMh, bytes_transferred, receptionTime);
+		}
+	}
+
+	do_read();
+}
+
+void AbstractSession::processMessageBody(const Energistics::Etp::v12::Datatypes::MessageHeader& receivedMh, avro::DecoderPtr d)
+{
 	try {
 		if (receivedMh.messageType == Energistics::Etp::v12::Protocol::Core::Acknowledge::messageTypeId) {
 			// Receive Acknowledge
@@ -95,11 +158,7 @@ void AbstractSession::on_read(boost::system::error_code ec, std::size_t bytes_tr
 			// Receive Protocol Exception
 			protocolHandlers[static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::Core)]->decodeMessageBody(receivedMh, d);
 			if ((receivedMh.messageFlags & 0x02) != 0) {
-				const std::lock_guard<std::mutex> specificProtocolHandlersLock(specificProtocolHandlersMutex);
-				auto specificProtocolHandlerIt = specificProtocolHandlers.find(receivedMh.correlationId);
-				if (specificProtocolHandlerIt != specificProtocolHandlers.end()) {
-					specificProtocolHandlers.erase(specificProtocolHandlerIt);
-				}
+				forgetAnsweredMessage(receivedMh.correlationId);
 			}
 		}
 		else {
@@ -111,16 +170,19 @@ void AbstractSession::on_read(boost::system::error_code ec, std::size_t bytes_tr
 					specificProtocolHandler = specificProtocolHandlerIt->second;
 				}
 			} // Scope for specificProtocolHandlersLock
+			auto messageCallbackIt = messageCallbacks.find(getMessageCallbackKey(receivedMh.protocol, receivedMh.messageType));
 
 			if (specificProtocolHandler) {
 				// Receive a message which has been asked to be processed with a specific protocol handler
 				specificProtocolHandler->decodeMessageBody(receivedMh, d);
 				if ((receivedMh.messageFlags & 0x02) != 0) {
-					const std::lock_guard<std::mutex> specificProtocolHandlersLock(specificProtocolHandlersMutex);
-					auto specificProtocolHandlerIt = specificProtocolHandlers.find(receivedMh.correlationId);
-					specificProtocolHandlers.erase(specificProtocolHandlerIt);
+					forgetAnsweredMessage(receivedMh.correlationId);
 				}
 			}
+			else if (messageCallbackIt != messageCallbacks.end()) {
+				// Receive a message to be processed with a callback registered for its message type
+				messageCallbackIt->second(receivedMh, d);
+			}
 			else if (receivedMh.protocol < protocolHandlers.size() && protocolHandlers[receivedMh.protocol] != nullptr) {
 				// Receive a message to be processed with a common protocol handler in case for example an unsollicited notification
 				protocolHandlers[receivedMh.protocol]->decodeMessageBody(receivedMh, d);
@@ -130,21 +192,46 @@ void AbstractSession::on_read(boost::system::error_code ec, std::size_t bytes_tr
 				send(ETP_NS::EtpHelpers::buildSingleMessageProtocolException(4, "The agent does not support the protocol " + std::to_string(receivedMh.protocol) + " identified in a message header."), receivedMh.messageId, 0x02);
 			}
 		}
-		flushReceivingBuffer();
 	}
 	catch (avro::Exception& e)
 	{
-		flushReceivingBuffer();
 		send(ETP_NS::EtpHelpers::buildSingleMessageProtocolException(19, "The agent is unable to de-serialize the body of the message id " + std::to_string(receivedMh.messageId) + " : " + std::string(e.what())), 0, 0x02);
 	}
 
-	if (specificProtocolHandlers.empty() && isCloseRequested)
+	if (isCloseRequested) {
+		bool isLastResponse = false;
+		{
+			const std::lock_guard<std::mutex> specificProtocolHandlersLock(specificProtocolHandlersMutex);
+			isLastResponse = specificProtocolHandlers.empty();
+		} // Scope for specificProtocolHandlersLock
+		if (isLastResponse) {
+			sendCloseSession();
+		}
+	}
+}
+
+void AbstractSession::forgetAnsweredMessage(int64_t correlationId)
+{
+	std::function<void()> listener;
 	{
+		const std::lock_guard<std::mutex> specificProtocolHandlersLock(specificProtocolHandlersMutex);
+		if (specificProtocolHandlers.erase(correlationId) == 0) {
+			return;
+		}
+		listener = answerListener;
+	} // Scope for specificProtocolHandlersLock
+	if (listener) {
+		listener();
+	}
+}
+
+void AbstractSession::sendCloseSession()
+{
+	bool expected = false;
+	if (isCloseSessionSent.compare_exchange_strong(expected, true)) {
 		etpSessionClosed = true;
 		send(Energistics::Etp::v12::Protocol::Core::CloseSession(), 0, 0x02);
 	}
-
-	do_read();
 }
 
 /****************
@@ -360,3 +447,175 @@ std::string AbstractSession::commitTransaction()
 		? ""
 		: handlers->getLastTransactionFailure();
 }
+
+int64_t AbstractSession::sendEncodedMessage(const std::vector<uint8_t>& message, std::shared_ptr<ETP_NS::ProtocolHandlers> specificHandler, int64_t correlationId)
+{
+	avro::InputStreamPtr in = avro::memoryInputStream(message.data(), message.size());
+	avro::DecoderPtr d = avro::binaryDecoder();
+	d->init(*in);
+	Energistics::Etp::v12::Datatypes::MessageHeader mh;
+	avro::decode(*d, mh);
+
+	// The Avro binary encoding is canonical : encoding again the decoded header gives its size in the encoded message.
+	avro::OutputStreamPtr out = avro::memoryOutputStream();
+	avro::EncoderPtr e = avro::binaryEncoder();
+	e->init(*out);
+	avro::encode(*e, mh);
+	e->flush();
+	const std::size_t headerSize = e->byteCount();
+	if (headerSize > message.size()) {
+		throw std::invalid_argument("The encoded message is truncated.");
+	}
+
+	mh.messageId = messageId.fetch_add(2);
+	mh.correlationId = correlationId;
+	out = avro::memoryOutputStream();
+	e->init(*out);
+	avro::encode(*e, mh);
+	e->flush();
+	std::vector<uint8_t> encoded = *avro::snapshot(*out).get();
+	encoded.insert(encoded.end(), message.begin() + headerSize, message.end());
+
+	auto queueItem = std::make_tuple(mh.messageId, std::move(encoded), specificHandler);
+	std::unique_lock<std::mutex> sendingQueueLock(sendingQueueMutex);
+	waitForRoomInSendingQueue(sendingQueueLock, queueItem, correlationId);
+
+	notifyQueuedMessage(mh.protocol, mh.messageType, queueItem, correlationId, mh.messageFlags);
+	return pushIntoSendingQueue(std::move(queueItem));
+}
+
+void AbstractSession::traceWrittenMessage(const std::vector<uint8_t>& message)
+{
+	// Only the header of the written message is decoded, in order to identify it.
+	avro::InputStreamPtr in = avro::memoryInputStream(message.data(), message.size());
+	avro::DecoderPtr d = avro::binaryDecoder();
+	d->init(*in);
+	Energistics::Etp::v12::Datatypes::MessageHeader mh;
+	avro::decode(*d, mh);
+
+	trace(TraceEvent::MessageWritten, mh, message.size());
+}
+
+void AbstractSession::startLivenessChecks()
+{
+	if (heartbeatInterval.count() == 0 && idleTimeOut.count() == 0) {
+		return;
+	}
+	if (livenessTimer == nullptr) {
+		livenessTimer.reset(new boost::asio::steady_timer(getIoContext()));
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	pendingPingId = -1;
+	missedPongCount = 0;
+	nextPingTime = now + heartbeatInterval;
+	lastActivityTime = now;
+	isIdleCloseRequested = false;
+	scheduleLivenessCheck();
+}
+
+void AbstractSession::scheduleLivenessCheck()
+{
+	std::chrono::steady_clock::time_point nextCheckTime = (std::chrono::steady_clock::time_point::max)();
+	if (heartbeatInterval.count() > 0) {
+		nextCheckTime = nextPingTime;
+	}
+	if (idleTimeOut.count() > 0) {
+		nextCheckTime = (std::min)(nextCheckTime, lastActivityTime + idleTimeOut);
+	}
+
+	std::shared_ptr<AbstractSession> self = shared_from_this();
+	livenessTimer->expires_at(nextCheckTime);
+	livenessTimer->async_wait([self](boost::system::error_code ec) {
+		if (ec != boost::asio::error::operation_aborted) {
+			self->dispatch([self]() { self->checkLiveness(); });
+		}
+	});
+}
+
+void AbstractSession::checkLiveness()
+{
+	if (isWebSocketSessionClosed()) {
+		return;
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	if (idleTimeOut.count() > 0 && now - lastActivityTime >= idleTimeOut) {
+		if (isIdleCloseRequested) {
+			FETPAPI_LOG(this, Warning, "The idle session has not been closed gracefully. Its connection is closed.");
+			do_abort();
+			return;
+		}
+		FETPAPI_LOG(this, Info, "No message has been received for", idleTimeOut.count(), "ms. The session is going to be closed.");
+		if (metrics) {
+			metrics->recordReapedSession();
+		}
+		isIdleCloseRequested = true;
+		// Give the same duration to the other endpoint for closing the session gracefully.
+		lastActivityTime = now;
+		close();
+	}
+
+	// No ping once the ETP session is closing but the next ping time keeps moving forward.
+	// An unanswered ping is forgotten, not to prevent the session from closing.
+	if (heartbeatInterval.count() > 0 && now >= nextPingTime && !isEtpSessionClosed()) {
+		if (pendingPingId >= 0) {
+			++missedPongCount;
+			if (metrics) {
+				metrics->recordMissedPong();
+			}
+			forgetPendingPing();
+			if (missedPongCount >= maxMissedPongCount) {
+				FETPAPI_LOG(this, Warning, missedPongCount, "pings in a row have not been answered. The connection is closed.");
+				if (metrics && !isIdleCloseRequested) {
+					metrics->recordReapedSession();
+				}
+				do_abort();
+				return;
+			}
+			if (isCloseRequested) {
+				// The unanswered ping may have been the last message preventing the requested close.
+				close();
+			}
+		}
+	}
+	if (heartbeatInterval.count() > 0 && now >= nextPingTime && !isEtpSessionClosed() && !isCloseRequested) {
+		Energistics::Etp::v12::Protocol::Core::Ping ping;
+		ping.currentDateTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		pendingPingId = send(ping, 0, 0x02);
+		pingSendingTime = now;
+	}
+	if (heartbeatInterval.count() > 0 && now >= nextPingTime) {
+		nextPingTime = now + heartbeatInterval;
+	}
+
+	scheduleLivenessCheck();
+}
+
+void AbstractSession::forgetPendingPing()
+{
+	if (pendingPingId < 0) {
+		return;
+	}
+	{
+		const std::lock_guard<std::mutex> specificProtocolHandlersLock(specificProtocolHandlersMutex);
+		specificProtocolHandlers.erase(pendingPingId);
+	} // Scope for specificProtocolHandlersLock
+	pendingPingId = -1;
+}
+
+void AbstractSession::on_pongReceived(int64_t correlationId)
+{
+	if (pendingPingId < 0) {
+		return;
+	}
+	// A late pong also proves that the other endpoint is alive.
+	missedPongCount = 0;
+	if (correlationId == pendingPingId) {
+		pendingPingId = -1;
+		const int64_t roundTripTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - pingSendingTime).count();
+		const int64_t smoothed = smoothedPingRoundTripTime.load();
+		// Same smoothing as the TCP round trip time estimation (RFC 6298)
+		smoothedPingRoundTripTime = smoothed < 0 ? roundTripTime : smoothed + (roundTripTime - smoothed) / 8;
+	}
+}
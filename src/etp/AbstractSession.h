@@ -18,21 +18,35 @@ under the License.
 -----------------------------------------------------------------------*/
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <queue>
+#include <sstream>
 #include <unordered_map>
 #include <utility>
 
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/uuid/nil_generator.hpp>
 
 #include "../nsDefinitions.h"
 
 #include "EtpHelpers.h"
+#include "HandlerDispatcher.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "SessionRecorder.h"
+#include "Tracing.h"
+#include "UriTable.h"
 #include "ProtocolHandlers/CoreHandlers.h"
 #include "ProtocolHandlers/DiscoveryHandlers.h"
 #include "ProtocolHandlers/StoreHandlers.h"
@@ -61,6 +75,9 @@ namespace ETP_NS
 {
 	class AbstractSession : public std::enable_shared_from_this<AbstractSession>
 	{
+		/// Indexes the sessions by their identifier before their ETP session is opened
+		friend class SessionRegistry;
+
 	public:
 
 		virtual ~AbstractSession() = default;
@@ -69,12 +86,9 @@ namespace ETP_NS
 		* Return the identifier of the session which is an UUID.
 		* If the ETP session is not set up, it returns the nil UUID.
 		*/
-		const boost::uuids::uuid& getIdentifier() {
-			if (isEtpSessionClosed()) {
-				identifier = boost::uuids::nil_uuid();
-			}
-
-			return identifier;
+		const boost::uuids::uuid& getIdentifier() const {
+			static const boost::uuids::uuid nilUuid = boost::uuids::nil_uuid();
+			return isEtpSessionClosed() ? nilUuid : identifier;
 		}
 
 		/**
@@ -203,6 +217,57 @@ namespace ETP_NS
 			protocolHandlers[static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::Dataspace)] = dataspaceHandlers;
 		}
 
+		/**
+		 * Set a dispatcher which executes the protocol handlers on its worker threads instead of the io context thread,
+		 * except the ones of the Core session management messages (RequestSession, OpenSession, CloseSession, Ping, Pong...).
+		 * Messages answering the same request, including a final ProtocolException or Acknowledge, or uncorrelated messages of the same protocol,
+		 * are still processed in their reception order.
+		 * The same dispatcher can be shared by several sessions.
+		 *
+		 * @param dispatcher	The dispatcher to use or nullptr (default) to execute the handlers on the io context thread.
+		 */
+		FETPAPI_DLL_IMPORT_OR_EXPORT void setHandlerDispatcher(std::shared_ptr<HandlerDispatcher> dispatcher) {
+			// Verify that we don't modify the dispatcher which could be in use on the io context thread
+			if (!isWebSocketSessionClosed()) {
+				throw std::logic_error("You cannot set a handler dispatcher once the session is running.");
+			}
+
+			handlerDispatcher = dispatcher;
+		}
+
+		std::shared_ptr<HandlerDispatcher> getHandlerDispatcher() const { return handlerDispatcher; }
+
+		/**
+		 * Register a callback for a particular message type without having to subclass the protocol handlers.
+		 * The callback is used instead of the protocol handlers for this message type except for responses to messages
+		 * which have been sent with a specific handler (e.g. sendAndBlock or the blocking client APIs).
+		 * Core messages cannot be registered since they drive the session life cycle : override CoreHandlers instead.
+		 * Example : session->setMessageCallback<Energistics::Etp::v12::Protocol::Store::GetDataObjects>(
+		 *		[](const Energistics::Etp::v12::Protocol::Store::GetDataObjects& msg, const Energistics::Etp::v12::Datatypes::MessageHeader& mh) { ... });
+		 *
+		 * @param callback	The callback to call with the decoded message body and its header. An empty callback unregisters the message type.
+		 */
+		template<typename T> void setMessageCallback(std::function<void(const T&, const Energistics::Etp::v12::Datatypes::MessageHeader&)> callback)
+		{
+			static_assert(T::protocolId != static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::Core), "Core messages must be handled by the CoreHandlers.");
+
+			// Verify that we don't modify callbacks which could be in use on the io context thread
+			if (!isWebSocketSessionClosed()) {
+				throw std::logic_error("You cannot set some message callbacks once the session is running.");
+			}
+
+			const int64_t key = getMessageCallbackKey(T::protocolId, T::messageTypeId);
+			if (callback) {
+				messageCallbacks[key] = [callback](const Energistics::Etp::v12::Datatypes::MessageHeader& mh, avro::DecoderPtr d) {
+					callback(decodeRecycled<T>(*d), mh);
+					releaseRecycledIfBig<T>();
+				};
+			}
+			else {
+				messageCallbacks.erase(key);
+			}
+		}
+
 		/**
 		 * Create a default ETP message header from the ETP message body.
 		 * Encode this created default ETP message header + the ETP message body and put the result in the sending queue.
@@ -214,12 +279,7 @@ namespace ETP_NS
 		 */
 		template<typename T> int64_t send(const T & mb, int64_t correlationId = 0, int32_t messageFlags = 0)
 		{
-			if (protocolHandlers.size() > mb.protocolId) {
-				return sendWithSpecificHandler(mb, protocolHandlers[mb.protocolId], correlationId, messageFlags);
-			}
-			else {
-				throw std::logic_error("The agent has no registered handler at all for the protocol " + std::to_string(mb.protocolId));
-			}
+			return sendWithSpecificHandler(mb, getDefaultHandlersForSending(mb.protocolId), correlationId, messageFlags);
 		}
 
 		/**
@@ -245,6 +305,9 @@ namespace ETP_NS
 
 		/**
 		* Send a message and register a specific handler for the response.
+		* If a maximum sending queue size has been set and the sending queue is full, this method blocks the current thread
+		* until the queue has been drained enough or until the time out (see setTimeOut) is reached. In the latter case, or if the session closes meanwhile, it throws.
+		* Responses (non zero correlationId) and messages sent from the io context thread never block since it would prevent the queue from being drained.
 		*
 		* @param mb The ETP message body to send
 		* @param specificHandler The handlers which are going to be called for the response to this sent message
@@ -256,35 +319,253 @@ namespace ETP_NS
 		{
 			// Encode the message into AVRO format
 			auto queueItem = encode(mb, correlationId, messageFlags);
+			// Set the handlers which are going to be called for the response to this sent message
+			std::get<2>(queueItem) = specificHandler;
+
+			std::unique_lock<std::mutex> sendingQueueLock(sendingQueueMutex);
+			waitForRoomInSendingQueue(sendingQueueLock, queueItem, correlationId);
+
+			notifyQueuedMessage(mb, queueItem, correlationId, messageFlags);
+			return pushIntoSendingQueue(std::move(queueItem));
+		}
+
+		/**
+		* Send a message which has already been encoded, typically by another session, for example a message read from a SessionRecordingReader.
+		* The message id of the encoded message header is replaced by a new message id of this session. The rest of the header and the body are sent as is.
+		* Like sendWithSpecificHandler, it blocks if the sending queue is full.
+		*
+		* @param message			The whole encoded message i.e. the encoded message header followed by the encoded message body
+		* @param specificHandler	The handlers which are going to be called for the response to this sent message
+		* @param correlationId		The ID of the message which this message is answering to. It replaces the one of the encoded message header.
+		* @return The ID of the message that has been put in the sending queue.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT int64_t sendEncodedMessage(const std::vector<uint8_t>& message, std::shared_ptr<ETP_NS::ProtocolHandlers> specificHandler, int64_t correlationId = 0);
+
+		/**
+		* Same as send but never blocks : if the sending queue is full, the message is not sent at all.
+		*
+		* @param mb The ETP message body to send
+		* @param correlationId The ID of the message which this message is answering to.
+		* @param messageFlags The message flags to be sent within the header
+		* @return The ID of the message that has been put in the sending queue or -1 if the sending queue is full.
+		*/
+		template<typename T> int64_t trySend(const T & mb, int64_t correlationId = 0, int32_t messageFlags = 0)
+		{
+			return trySendWithSpecificHandler(mb, getDefaultHandlersForSending(mb.protocolId), correlationId, messageFlags);
+		}
+
+		/**
+		* Same as sendWithSpecificHandler but never blocks : if the sending queue is full, the message is not sent at all.
+		*
+		* @param mb The ETP message body to send
+		* @param specificHandler The handlers which are going to be called for the response to this sent message
+		* @param correlationId The ID of the message which this message is answering to.
+		* @param messageFlags The message flags to be sent within the header
+		* @return The ID of the message that has been put in the sending queue or -1 if the sending queue is full.
+		*/
+		template<typename T> int64_t trySendWithSpecificHandler(const T & mb, std::shared_ptr<ETP_NS::ProtocolHandlers> specificHandler, int64_t correlationId = 0, int32_t messageFlags = 0)
+		{
+			auto queueItem = encode(mb, correlationId, messageFlags);
+			std::get<2>(queueItem) = specificHandler;
 
 			const std::lock_guard<std::mutex> sendingQueueLock(sendingQueueMutex);
-			// Set the handlers which are going to be called for the response to this sent message
+			if (!waitingQueue.empty() || !hasRoomInSendingQueue(std::get<1>(queueItem).size())) {
+				FETPAPI_LOG(this, Warning, "The sending queue is full. Message id", std::get<0>(queueItem), "has not been sent.");
+				return -1;
+			}
+
+			notifyQueuedMessage(mb, queueItem, correlationId, messageFlags);
+			return pushIntoSendingQueue(std::move(queueItem));
+		}
+
+		/**
+		* Same as send but never blocks : if the sending queue is full, the message is kept aside and
+		* is put in the sending queue as soon as the queue has been drained enough.
+		*
+		* @param mb The ETP message body to send
+		* @param onQueued Called on the io context thread with the ID of the message once it has been put in the sending queue, or with -1 if the session closed before.
+		* @param correlationId The ID of the message which this message is answering to.
+		* @param messageFlags The message flags to be sent within the header
+		*/
+		template<typename T> void asyncSend(const T & mb, std::function<void(int64_t)> onQueued, int64_t correlationId = 0, int32_t messageFlags = 0)
+		{
+			asyncSendWithSpecificHandler(mb, getDefaultHandlersForSending(mb.protocolId), onQueued, correlationId, messageFlags);
+		}
+
+		/**
+		* Same as sendWithSpecificHandler but never blocks : if the sending queue is full, the message is kept aside and
+		* is put in the sending queue as soon as the queue has been drained enough.
+		*
+		* @param mb The ETP message body to send
+		* @param specificHandler The handlers which are going to be called for the response to this sent message
+		* @param onQueued Called on the io context thread with the ID of the message once it has been put in the sending queue, or with -1 if the session closed before.
+		* @param correlationId The ID of the message which this message is answering to.
+		* @param messageFlags The message flags to be sent within the header
+		*/
+		template<typename T> void asyncSendWithSpecificHandler(const T & mb, std::shared_ptr<ETP_NS::ProtocolHandlers> specificHandler, std::function<void(int64_t)> onQueued, int64_t correlationId = 0, int32_t messageFlags = 0)
+		{
+			auto queueItem = encode(mb, correlationId, messageFlags);
 			std::get<2>(queueItem) = specificHandler;
-			// Push the message into the queue
-			sendingQueue.push(queueItem);
-			fesapi_log("*************************************************");
-			fesapi_log("Message Header put in the queue : ");
-			fesapi_log("protocol :", std::to_string(mb.protocolId));
-			fesapi_log("type :" , std::to_string(mb.messageTypeId));
-			fesapi_log("id :" , std::to_string(std::get<0>(queueItem)));
-			fesapi_log("correlation id :" , std::to_string(correlationId));
-			fesapi_log("flags :" , std::to_string(messageFlags));
-			fesapi_log("Whole message size :" , std::to_string(std::get<1>(queueItem).size()) , "bytes.");
-			fesapi_log("*************************************************");
 
-			// Send the message directly if the sending queue was empty.
-			if (sendingQueue.size() == 1) {
-				do_write();
+			const std::lock_guard<std::mutex> sendingQueueLock(sendingQueueMutex);
+			notifyQueuedMessage(mb, queueItem, correlationId, messageFlags);
+			if (waitingQueue.empty() && hasRoomInSendingQueue(std::get<1>(queueItem).size())) {
+				const int64_t msgId = pushIntoSendingQueue(std::move(queueItem));
+				if (onQueued) {
+					boost::asio::post(getIoContext(), std::bind(onQueued, msgId));
+				}
+			}
+			else {
+				++sendingQueueMessageCount;
+				waitingQueue.push(std::make_pair(std::move(queueItem), onQueued));
+			}
+		}
+
+		/**
+		* Set the maximum size in bytes of all encoded messages which are queued but not sent yet.
+		* A message is always accepted in an empty sending queue, even if it is bigger than this limit.
+		*
+		* @param value The maximum size in bytes. 0 (default) means unlimited.
+		*/
+		void setMaxSendingQueueByteSize(uint64_t value) {
+			maxSendingQueueByteSize = value;
+			sendingQueueCondition.notify_all();
+		}
+		uint64_t getMaxSendingQueueByteSize() const { return maxSendingQueueByteSize; }
+
+		/**
+		* Get the size in bytes of all encoded messages which are queued but not sent yet.
+		*/
+		uint64_t getSendingQueueByteSize() const { return sendingQueueByteSize; }
+
+		/**
+		* Get the count of messages which are queued but not sent yet, including the ones waiting for some room in the sending queue.
+		*/
+		uint64_t getSendingQueueMessageCount() const { return sendingQueueMessageCount; }
+
+		/**
+		* Record the metrics of this session into a registry.
+		* It must be called before the session runs.
+		*
+		* @param registry	The registry aggregating the metrics of this session. nullptr (default) means that no metric is recorded.
+		*/
+		void setMetricsRegistry(std::shared_ptr<MetricsRegistry> registry) {
+			// Verify that we don't modify the metrics which could be in use on the io context thread
+			if (!isWebSocketSessionClosed()) {
+				throw std::logic_error("You cannot set the metrics registry once the session is running.");
+			}
+			metrics = registry != nullptr ? registry->createSessionMetrics() : nullptr;
+		}
+
+		/**
+		* Get the metrics of this session.
+		* @return nullptr if no metrics registry has been set on this session.
+		*/
+		std::shared_ptr<SessionMetrics> getMetrics() const { return metrics; }
+
+		/**
+		* Get the table of the URIs interned by this session.
+		* It helps building and matching the large maps of the Store and DataArray requests and responses with compact keys (see UriTable).
+		*/
+		UriTable& getUriTable() { return uriTable; }
+
+		/**
+		* Trace the queuing, the writing, the reception and the handling of the messages of this session.
+		* It must be called before the session runs.
+		*
+		* @param newTracer	The tracer receiving the trace records, for example a ChromeTraceFileExporter. nullptr (default) disables tracing.
+		*/
+		void setTracer(std::shared_ptr<Tracer> newTracer) {
+			// Verify that we don't modify the tracer which could be in use on the io context thread
+			if (!isWebSocketSessionClosed()) {
+				throw std::logic_error("You cannot set the tracer once the session is running.");
 			}
+			tracer = newTracer;
+		}
+		std::shared_ptr<Tracer> getTracer() const { return tracer; }
 
-			return std::get<0>(queueItem);
+		/**
+		* Record the raw messages received and sent by this session, for example to replay them later against a local server.
+		* It must be called before the session runs.
+		*
+		* @param newRecorder	The recorder writing the messages. nullptr (default) disables the recording.
+		*/
+		void setRecorder(std::shared_ptr<SessionRecorder> newRecorder) {
+			// Verify that we don't modify the recorder which could be in use on the io context thread
+			if (!isWebSocketSessionClosed()) {
+				throw std::logic_error("You cannot set the recorder once the session is running.");
+			}
+			recorder = newRecorder;
+		}
+		std::shared_ptr<SessionRecorder> getRecorder() const { return recorder; }
+
+		/**
+		* Add a function to call once the websocket session is closed, whatever the reason : closing handshake, network error, etc...
+		* The function is called on the io context thread. It must be added before the session runs.
+		*/
+		void addClosedCallback(std::function<void(AbstractSession&)> callback) {
+			// Verify that we don't modify the callbacks which could be called on the io context thread
+			if (!isWebSocketSessionClosed()) {
+				throw std::logic_error("You cannot add a closed callback once the session is running.");
+			}
+			closedCallbacks.push_back(callback);
+		}
+
+		/**
+		* Send a Core Ping at a regular interval while the ETP session is opened and close the connection once some pings in a row
+		* have not been answered before the next one, the other endpoint being considered dead.
+		* The round trip time of the pings is recorded in the metrics, if any, as the one of the Core Ping message type
+		* and its smoothed value is given by getPingRoundTripTime. It must be called before the session runs.
+		*
+		* @param interval		The duration between two pings. Zero (default) disables the heartbeat.
+		* @param maxMissedPongs	The count of pings in a row without pong after which the connection is closed.
+		*/
+		void setHeartbeat(std::chrono::milliseconds interval, unsigned int maxMissedPongs = 3) {
+			// Verify that we don't modify the heartbeat which could be in use on the io context thread
+			if (!isWebSocketSessionClosed()) {
+				throw std::logic_error("You cannot set the heartbeat once the session is running.");
+			}
+			if (maxMissedPongs == 0) {
+				throw std::invalid_argument("The count of missed pongs closing the session must be strictly positive.");
+			}
+			heartbeatInterval = interval;
+			maxMissedPongCount = maxMissedPongs;
+		}
+		std::chrono::milliseconds getHeartbeatInterval() const { return heartbeatInterval; }
+		unsigned int getMaxMissedPongs() const { return maxMissedPongCount; }
+
+		/**
+		* Close the ETP session once no message, except a pong, has been received for some time.
+		* If the other endpoint does not close the connection within the same duration, the connection is closed without further notice.
+		* It must be called before the session runs.
+		*
+		* @param timeOut	Zero (default) disables the idle time out.
+		*/
+		void setIdleTimeOut(std::chrono::milliseconds timeOut) {
+			// Verify that we don't modify the idle time out which could be in use on the io context thread
+			if (!isWebSocketSessionClosed()) {
+				throw std::logic_error("You cannot set the idle time out once the session is running.");
+			}
+			idleTimeOut = timeOut;
 		}
+		std::chrono::milliseconds getIdleTimeOut() const { return idleTimeOut; }
+
+		/**
+		* @return The smoothed round trip time of the heartbeat pings (see setHeartbeat), or a negative duration if no pong has been received yet.
+		*/
+		std::chrono::microseconds getPingRoundTripTime() const { return std::chrono::microseconds(smoothedPingRoundTripTime.load()); }
 
 		/**
 		 * Close the web socket session (without sending any ETP message)
 		 */
 		virtual void do_close() = 0;
 
+		/**
+		* Close the underlying socket without any closing handshake, typically because the other endpoint does not answer anymore.
+		* The websocket session is marked as closed right now and the pending operations fail.
+		*/
+		virtual void do_abort() = 0;
+
 		/**
 		 * Read what is on the websocket
 		 */
@@ -302,8 +583,31 @@ namespace ETP_NS
 
 			// Remove the sent message from the queue
 			const std::lock_guard<std::mutex> sendingQueueLock(sendingQueueMutex);
+			if (tracer && !ec) {
+				traceWrittenMessage(std::get<1>(sendingQueue.front()));
+			}
+			if (recorder && !ec) {
+				recorder->record(this, RecordedDirection::Sent, std::get<1>(sendingQueue.front()).data(), std::get<1>(sendingQueue.front()).size());
+			}
+			sendingQueueByteSize -= std::get<1>(sendingQueue.front()).size();
+			--sendingQueueMessageCount;
 			sendingQueue.pop();
 
+			// Move the messages waiting for some room into the sending queue
+			while (!waitingQueue.empty() && hasRoomInSendingQueue(std::get<1>(waitingQueue.front().first).size())) {
+				std::function<void(int64_t)> onQueued = waitingQueue.front().second;
+				--sendingQueueMessageCount; // It is going to be counted again when pushed into the sending queue
+				const int64_t msgId = pushIntoSendingQueue(std::move(waitingQueue.front().first), false);
+				waitingQueue.pop();
+				if (onQueued) {
+					boost::asio::post(getIoContext(), std::bind(onQueued, msgId));
+				}
+			}
+			sendingQueueCondition.notify_all();
+			if (metrics) {
+				metrics->setSendingQueueSize(sendingQueueMessageCount, sendingQueueByteSize);
+			}
+
 			do_write();
 		}
 
@@ -316,7 +620,20 @@ namespace ETP_NS
 			}
 
 			// If we get here then the connection is closed gracefully
-			webSocketSessionClosed = true;
+			setWebSocketSessionClosed(true);
+
+			// The messages waiting for some room in the sending queue will never be sent.
+			const std::lock_guard<std::mutex> sendingQueueLock(sendingQueueMutex);
+			while (!waitingQueue.empty()) {
+				if (waitingQueue.front().second) {
+					boost::asio::post(getIoContext(), std::bind(waitingQueue.front().second, -1));
+				}
+				--sendingQueueMessageCount;
+				waitingQueue.pop();
+			}
+			if (metrics) {
+				metrics->setSendingQueueSize(sendingQueueMessageCount, sendingQueueByteSize);
+			}
 		}
 
 		/**
@@ -334,6 +651,17 @@ namespace ETP_NS
 		}
 		//FETPAPI_DLL_IMPORT_OR_EXPORT bool isMessageStillProcessing(int64_t msgId) const { return specificProtocolHandlers.count(msgId) > 0; }
 
+		/**
+		* Set a function to call each time a message sent with a specific handler has been completely responded
+		* and once the websocket session is closed, so that a thread waiting for some responses does not have to poll isMessageStillProcessing.
+		* Contrary to the closed callbacks, it can be set while the session is running. Set an empty function to remove it.
+		* The function is called on the io context thread : it must not block.
+		*/
+		void setAnswerListener(std::function<void()> listener) {
+			const std::lock_guard<std::mutex> specificProtocolHandlersLock(specificProtocolHandlersMutex);
+			answerListener = std::move(listener);
+		}
+
 		virtual void setMaxWebSocketMessagePayloadSize(int64_t value) = 0;
 		int64_t getMaxWebSocketMessagePayloadSize() const { return maxWebSocketMessagePayloadSize; }
 
@@ -348,17 +676,14 @@ namespace ETP_NS
 		*/
 		FETPAPI_DLL_IMPORT_OR_EXPORT void close() {
 			isCloseRequested = true;
-			sendingQueueMutex.lock();
-			specificProtocolHandlersMutex.lock();
-			if (specificProtocolHandlers.empty() && sendingQueue.empty()) {
-				etpSessionClosed = true;
-				sendingQueueMutex.unlock();
-				specificProtocolHandlersMutex.unlock();
-				send(Energistics::Etp::v12::Protocol::Core::CloseSession(), 0, 0x02);
-			}
-			else {
-				sendingQueueMutex.unlock();
-				specificProtocolHandlersMutex.unlock();
+			bool isIdle = false;
+			{
+				const std::lock_guard<std::mutex> sendingQueueLock(sendingQueueMutex);
+				const std::lock_guard<std::mutex> specificProtocolHandlersLock(specificProtocolHandlersMutex);
+				isIdle = specificProtocolHandlers.empty() && sendingQueue.empty() && waitingQueue.empty();
+			} // Scope for sendingQueueLock and specificProtocolHandlersLock
+			if (isIdle) {
+				sendCloseSession();
 			}
 		}
 
@@ -382,7 +707,11 @@ namespace ETP_NS
 		*/
 		FETPAPI_DLL_IMPORT_OR_EXPORT bool isEtpSessionClosed() const { return webSocketSessionClosed || etpSessionClosed; }
 
-		void setEtpSessionClosed(bool etpSessionClosed_) { etpSessionClosed = etpSessionClosed_; }
+		void setEtpSessionClosed(bool etpSessionClosed_) {
+			if (etpSessionClosed.exchange(etpSessionClosed_) && !etpSessionClosed_) {
+				on_etpSessionOpened();
+			}
+		}
 
 		/****************
 		*** DATASPACE ***
@@ -531,31 +860,60 @@ namespace ETP_NS
 		/***************************/
 
 		/**
-		* Indicates if the session must be verbose or not
+		* Indicates if the session must be verbose or not.
+		* A verbose session logs at Trace level, a non verbose one does not log at all.
 		*/
 		void setVerbose(bool verbose) {
-			_verbose = verbose;
+			logLevel.store(verbose ? LogLevel::Trace : LogLevel::Off);
 		}
 
-		//terminating log
-		void fesapi_log() { std::cout << std::endl; }
+		/**
+		* Set the lowest level of the messages logged by this session.
+		* Use LogLevel::Off to disable logging.
+		*/
+		void setLogLevel(LogLevel level) { logLevel.store(level); }
+		LogLevel getLogLevel() const { return logLevel.load(); }
 
-		template<typename First, typename ...Rest>
-		void fesapi_log(First && first, Rest && ...rest)
+		/**
+		* @return true if the messages of a given level are logged by this session.
+		*/
+		bool isLogEnabled(LogLevel level) const { return level >= logLevel.load(std::memory_order_relaxed); }
+
+		/**
+		* Format the arguments separated by a space and push them to the asynchronous logger.
+		* Prefer the FETPAPI_LOG macro which does not evaluate the arguments if the level is disabled.
+		*/
+		template<typename ...Args>
+		void log(LogLevel level, Args && ...args)
 		{
-			if (_verbose) {
-				std::cout << std::forward<First>(first) << " ";
-				fesapi_log(std::forward<Rest>(rest)...);
-			}
+			Logger::getInstance().push(level, Logger::format(std::forward<Args>(args)...));
+		}
+
+		/**
+		* Log at Debug level.
+		* Kept for backward compatibility : the arguments are always evaluated by the caller. Prefer the FETPAPI_LOG macro.
+		*/
+		template<typename ...Args>
+		void fesapi_log(Args && ...args)
+		{
+			FETPAPI_LOG(this, Debug, std::forward<Args>(args)...);
 		}
 
 	protected:
 		boost::beast::flat_buffer receivedBuffer;
+		/// The decoder of the received messages, reused from one message to the other.
+		avro::DecoderPtr receivedMessageDecoder;
+		/// The optional dispatcher executing the protocol handlers, except the Core session management ones, on worker threads.
+		std::shared_ptr<HandlerDispatcher> handlerDispatcher;
+		/// The callbacks registered per message type, indexed by getMessageCallbackKey.
+		std::unordered_map<int64_t, std::function<void(const Energistics::Etp::v12::Datatypes::MessageHeader&, avro::DecoderPtr)>> messageCallbacks;
 		/// The default handlers for each subprotocol. Default handlers are at the index of the corresponding subprotocol id.
 		std::vector<std::shared_ptr<ETP_NS::ProtocolHandlers>> protocolHandlers;
 		/// A map indicating which handlers must be used for responding to which message id.
 		std::unordered_map<int64_t, std::shared_ptr<ETP_NS::ProtocolHandlers>> specificProtocolHandlers;
 		std::mutex specificProtocolHandlersMutex;
+		/// Called each time an entry of specificProtocolHandlers is removed by a final response and once the websocket is closed. Protected by specificProtocolHandlersMutex.
+		std::function<void()> answerListener;
 		/// The maximum size in bytes allowed for a complete WebSocket message payload, which is composed of one or more WebSocket frames.
 		/// The limit to use during a session is the smaller of the client's and the server's value for MaxWebSocketMessagePayloadSize,
 		/// which should be determined by the limits imposed by the WebSocket library used by each endpoint. 
@@ -568,22 +926,146 @@ namespace ETP_NS
 		std::atomic<bool> etpSessionClosed{ true };
 		/// Timeout in milliseconds used when blocking waiting for message
 		std::atomic<double> _timeOut{ 10000 };
-		/// Indicates if the session must be verbose or not
-		std::atomic<bool> _verbose{ false };
+		/// The metrics of this session. nullptr if metrics are not recorded.
+		std::shared_ptr<SessionMetrics> metrics;
+		/// The tracer of this session. nullptr if messages are not traced.
+		std::shared_ptr<Tracer> tracer;
+		/// The recorder of the raw messages of this session. nullptr if messages are not recorded.
+		std::shared_ptr<SessionRecorder> recorder;
+		/// The URIs interned by this session.
+		UriTable uriTable;
+		/// The functions to call once the websocket session is closed
+		std::vector<std::function<void(AbstractSession&)>> closedCallbacks;
+		/// The lowest level of the messages logged by this session
+		std::atomic<LogLevel> logLevel{ LogLevel::Off };
+		/// The duration between two heartbeat pings. Zero if there is no heartbeat.
+		std::chrono::milliseconds heartbeatInterval{ 0 };
+		/// The count of heartbeat pings in a row without pong after which the connection is closed.
+		unsigned int maxMissedPongCount{ 3 };
+		/// The duration without any received message after which the session is closed. Zero if there is no idle time out.
+		std::chrono::milliseconds idleTimeOut{ 0 };
+		/// Wakes up the heartbeat and the idle time out checks. Created once the websocket session is opened, if needed.
+		std::unique_ptr<boost::asio::steady_timer> livenessTimer;
+		/// The last heartbeat ping which has not been answered yet, -1 if none. Only accessed by the liveness checks and the reading.
+		int64_t pendingPingId{ -1 };
+		std::chrono::steady_clock::time_point pingSendingTime;
+		std::chrono::steady_clock::time_point nextPingTime;
+		unsigned int missedPongCount{ 0 };
+		/// The smoothed round trip time of the heartbeat pings in microseconds, -1 if no pong has been received yet.
+		std::atomic<int64_t> smoothedPingRoundTripTime{ -1 };
+		/// The last time a message other than a pong has been received, only maintained if there is an idle time out.
+		std::chrono::steady_clock::time_point lastActivityTime;
+		/// Indicates that the session has already been asked to close because it was idle.
+		bool isIdleCloseRequested{ false };
 		/// The queue of messages to be sent where the tuple respectively define message id, message and protocol handlers for responding to this message.
 		std::queue< std::tuple<int64_t, std::vector<uint8_t>, std::shared_ptr<ETP_NS::ProtocolHandlers>> > sendingQueue;
 		std::mutex sendingQueueMutex;
+		/// Notified each time some room is made in the sending queue.
+		std::condition_variable sendingQueueCondition;
+		/// The messages which are waiting for some room in the sending queue, with the callback to call once they are put in the sending queue.
+		std::queue< std::pair<std::tuple<int64_t, std::vector<uint8_t>, std::shared_ptr<ETP_NS::ProtocolHandlers>>, std::function<void(int64_t)>> > waitingQueue;
+		/// The maximum size in bytes of the encoded messages in the sending queue. 0 means unlimited.
+		std::atomic<uint64_t> maxSendingQueueByteSize{ 0 };
+		/// The size in bytes of the encoded messages in the sending queue.
+		std::atomic<uint64_t> sendingQueueByteSize{ 0 };
+		/// The count of messages in the sending queue and in the waiting queue.
+		std::atomic<uint64_t> sendingQueueMessageCount{ 0 };
 		/// The next available message id.
 		std::atomic<int64_t> messageId;
 		/// The identifier of the session
-		boost::uuids::uuid identifier;
+		boost::uuids::uuid identifier = boost::uuids::nil_uuid();
 		/// Indicates that the endpoint request to close the websocket session 
-		bool isCloseRequested{ false };
+		std::atomic<bool> isCloseRequested{ false };
+		/// Indicates that CloseSession has been sent : it is sent only once even if several threads see the session ready to close.
+		std::atomic<bool> isCloseSessionSent{ false };
 
 		AbstractSession() = default;
 
 		virtual boost::asio::io_context& getIoContext() = 0;
 
+		/**
+		* Called on the io context thread each time the ETP session gets opened.
+		*/
+		virtual void on_etpSessionOpened() {}
+
+		/**
+		* Run a task on the io context of this session, serialized with the completion handlers of its websocket.
+		*/
+		virtual void dispatch(std::function<void()> task) {
+			boost::asio::dispatch(getIoContext(), task);
+		}
+
+		/**
+		* Start the heartbeat and the idle time out checks, if any. Called on the io context thread once the websocket session is opened.
+		* The pings are only sent while the ETP session is opened whereas a websocket which never opens an ETP session is an idle one.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void startLivenessChecks();
+
+		/**
+		* Wake up the liveness checks at the next heartbeat or at the next possible idle time out.
+		*/
+		void scheduleLivenessCheck();
+
+		/**
+		* Send a heartbeat ping and close the session if it is dead or idle.
+		*/
+		void checkLiveness();
+
+		/**
+		* Stop waiting for the pong of the pending heartbeat ping, if any, so that it does not prevent the session from closing.
+		*/
+		void forgetPendingPing();
+
+		/**
+		* Forget the specific handler of a message which has been completely responded and call the answer listener.
+		*/
+		void forgetAnsweredMessage(int64_t correlationId);
+
+		/**
+		* Send CloseSession unless it has already been sent, by close() or by the processing of the last awaited response.
+		*/
+		void sendCloseSession();
+
+		/**
+		* Record the round trip time of a heartbeat ping given the pong answering it.
+		*/
+		void on_pongReceived(int64_t correlationId);
+
+		/**
+		* Set the websocket session as opened or closed, keeping the metrics up to date.
+		*/
+		void setWebSocketSessionClosed(bool closed) {
+			const bool wasClosed = webSocketSessionClosed.exchange(closed);
+			if (metrics) {
+				metrics->setWebSocketSessionOpened(!closed);
+			}
+			if (closed && livenessTimer) {
+				livenessTimer->cancel();
+			}
+			else if (!closed && wasClosed) {
+				startLivenessChecks();
+			}
+			if (closed && !wasClosed) {
+				// Wake up the senders waiting for some room in the sending queue which is not going to be drained anymore.
+				// Locking the mutex guarantees that each of them is either already waiting or going to see the closed state.
+				{
+					const std::lock_guard<std::mutex> sendingQueueLock(sendingQueueMutex);
+				} // Scope for sendingQueueLock
+				sendingQueueCondition.notify_all();
+				for (const auto& closedCallback : closedCallbacks) {
+					closedCallback(*this);
+				}
+				std::function<void()> listener;
+				{
+					const std::lock_guard<std::mutex> specificProtocolHandlersLock(specificProtocolHandlersMutex);
+					listener = answerListener;
+				} // Scope for specificProtocolHandlersLock
+				if (listener) {
+					listener();
+				}
+			}
+		}
+
 		void flushReceivingBuffer() {
 			receivedBuffer.consume(receivedBuffer.size());
 		}
@@ -593,12 +1075,162 @@ namespace ETP_NS
 		 */
 		virtual void do_write() = 0;
 
+		/**
+		* Check if a message of a particular size can be put in the sending queue without exceeding the maximum sending queue size.
+		* The sending queue mutex must be locked by the caller.
+		*/
+		bool hasRoomInSendingQueue(size_t byteSize) const {
+			return maxSendingQueueByteSize == 0 || sendingQueue.empty() || sendingQueueByteSize + byteSize <= maxSendingQueueByteSize;
+		}
+
+		/**
+		* Block the current thread until there is some room in the sending queue for a message, if a maximum sending queue size has been set.
+		* Responses (non zero correlationId) and messages sent from the io context thread never wait since it would prevent the queue from being drained.
+		* It throws if the websocket session closes meanwhile.
+		* The sending queue mutex must be locked by the caller.
+		*/
+		void waitForRoomInSendingQueue(std::unique_lock<std::mutex>& sendingQueueLock, const std::tuple<int64_t, std::vector<uint8_t>, std::shared_ptr<ETP_NS::ProtocolHandlers>>& queueItem, int64_t correlationId) {
+			if (maxSendingQueueByteSize > 0 && correlationId == 0 && !getIoContext().get_executor().running_in_this_thread()) {
+				const size_t byteSize = std::get<1>(queueItem).size();
+				if (!sendingQueueCondition.wait_for(sendingQueueLock, std::chrono::duration<double, std::milli>(_timeOut.load()),
+					[this, byteSize] { return webSocketSessionClosed || (waitingQueue.empty() && hasRoomInSendingQueue(byteSize)); })) {
+					throw std::runtime_error("Time out waiting for some room in the sending queue for message id " + std::to_string(std::get<0>(queueItem)));
+				}
+				if (webSocketSessionClosed) {
+					throw std::runtime_error("The session has been closed while message id " + std::to_string(std::get<0>(queueItem)) + " was waiting for some room in the sending queue.");
+				}
+			}
+		}
+
+		/**
+		* Push an encoded message into the sending queue and send it directly if the sending queue was empty.
+		* The sending queue mutex must be locked by the caller.
+		*
+		* @param queueItem		The encoded message with its id and its response handlers
+		* @param writeIfAlone	Indicates if the message must be directly written if it is alone in the queue.
+		* @return The ID of the message that has been put in the sending queue.
+		*/
+		int64_t pushIntoSendingQueue(std::tuple<int64_t, std::vector<uint8_t>, std::shared_ptr<ETP_NS::ProtocolHandlers>>&& queueItem, bool writeIfAlone = true) {
+			const int64_t msgId = std::get<0>(queueItem);
+			sendingQueueByteSize += std::get<1>(queueItem).size();
+			++sendingQueueMessageCount;
+			sendingQueue.push(std::move(queueItem));
+			if (metrics) {
+				metrics->setSendingQueueSize(sendingQueueMessageCount, sendingQueueByteSize);
+			}
+
+			// Send the message directly if the sending queue was empty.
+			if (writeIfAlone && sendingQueue.size() == 1) {
+				do_write();
+			}
+
+			return msgId;
+		}
+
+		/**
+		* Log and record the metrics of a message which has just been put in the sending queue.
+		*/
+		template<typename T> void notifyQueuedMessage(const T & mb, const std::tuple<int64_t, std::vector<uint8_t>, std::shared_ptr<ETP_NS::ProtocolHandlers>>& queueItem, int64_t correlationId, int32_t messageFlags)
+		{
+			if (metrics) {
+				recordSentProtocolException(mb);
+			}
+			notifyQueuedMessage(mb.protocolId, mb.messageTypeId, queueItem, correlationId, messageFlags);
+		}
+
+		void notifyQueuedMessage(int32_t protocol, int32_t messageType, const std::tuple<int64_t, std::vector<uint8_t>, std::shared_ptr<ETP_NS::ProtocolHandlers>>& queueItem, int64_t correlationId, int32_t messageFlags)
+		{
+			if (metrics) {
+				metrics->recordSentMessage(protocol, messageType, std::get<0>(queueItem), correlationId, std::get<1>(queueItem).size());
+			}
+			if (tracer) {
+				TraceRecord traceRecord = makeTraceRecord(TraceEvent::MessageQueued, std::chrono::steady_clock::now());
+				traceRecord.messageId = std::get<0>(queueItem);
+				traceRecord.correlationId = correlationId;
+				traceRecord.protocol = protocol;
+				traceRecord.messageType = messageType;
+				traceRecord.messageFlags = messageFlags;
+				traceRecord.byteCount = std::get<1>(queueItem).size();
+				tracer->record(traceRecord);
+			}
+			FETPAPI_LOG(this, Trace, "Message Header put in the queue : protocol :", protocol, "type :", messageType,
+				"id :", std::get<0>(queueItem), "correlation id :", correlationId, "flags :", messageFlags,
+				"Whole message size :", std::get<1>(queueItem).size(), "bytes.");
+		}
+
+		TraceRecord makeTraceRecord(TraceEvent event, std::chrono::steady_clock::time_point time) const {
+			TraceRecord result;
+			result.event = event;
+			result.time = time;
+			result.session = this;
+			return result;
+		}
+
+		/**
+		* Send a trace record about a message to the tracer which must not be null.
+		*
+		* @param receptionTime	The time of the event for MessageReceived, the time of the reception of the handled message for HandlerCompleted.
+		*/
+		void trace(TraceEvent event, const Energistics::Etp::v12::Datatypes::MessageHeader& mh, std::size_t byteCount,
+			std::chrono::steady_clock::time_point receptionTime = std::chrono::steady_clock::time_point()) {
+			TraceRecord traceRecord = makeTraceRecord(event, event == TraceEvent::MessageReceived ? receptionTime : std::chrono::steady_clock::now());
+			traceRecord.receptionTime = receptionTime;
+			traceRecord.messageId = mh.messageId;
+			traceRecord.correlationId = mh.correlationId;
+			traceRecord.protocol = mh.protocol;
+			traceRecord.messageType = mh.messageType;
+			traceRecord.messageFlags = mh.messageFlags;
+			traceRecord.byteCount = byteCount;
+			tracer->record(traceRecord);
+		}
+
+		/**
+		* Send a MessageWritten trace record about an encoded message to the tracer which must not be null.
+		*/
+		void traceWrittenMessage(const std::vector<uint8_t>& message);
+
+		template<typename T> void recordSentProtocolException(const T &) {}
+
+		void recordSentProtocolException(const Energistics::Etp::v12::Protocol::Core::ProtocolException & pe) {
+			if (pe.error) {
+				metrics->recordSentProtocolException(pe.error.get().code);
+			}
+			for (const auto& error : pe.errors) {
+				metrics->recordSentProtocolException(error.second.code);
+			}
+		}
+
 		/**
 		 * Reads the message header currently stored in the decoder.
 		 * @param decoder	Must be initialized with stream containing a coded message header.
 		 */
 		Energistics::Etp::v12::Datatypes::MessageHeader decodeMessageHeader(avro::DecoderPtr decoder);
 
+		/**
+		 * Decodes the body of a received message and calls the appropriate handlers.
+		 * @param receivedMh	The already decoded header of the received message.
+		 * @param decoder		Must be initialized with the stream positioned at the start of the coded message body.
+		 */
+		void processMessageBody(const Energistics::Etp::v12::Datatypes::MessageHeader& receivedMh, avro::DecoderPtr decoder);
+
+		static int64_t getMessageCallbackKey(int32_t protocolId, int32_t messageTypeId) {
+			return (static_cast<int64_t>(protocolId) << 32) | static_cast<uint32_t>(messageTypeId);
+		}
+
+		/**
+		 * Get the handlers to register by default for the response of a message of a particular protocol.
+		 * Throws if the agent cannot process any message of this protocol.
+		 */
+		std::shared_ptr<ETP_NS::ProtocolHandlers> getDefaultHandlersForSending(int32_t protocolId) {
+			if (protocolHandlers.size() > static_cast<size_t>(protocolId)) {
+				return protocolHandlers[protocolId];
+			}
+			if (!messageCallbacks.empty()) {
+				return nullptr;
+			}
+			throw std::logic_error("The agent has no registered handler at all for the protocol " + std::to_string(protocolId));
+		}
+
 		template<typename T> std::tuple<int64_t, std::vector<uint8_t>, std::shared_ptr<ETP_NS::ProtocolHandlers>> encode(const T & mb, int64_t correlationId = 0, int32_t messageFlags = 0)
 		{
 			// Build message header
@@ -18,7 +18,8 @@ under the License.
 -----------------------------------------------------------------------*/
 #include "ClientSessionLaunchers.h"
 
-#include <sstream>
+#include <iostream>
+#include <stdexcept>
 
 #include "HttpClientSession.h"
 
@@ -114,46 +115,75 @@ namespace
 		return result;
 	}
 
-	std::size_t getNegotiatedMaxWebSocketFramePayloadSize(const std::string & responseBody, std::size_t preferredMaxFrameSize) {
-		const auto maxWebSocketFramePayloadSizePos = responseBody.find("MaxWebSocketFramePayloadSize");
-		if (maxWebSocketFramePayloadSizePos != std::string::npos) {
-			std::istringstream iss(responseBody);
-			iss.seekg(maxWebSocketFramePayloadSizePos);
-
-			std::string temp;
-			std::size_t serverMaxWebSocketFramePayloadSize;
-			while (!iss.eof()) {
-				/* extracting word by word from stream */
-				iss >> temp;
-
-				/* Checking the given word is integer or not */
-				if (std::istringstream(temp) >> serverMaxWebSocketFramePayloadSize) {
-					return std::min(serverMaxWebSocketFramePayloadSize, preferredMaxFrameSize);
-				}
+	std::string getServerCapabilitiesTarget(const ETP_NS::InitializationParameters* initializationParams) {
+		std::string result = "/" + initializationParams->getUrlPath();
+		if (result[result.size() - 1] != '/') {
+			result += '/';
+		}
+		return result + ".well-known/etp-server-capabilities?GetVersion=etp12.energistics.org";
+	}
+
+	/**
+	* Get the server capabilities from the endpoint cache or else by means of an HTTP(S) GET.
+	* The GET is synchronous : it blocks the calling thread, which is not an io context thread of the session since the session does not exist yet.
+	*
+	* @param get	Performs the HTTP(S) GET of a target and returns the response.
+	* @return		The websocket frame payload size to use according to the server capabilities and to the preferred one.
+	*/
+	template<typename HttpGet>
+	std::size_t getNegotiatedMaxWebSocketFramePayloadSize(ETP_NS::InitializationParameters* initializationParams, std::size_t preferredMaxFrameSize, HttpGet get) {
+		if (!initializationParams->isServerCapabilitiesPreflight()) {
+			return preferredMaxFrameSize;
+		}
+
+		const std::string port = std::to_string(initializationParams->getPort());
+		const std::string target = getServerCapabilitiesTarget(initializationParams);
+		const std::shared_ptr<ETP_NS::EndpointCache> cache = initializationParams->getEndpointCache();
+		std::shared_ptr<const ETP_NS::ServerCapabilitiesSummary> serverCapabilities;
+		if (cache != nullptr) {
+			serverCapabilities = cache->findServerCapabilities(initializationParams->getHost(), port, target);
+		}
+
+		if (serverCapabilities == nullptr) {
+			const http::response<http::string_body> response = get(target);
+			if (response.result() != http::status::ok || response.body().empty()) {
+				// The session may still be opened without the capabilities.
+				return preferredMaxFrameSize;
+			}
+			try {
+				serverCapabilities = std::make_shared<ETP_NS::ServerCapabilitiesSummary>(ETP_NS::parseServerCapabilities(response.body()));
+			}
+			catch (const std::invalid_argument& e) {
+				FETPAPI_LOG(&ETP_NS::Logger::getInstance(), Warning, "Cannot read the server capabilities :", e.what());
+				return preferredMaxFrameSize;
+			}
+			if (cache != nullptr) {
+				cache->putServerCapabilities(initializationParams->getHost(), port, target, serverCapabilities);
 			}
 		}
 
-		return preferredMaxFrameSize;
+		const auto it = serverCapabilities->endpointCapabilities.find("MaxWebSocketFramePayloadSize");
+		return it != serverCapabilities->endpointCapabilities.end() && it->second > 0
+			? std::min(static_cast<std::size_t>(it->second), preferredMaxFrameSize)
+			: preferredMaxFrameSize;
 	}
 }
 
 std::shared_ptr<ETP_NS::PlainClientSession> ETP_NS::ClientSessionLaunchers::createWsClientSession(InitializationParameters* initializationParams, const std::string & authorization,
-	const std::map<std::string, std::string>& additionalHandshakeHeaderFields, std::size_t preferredMaxFrameSize)
+	const std::map<std::string, std::string>& additionalHandshakeHeaderFields, std::size_t preferredMaxFrameSize,
+	std::shared_ptr<boost::asio::io_context> ioContext)
 {
-	boost::asio::io_context ioc;
-	auto httpClientSession = std::make_shared<HttpClientSession>(ioc);
-	std::string etpServerCapTarget = "/" + initializationParams->getUrlPath();
-	if (etpServerCapTarget[etpServerCapTarget.size() - 1] != '/') {
-		etpServerCapTarget += '/';
-	}
-	etpServerCapTarget += ".well-known/etp-server-capabilities?GetVersion=etp12.energistics.org";
-	httpClientSession->run(initializationParams->getHost().c_str(), initializationParams->getPort(), etpServerCapTarget.c_str(), 11, authorization);
-	// Run the I/O service. The call will return when the get operation is complete.
-	ioc.run();
-
-	preferredMaxFrameSize = getNegotiatedMaxWebSocketFramePayloadSize(httpClientSession->getResponse().body(), preferredMaxFrameSize);
-
-	auto result = std::make_shared<PlainClientSession>(initializationParams, "/" + initializationParams->getUrlPath(), authorization, additionalHandshakeHeaderFields, preferredMaxFrameSize);
+	preferredMaxFrameSize = getNegotiatedMaxWebSocketFramePayloadSize(initializationParams, preferredMaxFrameSize,
+		[&](const std::string & etpServerCapTarget) {
+			boost::asio::io_context ioc;
+			auto httpClientSession = std::make_shared<HttpClientSession>(ioc);
+			httpClientSession->run(initializationParams->getHost().c_str(), initializationParams->getPort(), etpServerCapTarget.c_str(), 11, authorization);
+			// Run the I/O service. The call will return when the get operation is complete.
+			ioc.run();
+			return httpClientSession->getResponse();
+		});
+
+	auto result = std::make_shared<PlainClientSession>(initializationParams, "/" + initializationParams->getUrlPath(), authorization, additionalHandshakeHeaderFields, preferredMaxFrameSize, ioContext);
 	initializationParams->postSessionCreationOperation(result.get());
 	return result;
 }
@@ -162,45 +192,32 @@ std::shared_ptr<ETP_NS::PlainClientSession> ETP_NS::ClientSessionLaunchers::crea
 
 #include "ssl/HttpsClientSession.h"
 
-namespace ssl = boost::asio::ssl;               // from <boost/asio/ssl.hpp>
-
 std::shared_ptr<ETP_NS::SslClientSession> ETP_NS::ClientSessionLaunchers::createWssClientSession(InitializationParameters* initializationParams, const std::string & authorization,
-	const std::map<std::string, std::string>& additionalHandshakeHeaderFields, std::size_t preferredMaxFrameSize, const std::string & additionalCertificates)
+	const std::map<std::string, std::string>& additionalHandshakeHeaderFields, std::size_t preferredMaxFrameSize, const std::string & additionalCertificates,
+	std::shared_ptr<boost::asio::io_context> ioContext)
 {
-	// The SSL context is required, and holds certificates
-	ssl::context ctx{ ssl::context::sslv23_client };
-	ctx.set_default_verify_paths();
-	ctx.set_options(
-		ssl::context::default_workarounds
-		| ssl::context::no_sslv2
-		| ssl::context::no_sslv3
-		| ssl::context::single_dh_use
-	);
-
-	if (!additionalCertificates.empty()) {
-		boost::system::error_code ec;
-		ctx.add_certificate_authority(
-			boost::asio::buffer(additionalCertificates.data(), additionalCertificates.size()), ec);
-		if (ec) {
-			std::cerr << "Cannot add certificates : " << additionalCertificates << std::endl;
-			return nullptr;
-		}
+	// The TLS context is shared by the sessions trusting the same certificates so that they resume the TLS sessions of each other.
+	std::shared_ptr<ClientTlsContext> tlsContext;
+	try {
+		tlsContext = ClientTlsContext::getInstance(additionalCertificates);
 	}
-
-	boost::asio::io_context ioc;
-	auto httpsClientSession = std::make_shared<HttpsClientSession>(ioc, ctx);
-	std::string etpServerCapTarget = "/" + initializationParams->getUrlPath();
-	if (etpServerCapTarget[etpServerCapTarget.size() - 1] != '/') {
-		etpServerCapTarget += '/';
+	catch (const std::invalid_argument&) {
+		std::cerr << "Cannot add certificates : " << additionalCertificates << std::endl;
+		return nullptr;
 	}
-	etpServerCapTarget += ".well-known/etp-server-capabilities?GetVersion=etp12.energistics.org";
-	httpsClientSession->run(initializationParams->getHost().c_str(), initializationParams->getPort(), etpServerCapTarget.c_str(), 11, authorization);
-	// Run the I/O service. The call will return when the get operation is complete.
-	ioc.run();
-
-	preferredMaxFrameSize = getNegotiatedMaxWebSocketFramePayloadSize(httpsClientSession->getResponse().body(), preferredMaxFrameSize);
 
-	auto result = std::make_shared<SslClientSession>(ctx, initializationParams, "/" + initializationParams->getUrlPath(), authorization, additionalHandshakeHeaderFields, preferredMaxFrameSize);
+	preferredMaxFrameSize = getNegotiatedMaxWebSocketFramePayloadSize(initializationParams, preferredMaxFrameSize,
+		[&](const std::string & etpServerCapTarget) {
+			boost::asio::io_context ioc;
+			auto httpsClientSession = std::make_shared<HttpsClientSession>(ioc, tlsContext->getContext());
+			tlsContext->prepare(httpsClientSession->getStream().native_handle(), initializationParams->getHost(), std::to_string(initializationParams->getPort()));
+			httpsClientSession->run(initializationParams->getHost().c_str(), initializationParams->getPort(), etpServerCapTarget.c_str(), 11, authorization);
+			// Run the I/O service. The call will return when the get operation is complete.
+			ioc.run();
+			return httpsClientSession->getResponse();
+		});
+
+	auto result = std::make_shared<SslClientSession>(tlsContext, initializationParams, "/" + initializationParams->getUrlPath(), authorization, additionalHandshakeHeaderFields, preferredMaxFrameSize, ioContext);
 	initializationParams->postSessionCreationOperation(result.get());
 	return result;
 }
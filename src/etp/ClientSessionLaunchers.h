@@ -33,13 +33,20 @@ namespace ETP_NS
 		* @param preferredFrameSize The preferred websocket frame payload to use by this client.
 		*							If the ETP websocket server on the other end has a lower related MaxWebSocketFramePayloadSize capability, then the used websocket frame payload will be the server one.
 		*							Default value corresponds to the default Boost.Beast value : https://www.boost.org/doc/libs/1_75_0/libs/beast/doc/html/beast/ref/boost__beast__websocket__stream/write_buffer_bytes/overload1.html.
+		* @param ioContext			The io context processing the session, which may be shared with other sessions (see IoContextPool).
+		*							nullptr (default) means that the session owns an io context, run by run(). Otherwise open the session with asyncConnect.
+		*
+		* Unless the server capabilities are cached or their preflight is disabled (see InitializationParameters::setServerCapabilitiesPreflight),
+		* this function blocks the calling thread while it gets them by means of an HTTP(S) GET.
 		*/
 		FETPAPI_DLL_IMPORT_OR_EXPORT std::shared_ptr<ETP_NS::PlainClientSession> createWsClientSession(InitializationParameters* initializationParams, const std::string & authorization,
-			const std::map<std::string, std::string>& additionalHandshakeHeaderFields = {}, std::size_t preferredMaxFrameSize = 4096);
+			const std::map<std::string, std::string>& additionalHandshakeHeaderFields = {}, std::size_t preferredMaxFrameSize = 4096,
+			std::shared_ptr<boost::asio::io_context> ioContext = nullptr);
 
 #ifdef WITH_ETP_SSL
 		FETPAPI_DLL_IMPORT_OR_EXPORT std::shared_ptr<ETP_NS::SslClientSession> createWssClientSession(InitializationParameters* initializationParams, const std::string & authorization,
-			const std::map<std::string, std::string>& additionalHandshakeHeaderFields = {}, std::size_t preferredMaxFrameSize = 4096, const std::string & additionalCertificates = "");
+			const std::map<std::string, std::string>& additionalHandshakeHeaderFields = {}, std::size_t preferredMaxFrameSize = 4096, const std::string & additionalCertificates = "",
+			std::shared_ptr<boost::asio::io_context> ioContext = nullptr);
 #endif
 
 	}
@@ -0,0 +1,218 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "EndpointCache.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+// Boost.PropertyTree still includes the deprecated boost/bind.hpp
+#ifndef BOOST_BIND_GLOBAL_PLACEHOLDERS
+#define BOOST_BIND_GLOBAL_PLACEHOLDERS
+#endif
+#include <boost/property_tree/json_parser.hpp>
+
+using namespace ETP_NS;
+
+namespace {
+	/// Boost.PropertyTree parses JSON recursively : a deeper document from a faulty server could overflow the stack.
+	constexpr unsigned int maxJsonDepth = 64;
+
+	/**
+	* @throw std::invalid_argument	if the objects and the arrays of @p json are nested deeper than maxJsonDepth.
+	*/
+	void checkJsonDepth(const std::string & json) {
+		unsigned int depth = 0;
+		bool inString = false;
+		for (std::size_t pos = 0; pos < json.size(); ++pos) {
+			const char c = json[pos];
+			if (inString) {
+				if (c == '\\') {
+					++pos;
+				}
+				else if (c == '"') {
+					inString = false;
+				}
+			}
+			else if (c == '"') {
+				inString = true;
+			}
+			else if (c == '{' || c == '[') {
+				if (++depth > maxJsonDepth) {
+					throw std::invalid_argument("Too deeply nested JSON in the server capabilities.");
+				}
+			}
+			else if ((c == '}' || c == ']') && depth > 0) {
+				--depth;
+			}
+		}
+	}
+
+	/**
+	* @return true if @p text is an integer which fits in an int64_t
+	*/
+	bool toInteger(const std::string & text, int64_t& result) {
+		if (text.empty() || text.find_first_of(".eE") != std::string::npos) {
+			return false;
+		}
+		errno = 0;
+		char* end = nullptr;
+		const long long value = std::strtoll(text.c_str(), &end, 10);
+		if (errno == ERANGE || end != text.c_str() + text.size()) {
+			return false;
+		}
+		result = value;
+		return true;
+	}
+
+	/**
+	* @return true if @p capability is an integer, directly or in an Avro JSON union item : 4096, {"item":4096} or {"item":{"long":4096}}
+	*/
+	bool getIntegerCapability(const boost::property_tree::ptree & capability, int64_t& result) {
+		if (capability.empty()) {
+			return toInteger(capability.data(), result);
+		}
+		if (capability.size() != 1 || capability.front().first != "item") {
+			return false;
+		}
+		const boost::property_tree::ptree & item = capability.front().second;
+		if (item.empty()) {
+			return toInteger(item.data(), result);
+		}
+		return item.size() == 1 && item.front().second.empty() && toInteger(item.front().second.data(), result);
+	}
+}
+
+ServerCapabilitiesSummary ETP_NS::parseServerCapabilities(const std::string & json)
+{
+	const std::size_t first = json.find_first_not_of(" \t\n\r");
+	if (first == std::string::npos || json[first] != '{') {
+		throw std::invalid_argument("The server capabilities are not a JSON object.");
+	}
+	checkJsonDepth(json);
+
+	boost::property_tree::ptree tree;
+	std::istringstream stream(json);
+	try {
+		boost::property_tree::read_json(stream, tree);
+	}
+	catch (const boost::property_tree::json_parser_error& e) {
+		throw std::invalid_argument("Invalid JSON server capabilities : " + e.message() + " at line " + std::to_string(e.line()));
+	}
+
+	ServerCapabilitiesSummary result;
+	result.applicationName = tree.get<std::string>("applicationName", "");
+	result.applicationVersion = tree.get<std::string>("applicationVersion", "");
+
+	const auto endpointCapabilities = tree.get_child_optional("endpointCapabilities");
+	if (endpointCapabilities) {
+		for (const auto& capability : *endpointCapabilities) {
+			int64_t value;
+			if (!capability.first.empty() && getIntegerCapability(capability.second, value)) {
+				result.endpointCapabilities[capability.first] = value;
+			}
+		}
+	}
+
+	return result;
+}
+
+EndpointCache::EndpointCache(Clock::duration timeToLive) : timeToLive(timeToLive) {}
+
+std::shared_ptr<EndpointCache> EndpointCache::getInstance()
+{
+	static const std::shared_ptr<EndpointCache> instance = std::make_shared<EndpointCache>();
+	return instance;
+}
+
+void EndpointCache::setTimeToLive(Clock::duration value)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	timeToLive = value;
+}
+
+EndpointCache::Clock::duration EndpointCache::getTimeToLive() const
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	return timeToLive;
+}
+
+bool EndpointCache::findEndpoints(const std::string & host, const std::string & port, boost::asio::ip::tcp::resolver::results_type& result)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	const auto it = endpoints.find(host + ':' + port);
+	if (it == endpoints.end()) {
+		return false;
+	}
+	if (it->second.expiry <= Clock::now()) {
+		endpoints.erase(it);
+		return false;
+	}
+	result = it->second.value;
+	return true;
+}
+
+void EndpointCache::putEndpoints(const std::string & host, const std::string & port, const boost::asio::ip::tcp::resolver::results_type& value)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	if (timeToLive > Clock::duration::zero() && !value.empty()) {
+		auto& entry = endpoints[host + ':' + port];
+		entry.value = value;
+		entry.expiry = Clock::now() + timeToLive;
+	}
+}
+
+void EndpointCache::eraseEndpoints(const std::string & host, const std::string & port)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	endpoints.erase(host + ':' + port);
+}
+
+std::shared_ptr<const ServerCapabilitiesSummary> EndpointCache::findServerCapabilities(const std::string & host, const std::string & port, const std::string & target)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	const auto it = serverCapabilities.find(host + ':' + port + target);
+	if (it == serverCapabilities.end()) {
+		return nullptr;
+	}
+	if (it->second.expiry <= Clock::now()) {
+		serverCapabilities.erase(it);
+		return nullptr;
+	}
+	return it->second.value;
+}
+
+void EndpointCache::putServerCapabilities(const std::string & host, const std::string & port, const std::string & target,
+	std::shared_ptr<const ServerCapabilitiesSummary> capabilities)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	if (timeToLive > Clock::duration::zero() && capabilities != nullptr) {
+		auto& entry = serverCapabilities[host + ':' + port + target];
+		entry.value = capabilities;
+		entry.expiry = Clock::now() + timeToLive;
+	}
+}
+
+void EndpointCache::clear()
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	endpoints.clear();
+	serverCapabilities.clear();
+}
@@ -0,0 +1,123 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <boost/asio/ip/tcp.hpp>
+
+#include "../nsDefinitions.h"
+
+#if defined(_WIN32) && !defined(FETPAPI_STATIC)
+#ifndef FETPAPI_DLL_IMPORT_OR_EXPORT
+#if defined(Fetpapi_EXPORTS)
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllexport)
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllimport)
+#endif
+#endif
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT
+#endif
+
+namespace ETP_NS
+{
+	/**
+	* What a client needs from the HTTP server capabilities document (/.well-known/etp-server-capabilities) of an ETP server.
+	*/
+	struct ServerCapabilitiesSummary
+	{
+		std::string applicationName;
+		std::string applicationVersion;
+		/// The endpoint capabilities which have an integer value, MaxWebSocketFramePayloadSize for example
+		std::map<std::string, int64_t> endpointCapabilities;
+	};
+
+	/**
+	* Parse the JSON server capabilities document of an ETP server.
+	* The values of the endpoint capabilities may be encoded as Avro JSON unions ({"item":{"long":4096}}) or directly ({"item":4096} or 4096).
+	* The document is read by Boost.PropertyTree, after checking that it is not nested too deeply.
+	* @throw std::invalid_argument	if the document is not valid JSON, is not a JSON object or is nested too deeply.
+	*/
+	FETPAPI_DLL_IMPORT_OR_EXPORT ServerCapabilitiesSummary parseServerCapabilities(const std::string & json);
+
+	/**
+	* Remembers, per host and port, the resolved endpoints and the server capabilities of the ETP servers a client has connected to
+	* so that the next client sessions to the same server neither resolve the host nor get the server capabilities again.
+	* The entries expire after a time to live. This class is thread safe.
+	*/
+	class EndpointCache
+	{
+	public:
+		typedef std::chrono::steady_clock Clock;
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT explicit EndpointCache(Clock::duration timeToLive = std::chrono::minutes(5));
+
+		/**
+		* The cache shared by all the client sessions of the process, unless their initialization parameters specify another one.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT static std::shared_ptr<EndpointCache> getInstance();
+
+		/**
+		* The time to live applies to the entries put afterwards. Zero disables the caching.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void setTimeToLive(Clock::duration value);
+		FETPAPI_DLL_IMPORT_OR_EXPORT Clock::duration getTimeToLive() const;
+
+		/**
+		* @return true and the endpoints in @p result if fresh endpoints of host:port are cached.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT bool findEndpoints(const std::string & host, const std::string & port, boost::asio::ip::tcp::resolver::results_type& result);
+		FETPAPI_DLL_IMPORT_OR_EXPORT void putEndpoints(const std::string & host, const std::string & port, const boost::asio::ip::tcp::resolver::results_type& endpoints);
+
+		/**
+		* Forget the endpoints of host:port, typically because none of them can be connected anymore.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void eraseEndpoints(const std::string & host, const std::string & port);
+
+		/**
+		* @param target	The HTTP target of the server capabilities document, since several ETP servers may be served on the same host and port.
+		* @return The cached server capabilities or nullptr if there are no fresh ones.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::shared_ptr<const ServerCapabilitiesSummary> findServerCapabilities(const std::string & host, const std::string & port, const std::string & target);
+		FETPAPI_DLL_IMPORT_OR_EXPORT void putServerCapabilities(const std::string & host, const std::string & port, const std::string & target,
+			std::shared_ptr<const ServerCapabilitiesSummary> capabilities);
+
+		/**
+		* Forget everything.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void clear();
+
+	private:
+		template<typename T> struct Entry {
+			T value;
+			Clock::time_point expiry;
+		};
+
+		mutable std::mutex mutex;
+		Clock::duration timeToLive;
+		std::map<std::string, Entry<boost::asio::ip::tcp::resolver::results_type>> endpoints;
+		std::map<std::string, Entry<std::shared_ptr<const ServerCapabilitiesSummary>>> serverCapabilities;
+	};
+}
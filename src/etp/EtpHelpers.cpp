@@ -18,99 +18,175 @@ under the License.
 -----------------------------------------------------------------------*/
 #include "EtpHelpers.h"
 
-#if (defined(_WIN32) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
-#include <regex>
-#endif
-
 #include "AbstractSession.h"
 #include "EtpException.h"
 
+namespace {
+	// The character classes are the ASCII ones whatever the locale is.
+	bool isDigit(char c) { return c >= '0' && c <= '9'; }
+	bool isLower(char c) { return c >= 'a' && c <= 'z'; }
+	bool isAlphanumeric(char c) { return isDigit(c) || isLower(c) || (c >= 'A' && c <= 'Z'); }
+	bool isHexadecimal(char c) { return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); }
+
+	void sendProtocolException(const Energistics::Etp::v12::Datatypes::ErrorInfo& errorInfo, ETP_NS::AbstractSession* session)
+	{
+		if (session != nullptr) {
+			Energistics::Etp::v12::Protocol::Core::ProtocolException error;
+			error.error.emplace(errorInfo);
+			session->send(error);
+		}
+	}
+}
+
+bool ETP_NS::EtpHelpers::parseUri(boost::string_view uri, UriView& result)
+{
+	result = UriView();
+	const std::size_t size = uri.size();
+	if (uri.substr(0, 7) != "eml:///") {
+		return false;
+	}
+	std::size_t pos = 7;
+
+	// Dataspace : the path ends at the first quote followed by a closing parenthesis and then by the end of the URI, a slash or a query.
+	if (uri.substr(pos, 11) == "dataspace('") {
+		const std::size_t pathStart = pos + 11;
+		std::size_t pathEnd = uri.find("')", pathStart);
+		while (pathEnd != boost::string_view::npos && pathEnd + 2 < size && uri[pathEnd + 2] != '/' && uri[pathEnd + 2] != '?') {
+			pathEnd = uri.find("')", pathEnd + 1);
+		}
+		if (pathEnd == boost::string_view::npos) {
+			return false;
+		}
+		result.dataspace = uri.substr(pathStart, pathEnd - pathStart);
+		pos = pathEnd + 2;
+		result.dataspaceUri = uri.substr(0, pos);
+
+		if (pos < size && uri[pos] == '/') {
+			// A data object must follow the slash
+			if (++pos == size || uri[pos] == '?') {
+				return false;
+			}
+		}
+	}
+
+	// Data object
+	if (pos < size && uri[pos] != '?') {
+		const std::size_t qualifiedTypeStart = pos;
+		while (pos < size && isLower(uri[pos])) {
+			++pos;
+		}
+		result.domain = uri.substr(qualifiedTypeStart, pos - qualifiedTypeStart);
+		if (result.domain != "eml" && result.domain != "resqml" && result.domain != "witsml" && result.domain != "prodml") {
+			return false;
+		}
+		if (pos + 2 > size || !isDigit(uri[pos]) || !isDigit(uri[pos + 1])) {
+			return false;
+		}
+		result.domainVersion = uri.substr(pos, 2);
+		pos += 2;
+		if (pos == size || uri[pos++] != '.') {
+			return false;
+		}
+
+		const std::size_t objectTypeStart = pos;
+		if (result.domainVersion == "20" && (result.domain == "resqml" || result.domain == "eml")) {
+			if (uri.substr(pos, 4) != "obj_") {
+				return false;
+			}
+			pos += 4;
+		}
+		const std::size_t nameStart = pos;
+		while (pos < size && isAlphanumeric(uri[pos])) {
+			++pos;
+		}
+		if (pos == nameStart) {
+			return false;
+		}
+		result.objectType = uri.substr(objectTypeStart, pos - objectTypeStart);
+		result.qualifiedType = uri.substr(qualifiedTypeStart, pos - qualifiedTypeStart);
+
+		// Identifier
+		if (pos == size || uri[pos++] != '(' || size - pos < 36) {
+			return false;
+		}
+		for (std::size_t i = 0; i < 36; ++i) {
+			const char c = uri[pos + i];
+			if (i == 8 || i == 13 || i == 18 || i == 23 ? c != '-' : !isHexadecimal(c)) {
+				return false;
+			}
+		}
+		result.uuid = uri.substr(pos, 36);
+		pos += 36;
+		if (pos < size && uri[pos] == ',') {
+			const std::size_t versionStart = ++pos;
+			while (pos < size && uri[pos] != ')') {
+				++pos;
+			}
+			result.objectVersion = uri.substr(versionStart, pos - versionStart);
+		}
+		if (pos == size || uri[pos++] != ')') {
+			return false;
+		}
+	}
+
+	// Query
+	if (pos < size) {
+		if (uri[pos] != '?') {
+			return false;
+		}
+		result.query = uri.substr(pos + 1);
+		result.hasQuery = true;
+	}
+
+	return true;
+}
+
 std::string ETP_NS::EtpHelpers::getDataObjectType(const std::string& uri)
 {
-	const std::size_t lastSlash = uri.find_last_of("/");
-	const std::size_t lastOpenParenthesis = uri.find_last_of("(");
-	return lastSlash != std::string::npos && lastOpenParenthesis != std::string::npos
-		? uri.substr(lastSlash + 1, lastOpenParenthesis - lastSlash - 1)
-		: "";
+	UriView view;
+	parseUri(uri, view);
+	return view.qualifiedType.to_string();
 }
 
 std::string ETP_NS::EtpHelpers::getDataspaceUri(const std::string& uri)
 {
-	const size_t dataspacePos = uri.find("dataspace('");
-	if (dataspacePos == std::string::npos) {
-		return "";
-	}
-
-	const size_t closingParenthesisPos = uri.find(')', dataspacePos);
-	if (closingParenthesisPos == std::string::npos) {
+	UriView view;
+	parseUri(uri, view);
+	if (view.dataspaceUri.empty() && uri.find("dataspace('") != std::string::npos) {
 		throw std::invalid_argument("The uri " + uri + " is malformed because it does not contain a closing parenthesis after the dataspace path.");
 	}
-	return uri.substr(0, closingParenthesisPos+1);
+	return view.dataspaceUri.to_string();
 }
 
 Energistics::Etp::v12::Datatypes::ErrorInfo ETP_NS::EtpHelpers::validateUri(const std::string & uri, ETP_NS::AbstractSession* session)
 {
 	Energistics::Etp::v12::Datatypes::ErrorInfo errorInfo;
 	errorInfo.code = -1;
-	// Regular expressions are not handled before GCC 4.9
-	// https://stackoverflow.com/questions/12530406/is-gcc-4-8-or-earlier-buggy-about-regular-expressions
-#if (defined(_WIN32) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
-	const bool result =
-		std::regex_match(uri, std::regex("^eml:///(dataspace[(]'.*'[)])?", std::regex::ECMAScript)) ||
-		std::regex_match(uri, std::regex("^eml:///(dataspace[(]'.*'[)]/)?(resqml20|eml20)\.obj_[a-zA-Z0-9]+[(][a-fA-F0-9]{8}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{12}(,.*)?[)]", std::regex::ECMAScript)) ||
-		std::regex_match(uri, std::regex("^eml:///(dataspace[(]'.*'[)]/)?(witsml|resqml|prodml|eml)([0-9]{2})\[a-zA-Z0-9]+[(][a-fA-F0-9]{8}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{12}(,.*)?[)]", std::regex::ECMAScript));
-	if (!result) {
-		std::cerr << "The URI \"" + uri + "\"  is invalid." << std::endl;
-	}
-#else
-	const bool result = uri.find("eml:///") == 0;
-#endif
 
-	if (!result) {
+	// A canonical URI has no query
+	UriView view;
+	if (!parseUri(uri, view) || view.hasQuery) {
+		std::cerr << "The URI \"" + uri + "\"  is invalid." << std::endl;
 		errorInfo.code = 9;
 		errorInfo.message = "The URI " + uri + "  is invalid.";
-
-		if (session != nullptr) {
-			Energistics::Etp::v12::Protocol::Core::ProtocolException error;
-			error.error.emplace(errorInfo);
-			session->send(error);
-		}
+		sendProtocolException(errorInfo, session);
 	}
 
 	return errorInfo;
-
 }
 
 Energistics::Etp::v12::Datatypes::ErrorInfo ETP_NS::EtpHelpers::validateDataObjectUri(const std::string & uri, AbstractSession* session)
 {
 	Energistics::Etp::v12::Datatypes::ErrorInfo errorInfo;
 	errorInfo.code = -1;
-	// Regular expressions are not handled before GCC 4.9
-	// https://stackoverflow.com/questions/12530406/is-gcc-4-8-or-earlier-buggy-about-regular-expressions
-#if (defined(_WIN32) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
-	const bool result = (uri.find("resqml20") != std::string::npos || uri.find("eml20") != std::string::npos)
-		? std::regex_match(uri, std::regex("^eml:///(dataspace[(]'.*'[)]/)?(resqml20|eml20)\.obj_[a-zA-Z0-9]+[(][a-fA-F0-9]{8}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{12}(,.*)?[)]", std::regex::ECMAScript))
-		: std::regex_match(uri, std::regex("^eml:///(dataspace[(]'.*'[)]/)?(witsml|resqml|prodml|eml)([0-9]{2})\.[a-zA-Z0-9]+[(][a-fA-F0-9]{8}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{12}(,.*)?[)]", std::regex::ECMAScript));
-	if (!result) {
+
+	// A canonical URI has no query
+	UriView view;
+	if (!parseUri(uri, view) || view.hasQuery || !view.isDataObject()) {
 		std::cerr << "The data object URI \"" + uri + "\"  is invalid." << std::endl;
-	}
-#else
-	const bool result = uri.find("eml:///") == 0 && 
-		(uri.find("resqml20.obj_") != std::string::npos || uri.find("eml20.obj_") != std::string::npos ||
-		uri.find("witsml20.") != std::string::npos || uri.find("eml21.") != std::string::npos ||
-		uri.find("prodml21.") != std::string::npos || uri.find("eml22.") != std::string::npos ||
-		uri.find("witsml21.") != std::string::npos);
-#endif
-
-	if (!result) {
 		errorInfo.code = 9;
 		errorInfo.message = "The data object URI " + uri + "  is invalid.";
-
-		if (session != nullptr) {
-			Energistics::Etp::v12::Protocol::Core::ProtocolException error;
-			error.error.emplace(errorInfo);
-			session->send(error);
-		}
+		sendProtocolException(errorInfo, session);
 	}
 
 	return errorInfo;
@@ -129,22 +205,12 @@ Energistics::Etp::v12::Protocol::Core::ProtocolException ETP_NS::EtpHelpers::bui
 
 std::pair<std::string, std::string> ETP_NS::EtpHelpers::getUuidAndVersionFromUri(const std::string & uri)
 {
-	std::pair<std::string, std::string> result;
-
 	Energistics::Etp::v12::Datatypes::ErrorInfo error = ETP_NS::EtpHelpers::validateDataObjectUri(uri);
 	if (error.code > -1) {
 		throw ETP_NS::EtpException(error.code, error.message);
 	}
 
-	if (uri[6] != '/') {
-		throw ETP_NS::EtpException(2, "The URI " + uri + " uses some dataspaces. This agent does not support dataspace.");
-	}
-
-	const size_t openingParenthesisPos = uri.find('(');
-	const std::string uuid = uri.substr(openingParenthesisPos + 1, 36);
-	const size_t comma = uri.find(',');
-	const size_t closingParenthesisPos = comma == std::string::npos ? std::string::npos : uri.find(')');
-	const std::string version = (comma == std::string::npos || closingParenthesisPos == std::string::npos) ? "" : uri.substr(comma + 1, closingParenthesisPos - comma - 1);
-
-	return std::pair<std::string, std::string>(uuid, version);
+	UriView view;
+	parseUri(uri, view);
+	return std::pair<std::string, std::string>(view.uuid.to_string(), view.objectVersion.to_string());
 }
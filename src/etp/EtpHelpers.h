@@ -18,6 +18,8 @@ under the License.
 -----------------------------------------------------------------------*/
 #pragma once
 
+#include <boost/utility/string_view.hpp>
+
 #include "../nsDefinitions.h"
 #include "EtpMessages.h"
 
@@ -44,6 +46,46 @@ namespace ETP_NS
 
 	namespace EtpHelpers {
 
+		/**
+		* The parts of a canonical ETP 1.2 URI such as eml:///dataspace('demo/Volve')/resqml20.obj_IjkGridRepresentation(2bd5d8f6-2c3f-4b0e-9b5e-5a1c1f2e3d4c,2)
+		* They are views on the parsed URI : they are only valid as long as the parsed URI is neither modified nor destroyed.
+		* The parts which are not in the URI are empty.
+		*/
+		struct UriView {
+			/// eml:///dataspace('demo/Volve')
+			boost::string_view dataspaceUri;
+			/// demo/Volve
+			boost::string_view dataspace;
+			/// resqml20.obj_IjkGridRepresentation
+			boost::string_view qualifiedType;
+			/// resqml
+			boost::string_view domain;
+			/// 20
+			boost::string_view domainVersion;
+			/// obj_IjkGridRepresentation
+			boost::string_view objectType;
+			/// 2bd5d8f6-2c3f-4b0e-9b5e-5a1c1f2e3d4c
+			boost::string_view uuid;
+			/// 2
+			boost::string_view objectVersion;
+			/// What follows the question mark, if any
+			boost::string_view query;
+			bool hasQuery = false;
+
+			bool isDataObject() const { return !uuid.empty(); }
+		};
+
+		/**
+		* Parse a canonical ETP 1.2 URI in a single pass and without any allocation.
+		* The accepted URIs are eml:/// , eml:///dataspace('path') and eml:///[dataspace('path')/]domainNN.type(uuid[,version]), all of them optionally followed by ?query
+		* where domain is one of eml, resqml, witsml or prodml and the type of a resqml20 or eml20 data object starts with obj_
+		*
+		* @param uri	The URI to parse. It must outlive result.
+		* @param result	The parts of the URI. When the URI is not valid, the parts which have been parsed before the error are still set.
+		* @return		True if the URI is a canonical ETP 1.2 URI.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT bool parseUri(boost::string_view uri, UriView& result);
+
 		/**
 		* Get the dataobject type from a canonical ETP 1.2 URI.
 		*
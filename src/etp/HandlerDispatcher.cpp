@@ -0,0 +1,88 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "HandlerDispatcher.h"
+
+#include <boost/asio/post.hpp>
+
+#include "Logger.h"
+
+using namespace ETP_NS;
+
+HandlerDispatcher::HandlerDispatcher(std::size_t threadCount) :
+	state(std::make_shared<State>(threadCount == 0 ? 1 : threadCount))
+{
+}
+
+HandlerDispatcher::~HandlerDispatcher()
+{
+	if (state->pool.get_executor().running_in_this_thread()) {
+		// A worker cannot join its own pool : the current worker finishes its task and the other ones are joined by a detached thread.
+		{
+			const std::lock_guard<std::mutex> pendingTasksLock(state->pendingTasksMutex);
+			state->isDiscarding = true;
+		} // Scope for pendingTasksLock
+		state->pool.stop();
+		std::shared_ptr<State> releasedState = state;
+		std::thread([releasedState]() { releasedState->pool.join(); }).detach();
+	}
+	else {
+		state->pool.join();
+	}
+}
+
+void HandlerDispatcher::post(const AbstractSession* session, int64_t orderingKey, std::function<void()> task)
+{
+	const Key key(session, orderingKey);
+	bool isNewKey = false;
+	{
+		const std::lock_guard<std::mutex> pendingTasksLock(state->pendingTasksMutex);
+		auto inserted = state->pendingTasks.emplace(key, std::queue<std::function<void()>>());
+		inserted.first->second.push(std::move(task));
+		isNewKey = inserted.second;
+	} // Scope for pendingTasksLock
+
+	// Only one worker at a time processes the tasks of a key
+	if (isNewKey) {
+		boost::asio::post(state->pool, std::bind(&HandlerDispatcher::run, state, key));
+	}
+}
+
+void HandlerDispatcher::run(std::shared_ptr<State> state, const Key& key)
+{
+	while (true) {
+		std::function<void()> task;
+		{
+			const std::lock_guard<std::mutex> pendingTasksLock(state->pendingTasksMutex);
+			auto it = state->pendingTasks.find(key);
+			if (it->second.empty() || state->isDiscarding) {
+				state->pendingTasks.erase(it);
+				return;
+			}
+			task = std::move(it->second.front());
+			it->second.pop();
+		} // Scope for pendingTasksLock
+
+		try {
+			task();
+		}
+		catch (std::exception& e) {
+			FETPAPI_LOG(&Logger::getInstance(), Error, "A handler executed by the dispatcher has thrown :", e.what());
+		}
+	}
+}
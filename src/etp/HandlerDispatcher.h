@@ -0,0 +1,103 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+
+#include <boost/asio/thread_pool.hpp>
+
+#include "../nsDefinitions.h"
+
+#if defined(_WIN32) && !defined(FETPAPI_STATIC)
+#ifndef FETPAPI_DLL_IMPORT_OR_EXPORT
+#if defined(Fetpapi_EXPORTS)
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllexport)
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllimport)
+#endif
+#endif
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT
+#endif
+
+namespace ETP_NS
+{
+	class AbstractSession;
+
+	/**
+	* Executes the protocol handlers of one or more sessions on a pool of worker threads instead of the session io context thread.
+	* Tasks posted with the same session and the same ordering key are executed one at a time, in the order they have been posted.
+	* Tasks with different ordering keys may run concurrently.
+	*/
+	class HandlerDispatcher
+	{
+	public:
+
+		/**
+		* @param threadCount	The count of worker threads executing the handlers.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT HandlerDispatcher(std::size_t threadCount = std::thread::hardware_concurrency());
+
+		/**
+		* Wait for all posted tasks to complete before destroying the worker threads.
+		* If the dispatcher is destroyed by one of its own tasks, typically because the task has released the last session owning the dispatcher,
+		* the pending tasks are discarded and the worker threads are joined by a detached thread since a worker cannot join its own pool.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT ~HandlerDispatcher();
+
+		/**
+		* Post a task to be executed on a worker thread.
+		*
+		* @param session		The session the task belongs to.
+		* @param orderingKey	The tasks of a session sharing this key are executed sequentially in posting order.
+		* @param task			The task to execute.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void post(const AbstractSession* session, int64_t orderingKey, std::function<void()> task);
+
+	private:
+		typedef std::pair<const AbstractSession*, int64_t> Key;
+
+		/**
+		* Shared with the workers so that it outlives the dispatcher when the dispatcher is destroyed by one of its own tasks.
+		*/
+		struct State {
+			State(std::size_t threadCount) : pool(threadCount) {}
+
+			boost::asio::thread_pool pool;
+			/// The pending tasks per key. A key is present in this map as long as a worker is processing its tasks.
+			std::map<Key, std::queue<std::function<void()>>> pendingTasks;
+			std::mutex pendingTasksMutex;
+			/// Set once the dispatcher has been destroyed by one of its own tasks : the pending tasks are then discarded.
+			bool isDiscarding = false;
+		};
+
+		/**
+		* Execute all pending tasks of a key until there is no more one.
+		*/
+		static void run(std::shared_ptr<State> state, const Key& key);
+
+		std::shared_ptr<State> state;
+	};
+}
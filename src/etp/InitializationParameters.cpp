@@ -173,3 +173,22 @@ std::vector<Energistics::Etp::v12::Datatypes::SupportedProtocol> InitializationP
 void InitializationParameters::postSessionCreationOperation(AbstractSession* session) const {
 	session->setCoreProtocolHandlers(std::make_shared<CoreHandlers>(session));
 }
+
+std::shared_ptr<const SessionCapabilities> InitializationParameters::getSessionCapabilities() const
+{
+	const uint64_t revision = capabilitiesRevision_;
+	{
+		std::lock_guard<std::mutex> lock(sessionCapabilitiesMutex_);
+		if (sessionCapabilities_ != nullptr && sessionCapabilitiesRevision_ == revision) {
+			return sessionCapabilities_;
+		}
+	}
+
+	// Build the capabilities outside of the lock since the overriden make... methods may be slow.
+	auto result = std::make_shared<const SessionCapabilities>(*this);
+
+	std::lock_guard<std::mutex> lock(sessionCapabilitiesMutex_);
+	sessionCapabilities_ = result;
+	sessionCapabilitiesRevision_ = revision;
+	return result;
+}
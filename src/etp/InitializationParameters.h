@@ -18,10 +18,18 @@ under the License.
 -----------------------------------------------------------------------*/
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+
 #include <boost/uuid/uuid_io.hpp>
 
 #include "../nsDefinitions.h"
+#include "EndpointCache.h"
 #include "EtpMessages.h"
+#include "Metrics.h"
+#include "SessionCapabilities.h"
 
 #if defined(_WIN32) && !defined(FETPAPI_STATIC)
 #ifndef FETPAPI_DLL_IMPORT_OR_EXPORT
@@ -53,6 +61,26 @@ namespace ETP_NS
 		// and https://www.boost.org/doc/libs/1_75_0/libs/beast/doc/html/beast/ref/boost__beast__websocket__stream/read_message_max/overload1.html
 		int64_t maxWebSocketMessagePayloadSize_ = 16000000;
 
+		/// The registry where the sessions record their metrics. nullptr means that no metric is recorded.
+		std::shared_ptr<MetricsRegistry> metricsRegistry_;
+
+		/// Where the client sessions cache the resolved endpoints and the server capabilities. nullptr means no caching.
+		std::shared_ptr<EndpointCache> endpointCache_ = EndpointCache::getInstance();
+		/// Whether the client session launchers get the HTTP server capabilities before opening a websocket
+		bool serverCapabilitiesPreflight_ = true;
+		/// The heartbeat of the sessions, see AbstractSession::setHeartbeat
+		std::chrono::milliseconds heartbeatInterval_{ 0 };
+		unsigned int maxMissedPongs_ = 3;
+
+		/// Incremented each time the capabilities returned by the make...Capabilities(), makeSupported...() methods may have changed
+		std::atomic<uint64_t> capabilitiesRevision_{ 0 };
+
+	private:
+		mutable std::mutex sessionCapabilitiesMutex_;
+		mutable std::shared_ptr<const SessionCapabilities> sessionCapabilities_;
+		/// The capabilities revision sessionCapabilities_ has been built from
+		mutable uint64_t sessionCapabilitiesRevision_ = 0;
+
 	public:
 
 		/**
@@ -104,9 +132,47 @@ namespace ETP_NS
 		/**
 		* The default value is 16000000 according to Boost.Beast. This method allows you to modify it.
 		*/
-		FETPAPI_DLL_IMPORT_OR_EXPORT void setMaxWebSocketMessagePayloadSize(int64_t value) { maxWebSocketMessagePayloadSize_ = value; }
+		FETPAPI_DLL_IMPORT_OR_EXPORT void setMaxWebSocketMessagePayloadSize(int64_t value) { maxWebSocketMessagePayloadSize_ = value; ++capabilitiesRevision_; }
 		int64_t getMaxWebSocketMessagePayloadSize() const { return maxWebSocketMessagePayloadSize_; }
 
+		/**
+		* Set the registry where the sessions created with these parameters record their metrics.
+		* On a server, it also enables the /metrics and /health HTTP routes.
+		*/
+		void setMetricsRegistry(std::shared_ptr<MetricsRegistry> registry) { metricsRegistry_ = registry; }
+		std::shared_ptr<MetricsRegistry> getMetricsRegistry() const { return metricsRegistry_; }
+
+		/**
+		* Set where the client sessions created with these parameters cache the resolved endpoints and the server capabilities of their server.
+		* The default cache is shared by the whole process (see EndpointCache::getInstance). nullptr disables the caching.
+		*/
+		void setEndpointCache(std::shared_ptr<EndpointCache> cache) { endpointCache_ = cache; }
+		std::shared_ptr<EndpointCache> getEndpointCache() const { return endpointCache_; }
+
+		/**
+		* By default, the client session launchers get the HTTP server capabilities of the server (unless they are cached) before opening a websocket
+		* in order to negotiate the websocket frame size. Disabling this preflight saves a connection and a handshake per session :
+		* the preferred frame size of the client is then used as is.
+		* The preflight is a synchronous HTTP(S) GET, performed by the calling thread of the launcher on a cache miss, even if the session is then
+		* opened on a shared io context : disable it (or warm the endpoint cache) when the sessions are created on an io context thread.
+		*/
+		void setServerCapabilitiesPreflight(bool enabled) { serverCapabilitiesPreflight_ = enabled; }
+		bool isServerCapabilitiesPreflight() const { return serverCapabilitiesPreflight_; }
+
+		/**
+		* Set the heartbeat of the sessions created with these parameters : see AbstractSession::setHeartbeat.
+		* A zero interval (default) disables the heartbeat.
+		*/
+		void setHeartbeat(std::chrono::milliseconds interval, unsigned int maxMissedPongs = 3) {
+			if (maxMissedPongs == 0) {
+				throw std::invalid_argument("The count of missed pongs closing a session must be strictly positive.");
+			}
+			heartbeatInterval_ = interval;
+			maxMissedPongs_ = maxMissedPongs;
+		}
+		std::chrono::milliseconds getHeartbeatInterval() const { return heartbeatInterval_; }
+		unsigned int getMaxMissedPongs() const { return maxMissedPongs_; }
+
 		const boost::uuids::uuid& getInstanceId() const { return identifier_; }
 		const std::string& getHost() const { return host_; }
 		unsigned short getPort() const { return port_; }
@@ -114,6 +180,21 @@ namespace ETP_NS
 		FETPAPI_DLL_IMPORT_OR_EXPORT virtual std::string getApplicationName() const { return "F2I-CONSULTING ETP CLIENT"; }
 		FETPAPI_DLL_IMPORT_OR_EXPORT virtual std::string getApplicationVersion() const { return "0.0"; }
 
+		/**
+		* Tell that the capabilities returned by the make...Capabilities(), makeSupported...() methods have changed,
+		* for example because an overriding method now returns something else.
+		* It discards what has been computed from the previous capabilities, such as the HTTP capabilities response of a server.
+		*/
+		void invalidateCapabilities() { ++capabilitiesRevision_; }
+		uint64_t getCapabilitiesRevision() const { return capabilitiesRevision_; }
+
+		/**
+		* Get the capabilities the sessions created with these parameters negotiate with.
+		* They are built once from the below make...() methods and built again only after the capabilities have been invalidated (see invalidateCapabilities).
+		* This method is thread safe.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::shared_ptr<const SessionCapabilities> getSessionCapabilities() const;
+
 		FETPAPI_DLL_IMPORT_OR_EXPORT std::map<std::string, Energistics::Etp::v12::Datatypes::DataValue> makeEndpointCapabilities() const;
 		FETPAPI_DLL_IMPORT_OR_EXPORT virtual std::vector<Energistics::Etp::v12::Datatypes::SupportedDataObject> makeSupportedDataObjects() const;
 		FETPAPI_DLL_IMPORT_OR_EXPORT virtual std::vector<Energistics::Etp::v12::Datatypes::SupportedProtocol> makeSupportedProtocols() const;
@@ -0,0 +1,69 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "IoContextPool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/version.hpp>
+
+using namespace ETP_NS;
+
+IoContextPool::IoContextPool(std::size_t threadCount)
+{
+#if BOOST_VERSION < 107000
+	// No strand serializes the completion handlers of a session.
+	if (threadCount > 1) {
+		throw std::invalid_argument("Before Boost 1.70, the io context of an IoContextPool can be run by a single thread only.");
+	}
+	threadCount = 1;
+#else
+	if (threadCount == 0) {
+		threadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+	}
+#endif
+	ioc = std::make_shared<boost::asio::io_context>(static_cast<int>(threadCount));
+	work.reset(new boost::asio::executor_work_guard<boost::asio::io_context::executor_type>(ioc->get_executor()));
+	threads.reserve(threadCount);
+	for (std::size_t i = 0; i < threadCount; ++i) {
+		std::shared_ptr<boost::asio::io_context> context = ioc;
+		threads.emplace_back([context] { context->run(); });
+	}
+}
+
+IoContextPool::~IoContextPool()
+{
+	stop();
+}
+
+void IoContextPool::join()
+{
+	work.reset();
+	for (auto& thread : threads) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+}
+
+void IoContextPool::stop()
+{
+	ioc->stop();
+	join();
+}
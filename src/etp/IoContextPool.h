@@ -0,0 +1,94 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include "../nsDefinitions.h"
+
+#if defined(_WIN32) && !defined(FETPAPI_STATIC)
+#ifndef FETPAPI_DLL_IMPORT_OR_EXPORT
+#if defined(Fetpapi_EXPORTS)
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllexport)
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllimport)
+#endif
+#endif
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT
+#endif
+
+namespace ETP_NS
+{
+	/**
+	* An io context run by a fixed count of threads, on which many client sessions can be multiplexed
+	* instead of blocking a thread per session in AbstractClientSession::run().
+	* Give getIoContext() to the client session constructors or to ClientSessionLaunchers and open the sessions with AbstractClientSession::asyncConnect.
+	* The completion handlers of a session never run concurrently, even if several threads run the io context.
+	* Before Boost 1.70, the websocket of a session cannot be bound to a strand : the io context can then be run by a single thread only.
+	*/
+	class IoContextPool
+	{
+	public:
+		/**
+		* Start the threads running the io context.
+		*
+		* @param threadCount	The count of threads running the io context. 0 means the count of hardware threads.
+		*						It must be 0 or 1 before Boost 1.70 (0 then means 1), otherwise std::invalid_argument is thrown.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT explicit IoContextPool(std::size_t threadCount = 1);
+
+		/**
+		* Stop the io context, abandoning the sessions which are still running, and join the threads.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT ~IoContextPool();
+
+		IoContextPool(const IoContextPool&) = delete;
+		IoContextPool& operator=(const IoContextPool&) = delete;
+
+		/**
+		* @return The io context to give to the sessions. The sessions keep it alive, even after the pool is destroyed.
+		*/
+		std::shared_ptr<boost::asio::io_context> getIoContext() const { return ioc; }
+
+		std::size_t getThreadCount() const { return threads.size(); }
+
+		/**
+		* Wait for the sessions of this pool to be closed and join the threads.
+		* No session can be opened on this pool afterwards.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void join();
+
+		/**
+		* Stop the io context, abandoning the sessions which are still running, and join the threads.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void stop();
+
+	private:
+		std::shared_ptr<boost::asio::io_context> ioc;
+		/// Prevents the threads from returning while no session is running.
+		std::unique_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> work;
+		std::vector<std::thread> threads;
+	};
+}
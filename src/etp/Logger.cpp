@@ -0,0 +1,188 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "Logger.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace ETP_NS;
+
+Logger& Logger::getInstance()
+{
+	// Deliberately leaked : see the documentation of this method.
+	static Logger* instance = []() {
+		Logger* result = new Logger(8192);
+		std::atexit([]() { getInstance().flush(); });
+		return result;
+	}();
+	return *instance;
+}
+
+Logger::Logger(std::size_t capacity) :
+	slots(new Slot[capacity]), mask(capacity - 1),
+	sink([](LogLevel level, const std::string& line) { std::cout << '[' << getLevelName(level) << "] " << line << '\n'; })
+{
+	for (std::size_t i = 0; i < capacity; ++i) {
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	writer = std::thread(&Logger::writeLoop, this);
+}
+
+Logger::~Logger()
+{
+	stop();
+}
+
+void Logger::stop()
+{
+	const std::lock_guard<std::mutex> writerLock(writerMutex);
+	if (!writer.joinable()) {
+		return;
+	}
+	{
+		const std::lock_guard<std::mutex> wakeUpLock(wakeUpMutex);
+		stopRequested.store(true);
+	} // Scope for wakeUpLock
+	wakeUpCondition.notify_one();
+	writer.join();
+}
+
+bool Logger::push(LogLevel level, std::string&& line)
+{
+	std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+	while (true) {
+		Slot& slot = slots[position & mask];
+		const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+		if (difference == 0) {
+			if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				slot.level = level;
+				slot.line = std::move(line);
+				slot.sequence.store(position + 1);
+				// Both the sequence store above and this load are sequentially consistent, like the store of writerSleeping and the load of the sequence
+				// by the writer : either the writer sees this line before sleeping or this producer sees the writer sleeping.
+				if (writerSleeping.load()) {
+					{
+						const std::lock_guard<std::mutex> wakeUpLock(wakeUpMutex);
+					} // Scope for wakeUpLock : the writer is either waiting or going to see this line.
+					wakeUpCondition.notify_one();
+				}
+				return true;
+			}
+		}
+		else if (difference < 0) {
+			// The writer has not consumed this slot yet : the ring buffer is full.
+			droppedCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else {
+			position = enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+bool Logger::pop(LogLevel& level, std::string& line)
+{
+	std::size_t position = dequeuePosition.load(std::memory_order_relaxed);
+	while (true) {
+		Slot& slot = slots[position & mask];
+		const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+		if (difference == 0) {
+			if (dequeuePosition.compare_exchange_weak(position, position + 1)) {
+				level = slot.level;
+				line.swap(slot.line);
+				slot.line.clear();
+				slot.sequence.store(position + mask + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (difference < 0) {
+			return false;
+		}
+		else {
+			position = dequeuePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+bool Logger::hasPendingLine() const
+{
+	const std::size_t position = dequeuePosition.load();
+	return slots[position & mask].sequence.load() == position + 1;
+}
+
+void Logger::setSink(Sink newSink)
+{
+	const std::lock_guard<std::mutex> sinkLock(sinkMutex);
+	drain();
+	sink = std::move(newSink);
+}
+
+void Logger::flush()
+{
+	const std::lock_guard<std::mutex> sinkLock(sinkMutex);
+	drain();
+}
+
+void Logger::drain()
+{
+	LogLevel level;
+	std::string line;
+	bool hasWritten = false;
+	while (pop(level, line)) {
+		if (sink) {
+			sink(level, line);
+		}
+		hasWritten = true;
+	}
+	if (hasWritten) {
+		std::cout.flush();
+	}
+}
+
+void Logger::writeLoop()
+{
+	while (!stopRequested.load()) {
+		{
+			const std::lock_guard<std::mutex> sinkLock(sinkMutex);
+			drain();
+		} // Scope for sinkLock
+
+		std::unique_lock<std::mutex> wakeUpLock(wakeUpMutex);
+		writerSleeping.store(true);
+		wakeUpCondition.wait(wakeUpLock, [this] { return stopRequested.load() || hasPendingLine(); });
+		writerSleeping.store(false);
+	}
+
+	const std::lock_guard<std::mutex> sinkLock(sinkMutex);
+	drain();
+}
+
+const char* Logger::getLevelName(LogLevel level)
+{
+	switch (level) {
+	case LogLevel::Trace: return "TRACE";
+	case LogLevel::Debug: return "DEBUG";
+	case LogLevel::Info: return "INFO";
+	case LogLevel::Warning: return "WARNING";
+	case LogLevel::Error: return "ERROR";
+	default: return "OFF";
+	}
+}
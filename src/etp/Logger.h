@@ -0,0 +1,217 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "../nsDefinitions.h"
+
+#if defined(_WIN32) && !defined(FETPAPI_STATIC)
+#ifndef FETPAPI_DLL_IMPORT_OR_EXPORT
+#if defined(Fetpapi_EXPORTS)
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllexport)
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllimport)
+#endif
+#endif
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT
+#endif
+
+/**
+* The lowest log level which is compiled. Log statements below this level are removed by the compiler.
+* 0 = Trace, 1 = Debug, 2 = Info, 3 = Warning, 4 = Error
+*/
+#ifndef FETPAPI_COMPILED_LOG_LEVEL
+#define FETPAPI_COMPILED_LOG_LEVEL 0
+#endif
+
+/**
+* Log a message at a level if this level is enabled on the owner (typically a session).
+* The message arguments are not evaluated at all when the level is disabled.
+*
+* @param OWNER	A pointer to an object providing isLogEnabled(LogLevel) and log(LogLevel, ...) : a session or, when there is none, &ETP_NS::Logger::getInstance().
+* @param LEVEL	One of the LogLevel enumerators without its scope : Trace, Debug, Info, Warning or Error.
+*/
+#define FETPAPI_LOG(OWNER, LEVEL, ...) \
+	do { \
+		if (static_cast<int>(ETP_NS::LogLevel::LEVEL) >= FETPAPI_COMPILED_LOG_LEVEL && (OWNER)->isLogEnabled(ETP_NS::LogLevel::LEVEL)) { \
+			(OWNER)->log(ETP_NS::LogLevel::LEVEL, __VA_ARGS__); \
+		} \
+	} while (false)
+
+namespace ETP_NS
+{
+	enum class LogLevel : int { Trace = 0, Debug = 1, Info = 2, Warning = 3, Error = 4, Off = 5 };
+
+	/**
+	* Collects the log lines of all sessions into a lock free ring buffer and writes them from a background thread.
+	* Producers never wait for the writer : a line is dropped when the ring buffer is full.
+	* They only lock a mutex, for an instant, when they have to wake up the writer which sleeps because it has written all the lines.
+	*/
+	class Logger
+	{
+	public:
+		typedef std::function<void(LogLevel, const std::string&)> Sink;
+
+		/**
+		* The logger shared by the whole process.
+		* It is never destroyed since joining its writer thread in a static destructor is unsafe, at DLL unload on Windows in particular :
+		* the pending lines are written at exit but call stop() for stopping the writer thread cleanly.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT static Logger& getInstance();
+
+		/**
+		* Stop the background writer after it has written all pending lines.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT ~Logger();
+
+		/**
+		* Write all pending lines and stop the background writer thread.
+		* The lines which are logged afterwards are only written by flush().
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void stop();
+
+		/**
+		* Set the lowest level of the messages which are not related to a session, typically the server listener or the client launcher ones.
+		* It is Warning by default. Use LogLevel::Off to disable them.
+		*/
+		void setLogLevel(LogLevel level) { logLevel.store(level); }
+		LogLevel getLogLevel() const { return logLevel.load(); }
+
+		/**
+		* @return true if the messages of a given level which are not related to a session are logged.
+		*/
+		bool isLogEnabled(LogLevel level) const { return level >= logLevel.load(std::memory_order_relaxed); }
+
+		/**
+		* Format the arguments separated by a space and push them to the ring buffer.
+		* Prefer the FETPAPI_LOG macro which does not evaluate the arguments if the level is disabled.
+		*/
+		template<typename ...Args>
+		void log(LogLevel level, Args && ...args)
+		{
+			push(level, format(std::forward<Args>(args)...));
+		}
+
+		/**
+		* @return The arguments separated by a space.
+		*/
+		template<typename ...Args>
+		static std::string format(Args && ...args)
+		{
+			std::ostringstream oss;
+			append(oss, std::forward<Args>(args)...);
+			return oss.str();
+		}
+
+		/**
+		* Put a log line in the ring buffer without blocking.
+		*
+		* @return false if the line has been dropped because the ring buffer is full.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT bool push(LogLevel level, std::string&& line);
+
+		/**
+		* Set where the log lines are written. By default, they are written to the standard output.
+		* The sink is always called from a single thread at a time.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void setSink(Sink newSink);
+
+		/**
+		* Write all the lines which are currently in the ring buffer before returning.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void flush();
+
+		/**
+		* @return the count of lines which have been dropped because the ring buffer was full.
+		*/
+		uint64_t getDroppedCount() const { return droppedCount.load(std::memory_order_relaxed); }
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT static const char* getLevelName(LogLevel level);
+
+	private:
+		struct Slot {
+			std::atomic<std::size_t> sequence;
+			LogLevel level;
+			std::string line;
+		};
+
+		Logger(std::size_t capacity);
+		Logger(const Logger&) = delete;
+		Logger& operator=(const Logger&) = delete;
+
+		static void append(std::ostringstream&) {}
+
+		template<typename First, typename ...Rest>
+		static void append(std::ostringstream& oss, First && first, Rest && ...rest)
+		{
+			oss << std::forward<First>(first);
+			if (sizeof...(Rest) > 0) {
+				oss << ' ';
+			}
+			append(oss, std::forward<Rest>(rest)...);
+		}
+
+		bool pop(LogLevel& level, std::string& line);
+
+		/**
+		* @return true if the next line to pop has been completely pushed.
+		*/
+		bool hasPendingLine() const;
+
+		/**
+		* Write all the lines of the ring buffer to the sink.
+		* Must be called with sinkMutex locked.
+		*/
+		void drain();
+
+		void writeLoop();
+
+		/// The ring buffer. Its capacity is a power of two.
+		std::unique_ptr<Slot[]> slots;
+		const std::size_t mask;
+		std::atomic<std::size_t> enqueuePosition{ 0 };
+		std::atomic<std::size_t> dequeuePosition{ 0 };
+		std::atomic<uint64_t> droppedCount{ 0 };
+		std::atomic<LogLevel> logLevel{ LogLevel::Warning };
+
+		Sink sink;
+		/// Serializes the consumers of the ring buffer and the calls to the sink.
+		std::mutex sinkMutex;
+
+		std::atomic<bool> stopRequested{ false };
+		/// True while the writer waits for a line, or is about to. The producers notify it only in this case.
+		std::atomic<bool> writerSleeping{ false };
+		/// Notified when a line is pushed while the writer is sleeping
+		std::mutex wakeUpMutex;
+		std::condition_variable wakeUpCondition;
+		std::thread writer;
+		/// Serializes the calls to stop
+		std::mutex writerMutex;
+	};
+}
@@ -0,0 +1,636 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "Metrics.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+using namespace ETP_NS;
+
+namespace {
+	void mergeCounts(std::map<int32_t, uint64_t>& target, const std::map<int32_t, uint64_t>& source)
+	{
+		for (const auto& item : source) {
+			target[item.first] += item.second;
+		}
+	}
+
+	void writeCountsAsJson(std::ostringstream& oss, const std::map<int32_t, uint64_t>& counts)
+	{
+		oss << '{';
+		for (auto it = counts.begin(); it != counts.end(); ++it) {
+			if (it != counts.begin()) {
+				oss << ',';
+			}
+			oss << '"' << it->first << "\":" << it->second;
+		}
+		oss << '}';
+	}
+
+	void writeHistogramAsJson(std::ostringstream& oss, const HistogramSnapshot& histogram)
+	{
+		oss << "{\"count\":" << histogram.count << ",\"sum\":" << histogram.sum << ",\"buckets\":[";
+		for (size_t i = 0; i < histogram.bucketCounts.size(); ++i) {
+			if (i > 0) {
+				oss << ',';
+			}
+			oss << "{\"le\":";
+			if (i < histogram.upperBounds.size()) {
+				oss << histogram.upperBounds[i];
+			}
+			else {
+				oss << "\"+Inf\"";
+			}
+			oss << ",\"count\":" << histogram.bucketCounts[i] << '}';
+		}
+		oss << "]}";
+	}
+
+	void writePrometheusHeader(std::ostringstream& oss, const char* name, const char* type, const char* help)
+	{
+		oss << "# HELP fetpapi_" << name << ' ' << help << "\n# TYPE fetpapi_" << name << ' ' << type << '\n';
+	}
+
+	template<typename T> void writePrometheusValue(std::ostringstream& oss, const char* name, const char* type, const char* help, T value)
+	{
+		writePrometheusHeader(oss, name, type, help);
+		oss << "fetpapi_" << name << ' ' << value << '\n';
+	}
+
+	void writePrometheusCounts(std::ostringstream& oss, const char* direction, const std::map<int32_t, uint64_t>& counts)
+	{
+		for (const auto& item : counts) {
+			oss << "fetpapi_protocol_exceptions_total{direction=\"" << direction << "\",code=\"" << item.first << "\"} " << item.second << '\n';
+		}
+	}
+}
+
+void HistogramSnapshot::merge(const HistogramSnapshot& other)
+{
+	if (bucketCounts.empty()) {
+		*this = other;
+		return;
+	}
+	if (other.bucketCounts.size() != bucketCounts.size()) {
+		throw std::logic_error("Cannot merge histograms having different buckets.");
+	}
+
+	for (size_t i = 0; i < bucketCounts.size(); ++i) {
+		bucketCounts[i] += other.bucketCounts[i];
+	}
+	count += other.count;
+	sum += other.sum;
+}
+
+const std::array<double, LatencyHistogram::BUCKET_COUNT - 1>& LatencyHistogram::getUpperBounds()
+{
+	static const std::array<double, BUCKET_COUNT - 1> upperBounds = { {
+		0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10
+	} };
+	return upperBounds;
+}
+
+void LatencyHistogram::observe(std::chrono::steady_clock::duration duration)
+{
+	const double seconds = std::chrono::duration<double>(duration).count();
+	const auto& upperBounds = getUpperBounds();
+	const size_t bucket = std::lower_bound(upperBounds.begin(), upperBounds.end(), seconds) - upperBounds.begin();
+
+	bucketCounts[bucket].fetch_add(1, std::memory_order_relaxed);
+	count.fetch_add(1, std::memory_order_relaxed);
+	const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+	sumInNanoseconds.fetch_add(nanoseconds > 0 ? static_cast<uint64_t>(nanoseconds) : 0, std::memory_order_relaxed);
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const
+{
+	HistogramSnapshot result;
+	result.upperBounds.assign(getUpperBounds().begin(), getUpperBounds().end());
+	result.bucketCounts.reserve(BUCKET_COUNT);
+	for (const auto& bucketCount : bucketCounts) {
+		result.bucketCounts.push_back(bucketCount.load(std::memory_order_relaxed));
+	}
+	result.count = count.load(std::memory_order_relaxed);
+	result.sum = sumInNanoseconds.load(std::memory_order_relaxed) / 1e9;
+	return result;
+}
+
+void MessageTypeMetricsSnapshot::merge(const MessageTypeMetricsSnapshot& other)
+{
+	sentMessageCount += other.sentMessageCount;
+	sentByteCount += other.sentByteCount;
+	receivedMessageCount += other.receivedMessageCount;
+	receivedByteCount += other.receivedByteCount;
+	roundTripTime.merge(other.roundTripTime);
+}
+
+void MetricsSnapshot::merge(const MetricsSnapshot& other)
+{
+	sessionCount += other.sessionCount;
+	openSessionCount += other.openSessionCount;
+	acceptedConnectionCount += other.acceptedConnectionCount;
+	acceptedHandshakeCount += other.acceptedHandshakeCount;
+	failedHandshakeCount += other.failedHandshakeCount;
+
+	// Both vectors are sorted by protocol and message type
+	std::vector<MessageTypeMetricsSnapshot> merged;
+	merged.reserve(messageTypes.size() + other.messageTypes.size());
+	auto it = messageTypes.begin();
+	auto otherIt = other.messageTypes.begin();
+	while (it != messageTypes.end() || otherIt != other.messageTypes.end()) {
+		if (otherIt == other.messageTypes.end() ||
+			(it != messageTypes.end() && std::make_pair(it->protocol, it->messageType) < std::make_pair(otherIt->protocol, otherIt->messageType))) {
+			merged.push_back(*it++);
+		}
+		else if (it == messageTypes.end() ||
+			std::make_pair(otherIt->protocol, otherIt->messageType) < std::make_pair(it->protocol, it->messageType)) {
+			merged.push_back(*otherIt++);
+		}
+		else {
+			merged.push_back(*it++);
+			merged.back().merge(*otherIt++);
+		}
+	}
+	messageTypes.swap(merged);
+
+	mergeCounts(sentProtocolExceptionCounts, other.sentProtocolExceptionCounts);
+	mergeCounts(receivedProtocolExceptionCounts, other.receivedProtocolExceptionCounts);
+	sendingQueueMessageCount += other.sendingQueueMessageCount;
+	sendingQueueByteSize += other.sendingQueueByteSize;
+	inFlightRequestCount += other.inFlightRequestCount;
+	missedPongCount += other.missedPongCount;
+	reapedSessionCount += other.reapedSessionCount;
+}
+
+std::vector<MessageTypeMetricsSnapshot> MetricsSnapshot::getProtocolTotals() const
+{
+	std::vector<MessageTypeMetricsSnapshot> result;
+	for (const auto& messageType : messageTypes) {
+		if (result.empty() || result.back().protocol != messageType.protocol) {
+			result.push_back(messageType);
+			result.back().messageType = -1;
+		}
+		else {
+			result.back().merge(messageType);
+		}
+	}
+	return result;
+}
+
+std::string MetricsSnapshot::toJson() const
+{
+	std::ostringstream oss;
+	oss << "{\"sessionCount\":" << sessionCount
+		<< ",\"sendingQueueMessageCount\":" << sendingQueueMessageCount
+		<< ",\"sendingQueueByteSize\":" << sendingQueueByteSize
+		<< ",\"inFlightRequestCount\":" << inFlightRequestCount
+		<< ",\"missedPongCount\":" << missedPongCount
+		<< ",\"reapedSessionCount\":" << reapedSessionCount
+		<< ",\"openSessionCount\":" << openSessionCount
+		<< ",\"acceptedConnectionCount\":" << acceptedConnectionCount
+		<< ",\"acceptedHandshakeCount\":" << acceptedHandshakeCount
+		<< ",\"failedHandshakeCount\":" << failedHandshakeCount
+		<< ",\"ioThreadCount\":" << ioThreadCount
+		<< ",\"ioThreadCpuSeconds\":" << ioThreadCpuSeconds
+		<< ",\"ioThreadUtilization\":" << ioThreadUtilization
+		<< ",\"sentProtocolExceptionCounts\":";
+	writeCountsAsJson(oss, sentProtocolExceptionCounts);
+	oss << ",\"receivedProtocolExceptionCounts\":";
+	writeCountsAsJson(oss, receivedProtocolExceptionCounts);
+	oss << ",\"messageTypes\":[";
+	for (size_t i = 0; i < messageTypes.size(); ++i) {
+		const MessageTypeMetricsSnapshot& messageType = messageTypes[i];
+		if (i > 0) {
+			oss << ',';
+		}
+		oss << "{\"protocol\":" << messageType.protocol
+			<< ",\"messageType\":" << messageType.messageType
+			<< ",\"sentMessageCount\":" << messageType.sentMessageCount
+			<< ",\"sentByteCount\":" << messageType.sentByteCount
+			<< ",\"receivedMessageCount\":" << messageType.receivedMessageCount
+			<< ",\"receivedByteCount\":" << messageType.receivedByteCount
+			<< ",\"roundTripTime\":";
+		writeHistogramAsJson(oss, messageType.roundTripTime);
+		oss << '}';
+	}
+	oss << "]}";
+	return oss.str();
+}
+
+std::string MetricsSnapshot::toPrometheusText() const
+{
+	std::ostringstream oss;
+	writePrometheusValue(oss, "sessions", "gauge", "Count of ETP sessions which have not been destroyed yet.", sessionCount);
+	writePrometheusValue(oss, "open_sessions", "gauge", "Count of ETP sessions having their websocket opened.", openSessionCount);
+	writePrometheusValue(oss, "accepted_connections_total", "counter", "Count of accepted TCP connections.", acceptedConnectionCount);
+	writePrometheusHeader(oss, "handshakes_total", "counter", "Count of websocket handshakes by result.");
+	oss << "fetpapi_handshakes_total{result=\"accepted\"} " << acceptedHandshakeCount << '\n';
+	oss << "fetpapi_handshakes_total{result=\"failed\"} " << failedHandshakeCount << '\n';
+	writePrometheusValue(oss, "io_threads", "gauge", "Count of threads running the io context.", ioThreadCount);
+	writePrometheusValue(oss, "io_thread_cpu_seconds_total", "counter", "CPU time consumed by the threads running the io context.", ioThreadCpuSeconds);
+	writePrometheusValue(oss, "io_thread_utilization", "gauge", "Mean ratio of the time the io context threads have spent working since the previous scrape.", ioThreadUtilization);
+	writePrometheusValue(oss, "sending_queue_messages", "gauge", "Count of messages waiting to be written.", sendingQueueMessageCount);
+	writePrometheusValue(oss, "sending_queue_bytes", "gauge", "Size of the messages waiting to be written.", sendingQueueByteSize);
+	writePrometheusValue(oss, "in_flight_requests", "gauge", "Count of sent requests waiting for their final response.", inFlightRequestCount);
+	writePrometheusValue(oss, "missed_pongs_total", "counter", "Count of heartbeat pings which have not been answered in time.", missedPongCount);
+	writePrometheusValue(oss, "reaped_sessions_total", "counter", "Count of sessions closed because they missed too many pongs or were idle for too long.", reapedSessionCount);
+
+	writePrometheusHeader(oss, "protocol_exceptions_total", "counter", "Count of ProtocolException errors by direction and error code.");
+	writePrometheusCounts(oss, "sent", sentProtocolExceptionCounts);
+	writePrometheusCounts(oss, "received", receivedProtocolExceptionCounts);
+
+	struct MessageCounter {
+		const char* name;
+		const char* help;
+		uint64_t MessageTypeMetricsSnapshot::* value;
+	};
+	const MessageCounter messageCounters[] = {
+		{ "sent_messages_total", "Count of sent messages by protocol and message type.", &MessageTypeMetricsSnapshot::sentMessageCount },
+		{ "sent_bytes_total", "Size of the sent messages by protocol and message type.", &MessageTypeMetricsSnapshot::sentByteCount },
+		{ "received_messages_total", "Count of received messages by protocol and message type.", &MessageTypeMetricsSnapshot::receivedMessageCount },
+		{ "received_bytes_total", "Size of the received messages by protocol and message type.", &MessageTypeMetricsSnapshot::receivedByteCount }
+	};
+	for (const auto& messageCounter : messageCounters) {
+		writePrometheusHeader(oss, messageCounter.name, "counter", messageCounter.help);
+		for (const auto& messageType : messageTypes) {
+			oss << "fetpapi_" << messageCounter.name << "{protocol=\"" << messageType.protocol << "\",message_type=\"" << messageType.messageType << "\"} "
+				<< messageType.*(messageCounter.value) << '\n';
+		}
+	}
+
+	writePrometheusHeader(oss, "round_trip_seconds", "histogram", "Duration between the queuing of a request and the reception of its final response.");
+	for (const auto& messageType : messageTypes) {
+		const HistogramSnapshot& histogram = messageType.roundTripTime;
+		if (histogram.count == 0) {
+			continue;
+		}
+		std::ostringstream labels;
+		labels << "protocol=\"" << messageType.protocol << "\",message_type=\"" << messageType.messageType << '"';
+		uint64_t cumulativeCount = 0;
+		for (size_t i = 0; i < histogram.bucketCounts.size(); ++i) {
+			cumulativeCount += histogram.bucketCounts[i];
+			oss << "fetpapi_round_trip_seconds_bucket{" << labels.str() << ",le=\"";
+			if (i < histogram.upperBounds.size()) {
+				oss << histogram.upperBounds[i];
+			}
+			else {
+				oss << "+Inf";
+			}
+			oss << "\"} " << cumulativeCount << '\n';
+		}
+		oss << "fetpapi_round_trip_seconds_sum{" << labels.str() << "} " << histogram.sum << '\n';
+		oss << "fetpapi_round_trip_seconds_count{" << labels.str() << "} " << histogram.count << '\n';
+	}
+
+	return oss.str();
+}
+
+void IoThreadUtilization::registerCurrentThread()
+{
+	MeasuredThread thread;
+	thread.id = std::this_thread::get_id();
+#ifdef _WIN32
+	HANDLE handle = nullptr;
+	if (!DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &handle, THREAD_QUERY_LIMITED_INFORMATION, FALSE, 0)) {
+		return;
+	}
+	thread.cpuClock = reinterpret_cast<std::uintptr_t>(handle);
+#elif defined(__APPLE__)
+	return; // pthread_getcpuclockid is not available
+#else
+	clockid_t clockId;
+	if (pthread_getcpuclockid(pthread_self(), &clockId) != 0) {
+		return;
+	}
+	thread.cpuClock = static_cast<std::uintptr_t>(clockId);
+#endif
+	thread.cpuSecondsAtRegistration = getThreadCpuSeconds(thread.cpuClock);
+
+	const std::lock_guard<std::mutex> threadsLock(threadsMutex);
+	threads.push_back(thread);
+}
+
+void IoThreadUtilization::unregisterCurrentThread()
+{
+	const std::lock_guard<std::mutex> threadsLock(threadsMutex);
+	const std::thread::id id = std::this_thread::get_id();
+	for (auto it = threads.begin(); it != threads.end(); ++it) {
+		if (it->id == id) {
+#ifdef _WIN32
+			CloseHandle(reinterpret_cast<HANDLE>(it->cpuClock));
+#endif
+			threads.erase(it);
+			return;
+		}
+	}
+}
+
+size_t IoThreadUtilization::getThreadCount() const
+{
+	const std::lock_guard<std::mutex> threadsLock(threadsMutex);
+	return threads.size();
+}
+
+double IoThreadUtilization::getCpuSeconds() const
+{
+	const std::lock_guard<std::mutex> threadsLock(threadsMutex);
+	return getCpuSecondsWithoutLock();
+}
+
+double IoThreadUtilization::getCpuSecondsWithoutLock() const
+{
+	double result = 0;
+	for (const auto& thread : threads) {
+		result += getThreadCpuSeconds(thread.cpuClock) - thread.cpuSecondsAtRegistration;
+	}
+	return result;
+}
+
+double IoThreadUtilization::sample()
+{
+	const std::lock_guard<std::mutex> threadsLock(threadsMutex);
+	const auto now = std::chrono::steady_clock::now();
+	const double cpuSeconds = getCpuSecondsWithoutLock();
+	const double elapsedSeconds = std::chrono::duration<double>(now - lastSampleTime).count() * threads.size();
+	const double result = elapsedSeconds > 0 ? (cpuSeconds - lastSampleCpuSeconds) / elapsedSeconds : 0;
+
+	lastSampleTime = now;
+	lastSampleCpuSeconds = cpuSeconds;
+
+	// The CPU time decreases when a thread is unregistered.
+	return result < 0 ? 0 : (result > 1 ? 1 : result);
+}
+
+double IoThreadUtilization::getThreadCpuSeconds(std::uintptr_t cpuClock)
+{
+#ifdef _WIN32
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	if (!GetThreadTimes(reinterpret_cast<HANDLE>(cpuClock), &creationTime, &exitTime, &kernelTime, &userTime)) {
+		return 0;
+	}
+	// FILETIME are expressed in 100 nanoseconds intervals
+	const uint64_t kernel = (static_cast<uint64_t>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+	const uint64_t user = (static_cast<uint64_t>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+	return (kernel + user) / 1e7;
+#elif defined(__APPLE__)
+	return 0;
+#else
+	timespec cpuTime;
+	if (clock_gettime(static_cast<clockid_t>(cpuClock), &cpuTime) != 0) {
+		return 0;
+	}
+	return cpuTime.tv_sec + cpuTime.tv_nsec / 1e9;
+#endif
+}
+
+SessionMetrics::~SessionMetrics()
+{
+	std::shared_ptr<MetricsRegistry> owner = registry.lock();
+	if (owner) {
+		MetricsSnapshot counters = snapshot();
+		// Only the counters remain meaningful once the session is destroyed.
+		counters.sessionCount = 0;
+		counters.openSessionCount = 0;
+		counters.sendingQueueMessageCount = 0;
+		counters.sendingQueueByteSize = 0;
+		counters.inFlightRequestCount = 0;
+		owner->retire(counters);
+	}
+
+	for (auto& metrics : messageTypeMetrics) {
+		delete metrics.load();
+	}
+}
+
+size_t SessionMetrics::getMessageTypeSlot(int32_t messageType)
+{
+	if (messageType > 0 && messageType < 14) {
+		return messageType;
+	}
+	if (messageType == 1000 || messageType == 1001) { // ProtocolException or Acknowledge
+		return messageType - 986;
+	}
+	return 0;
+}
+
+int32_t SessionMetrics::getMessageType(size_t slot)
+{
+	return slot < 14 ? static_cast<int32_t>(slot) : static_cast<int32_t>(slot) + 986;
+}
+
+SessionMetrics::MessageTypeMetrics* SessionMetrics::getMessageTypeMetrics(int32_t protocol, int32_t messageType)
+{
+	if (protocol < 0 || static_cast<size_t>(protocol) >= PROTOCOL_COUNT) {
+		return nullptr;
+	}
+
+	std::atomic<MessageTypeMetrics*>& slot = messageTypeMetrics[protocol * MESSAGE_TYPE_SLOT_COUNT + getMessageTypeSlot(messageType)];
+	MessageTypeMetrics* result = slot.load(std::memory_order_acquire);
+	if (result == nullptr) {
+		MessageTypeMetrics* created = new MessageTypeMetrics();
+		if (slot.compare_exchange_strong(result, created, std::memory_order_acq_rel)) {
+			result = created;
+		}
+		else {
+			// Another thread has created them in the meantime
+			delete created;
+		}
+	}
+	return result;
+}
+
+void SessionMetrics::recordSentMessage(int32_t protocol, int32_t messageType, int64_t messageId, int64_t correlationId, size_t byteCount)
+{
+	MessageTypeMetrics* metrics = getMessageTypeMetrics(protocol, messageType);
+	if (metrics == nullptr) {
+		return;
+	}
+	metrics->sentMessageCount.increment();
+	metrics->sentByteCount.increment(byteCount);
+
+	if (correlationId == 0 && messageId >= 0) {
+		const auto now = std::chrono::steady_clock::now();
+		const std::lock_guard<std::mutex> trackedRequestsLock(trackedRequestsMutex);
+		// Stop tracking the messages which will probably never be answered
+		while (!trackedRequests.empty() && now - trackedRequests.begin()->second.queuingTime > requestTrackingTimeOut) {
+			trackedRequests.erase(trackedRequests.begin());
+		}
+		TrackedRequest& request = trackedRequests[messageId];
+		request.protocol = protocol;
+		request.messageType = messageType;
+		request.queuingTime = now;
+	}
+}
+
+void SessionMetrics::recordReceivedMessage(int32_t protocol, int32_t messageType, int64_t correlationId, int32_t messageFlags, size_t byteCount)
+{
+	MessageTypeMetrics* metrics = getMessageTypeMetrics(protocol, messageType);
+	if (metrics != nullptr) {
+		metrics->receivedMessageCount.increment();
+		metrics->receivedByteCount.increment(byteCount);
+	}
+
+	// An Acknowledge is not the response to a request
+	if (correlationId != 0 && (messageFlags & 0x02) != 0 && messageType != 1001) {
+		TrackedRequest request;
+		{
+			const std::lock_guard<std::mutex> trackedRequestsLock(trackedRequestsMutex);
+			auto it = trackedRequests.find(correlationId);
+			if (it == trackedRequests.end()) {
+				return;
+			}
+			request = it->second;
+			trackedRequests.erase(it);
+		} // Scope for trackedRequestsLock
+
+		MessageTypeMetrics* requestMetrics = getMessageTypeMetrics(request.protocol, request.messageType);
+		if (requestMetrics != nullptr) {
+			requestMetrics->roundTripTime.observe(std::chrono::steady_clock::now() - request.queuingTime);
+		}
+	}
+}
+
+void SessionMetrics::recordSentProtocolException(int32_t errorCode)
+{
+	const std::lock_guard<std::mutex> protocolExceptionCountsLock(protocolExceptionCountsMutex);
+	++sentProtocolExceptionCounts[errorCode];
+}
+
+void SessionMetrics::recordReceivedProtocolException(int32_t errorCode)
+{
+	const std::lock_guard<std::mutex> protocolExceptionCountsLock(protocolExceptionCountsMutex);
+	++receivedProtocolExceptionCounts[errorCode];
+}
+
+MetricsSnapshot SessionMetrics::snapshot() const
+{
+	MetricsSnapshot result;
+	result.sessionCount = 1;
+
+	for (size_t protocol = 0; protocol < PROTOCOL_COUNT; ++protocol) {
+		for (size_t slot = 0; slot < MESSAGE_TYPE_SLOT_COUNT; ++slot) {
+			const MessageTypeMetrics* metrics = messageTypeMetrics[protocol * MESSAGE_TYPE_SLOT_COUNT + slot].load(std::memory_order_acquire);
+			if (metrics != nullptr) {
+				MessageTypeMetricsSnapshot messageType;
+				messageType.protocol = static_cast<int32_t>(protocol);
+				messageType.messageType = getMessageType(slot);
+				messageType.sentMessageCount = metrics->sentMessageCount.get();
+				messageType.sentByteCount = metrics->sentByteCount.get();
+				messageType.receivedMessageCount = metrics->receivedMessageCount.get();
+				messageType.receivedByteCount = metrics->receivedByteCount.get();
+				messageType.roundTripTime = metrics->roundTripTime.snapshot();
+				result.messageTypes.push_back(messageType);
+			}
+		}
+	}
+
+	{
+		const std::lock_guard<std::mutex> protocolExceptionCountsLock(protocolExceptionCountsMutex);
+		result.sentProtocolExceptionCounts = sentProtocolExceptionCounts;
+		result.receivedProtocolExceptionCounts = receivedProtocolExceptionCounts;
+	} // Scope for protocolExceptionCountsLock
+
+	result.openSessionCount = webSocketSessionOpened.get();
+	result.sendingQueueMessageCount = sendingQueueMessageCount.get();
+	result.sendingQueueByteSize = sendingQueueByteSize.get();
+	result.missedPongCount = missedPongCount.get();
+	result.reapedSessionCount = reapedSessionCount.get();
+	{
+		const std::lock_guard<std::mutex> trackedRequestsLock(trackedRequestsMutex);
+		result.inFlightRequestCount = trackedRequests.size();
+	} // Scope for trackedRequestsLock
+
+	return result;
+}
+
+std::shared_ptr<SessionMetrics> MetricsRegistry::createSessionMetrics()
+{
+	std::shared_ptr<SessionMetrics> result(new SessionMetrics(shared_from_this()));
+
+	const std::lock_guard<std::mutex> sessionsLock(sessionsMutex);
+	// Forget the destroyed sessions
+	sessions.erase(std::remove_if(sessions.begin(), sessions.end(),
+		[](const std::weak_ptr<SessionMetrics>& session) { return session.expired(); }), sessions.end());
+	sessions.push_back(result);
+
+	return result;
+}
+
+MetricsSnapshot MetricsRegistry::snapshot()
+{
+	std::vector<std::shared_ptr<SessionMetrics>> living = getSessionMetrics();
+
+	MetricsSnapshot result;
+	{
+		const std::lock_guard<std::mutex> sessionsLock(sessionsMutex);
+		result = retired;
+	} // Scope for sessionsLock
+	for (const auto& session : living) {
+		result.merge(session->snapshot());
+	}
+	result.acceptedConnectionCount += acceptedConnectionCount.get();
+	result.acceptedHandshakeCount += acceptedHandshakeCount.get();
+	result.failedHandshakeCount += failedHandshakeCount.get();
+	result.ioThreadCount = ioThreadUtilization.getThreadCount();
+	result.ioThreadCpuSeconds = ioThreadUtilization.getCpuSeconds();
+	result.ioThreadUtilization = ioThreadUtilization.sample();
+
+	return result;
+}
+
+std::vector<std::shared_ptr<SessionMetrics>> MetricsRegistry::getSessionMetrics()
+{
+	std::vector<std::shared_ptr<SessionMetrics>> result;
+
+	const std::lock_guard<std::mutex> sessionsLock(sessionsMutex);
+	for (const auto& session : sessions) {
+		std::shared_ptr<SessionMetrics> living = session.lock();
+		if (living) {
+			result.push_back(living);
+		}
+	}
+
+	return result;
+}
+
+int64_t MetricsRegistry::getOpenSessionCount()
+{
+	int64_t result = 0;
+	for (const auto& session : getSessionMetrics()) {
+		result += session->webSocketSessionOpened.get();
+	}
+	return result;
+}
+
+void MetricsRegistry::retire(const MetricsSnapshot& sessionSnapshot)
+{
+	const std::lock_guard<std::mutex> sessionsLock(sessionsMutex);
+	retired.merge(sessionSnapshot);
+}
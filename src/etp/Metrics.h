@@ -0,0 +1,389 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../nsDefinitions.h"
+
+#if defined(_WIN32) && !defined(FETPAPI_STATIC)
+#ifndef FETPAPI_DLL_IMPORT_OR_EXPORT
+#if defined(Fetpapi_EXPORTS)
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllexport)
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllimport)
+#endif
+#endif
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT
+#endif
+
+namespace ETP_NS
+{
+	/**
+	* A monotonically increasing count.
+	*/
+	class Counter
+	{
+	public:
+		void increment(uint64_t value = 1) { count.fetch_add(value, std::memory_order_relaxed); }
+		uint64_t get() const { return count.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<uint64_t> count{ 0 };
+	};
+
+	/**
+	* A value which can go up and down.
+	*/
+	class Gauge
+	{
+	public:
+		void set(int64_t newValue) { value.store(newValue, std::memory_order_relaxed); }
+		void add(int64_t delta) { value.fetch_add(delta, std::memory_order_relaxed); }
+		int64_t get() const { return value.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<int64_t> value{ 0 };
+	};
+
+	/**
+	* A copy of the content of a LatencyHistogram at a particular time.
+	*/
+	struct HistogramSnapshot
+	{
+		/// The upper bounds in seconds of the buckets. The last bucket, which is not listed here, has no upper bound.
+		std::vector<double> upperBounds;
+		/// The count of observations in each bucket (not cumulative). It has one more item than upperBounds.
+		std::vector<uint64_t> bucketCounts;
+		uint64_t count = 0;
+		/// The sum of all observations in seconds
+		double sum = 0;
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT void merge(const HistogramSnapshot& other);
+	};
+
+	/**
+	* Counts durations into fixed buckets going from 100 microseconds to 10 seconds.
+	*/
+	class LatencyHistogram
+	{
+	public:
+		static constexpr std::size_t BUCKET_COUNT = 17;
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT void observe(std::chrono::steady_clock::duration duration);
+		FETPAPI_DLL_IMPORT_OR_EXPORT HistogramSnapshot snapshot() const;
+
+		/**
+		* The upper bounds in seconds of the buckets, except the last one which has no upper bound.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT static const std::array<double, BUCKET_COUNT - 1>& getUpperBounds();
+
+	private:
+		std::array<std::atomic<uint64_t>, BUCKET_COUNT> bucketCounts{};
+		std::atomic<uint64_t> count{ 0 };
+		std::atomic<uint64_t> sumInNanoseconds{ 0 };
+	};
+
+	/**
+	* The metrics of a message type at a particular time.
+	*/
+	struct MessageTypeMetricsSnapshot
+	{
+		int32_t protocol = 0;
+		/// -1 when the snapshot aggregates all message types of the protocol
+		int32_t messageType = 0;
+		uint64_t sentMessageCount = 0;
+		uint64_t sentByteCount = 0;
+		uint64_t receivedMessageCount = 0;
+		uint64_t receivedByteCount = 0;
+		/// The durations between the queuing of the requests of this message type and the reception of their final response.
+		HistogramSnapshot roundTripTime;
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT void merge(const MessageTypeMetricsSnapshot& other);
+	};
+
+	/**
+	* The metrics of one or more sessions at a particular time.
+	*/
+	struct MetricsSnapshot
+	{
+		/// The count of sessions which are currently aggregated in this snapshot.
+		uint64_t sessionCount = 0;
+		/// The count of sessions having their websocket opened.
+		int64_t openSessionCount = 0;
+		/// The count of TCP connections accepted by a server.
+		uint64_t acceptedConnectionCount = 0;
+		/// The count of websocket (and TLS if any) handshakes which a server has succeeded.
+		uint64_t acceptedHandshakeCount = 0;
+		/// The count of websocket (and TLS if any) handshakes which a server has failed or refused.
+		uint64_t failedHandshakeCount = 0;
+		/// The count of threads running the io context of a server. Only filled by MetricsRegistry::snapshot, never merged.
+		uint64_t ioThreadCount = 0;
+		/// The CPU time in seconds consumed by the threads running the io context of a server. Only filled by MetricsRegistry::snapshot, never merged.
+		double ioThreadCpuSeconds = 0;
+		/// The mean ratio, between 0 and 1, of the time the io context threads of a server have spent working since the previous registry snapshot. Only filled by MetricsRegistry::snapshot, never merged.
+		double ioThreadUtilization = 0;
+		/// Sorted by protocol and then by message type. Message types which have never been sent nor received are not listed.
+		std::vector<MessageTypeMetricsSnapshot> messageTypes;
+		/// The count of ProtocolException errors which have been sent, indexed by error code.
+		std::map<int32_t, uint64_t> sentProtocolExceptionCounts;
+		/// The count of ProtocolException errors which have been received, indexed by error code.
+		std::map<int32_t, uint64_t> receivedProtocolExceptionCounts;
+		int64_t sendingQueueMessageCount = 0;
+		int64_t sendingQueueByteSize = 0;
+		/// The count of requests which have been sent and which have not received their final response yet.
+		int64_t inFlightRequestCount = 0;
+		/// The count of Core Ping messages which have not been answered before the next heartbeat (see AbstractSession::setHeartbeat).
+		uint64_t missedPongCount = 0;
+		/// The count of sessions which have been closed because they missed too many pongs or because they were idle for too long.
+		uint64_t reapedSessionCount = 0;
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT void merge(const MetricsSnapshot& other);
+
+		/**
+		* Aggregate the message types of each protocol.
+		* The messageType of the returned items is -1.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::vector<MessageTypeMetricsSnapshot> getProtocolTotals() const;
+
+		/**
+		* Export this snapshot as a JSON object.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::string toJson() const;
+
+		/**
+		* Export this snapshot in the Prometheus text exposition format.
+		* All metric names are prefixed with "fetpapi_".
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::string toPrometheusText() const;
+	};
+
+	/**
+	* Measures how busy the threads running an io context are, using the CPU time they consume.
+	*/
+	class IoThreadUtilization
+	{
+	public:
+		/**
+		* Start measuring the calling thread. It must be called by the io context thread itself.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void registerCurrentThread();
+
+		/**
+		* Stop measuring the calling thread. It must be called before the thread ends.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void unregisterCurrentThread();
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::size_t getThreadCount() const;
+
+		/**
+		* @return The CPU time in seconds consumed by the registered threads since their registration.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT double getCpuSeconds() const;
+
+		/**
+		* @return The mean ratio, between 0 and 1, of the time the registered threads have spent working since the previous call to this method.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT double sample();
+
+	private:
+		struct MeasuredThread {
+			std::thread::id id;
+			/// The platform specific clock or handle giving the CPU time of the thread
+			std::uintptr_t cpuClock;
+			double cpuSecondsAtRegistration;
+		};
+
+		static double getThreadCpuSeconds(std::uintptr_t cpuClock);
+		double getCpuSecondsWithoutLock() const;
+
+		mutable std::mutex threadsMutex;
+		std::vector<MeasuredThread> threads;
+		std::chrono::steady_clock::time_point lastSampleTime{ std::chrono::steady_clock::now() };
+		double lastSampleCpuSeconds = 0;
+	};
+
+	class MetricsRegistry;
+
+	/**
+	* The metrics of a single session.
+	* All recording methods are thread safe and, except the request tracking, lock free.
+	*/
+	class SessionMetrics
+	{
+	public:
+		/// The protocol ids of ETP1.2 go from 0 to 25
+		static constexpr std::size_t PROTOCOL_COUNT = 26;
+		/// Message types from 1 to 13 are stored at their own index, ProtocolException and Acknowledge at 14 and 15, other ones at 0.
+		static constexpr std::size_t MESSAGE_TYPE_SLOT_COUNT = 16;
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT ~SessionMetrics();
+
+		/**
+		* Record a message which has been put in the sending queue.
+		* If the message is not a response, it is tracked until its final response in order to compute its round trip time.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void recordSentMessage(int32_t protocol, int32_t messageType, int64_t messageId, int64_t correlationId, std::size_t byteCount);
+
+		/**
+		* Record a received message.
+		* If the message is the final response to a tracked request, the round trip time of the request is recorded.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void recordReceivedMessage(int32_t protocol, int32_t messageType, int64_t correlationId, int32_t messageFlags, std::size_t byteCount);
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT void recordSentProtocolException(int32_t errorCode);
+		FETPAPI_DLL_IMPORT_OR_EXPORT void recordReceivedProtocolException(int32_t errorCode);
+
+		void recordMissedPong() { missedPongCount.increment(); }
+		void recordReapedSession() { reapedSessionCount.increment(); }
+
+		void setWebSocketSessionOpened(bool opened) { webSocketSessionOpened.set(opened ? 1 : 0); }
+
+		void setSendingQueueSize(uint64_t messageCount, uint64_t byteSize) {
+			sendingQueueMessageCount.set(messageCount);
+			sendingQueueByteSize.set(byteSize);
+		}
+
+		/**
+		* Set the duration after which a request which has not been answered is not tracked anymore.
+		* It prevents from tracking forever the messages which do not expect any response, such as notifications.
+		*/
+		void setRequestTrackingTimeOut(std::chrono::steady_clock::duration timeOut) { requestTrackingTimeOut = timeOut; }
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT MetricsSnapshot snapshot() const;
+
+	private:
+		friend class MetricsRegistry;
+
+		struct MessageTypeMetrics {
+			Counter sentMessageCount;
+			Counter sentByteCount;
+			Counter receivedMessageCount;
+			Counter receivedByteCount;
+			LatencyHistogram roundTripTime;
+		};
+
+		struct TrackedRequest {
+			int32_t protocol;
+			int32_t messageType;
+			std::chrono::steady_clock::time_point queuingTime;
+		};
+
+		SessionMetrics(std::weak_ptr<MetricsRegistry> registry) : registry(registry) {}
+		SessionMetrics(const SessionMetrics&) = delete;
+		SessionMetrics& operator=(const SessionMetrics&) = delete;
+
+		static std::size_t getMessageTypeSlot(int32_t messageType);
+		static int32_t getMessageType(std::size_t slot);
+
+		/**
+		* Get the metrics of a message type, creating them at first use.
+		* @return nullptr if the protocol is not an ETP1.2 one.
+		*/
+		MessageTypeMetrics* getMessageTypeMetrics(int32_t protocol, int32_t messageType);
+
+		std::weak_ptr<MetricsRegistry> registry;
+		/// The metrics of each message type, allocated at first use and indexed by protocol * MESSAGE_TYPE_SLOT_COUNT + slot
+		std::array<std::atomic<MessageTypeMetrics*>, PROTOCOL_COUNT * MESSAGE_TYPE_SLOT_COUNT> messageTypeMetrics{};
+
+		mutable std::mutex protocolExceptionCountsMutex;
+		std::map<int32_t, uint64_t> sentProtocolExceptionCounts;
+		std::map<int32_t, uint64_t> receivedProtocolExceptionCounts;
+
+		Counter missedPongCount;
+		Counter reapedSessionCount;
+		Gauge webSocketSessionOpened;
+		Gauge sendingQueueMessageCount;
+		Gauge sendingQueueByteSize;
+
+		/// The requests waiting for their final response, indexed by message id. Message ids are increasing, the oldest request is consequently the first one.
+		std::map<int64_t, TrackedRequest> trackedRequests;
+		mutable std::mutex trackedRequestsMutex;
+		std::chrono::steady_clock::duration requestTrackingTimeOut{ std::chrono::seconds(60) };
+	};
+
+	/**
+	* Aggregates the metrics of many sessions, including the ones of the sessions which are already closed.
+	* It must be owned by a std::shared_ptr.
+	*/
+	class MetricsRegistry : public std::enable_shared_from_this<MetricsRegistry>
+	{
+	public:
+		/**
+		* Create the metrics of a new session which are going to be aggregated in this registry.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::shared_ptr<SessionMetrics> createSessionMetrics();
+
+		/**
+		* Aggregate the metrics of all the sessions which have been created by this registry.
+		* The gauges only aggregate the living sessions.
+		* The io thread utilization is computed since the previous call to this method.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT MetricsSnapshot snapshot();
+
+		/**
+		* Get the metrics of each living session.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::vector<std::shared_ptr<SessionMetrics>> getSessionMetrics();
+
+		/**
+		* @return The count of living sessions having their websocket opened.
+		* Contrary to snapshot, it does not aggregate the other metrics and does not start a new io thread utilization sample.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT int64_t getOpenSessionCount();
+
+		std::size_t getIoThreadCount() const { return ioThreadUtilization.getThreadCount(); }
+
+		void recordAcceptedConnection() { acceptedConnectionCount.increment(); }
+		void recordHandshake(bool succeeded) { succeeded ? acceptedHandshakeCount.increment() : failedHandshakeCount.increment(); }
+
+		/**
+		* The utilization of the threads running the io context of the server recording into this registry.
+		*/
+		IoThreadUtilization& getIoThreadUtilization() { return ioThreadUtilization; }
+
+	private:
+		friend class SessionMetrics;
+
+		/**
+		* Keep the counters of a session which is going to be destroyed.
+		*/
+		void retire(const MetricsSnapshot& sessionSnapshot);
+
+		std::mutex sessionsMutex;
+		std::vector<std::weak_ptr<SessionMetrics>> sessions;
+		/// The aggregated counters of the destroyed sessions
+		MetricsSnapshot retired;
+
+		Counter acceptedConnectionCount;
+		Counter acceptedHandshakeCount;
+		Counter failedHandshakeCount;
+		IoThreadUtilization ioThreadUtilization;
+	};
+}
@@ -23,9 +23,16 @@ using namespace ETP_NS;
 
 PlainClientSession::PlainClientSession(
 	InitializationParameters* initializationParams, const std::string & target, const std::string & authorization,
-	const std::map<std::string, std::string>& additionalHandshakeHeaderFields, std::size_t frameSize) :
-		AbstractClientSession<PlainClientSession>(initializationParams, target, authorization),
+	const std::map<std::string, std::string>& additionalHandshakeHeaderFields, std::size_t frameSize,
+	std::shared_ptr<boost::asio::io_context> ioContext) :
+		AbstractClientSession<PlainClientSession>(initializationParams, target, authorization, ioContext),
+#if BOOST_VERSION < 107000
+		// No strand : the io context must be run by a single thread (see IoContextPool).
 		ws_(ioc)
+#else
+		// The strand serializes the completion handlers of this session when several threads run its io context.
+		ws_(boost::asio::make_strand(ioc))
+#endif
 {
 	ws_.binary(true);
 #if BOOST_VERSION < 107000
@@ -20,6 +20,8 @@ under the License.
 
 #include "AbstractClientSession.h"
 
+#include <boost/asio/strand.hpp>
+
 namespace ETP_NS
 {
 	class PlainClientSession : public AbstractClientSession<PlainClientSession>
@@ -29,10 +31,13 @@ namespace ETP_NS
 
 		/*
 		* @param frameSize				Sets the size of the write buffer used by the implementation to send frames : https://www.boost.org/doc/libs/1_75_0/libs/beast/doc/html/beast/ref/boost__beast__websocket__stream/write_buffer_bytes/overload1.html.
+		* @param ioContext				The io context processing this session, which may be shared with other sessions (see IoContextPool).
+		*								nullptr (default) means that the session owns an io context, run by run().
 		*/
 		FETPAPI_DLL_IMPORT_OR_EXPORT PlainClientSession(
 			InitializationParameters* initializationParams, const std::string & target, const std::string & authorization,
-			const std::map<std::string, std::string>& additionalHandshakeHeaderFields = {}, std::size_t frameSize = 4096);
+			const std::map<std::string, std::string>& additionalHandshakeHeaderFields = {}, std::size_t frameSize = 4096,
+			std::shared_ptr<boost::asio::io_context> ioContext = nullptr);
 
 		virtual ~PlainClientSession() = default;
 
@@ -43,6 +48,8 @@ namespace ETP_NS
 		{
 			if (ec) {
 				std::cerr << "on_resolve : " << ec.message() << std::endl;
+				notifyReady(false);
+				return;
 			}
 
 			// Make the connection on the IP address we get from a lookup
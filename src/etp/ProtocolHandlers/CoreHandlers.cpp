@@ -27,24 +27,20 @@ under the License.
 
 using namespace ETP_NS;
 
-void CoreHandlers::decodeMessageBody(const Energistics::Etp::v12::Datatypes::MessageHeader & mh, avro::DecoderPtr d)
-{
-	if (mh.messageType != Energistics::Etp::v12::Protocol::Core::ProtocolException::messageTypeId &&
-		mh.messageType != Energistics::Etp::v12::Protocol::Core::Acknowledge::messageTypeId &&
-		mh.protocol != static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::Core)) {
-		std::cerr << "Error : This message header does not belong to the protocol Core" << std::endl;
-		return;
-	}
-
-	if (mh.messageType == Energistics::Etp::v12::Protocol::Core::RequestSession::messageTypeId) {
+namespace {
+	void decodeRequestSession(ProtocolHandlers& handlers, const Energistics::Etp::v12::Datatypes::MessageHeader& mh, avro::DecoderPtr d)
+	{
 		Energistics::Etp::v12::Protocol::Core::RequestSession rs;
 		avro::decode(*d, rs);
-		session->setEtpSessionClosed(false);
-		on_RequestSession(rs, mh.messageId);
+		handlers.getSession()->setEtpSessionClosed(false);
+		static_cast<CoreHandlers&>(handlers).on_RequestSession(rs, mh.messageId);
 	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Core::OpenSession::messageTypeId) {
+
+	void decodeOpenSession(ProtocolHandlers& handlers, const Energistics::Etp::v12::Datatypes::MessageHeader& mh, avro::DecoderPtr d)
+	{
 		Energistics::Etp::v12::Protocol::Core::OpenSession os;
 		avro::decode(*d, os);
+		AbstractSession* session = handlers.getSession();
 
 		// Check MaxWebSocketMessagePayloadSize capability
 		auto search = os.endpointCapabilities.find("MaxWebSocketMessagePayloadSize");
@@ -58,47 +54,57 @@ void CoreHandlers::decodeMessageBody(const Energistics::Etp::v12::Datatypes::Mes
 		}
 
 		session->setEtpSessionClosed(false);
-		on_OpenSession(os, mh.correlationId);
+		static_cast<CoreHandlers&>(handlers).on_OpenSession(os, mh.correlationId);
 	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Core::CloseSession::messageTypeId) {
+
+	void decodeCloseSession(ProtocolHandlers& handlers, const Energistics::Etp::v12::Datatypes::MessageHeader& mh, avro::DecoderPtr d)
+	{
 		Energistics::Etp::v12::Protocol::Core::CloseSession cs;
 		avro::decode(*d, cs);
-		session->setEtpSessionClosed(true);
-		on_CloseSession(cs, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Core::ProtocolException::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Core::ProtocolException pe;
-		avro::decode(*d, pe);
-		on_ProtocolException(pe, mh.correlationId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Core::Acknowledge::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Core::Acknowledge ack;
-		avro::decode(*d, ack);
-		on_Acknowledge(ack, mh.correlationId);
+		handlers.getSession()->setEtpSessionClosed(true);
+		static_cast<CoreHandlers&>(handlers).on_CloseSession(cs, mh.messageId);
 	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Core::Ping::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Core::Ping ping;
-		avro::decode(*d, ping);
-		on_Ping(ping, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Core::Pong::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Core::Pong pong;
-		avro::decode(*d, pong);
-		on_Pong(pong, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Core::Authorize::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Core::Authorize msg;
-		avro::decode(*d, msg);
-		on_Authorize(msg, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Core::AuthorizeResponse::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Core::AuthorizeResponse msg;
-		avro::decode(*d, msg);
-		on_AuthorizeResponse(msg, mh.messageId);
-	}
-	else {
-		session->send(ETP_NS::EtpHelpers::buildSingleMessageProtocolException(3, "The message type ID " + std::to_string(mh.messageType) + " is invalid for the core protocol."), mh.messageId, 0x02);
+
+	void decodeProtocolException(ProtocolHandlers& handlers, const Energistics::Etp::v12::Datatypes::MessageHeader& mh, avro::DecoderPtr d)
+	{
+		const Energistics::Etp::v12::Protocol::Core::ProtocolException& pe = decodeRecycled<Energistics::Etp::v12::Protocol::Core::ProtocolException>(*d);
+		std::shared_ptr<SessionMetrics> metrics = handlers.getSession()->getMetrics();
+		if (metrics) {
+			if (pe.error) {
+				metrics->recordReceivedProtocolException(pe.error.get().code);
+			}
+			for (const auto& error : pe.errors) {
+				metrics->recordReceivedProtocolException(error.second.code);
+			}
+		}
+		static_cast<CoreHandlers&>(handlers).on_ProtocolException(pe, mh.correlationId);
+		releaseRecycledIfBig<Energistics::Etp::v12::Protocol::Core::ProtocolException>();
+	}
+
+	constexpr MessageDecoderEntry coreEntries[] = {
+		{ Energistics::Etp::v12::Protocol::Core::RequestSession::messageTypeId, &decodeRequestSession },
+		{ Energistics::Etp::v12::Protocol::Core::OpenSession::messageTypeId, &decodeOpenSession },
+		{ Energistics::Etp::v12::Protocol::Core::CloseSession::messageTypeId, &decodeCloseSession },
+		{ Energistics::Etp::v12::Protocol::Core::ProtocolException::messageTypeId, &decodeProtocolException },
+		ETP_MESSAGE_DECODER(CoreHandlers, Core, Acknowledge, correlationId),
+		ETP_MESSAGE_DECODER(CoreHandlers, Core, Ping, messageId),
+		ETP_MESSAGE_DECODER(CoreHandlers, Core, Pong, correlationId),
+		ETP_MESSAGE_DECODER(CoreHandlers, Core, Authorize, messageId),
+		ETP_MESSAGE_DECODER(CoreHandlers, Core, AuthorizeResponse, messageId)
+	};
+	const MessageDecoderTable coreDecoders(coreEntries);
+}
+
+void CoreHandlers::decodeMessageBody(const Energistics::Etp::v12::Datatypes::MessageHeader & mh, avro::DecoderPtr d)
+{
+	if (mh.messageType != Energistics::Etp::v12::Protocol::Core::ProtocolException::messageTypeId &&
+		mh.messageType != Energistics::Etp::v12::Protocol::Core::Acknowledge::messageTypeId &&
+		mh.protocol != static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::Core)) {
+		std::cerr << "Error : This message header does not belong to the protocol Core" << std::endl;
+		return;
 	}
+
+	dispatchMessageBody(coreDecoders, "core", mh, d);
 }
 
 void CoreHandlers::on_RequestSession(const Energistics::Etp::v12::Protocol::Core::RequestSession & rs, int64_t correlationId)
@@ -129,21 +135,14 @@ void CoreHandlers::on_RequestSession(const Energistics::Etp::v12::Protocol::Core
 		return;
 	}
 
+	// The capabilities are shared by all the sessions of the server
+	const std::shared_ptr<const SessionCapabilities> capabilities = serverInitializationParams->getSessionCapabilities();
+
 	// Check requested protocols
-	auto supportedProtocols = serverInitializationParams->makeSupportedProtocols();
 	std::vector<Energistics::Etp::v12::Datatypes::SupportedProtocol> requestedAndSupportedProtocols;
-	for (auto& rp : rs.requestedProtocols) {
-		const auto validatedProtocol = std::find_if(supportedProtocols.begin(), supportedProtocols.end(),
-			[rp](const Energistics::Etp::v12::Datatypes::SupportedProtocol & sp) -> bool {
-				return sp.protocol == rp.protocol &&
-					sp.role == rp.role &&
-					sp.protocolVersion.major == rp.protocolVersion.major &&
-					sp.protocolVersion.minor == rp.protocolVersion.minor &&
-					sp.protocolVersion.patch == rp.protocolVersion.patch &&
-					sp.protocolVersion.revision == rp.protocolVersion.revision;
-			}
-		);
-		if (validatedProtocol != std::end(supportedProtocols)) {
+	for (const auto& rp : rs.requestedProtocols) {
+		const Energistics::Etp::v12::Datatypes::SupportedProtocol* validatedProtocol = capabilities->findProtocol(rp);
+		if (validatedProtocol != nullptr) {
 			requestedAndSupportedProtocols.push_back(*validatedProtocol);
 		}
 	}
@@ -154,22 +153,19 @@ void CoreHandlers::on_RequestSession(const Energistics::Etp::v12::Protocol::Core
 		return;
 	}
 
+	// Build Open Session message
+	Energistics::Etp::v12::Protocol::Core::OpenSession openSession;
+	openSession.applicationName = serverInitializationParams->getApplicationName();
+	openSession.applicationVersion = serverInitializationParams->getApplicationVersion();
+	std::copy(std::begin(session->getIdentifier().data), std::end(session->getIdentifier().data), openSession.sessionId.array.begin());
+	std::copy(std::begin(serverInitializationParams->getInstanceId().data), std::end(serverInitializationParams->getInstanceId().data), openSession.serverInstanceId.array.begin());
+	openSession.supportedFormats.push_back("xml");
+	openSession.supportedProtocols = requestedAndSupportedProtocols;
 	// Check requested dataobjects
-	auto supportedDataobjects = serverInitializationParams->makeSupportedDataObjects();
-	std::vector<Energistics::Etp::v12::Datatypes::SupportedDataObject> requestedAndSupportedDataObjects;
-	for (auto& rd : rs.supportedDataObjects) {
-		const auto validatedDataObject = std::find_if(supportedDataobjects.begin(), supportedDataobjects.end(),
-			[rd](const Energistics::Etp::v12::Datatypes::SupportedDataObject & sd) -> bool {
-				return sd.qualifiedType == rd.qualifiedType;
-			}
-		);
-		if (validatedDataObject != std::end(supportedDataobjects)) {
-			requestedAndSupportedDataObjects.push_back(*validatedDataObject);
-		}
-	}
+	openSession.supportedDataObjects = capabilities->matchDataObjects(rs.supportedDataObjects);
+	openSession.endpointCapabilities = capabilities->getEndpointCapabilities();
 
 	// Check MaxWebSocketMessagePayloadSize endpoint capability
-	auto supportedEndPointCaps = serverInitializationParams->makeEndpointCapabilities();
 	const auto requestedMaxWebSocketMessagePayloadSizeIt = rs.endpointCapabilities.find("MaxWebSocketMessagePayloadSize");
 	if (requestedMaxWebSocketMessagePayloadSizeIt != rs.endpointCapabilities.end() && requestedMaxWebSocketMessagePayloadSizeIt->second.item.idx() == 3) {
 		const int64_t requestedMaxWebSocketMessagePayloadSize = requestedMaxWebSocketMessagePayloadSizeIt->second.item.get_long();
@@ -178,60 +174,50 @@ void CoreHandlers::on_RequestSession(const Energistics::Etp::v12::Protocol::Core
 
 			Energistics::Etp::v12::Datatypes::DataValue value;
 			value.item.set_long(requestedMaxWebSocketMessagePayloadSize);
-			supportedEndPointCaps["MaxWebSocketFramePayloadSize"] = value;
-			supportedEndPointCaps["MaxWebSocketMessagePayloadSize"] = value;
+			openSession.endpointCapabilities["MaxWebSocketFramePayloadSize"] = value;
+			openSession.endpointCapabilities["MaxWebSocketMessagePayloadSize"] = value;
 		}
 	}
 
-	// Build Open Session message
-	Energistics::Etp::v12::Protocol::Core::OpenSession openSession;
-	openSession.applicationName = serverInitializationParams->getApplicationName();
-	openSession.applicationVersion = serverInitializationParams->getApplicationVersion();
-	std::copy(std::begin(session->getIdentifier().data), std::end(session->getIdentifier().data), openSession.sessionId.array.begin());
-	std::copy(std::begin(serverInitializationParams->getInstanceId().data), std::end(serverInitializationParams->getInstanceId().data), openSession.serverInstanceId.array.begin());
-	openSession.supportedFormats.push_back("xml");
-	openSession.supportedProtocols = requestedAndSupportedProtocols;
-	openSession.endpointCapabilities = supportedEndPointCaps;
-	openSession.supportedDataObjects = requestedAndSupportedDataObjects;
 	openSession.currentDateTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 
 	session->send(openSession, correlationId, 0x02);
 
-	session->fesapi_log("A new websocket session", session->getIdentifier(), "has been opened by a client");
+	FETPAPI_LOG(session, Info, "A new websocket session", session->getIdentifier(), "has been opened by a client");
 }
 
 void CoreHandlers::on_OpenSession(const Energistics::Etp::v12::Protocol::Core::OpenSession &, int64_t)
 {
-	session->fesapi_log("The session has been opened with the default core protocol handlers.");
+	FETPAPI_LOG(session, Info, "The session has been opened with the default core protocol handlers.");
 }
 
 void CoreHandlers::on_CloseSession(const Energistics::Etp::v12::Protocol::Core::CloseSession &, int64_t)
 {
-	session->fesapi_log("Close session after receiving ETP message to close session.");
+	FETPAPI_LOG(session, Info, "Close session after receiving ETP message to close session.");
 	session->do_close();
 }
 
 void CoreHandlers::on_ProtocolException(const Energistics::Etp::v12::Protocol::Core::ProtocolException & pe, int64_t correlationId)
 {
-	session->fesapi_log("EXCEPTION received for message_id", correlationId);
+	FETPAPI_LOG(session, Warning, "EXCEPTION received for message_id", correlationId);
 	if (pe.error) {
-		session->fesapi_log("Single error code", pe.error.get().code, ":", pe.error.get().message);
+		FETPAPI_LOG(session, Warning, "Single error code", pe.error.get().code, ":", pe.error.get().message);
 	}
 	else {
-		session->fesapi_log("One or more error code :");
+		FETPAPI_LOG(session, Warning, "One or more error code :");
 		for (const auto& error : pe.errors) {
-			session->fesapi_log("*************************************************");
-			session->fesapi_log("Resource non received :");
-			session->fesapi_log("key :", error.first);
-			session->fesapi_log("message :", error.second.message);
-			session->fesapi_log("code :", error.second.code);
+			FETPAPI_LOG(session, Warning, "*************************************************");
+			FETPAPI_LOG(session, Warning, "Resource non received :");
+			FETPAPI_LOG(session, Warning, "key :", error.first);
+			FETPAPI_LOG(session, Warning, "message :", error.second.message);
+			FETPAPI_LOG(session, Warning, "code :", error.second.code);
 		}
 	}
 }
 
 void CoreHandlers::on_Acknowledge(const Energistics::Etp::v12::Protocol::Core::Acknowledge &, int64_t correlationId)
 {
-	session->fesapi_log("Acknowledge message_id", std::to_string(correlationId));
+	FETPAPI_LOG(session, Debug, "Acknowledge message_id", std::to_string(correlationId));
 }
 
 void CoreHandlers::on_Ping(const Energistics::Etp::v12::Protocol::Core::Ping &, int64_t correlationId)
@@ -244,7 +230,7 @@ void CoreHandlers::on_Ping(const Energistics::Etp::v12::Protocol::Core::Ping &,
 
 void CoreHandlers::on_Pong(const Energistics::Etp::v12::Protocol::Core::Pong & pong, int64_t correlationId)
 {
-	session->fesapi_log("Received Pong at", std::to_string(pong.currentDateTime), "with message id", std::to_string(correlationId));
+	FETPAPI_LOG(session, Debug, "Received Pong at", std::to_string(pong.currentDateTime), "answering the ping", std::to_string(correlationId));
 }
 
 void CoreHandlers::on_Authorize(const Energistics::Etp::v12::Protocol::Core::Authorize &, int64_t correlationId)
@@ -254,5 +240,5 @@ void CoreHandlers::on_Authorize(const Energistics::Etp::v12::Protocol::Core::Aut
 
 void CoreHandlers::on_AuthorizeResponse(const Energistics::Etp::v12::Protocol::Core::AuthorizeResponse &, int64_t)
 {
-	session->fesapi_log("Renewed token");
+	FETPAPI_LOG(session, Debug, "Renewed token");
 }
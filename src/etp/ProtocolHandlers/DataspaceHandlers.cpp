@@ -23,6 +23,18 @@ under the License.
 
 using namespace ETP_NS;
 
+namespace {
+	constexpr MessageDecoderEntry dataspaceEntries[] = {
+		ETP_MESSAGE_DECODER(DataspaceHandlers, Dataspace, GetDataspaces, messageId),
+		ETP_MESSAGE_DECODER(DataspaceHandlers, Dataspace, GetDataspacesResponse, correlationId),
+		ETP_MESSAGE_DECODER(DataspaceHandlers, Dataspace, PutDataspaces, messageId),
+		ETP_MESSAGE_DECODER(DataspaceHandlers, Dataspace, PutDataspacesResponse, messageId),
+		ETP_MESSAGE_DECODER(DataspaceHandlers, Dataspace, DeleteDataspaces, messageId),
+		ETP_MESSAGE_DECODER(DataspaceHandlers, Dataspace, DeleteDataspacesResponse, messageId)
+	};
+	const MessageDecoderTable dataspaceDecoders(dataspaceEntries);
+}
+
 void DataspaceHandlers::decodeMessageBody(const Energistics::Etp::v12::Datatypes::MessageHeader& mh, avro::DecoderPtr d)
 {
 	if (mh.protocol != static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::Dataspace)) {
@@ -30,39 +42,7 @@ void DataspaceHandlers::decodeMessageBody(const Energistics::Etp::v12::Datatypes
 		return;
 	}
 
-	if (mh.messageType == Energistics::Etp::v12::Protocol::Dataspace::GetDataspaces::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Dataspace::GetDataspaces getO;
-		avro::decode(*d, getO);
-		on_GetDataspaces(getO, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Dataspace::GetDataspacesResponse::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Dataspace::GetDataspacesResponse obj;
-		avro::decode(*d, obj);
-		on_GetDataspacesResponse(obj, mh.correlationId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Dataspace::PutDataspaces::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Dataspace::PutDataspaces putO;
-		avro::decode(*d, putO);
-		on_PutDataspaces(putO, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Dataspace::PutDataspacesResponse::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Dataspace::PutDataspacesResponse msg;
-		avro::decode(*d, msg);
-		on_PutDataspacesResponse(msg, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Dataspace::DeleteDataspaces::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Dataspace::DeleteDataspaces deleteO;
-		avro::decode(*d, deleteO);
-		on_DeleteDataspaces(deleteO, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Dataspace::DeleteDataspacesResponse::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Dataspace::DeleteDataspacesResponse msg;
-		avro::decode(*d, msg);
-		on_DeleteDataspacesResponse(msg, mh.messageId);
-	}
-	else {
-		session->send(ETP_NS::EtpHelpers::buildSingleMessageProtocolException(3, "The message type ID " + std::to_string(mh.messageType) + " is invalid for the Dataspace protocol."), mh.messageId, 0x02);
-	}
+	dispatchMessageBody(dataspaceDecoders, "Dataspace", mh, d);
 }
 
 void DataspaceHandlers::on_GetDataspaces(const Energistics::Etp::v12::Protocol::Dataspace::GetDataspaces&, int64_t correlationId)
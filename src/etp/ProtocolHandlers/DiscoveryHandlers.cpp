@@ -23,40 +23,25 @@ under the License.
 
 using namespace ETP_NS;
 
-void DiscoveryHandlers::decodeMessageBody(const Energistics::Etp::v12::Datatypes::MessageHeader & mh, avro::DecoderPtr d)
+namespace {
+	constexpr MessageDecoderEntry discoveryEntries[] = {
+		ETP_MESSAGE_DECODER(DiscoveryHandlers, Discovery, GetResources, messageId),
+		ETP_MESSAGE_DECODER(DiscoveryHandlers, Discovery, GetResourcesResponse, correlationId),
+		ETP_MESSAGE_DECODER(DiscoveryHandlers, Discovery, GetResourcesEdgesResponse, correlationId),
+		ETP_MESSAGE_DECODER(DiscoveryHandlers, Discovery, GetDeletedResources, messageId),
+		ETP_MESSAGE_DECODER(DiscoveryHandlers, Discovery, GetDeletedResourcesResponse, correlationId)
+	};
+	const MessageDecoderTable discoveryDecoders(discoveryEntries);
+}
+
+void DiscoveryHandlers::decodeMessageBody(const Energistics::Etp::v12::Datatypes::MessageHeader& mh, avro::DecoderPtr d)
 {
 	if (mh.protocol != static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::Discovery)) {
 		std::cerr << "Error : This message header does not belong to the protocol Discovery" << std::endl;
 		return;
 	}
-	if (mh.messageType == Energistics::Etp::v12::Protocol::Discovery::GetResources::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Discovery::GetResources msg;
-		avro::decode(*d, msg);
-		on_GetResources(msg, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Discovery::GetResourcesResponse::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Discovery::GetResourcesResponse msg;
-		avro::decode(*d, msg);
-		on_GetResourcesResponse(msg, mh.correlationId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Discovery::GetResourcesEdgesResponse::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Discovery::GetResourcesEdgesResponse msg;
-		avro::decode(*d, msg);
-		on_GetResourcesEdgesResponse(msg, mh.correlationId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Discovery::GetDeletedResources::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Discovery::GetDeletedResources msg;
-		avro::decode(*d, msg);
-		on_GetDeletedResources(msg, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Discovery::GetDeletedResourcesResponse::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Discovery::GetDeletedResourcesResponse msg;
-		avro::decode(*d, msg);
-		on_GetDeletedResourcesResponse(msg, mh.correlationId);
-	}
-	else {
-		session->send(ETP_NS::EtpHelpers::buildSingleMessageProtocolException(3, "The message type ID " + std::to_string(mh.messageType) + " is invalid for the discovery protocol."), mh.messageId, 0x02);
-	}
+
+	dispatchMessageBody(discoveryDecoders, "discovery", mh, d);
 }
 
 void DiscoveryHandlers::on_GetResources(const Energistics::Etp::v12::Protocol::Discovery::GetResources &, int64_t correlationId)
@@ -72,7 +57,7 @@ void DiscoveryHandlers::on_GetResourcesResponse(const Energistics::Etp::v12::Pro
 void DiscoveryHandlers::on_GetResourcesEdgesResponse(const Energistics::Etp::v12::Protocol::Discovery::GetResourcesEdgesResponse & msg, int64_t)
 {
 	for (const auto& edge : msg.edges) {
-		session->fesapi_log("DISCOVERED EDGE (", edge.sourceUri, "->", edge.targetUri, ")");
+		FETPAPI_LOG(session, Debug, "DISCOVERED EDGE (", edge.sourceUri, "->", edge.targetUri, ")");
 	}
 }
 
@@ -25,6 +25,21 @@ under the License.
 
 using namespace ETP_NS;
 
+namespace {
+	/// The byte count of the message whose body is decoded on the current thread
+	thread_local size_t decodedMessageByteCount = 0;
+}
+
+void ETP_NS::setDecodedMessageByteCount(size_t byteCount)
+{
+	decodedMessageByteCount = byteCount;
+}
+
+size_t ETP_NS::getDecodedMessageByteCount()
+{
+	return decodedMessageByteCount;
+}
+
 void ProtocolHandlers::printDataObject(const Energistics::Etp::v12::Datatypes::Object::DataObject & dataObject)
 {
 	std::cout << "uri : " << dataObject.resource.uri << std::endl;
@@ -57,3 +72,15 @@ void ProtocolHandlers::printDataObject(const Energistics::Etp::v12::Datatypes::O
 	std::cout << dataObject.data << std::endl;
 	std::cout << "*************************************************" << std::endl;
 }
+
+void ProtocolHandlers::dispatchMessageBody(const MessageDecoderTable& decoders, const std::string& protocolName,
+	const Energistics::Etp::v12::Datatypes::MessageHeader& mh, avro::DecoderPtr d)
+{
+	MessageBodyDecoder decoder = decoders.find(mh.messageType);
+	if (decoder != nullptr) {
+		decoder(*this, mh, d);
+	}
+	else {
+		session->send(ETP_NS::EtpHelpers::buildSingleMessageProtocolException(3, "The message type ID " + std::to_string(mh.messageType) + " is invalid for the " + protocolName + " protocol."), mh.messageId, 0x02);
+	}
+}
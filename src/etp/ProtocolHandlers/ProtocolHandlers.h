@@ -35,9 +35,118 @@ under the License.
 	#define FETPAPI_DLL_IMPORT_OR_EXPORT
 #endif
 
+/**
+* Builds a MessageDecoderEntry which decodes a message of a protocol and forwards it to the on_<message> method of some handlers
+* with either the messageId or the correlationId of the received message header.
+* Example : ETP_MESSAGE_DECODER(StoreHandlers, Store, GetDataObjects, messageId)
+*/
+#define ETP_MESSAGE_DECODER(HANDLERS, PROTOCOL, MESSAGE, FORWARDED_ID) \
+	{ Energistics::Etp::v12::Protocol::PROTOCOL::MESSAGE::messageTypeId, \
+	&ETP_NS::decodeAndForward<Energistics::Etp::v12::Protocol::PROTOCOL::MESSAGE, HANDLERS, &HANDLERS::on_##MESSAGE, &Energistics::Etp::v12::Datatypes::MessageHeader::FORWARDED_ID> }
+
 namespace ETP_NS
 {
 	class AbstractSession;
+	class ProtocolHandlers;
+
+	/**
+	* Decodes a message body and calls the appropriate method of some protocol handlers.
+	*/
+	typedef void (*MessageBodyDecoder)(ProtocolHandlers& handlers, const Energistics::Etp::v12::Datatypes::MessageHeader& mh, avro::DecoderPtr d);
+
+	/**
+	* Associates a message type to its decoder.
+	*/
+	struct MessageDecoderEntry {
+		int32_t messageTypeId;
+		MessageBodyDecoder decoder;
+	};
+
+	/**
+	* The byte count of a received message above which the memory of its decoded body is not kept for the next messages of the same type.
+	*/
+	const size_t maxRecycledMessageByteCount = 1048576;
+
+	/**
+	* Set the byte count of the message whose body is going to be decoded on the current thread.
+	* The session calls it before processing each message body.
+	*/
+	FETPAPI_DLL_IMPORT_OR_EXPORT void setDecodedMessageByteCount(size_t byteCount);
+	FETPAPI_DLL_IMPORT_OR_EXPORT size_t getDecodedMessageByteCount();
+
+	/**
+	* @return The instance of a message type which is recycled on the current thread.
+	*/
+	template<typename T> T& getRecycledMessage()
+	{
+		static thread_local T msg;
+		return msg;
+	}
+
+	/**
+	* Decodes a message body into an instance which is recycled for all messages of the same type decoded on the same thread.
+	* The containers of the recycled instance keep the memory they allocated for the previous messages,
+	* which saves most of the allocations of the top level vectors and strings on sessions receiving many messages of the same type.
+	* The returned reference is only valid until the next message of the same type is decoded on the same thread.
+	* Call releaseRecycledIfBig once the message has been processed.
+	*/
+	template<typename T> const T& decodeRecycled(avro::Decoder& d)
+	{
+		T& msg = getRecycledMessage<T>();
+		avro::decode(d, msg);
+		return msg;
+	}
+
+	/**
+	* Release the memory of the recycled instance of a message type if the message it has just decoded is bigger than maxRecycledMessageByteCount :
+	* each thread would otherwise keep the biggest message it has ever received of each type.
+	*/
+	template<typename T> void releaseRecycledIfBig()
+	{
+		if (getDecodedMessageByteCount() > maxRecycledMessageByteCount) {
+			getRecycledMessage<T>() = T();
+		}
+	}
+
+	/**
+	* Decodes a message body of type T and forwards it to a callback of some handlers of type H
+	* with one of the id (messageId or correlationId) of the received message header.
+	*/
+	template<typename T, typename H, void (H::*callback)(const T&, int64_t), int64_t Energistics::Etp::v12::Datatypes::MessageHeader::*forwardedId>
+	void decodeAndForward(ProtocolHandlers& handlers, const Energistics::Etp::v12::Datatypes::MessageHeader& mh, avro::DecoderPtr d)
+	{
+		(static_cast<H&>(handlers).*callback)(decodeRecycled<T>(*d), mh.*forwardedId);
+		releaseRecycledIfBig<T>();
+	}
+
+	/**
+	* A table giving in constant time the decoder of a message type of a protocol.
+	*/
+	class MessageDecoderTable
+	{
+	public:
+		template<size_t N> MessageDecoderTable(const MessageDecoderEntry(&entries)[N]) {
+			for (size_t i = 0; i < N; ++i) {
+				if (decoders.size() <= static_cast<size_t>(entries[i].messageTypeId)) {
+					decoders.resize(entries[i].messageTypeId + 1, nullptr);
+				}
+				decoders[entries[i].messageTypeId] = entries[i].decoder;
+			}
+		}
+
+		/**
+		* @return The decoder of a message type or nullptr if the message type is unknown.
+		*/
+		MessageBodyDecoder find(int32_t messageTypeId) const {
+			return messageTypeId >= 0 && static_cast<size_t>(messageTypeId) < decoders.size()
+				? decoders[messageTypeId]
+				: nullptr;
+		}
+
+	private:
+		/// The decoders indexed by the message type id.
+		std::vector<MessageBodyDecoder> decoders;
+	};
 
 	class FETPAPI_DLL_IMPORT_OR_EXPORT ProtocolHandlers : public std::enable_shared_from_this<ProtocolHandlers>
 	{
@@ -48,6 +157,16 @@ namespace ETP_NS
 
 		void printDataObject(const Energistics::Etp::v12::Datatypes::Object::DataObject & dataObject);
 
+		/**
+		* Decodes a message body with the decoder found in a table for the message type of the message header.
+		* Sends back a ProtocolException if the message type is not in the table.
+		*
+		* @param decoders		The decoders of the protocol
+		* @param protocolName	The name of the protocol to use in the error message
+		*/
+		void dispatchMessageBody(const MessageDecoderTable& decoders, const std::string& protocolName,
+			const Energistics::Etp::v12::Datatypes::MessageHeader& mh, avro::DecoderPtr d);
+
 	public:
 		virtual ~ProtocolHandlers() = default;
 
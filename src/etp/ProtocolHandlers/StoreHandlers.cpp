@@ -23,6 +23,19 @@ under the License.
 
 using namespace ETP_NS;
 
+namespace {
+	constexpr MessageDecoderEntry storeEntries[] = {
+		ETP_MESSAGE_DECODER(StoreHandlers, Store, GetDataObjects, messageId),
+		ETP_MESSAGE_DECODER(StoreHandlers, Store, GetDataObjectsResponse, correlationId),
+		ETP_MESSAGE_DECODER(StoreHandlers, Store, PutDataObjects, messageId),
+		ETP_MESSAGE_DECODER(StoreHandlers, Store, PutDataObjectsResponse, correlationId),
+		ETP_MESSAGE_DECODER(StoreHandlers, Store, DeleteDataObjects, messageId),
+		ETP_MESSAGE_DECODER(StoreHandlers, Store, DeleteDataObjectsResponse, correlationId),
+		ETP_MESSAGE_DECODER(StoreHandlers, Store, Chunk, messageId)
+	};
+	const MessageDecoderTable storeDecoders(storeEntries);
+}
+
 void StoreHandlers::decodeMessageBody(const Energistics::Etp::v12::Datatypes::MessageHeader& mh, avro::DecoderPtr d)
 {
 	if (mh.protocol != static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::Store)) {
@@ -30,44 +43,7 @@ void StoreHandlers::decodeMessageBody(const Energistics::Etp::v12::Datatypes::Me
 		return;
 	}
 
-	if (mh.messageType == Energistics::Etp::v12::Protocol::Store::GetDataObjects::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Store::GetDataObjects getO;
-		avro::decode(*d, getO);
-		on_GetDataObjects(getO, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Store::GetDataObjectsResponse::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Store::GetDataObjectsResponse obj;
-		avro::decode(*d, obj);
-		on_GetDataObjectsResponse(obj, mh.correlationId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Store::PutDataObjects::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Store::PutDataObjects putO;
-		avro::decode(*d, putO);
-		on_PutDataObjects(putO, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Store::PutDataObjectsResponse::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Store::PutDataObjectsResponse msg;
-		avro::decode(*d, msg);
-		on_PutDataObjectsResponse(msg, mh.correlationId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Store::DeleteDataObjects::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Store::DeleteDataObjects deleteO;
-		avro::decode(*d, deleteO);
-		on_DeleteDataObjects(deleteO, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Store::DeleteDataObjectsResponse::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Store::DeleteDataObjectsResponse msg;
-		avro::decode(*d, msg);
-		on_DeleteDataObjectsResponse(msg, mh.correlationId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Store::Chunk::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Store::Chunk msg;
-		avro::decode(*d, msg);
-		on_Chunk(msg, mh.messageId);
-	}
-	else {
-		session->send(ETP_NS::EtpHelpers::buildSingleMessageProtocolException(3, "The message type ID " + std::to_string(mh.messageType) + " is invalid for the store protocol."), mh.messageId, 0x02);
-	}
+	dispatchMessageBody(storeDecoders, "store", mh, d);
 }
 
 void StoreHandlers::on_GetDataObjects(const Energistics::Etp::v12::Protocol::Store::GetDataObjects&, int64_t correlationId)
@@ -106,5 +82,5 @@ void StoreHandlers::on_DeleteDataObjectsResponse(const Energistics::Etp::v12::Pr
 
 void StoreHandlers::on_Chunk(const Energistics::Etp::v12::Protocol::Store::Chunk&, int64_t)
 {
-	session->fesapi_log("Received Store Chunk");
+	FETPAPI_LOG(session, Debug, "Received Store Chunk");
 }
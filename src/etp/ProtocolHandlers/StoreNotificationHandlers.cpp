@@ -25,6 +25,29 @@ under the License.
 
 using namespace ETP_NS;
 
+namespace {
+	void decodeUnsubscribeNotifications(ProtocolHandlers& handlers, const Energistics::Etp::v12::Datatypes::MessageHeader& mh, avro::DecoderPtr d)
+	{
+		Energistics::Etp::v12::Protocol::StoreNotification::UnsubscribeNotifications msg;
+		avro::decode(*d, msg);
+		static_cast<StoreNotificationHandlers&>(handlers).on_UnsubscribeNotifications(msg, mh.messageId, mh.correlationId);
+	}
+
+	constexpr MessageDecoderEntry storeNotificationEntries[] = {
+		ETP_MESSAGE_DECODER(StoreNotificationHandlers, StoreNotification, SubscribeNotifications, messageId),
+		ETP_MESSAGE_DECODER(StoreNotificationHandlers, StoreNotification, SubscribeNotificationsResponse, messageId),
+		{ Energistics::Etp::v12::Protocol::StoreNotification::UnsubscribeNotifications::messageTypeId, &decodeUnsubscribeNotifications },
+		ETP_MESSAGE_DECODER(StoreNotificationHandlers, StoreNotification, UnsolicitedStoreNotifications, messageId),
+		ETP_MESSAGE_DECODER(StoreNotificationHandlers, StoreNotification, SubscriptionEnded, correlationId),
+		ETP_MESSAGE_DECODER(StoreNotificationHandlers, StoreNotification, ObjectChanged, correlationId),
+		ETP_MESSAGE_DECODER(StoreNotificationHandlers, StoreNotification, ObjectDeleted, correlationId),
+		ETP_MESSAGE_DECODER(StoreNotificationHandlers, StoreNotification, ObjectAccessRevoked, correlationId),
+		ETP_MESSAGE_DECODER(StoreNotificationHandlers, StoreNotification, ObjectActiveStatusChanged, correlationId),
+		ETP_MESSAGE_DECODER(StoreNotificationHandlers, StoreNotification, Chunk, messageId)
+	};
+	const MessageDecoderTable storeNotificationDecoders(storeNotificationEntries);
+}
+
 void StoreNotificationHandlers::decodeMessageBody(const Energistics::Etp::v12::Datatypes::MessageHeader & mh, avro::DecoderPtr d)
 {
 	if (mh.protocol != static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::StoreNotification)) {
@@ -32,76 +55,24 @@ void StoreNotificationHandlers::decodeMessageBody(const Energistics::Etp::v12::D
 		return;
 	}
 
-	if (mh.messageType == Energistics::Etp::v12::Protocol::StoreNotification::SubscribeNotifications::messageTypeId) {
-		Energistics::Etp::v12::Protocol::StoreNotification::SubscribeNotifications msg;
-		avro::decode(*d, msg);
-		on_SubscribeNotifications(msg, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::StoreNotification::SubscribeNotificationsResponse::messageTypeId) {
-		Energistics::Etp::v12::Protocol::StoreNotification::SubscribeNotificationsResponse msg;
-		avro::decode(*d, msg);
-		on_SubscribeNotificationsResponse(msg, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::StoreNotification::UnsubscribeNotifications::messageTypeId) {
-		Energistics::Etp::v12::Protocol::StoreNotification::UnsubscribeNotifications msg;
-		avro::decode(*d, msg);
-		on_UnsubscribeNotifications(msg, mh.messageId, mh.correlationId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::StoreNotification::UnsolicitedStoreNotifications::messageTypeId) {
-		Energistics::Etp::v12::Protocol::StoreNotification::UnsolicitedStoreNotifications msg;
-		avro::decode(*d, msg);
-		on_UnsolicitedStoreNotifications(msg, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::StoreNotification::SubscriptionEnded::messageTypeId) {
-		Energistics::Etp::v12::Protocol::StoreNotification::SubscriptionEnded msg;
-		avro::decode(*d, msg);
-		on_SubscriptionEnded(msg, mh.correlationId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::StoreNotification::ObjectChanged::messageTypeId) {
-		Energistics::Etp::v12::Protocol::StoreNotification::ObjectChanged msg;
-		avro::decode(*d, msg);
-		on_ObjectChanged(msg, mh.correlationId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::StoreNotification::ObjectDeleted::messageTypeId) {
-		Energistics::Etp::v12::Protocol::StoreNotification::ObjectDeleted msg;
-		avro::decode(*d, msg);
-		on_ObjectDeleted(msg, mh.correlationId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::StoreNotification::ObjectAccessRevoked::messageTypeId) {
-		Energistics::Etp::v12::Protocol::StoreNotification::ObjectAccessRevoked msg;
-		avro::decode(*d, msg);
-		on_ObjectAccessRevoked(msg, mh.correlationId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::StoreNotification::ObjectActiveStatusChanged::messageTypeId) {
-		Energistics::Etp::v12::Protocol::StoreNotification::ObjectActiveStatusChanged msg;
-		avro::decode(*d, msg);
-		on_ObjectActiveStatusChanged(msg, mh.correlationId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::StoreNotification::Chunk::messageTypeId) {
-		Energistics::Etp::v12::Protocol::StoreNotification::Chunk msg;
-		avro::decode(*d, msg);
-		on_Chunk(msg, mh.messageId);
-	}
-	else {
-		session->send(ETP_NS::EtpHelpers::buildSingleMessageProtocolException(3, "The message type ID " + std::to_string(mh.messageType) + " is invalid for the store notification protocol."), mh.messageId, 0x02);
-	}
+	dispatchMessageBody(storeNotificationDecoders, "store notification", mh, d);
 }
 
 void StoreNotificationHandlers::on_SubscribeNotifications(const Energistics::Etp::v12::Protocol::StoreNotification::SubscribeNotifications &, int64_t)
 {
-	session->fesapi_log("on_SubscribeNotifications");
+	FETPAPI_LOG(session, Debug, "on_SubscribeNotifications");
 
 	session->send(ETP_NS::EtpHelpers::buildSingleMessageProtocolException(7, "The StoreHandlers::on_SubscribeNotifications method has not been overriden by the agent."), 0x02);
 }
 
 void StoreNotificationHandlers::on_SubscribeNotificationsResponse(const Energistics::Etp::v12::Protocol::StoreNotification::SubscribeNotificationsResponse&, int64_t)
 {
-	session->fesapi_log("Received SubscribeNotificationsResponse");
+	FETPAPI_LOG(session, Debug, "Received SubscribeNotificationsResponse");
 }
 
 void StoreNotificationHandlers::on_UnsubscribeNotifications(const Energistics::Etp::v12::Protocol::StoreNotification::UnsubscribeNotifications & msg, int64_t messageId, int64_t)
 {
-	session->fesapi_log("on_UnsubscribeNotifications");
+	FETPAPI_LOG(session, Debug, "on_UnsubscribeNotifications");
 
 	int64_t toRemove = (std::numeric_limits<int64_t>::max)();
 	for (const auto& pair : session->subscriptions) {
@@ -121,48 +92,48 @@ void StoreNotificationHandlers::on_UnsubscribeNotifications(const Energistics::E
 
 void StoreNotificationHandlers::on_UnsolicitedStoreNotifications(const Energistics::Etp::v12::Protocol::StoreNotification::UnsolicitedStoreNotifications &, int64_t)
 {
-	session->fesapi_log("Received UnsolicitedStoreNotifications");
+	FETPAPI_LOG(session, Debug, "Received UnsolicitedStoreNotifications");
 }
 
 void StoreNotificationHandlers::on_SubscriptionEnded(const Energistics::Etp::v12::Protocol::StoreNotification::SubscriptionEnded &, int64_t)
 {
-	session->fesapi_log("Received SubscriptionEnded ");
+	FETPAPI_LOG(session, Debug, "Received SubscriptionEnded ");
 }
 
 void StoreNotificationHandlers::on_ObjectChanged(const Energistics::Etp::v12::Protocol::StoreNotification::ObjectChanged & msg, int64_t)
 {
 	switch (msg.change.changeKind) {
-	case Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::authorized: session->fesapi_log("authorized"); break;
-	case Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::insert: session->fesapi_log("insert"); break;
-	case Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::update: session->fesapi_log("update"); break;
-	case Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::joined: session->fesapi_log("joined"); break;
-	case Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::unjoined: session->fesapi_log("unjoined"); break;
-	case Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::joinedSubscription: session->fesapi_log("joinedSubscription"); break;
-	case Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::unjoinedSubscription: session->fesapi_log("unjoinedSubscription"); break;
+	case Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::authorized: FETPAPI_LOG(session, Debug, "authorized"); break;
+	case Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::insert: FETPAPI_LOG(session, Debug, "insert"); break;
+	case Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::update: FETPAPI_LOG(session, Debug, "update"); break;
+	case Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::joined: FETPAPI_LOG(session, Debug, "joined"); break;
+	case Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::unjoined: FETPAPI_LOG(session, Debug, "unjoined"); break;
+	case Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::joinedSubscription: FETPAPI_LOG(session, Debug, "joinedSubscription"); break;
+	case Energistics::Etp::v12::Datatypes::Object::ObjectChangeKind::unjoinedSubscription: FETPAPI_LOG(session, Debug, "unjoinedSubscription"); break;
 	}
 
 	auto duration = std::chrono::microseconds(msg.change.changeTime);
-	session->fesapi_log("on", date::format("%FT%TZ", date::floor<std::chrono::microseconds>(duration)));
+	FETPAPI_LOG(session, Debug, "on", date::format("%FT%TZ", date::floor<std::chrono::microseconds>(duration)));
 
 	printDataObject(msg.change.dataObject);
 }
 
 void StoreNotificationHandlers::on_ObjectDeleted(const Energistics::Etp::v12::Protocol::StoreNotification::ObjectDeleted &, int64_t)
 {
-	session->fesapi_log("on_ObjectDeleted");
+	FETPAPI_LOG(session, Debug, "on_ObjectDeleted");
 }
 
 void StoreNotificationHandlers::on_ObjectAccessRevoked(const Energistics::Etp::v12::Protocol::StoreNotification::ObjectAccessRevoked &, int64_t)
 {
-	session->fesapi_log("on_ObjectAccessRevoked");
+	FETPAPI_LOG(session, Debug, "on_ObjectAccessRevoked");
 }
 
 void StoreNotificationHandlers::on_ObjectActiveStatusChanged(const Energistics::Etp::v12::Protocol::StoreNotification::ObjectActiveStatusChanged&, int64_t)
 {
-	session->fesapi_log("Received ObjectActiveStatusChanged");
+	FETPAPI_LOG(session, Debug, "Received ObjectActiveStatusChanged");
 }
 
 void StoreNotificationHandlers::on_Chunk(const Energistics::Etp::v12::Protocol::StoreNotification::Chunk&, int64_t)
 {
-	session->fesapi_log("Received StoreNotification Chunk");
+	FETPAPI_LOG(session, Debug, "Received StoreNotification Chunk");
 }
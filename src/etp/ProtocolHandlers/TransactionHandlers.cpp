@@ -23,6 +23,18 @@ under the License.
 
 using namespace ETP_NS;
 
+namespace {
+	constexpr MessageDecoderEntry transactionEntries[] = {
+		ETP_MESSAGE_DECODER(TransactionHandlers, Transaction, StartTransaction, messageId),
+		ETP_MESSAGE_DECODER(TransactionHandlers, Transaction, StartTransactionResponse, correlationId),
+		ETP_MESSAGE_DECODER(TransactionHandlers, Transaction, CommitTransaction, messageId),
+		ETP_MESSAGE_DECODER(TransactionHandlers, Transaction, CommitTransactionResponse, messageId),
+		ETP_MESSAGE_DECODER(TransactionHandlers, Transaction, RollbackTransaction, messageId),
+		ETP_MESSAGE_DECODER(TransactionHandlers, Transaction, RollbackTransactionResponse, messageId)
+	};
+	const MessageDecoderTable transactionDecoders(transactionEntries);
+}
+
 void TransactionHandlers::decodeMessageBody(const Energistics::Etp::v12::Datatypes::MessageHeader& mh, avro::DecoderPtr d)
 {
 	if (mh.protocol != static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::Transaction)) {
@@ -30,39 +42,7 @@ void TransactionHandlers::decodeMessageBody(const Energistics::Etp::v12::Datatyp
 		return;
 	}
 
-	if (mh.messageType == Energistics::Etp::v12::Protocol::Transaction::StartTransaction::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Transaction::StartTransaction getO;
-		avro::decode(*d, getO);
-		on_StartTransaction(getO, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Transaction::StartTransactionResponse::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Transaction::StartTransactionResponse obj;
-		avro::decode(*d, obj);
-		on_StartTransactionResponse(obj, mh.correlationId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Transaction::CommitTransaction::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Transaction::CommitTransaction putO;
-		avro::decode(*d, putO);
-		on_CommitTransaction(putO, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Transaction::CommitTransactionResponse::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Transaction::CommitTransactionResponse msg;
-		avro::decode(*d, msg);
-		on_CommitTransactionResponse(msg, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Transaction::RollbackTransaction::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Transaction::RollbackTransaction deleteO;
-		avro::decode(*d, deleteO);
-		on_RollbackTransaction(deleteO, mh.messageId);
-	}
-	else if (mh.messageType == Energistics::Etp::v12::Protocol::Transaction::RollbackTransactionResponse::messageTypeId) {
-		Energistics::Etp::v12::Protocol::Transaction::RollbackTransactionResponse msg;
-		avro::decode(*d, msg);
-		on_RollbackTransactionResponse(msg, mh.messageId);
-	}
-	else {
-		session->send(ETP_NS::EtpHelpers::buildSingleMessageProtocolException(3, "The message type ID " + std::to_string(mh.messageType) + " is invalid for the Transaction protocol."), mh.messageId, 0x02);
-	}
+	dispatchMessageBody(transactionDecoders, "Transaction", mh, d);
 }
 
 void TransactionHandlers::on_StartTransaction(const Energistics::Etp::v12::Protocol::Transaction::StartTransaction&, int64_t correlationId)
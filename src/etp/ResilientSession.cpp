@@ -0,0 +1,318 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "ResilientSession.h"
+
+#include <stdexcept>
+
+using namespace ETP_NS;
+
+namespace {
+	/// How often the supervisor checks the session when nothing wakes it up
+	const std::chrono::milliseconds supervisionPeriod(20);
+	/// How long a session must have stayed opened, unless it has answered a request, for its failure to restart the backoff from the beginning.
+	const std::chrono::milliseconds stableSessionDuration(10000);
+
+	bool isSameUuid(const Energistics::Etp::v12::Datatypes::Uuid& a, const Energistics::Etp::v12::Datatypes::Uuid& b)
+	{
+		return std::equal(a.array.begin(), a.array.end(), b.array.begin());
+	}
+}
+
+ResilientSession::ResilientSession(SessionPool::SessionOpener opener, unsigned int maxOpeningAttempts,
+	std::chrono::milliseconds initialBackoff, std::chrono::milliseconds maxBackoff) :
+	opener(opener), maxOpeningAttempts(maxOpeningAttempts), initialBackoff(initialBackoff), maxBackoff(maxBackoff),
+	answerSignal(std::make_shared<AnswerSignal>())
+{
+	if (maxOpeningAttempts == 0) {
+		throw std::invalid_argument("A resilient session needs at least one opening attempt.");
+	}
+	{
+		const std::lock_guard<std::mutex> lock(mutex);
+		failureCount = 1;
+		retryTime = Clock::now() + initialBackoff;
+		open();
+	}
+	supervisor = std::thread(&ResilientSession::supervise, this);
+}
+
+ResilientSession::~ResilientSession()
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	condition.notify_all();
+	supervisor.join();
+
+	if (session != nullptr && !session->isWebSocketSessionClosed()) {
+		session->close();
+	}
+}
+
+std::shared_ptr<AbstractSession> ResilientSession::getSession() const
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	return session;
+}
+
+bool ResilientSession::isOpened() const
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	return state->load() == Opened && session == resumedSession && !session->isEtpSessionClosed();
+}
+
+void ResilientSession::waitForOpening()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	if (!condition.wait_for(lock, std::chrono::duration<double, std::milli>(_timeOut.load()),
+		[this] { return givenUp || (state->load() == Opened && session == resumedSession && !session->isEtpSessionClosed()); })) {
+		throw std::runtime_error("Time out waiting for the opening of a session.");
+	}
+	if (givenUp) {
+		throw std::runtime_error("No session can be opened anymore.");
+	}
+}
+
+bool ResilientSession::isReplayable(int32_t protocolId, int32_t messageTypeId)
+{
+	const int64_t key = (static_cast<int64_t>(protocolId) << 32) | static_cast<uint32_t>(messageTypeId);
+	switch (key) {
+	case (static_cast<int64_t>(Energistics::Etp::v12::Protocol::Discovery::GetResources::protocolId) << 32) | Energistics::Etp::v12::Protocol::Discovery::GetResources::messageTypeId:
+	case (static_cast<int64_t>(Energistics::Etp::v12::Protocol::Discovery::GetDeletedResources::protocolId) << 32) | Energistics::Etp::v12::Protocol::Discovery::GetDeletedResources::messageTypeId:
+	case (static_cast<int64_t>(Energistics::Etp::v12::Protocol::Store::GetDataObjects::protocolId) << 32) | Energistics::Etp::v12::Protocol::Store::GetDataObjects::messageTypeId:
+	case (static_cast<int64_t>(Energistics::Etp::v12::Protocol::DataArray::GetDataArrays::protocolId) << 32) | Energistics::Etp::v12::Protocol::DataArray::GetDataArrays::messageTypeId:
+	case (static_cast<int64_t>(Energistics::Etp::v12::Protocol::DataArray::GetDataSubarrays::protocolId) << 32) | Energistics::Etp::v12::Protocol::DataArray::GetDataSubarrays::messageTypeId:
+	case (static_cast<int64_t>(Energistics::Etp::v12::Protocol::DataArray::GetDataArrayMetadata::protocolId) << 32) | Energistics::Etp::v12::Protocol::DataArray::GetDataArrayMetadata::messageTypeId:
+	case (static_cast<int64_t>(Energistics::Etp::v12::Protocol::Dataspace::GetDataspaces::protocolId) << 32) | Energistics::Etp::v12::Protocol::Dataspace::GetDataspaces::messageTypeId:
+		return true;
+	default:
+		return false;
+	}
+}
+
+int64_t ResilientSession::sendIdempotent(RequestSender sender)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	if (givenUp) {
+		throw std::runtime_error("No session can be opened anymore.");
+	}
+	const int64_t requestId = nextRequestId++;
+	Request& request = requests[requestId];
+	request.sender = sender;
+	// Otherwise the request is going to be sent once the session is opened.
+	if (state->load() == Opened && session == resumedSession && !session->isWebSocketSessionClosed()) {
+		sendOnCurrentSession(request);
+	}
+	return requestId;
+}
+
+bool ResilientSession::isRequestStillProcessing(int64_t requestId)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	return isStillProcessing(requestId);
+}
+
+bool ResilientSession::isStillProcessing(int64_t requestId)
+{
+	auto it = requests.find(requestId);
+	if (it == requests.end()) {
+		return false;
+	}
+	if (it->second.session != nullptr && it->second.session == session && isAnswered(it->second)) {
+		requests.erase(it);
+		hasSessionAnswered = true;
+		return false;
+	}
+	return true;
+}
+
+void ResilientSession::waitForResponse(int64_t requestId)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		// Read the generation before checking the request so that a signal happening after the check is not missed.
+		uint64_t checkedGeneration = 0;
+		{
+			const std::lock_guard<std::mutex> answerSignalLock(answerSignal->mutex);
+			checkedGeneration = answerSignal->generation;
+		} // Scope for answerSignalLock
+		if (!isStillProcessing(requestId)) {
+			return;
+		}
+		if (givenUp) {
+			throw std::runtime_error("No session can be opened anymore to send the request " + std::to_string(requestId));
+		}
+
+		const Request& request = requests[requestId];
+		const auto timeOut = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(_timeOut.load()));
+		// The time spent reopening the session is not counted : check again after a time out in case the request has been replayed meanwhile.
+		Clock::time_point deadline = Clock::now() + timeOut;
+		if (request.session != nullptr && request.session == session && !session->isWebSocketSessionClosed()) {
+			if (Clock::now() - request.sendingTime > timeOut) {
+				throw std::runtime_error("Time out waiting for a response of message id " + std::to_string(request.messageId));
+			}
+			deadline = request.sendingTime + timeOut;
+		}
+
+		// The sessions signal their answers and their closing, the supervisor signals when it gives up or replays the request.
+		lock.unlock();
+		{
+			std::unique_lock<std::mutex> answerSignalLock(answerSignal->mutex);
+			answerSignal->condition.wait_until(answerSignalLock, deadline, [this, checkedGeneration] { return answerSignal->generation != checkedGeneration; });
+		} // Scope for answerSignalLock
+		lock.lock();
+	}
+}
+
+void ResilientSession::subscribeNotifications(const Energistics::Etp::v12::Protocol::StoreNotification::SubscribeNotifications& msg)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	subscriptions.push_back(msg);
+	if (state->load() == Opened && session == resumedSession && !session->isWebSocketSessionClosed()) {
+		session->send(msg, 0, 0x02);
+	}
+}
+
+void ResilientSession::unsubscribeNotifications(const Energistics::Etp::v12::Datatypes::Uuid& requestUuid)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	for (auto it = subscriptions.begin(); it != subscriptions.end();) {
+		for (auto subscriptionIt = it->request.begin(); subscriptionIt != it->request.end();) {
+			if (isSameUuid(subscriptionIt->second.requestUuid, requestUuid)) {
+				subscriptionIt = it->request.erase(subscriptionIt);
+			}
+			else {
+				++subscriptionIt;
+			}
+		}
+		if (it->request.empty()) {
+			it = subscriptions.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+
+	if (state->load() == Opened && session == resumedSession && !session->isWebSocketSessionClosed()) {
+		Energistics::Etp::v12::Protocol::StoreNotification::UnsubscribeNotifications msg;
+		msg.requestUuid = requestUuid;
+		session->send(msg, 0, 0x02);
+	}
+}
+
+void ResilientSession::open()
+{
+	std::shared_ptr<std::atomic<int>> newState = std::make_shared<std::atomic<int>>(Opening);
+	std::shared_ptr<AbstractSession> newSession = opener([newState](AbstractSession&, bool opened) {
+		*newState = opened ? Opened : Failed;
+	});
+	if (newSession == nullptr) {
+		*newState = Failed;
+	}
+	else {
+		// No request is sent on the session before it is opened : the listener is always set in time.
+		std::shared_ptr<AnswerSignal> sharedAnswerSignal = answerSignal;
+		newSession->setAnswerListener([sharedAnswerSignal] { sharedAnswerSignal->signal(); });
+	}
+
+	if (session != nullptr && !session->isWebSocketSessionClosed()) {
+		session->close();
+	}
+	session = newSession;
+	state = newState;
+}
+
+void ResilientSession::sendOnCurrentSession(Request& request)
+{
+	request.session = session;
+	request.messageId = request.sender(*session);
+	request.sendingTime = Clock::now();
+}
+
+bool ResilientSession::isAnswered(const Request& request)
+{
+	return !request.session->isMessageStillProcessing(request.messageId);
+}
+
+void ResilientSession::supervise()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!stopping) {
+		const Clock::time_point now = Clock::now();
+		if (state->load() == Opened && session->isWebSocketSessionClosed()) {
+			// The session failed after having been opened : replace it right now if it has been working.
+			FETPAPI_LOG(session.get(), Warning, "The websocket has been closed. A new session is going to be opened and", requests.size(), "requests are going to be replayed.");
+			*state = Failed;
+			if (session == resumedSession && (hasSessionAnswered || now - resumingTime >= stableSessionDuration)) {
+				failureCount = 0;
+				retryTime = now;
+			}
+			// Otherwise the session has failed right after its opening, for example because the server accepts the sessions without serving them :
+			// the backoff goes on as if the opening had failed.
+		}
+
+		const int currentState = state->load();
+		if (currentState == Failed && !givenUp) {
+			if (failureCount >= maxOpeningAttempts) {
+				givenUp = true;
+				condition.notify_all();
+				answerSignal->signal();
+			}
+			else if (now >= retryTime) {
+				// Exponential backoff
+				std::chrono::milliseconds backoff = initialBackoff;
+				for (unsigned int i = 0; i < failureCount && backoff < maxBackoff; ++i) {
+					backoff *= 2;
+				}
+				++failureCount;
+				retryTime = now + (std::min)(backoff, maxBackoff);
+				++reconnectionCount;
+				open();
+			}
+		}
+		else if (currentState == Opened && session != resumedSession) {
+			resumingTime = now;
+			hasSessionAnswered = false;
+			// Forget the requests which have been answered by the failed session before its failure.
+			for (auto it = requests.begin(); it != requests.end();) {
+				if (it->second.session != nullptr && isAnswered(it->second)) {
+					it = requests.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+
+			for (const auto& subscription : subscriptions) {
+				session->send(subscription, 0, 0x02);
+			}
+			for (auto& request : requests) {
+				if (request.second.session != nullptr) {
+					++replayedRequestCount;
+				}
+				sendOnCurrentSession(request.second);
+			}
+			resumedSession = session;
+			condition.notify_all();
+			answerSignal->signal();
+		}
+
+		condition.wait_for(lock, supervisionPeriod);
+	}
+}
@@ -0,0 +1,259 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <thread>
+
+#include "SessionPool.h"
+
+namespace ETP_NS
+{
+	/**
+	* A client session which survives the transient failures of the network.
+	* When its websocket closes, whatever the reason, a new session is opened with an exponential backoff, which sends RequestSession again.
+	* Once the new session is opened, the StoreNotification subscriptions are sent again and then the requests which have not been answered yet are replayed.
+	* Only idempotent requests are sent through this wrapper (gets, metadata and subarray reads for example) : a replayed request may have already been
+	* processed by the store before the failure. Other messages must be sent directly on getSession() and are lost if the session fails.
+	* It is opt-in : a session created by ClientSessionLaunchers is not resilient by itself.
+	*/
+	class ResilientSession
+	{
+	public:
+		/**
+		* Sends a request on a session and returns the ID of the sent message, typically by means of AbstractSession::sendWithSpecificHandler.
+		* It is called again with the new session each time the request is replayed : the response handlers must be the ones of this session.
+		*/
+		typedef std::function<int64_t(AbstractSession&)> RequestSender;
+
+		/**
+		* Start to open the session. It does not block.
+		*
+		* @param opener				Opens the first session and each replacing session, see SessionPool::makeWsSessionOpener for example.
+		* @param maxOpeningAttempts	The count of consecutive failed openings after which the wrapper gives up.
+		* @param initialBackoff		The delay before the second opening attempt. It doubles at each new attempt.
+		* @param maxBackoff			The maximum delay between two opening attempts.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT ResilientSession(SessionPool::SessionOpener opener, unsigned int maxOpeningAttempts = 8,
+			std::chrono::milliseconds initialBackoff = std::chrono::milliseconds(200), std::chrono::milliseconds maxBackoff = std::chrono::milliseconds(10000));
+
+		/**
+		* Close the current session. The requests which have not been answered yet are forgotten.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT ~ResilientSession();
+
+		ResilientSession(const ResilientSession&) = delete;
+		ResilientSession& operator=(const ResilientSession&) = delete;
+
+		/**
+		* @return The current session. It may be closed or not opened yet. It is replaced after each failure.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::shared_ptr<AbstractSession> getSession() const;
+
+		/**
+		* @return True if the current ETP session is opened.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT bool isOpened() const;
+
+		/**
+		* @return True if the wrapper has given up opening a session, see maxOpeningAttempts in the constructor.
+		*/
+		bool hasGivenUp() const { return givenUp; }
+
+		/**
+		* Block the current thread until a session is opened.
+		*
+		* @throw std::runtime_error	if no session is opened within the time out or if the wrapper has given up opening a session.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void waitForOpening();
+
+		/**
+		* @return How many sessions have been opened again after a failure since the creation of the wrapper.
+		*/
+		std::size_t getReconnectionCount() const { return reconnectionCount; }
+
+		/**
+		* @return How many requests have been sent again on a new session since the creation of the wrapper.
+		*/
+		std::size_t getReplayedRequestCount() const { return replayedRequestCount; }
+
+		/**
+		* Set the time out in milliseconds of a request, counted from its last sending. Default is 10 000 ms.
+		* The time spent reopening the session is not counted.
+		*/
+		void setTimeOut(double timeOut) { _timeOut = timeOut; }
+		double getTimeOut() const { return _timeOut; }
+
+		/**
+		* @return True if the messages of this protocol and of this type are idempotent requests which can be replayed after a failure.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT static bool isReplayable(int32_t protocolId, int32_t messageTypeId);
+
+		/**
+		* Send an idempotent request, right now if the session is opened, otherwise once it is opened.
+		* The response is processed by the default handlers of the session which sends it.
+		*
+		* @return The ID of the request within this wrapper, which is not the ID of the sent message since it changes at each replay.
+		* @throw std::invalid_argument	if the message is not replayable, see isReplayable.
+		*/
+		template<typename T> int64_t send(const T & mb)
+		{
+			if (!isReplayable(mb.protocolId, mb.messageTypeId)) {
+				throw std::invalid_argument("The message type " + std::to_string(mb.messageTypeId) + " of the protocol " + std::to_string(mb.protocolId)
+					+ " is not an idempotent request. Send it directly on the session.");
+			}
+			return sendIdempotent([mb](AbstractSession& session) { return session.send(mb, 0, 0x02); });
+		}
+
+		/**
+		* Send a request which the caller knows to be idempotent, right now if the session is opened, otherwise once it is opened.
+		*
+		* @return The ID of the request within this wrapper, which is not the ID of the sent message since it changes at each replay.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT int64_t sendIdempotent(RequestSender sender);
+
+		/**
+		* Same as send but block the current thread until the response to the request has been processed by the handlers, even across a reconnection.
+		*
+		* @throw std::runtime_error	if the request is not answered within the time out or if the wrapper has given up opening a session.
+		*/
+		template<typename T> void sendAndBlock(const T & mb)
+		{
+			waitForResponse(send(mb));
+		}
+
+		/**
+		* Check whether a request sent through this wrapper has been answered or not.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT bool isRequestStillProcessing(int64_t requestId);
+
+		/**
+		* Block the current thread until a request sent through this wrapper has been answered.
+		*
+		* @throw std::runtime_error	if the request is not answered within the time out or if the wrapper has given up opening a session.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void waitForResponse(int64_t requestId);
+
+		/**
+		* Subscribe to some store notifications. The subscriptions are sent again on each new session until they are unsubscribed.
+		* The notifications are processed by the StoreNotification handlers of each session.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void subscribeNotifications(const Energistics::Etp::v12::Protocol::StoreNotification::SubscribeNotifications& msg);
+
+		/**
+		* Cancel a subscription made by subscribeNotifications, on the current session and on the next ones.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void unsubscribeNotifications(const Energistics::Etp::v12::Datatypes::Uuid& requestUuid);
+
+	private:
+		typedef std::chrono::steady_clock Clock;
+
+		enum SessionState : int { Opening, Opened, Failed };
+
+		struct Request {
+			RequestSender sender;
+			/// The session on which the request has been sent for the last time. nullptr if it has not been sent yet.
+			std::shared_ptr<AbstractSession> session;
+			int64_t messageId = -1;
+			Clock::time_point sendingTime;
+		};
+
+		/**
+		* Wakes up waitForResponse when a request gets answered, when a websocket gets closed, when the requests are replayed or when the wrapper gives up.
+		* Shared with the answer listeners of the sessions, which may be called after the destruction of the wrapper.
+		*/
+		struct AnswerSignal {
+			std::mutex mutex;
+			std::condition_variable condition;
+			/// Incremented at each signal so that a waiting thread knows whether something happened since its last check.
+			uint64_t generation = 0;
+
+			void signal() {
+				{
+					const std::lock_guard<std::mutex> lock(mutex);
+					++generation;
+				} // Scope for lock
+				condition.notify_all();
+			}
+		};
+
+		/**
+		* Reopen the session when it failed, resubscribe and replay the requests once it is opened.
+		*/
+		void supervise();
+
+		/**
+		* Open a new session. The mutex must be locked by the caller.
+		*/
+		void open();
+
+		/**
+		* Send a request on the current session. The mutex must be locked by the caller and the session must be opened.
+		*/
+		void sendOnCurrentSession(Request& request);
+
+		/**
+		* @return True if the request has been answered. The mutex must be locked by the caller.
+		*/
+		static bool isAnswered(const Request& request);
+
+		/**
+		* Same as isRequestStillProcessing but the mutex must be locked by the caller.
+		*/
+		bool isStillProcessing(int64_t requestId);
+
+		SessionPool::SessionOpener opener;
+		const unsigned int maxOpeningAttempts;
+		const std::chrono::milliseconds initialBackoff;
+		const std::chrono::milliseconds maxBackoff;
+
+		std::shared_ptr<AbstractSession> session;
+		/// Shared with the ready callback of the session, which may be called after the session has been replaced.
+		std::shared_ptr<std::atomic<int>> state;
+		/// The session on which the subscriptions have been sent and the requests replayed.
+		std::shared_ptr<AbstractSession> resumedSession;
+		/// The count of consecutive failed openings, including the sessions which failed before having answered a request or stayed opened long enough
+		unsigned int failureCount = 0;
+		Clock::time_point retryTime;
+		/// When the subscriptions have been sent and the requests replayed on the current session
+		Clock::time_point resumingTime;
+		/// True if the current session has answered at least one request sent through this wrapper
+		bool hasSessionAnswered = false;
+
+		/// The requests which have not been answered yet, by request ID
+		std::map<int64_t, Request> requests;
+		int64_t nextRequestId = 0;
+		std::vector<Energistics::Etp::v12::Protocol::StoreNotification::SubscribeNotifications> subscriptions;
+
+		std::atomic<bool> givenUp{ false };
+		std::atomic<std::size_t> reconnectionCount{ 0 };
+		std::atomic<std::size_t> replayedRequestCount{ 0 };
+		std::atomic<double> _timeOut{ 10000 };
+
+		/// Protects all the members above which are not atomic
+		mutable std::mutex mutex;
+		std::condition_variable condition;
+		std::shared_ptr<AnswerSignal> answerSignal;
+		bool stopping = false;
+		std::thread supervisor;
+	};
+}
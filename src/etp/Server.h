@@ -19,12 +19,13 @@ under the License.
 #pragma once
 
 #include <fstream>
-#include <regex>
+#include <memory>
 #include <stdexcept>
 #include <thread>
 #include <vector>
 
 #include <boost/asio/bind_executor.hpp>
+#include <boost/asio/executor_work_guard.hpp>
 #include <boost/asio/signal_set.hpp>
 #ifdef WITH_ETP_SSL
 #include <boost/asio/ssl.hpp>
@@ -34,10 +35,17 @@ under the License.
 #include <boost/asio/ip/tcp.hpp>
 
 #include <boost/beast/http/file_body.hpp>
+#include <boost/core/ignore_unused.hpp>
 
-#include "avro/Compiler.hh"
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
 
 #include "PlainServerSession.h"
+#include "SessionRegistry.h"
 #ifdef WITH_ETP_SSL
 #include "ssl/SslServerSession.h"
 #endif
@@ -49,6 +57,12 @@ namespace ssl = boost::asio::ssl;       // from <boost/asio/ssl.hpp>
 #endif
 using tcp = boost::asio::ip::tcp;               // from <boost/asio/ip/tcp.hpp>
 
+// Only Linux balances the incoming connections between several sockets listening on the same port.
+#if defined(__linux__) && defined(SO_REUSEPORT)
+#define FETPAPI_REUSE_PORT
+typedef boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT> reuse_port;
+#endif
+
 namespace ETP_NS
 {
 	// Return a reasonable mime type based on the extension of a file.
@@ -87,33 +101,54 @@ namespace ETP_NS
 		return "application/text";
 	}
 
-	// Append an HTTP rel-path to a local filesystem path.
-	// The returned path is normalized for the platform.
-	std::string
-		path_cat(
-			beast::string_view base,
-			beast::string_view path)
+	// Split an HTTP request target into its query and its route
+	// where each run of slashes or backslashes is replaced by a single slash.
+	inline std::string
+		parse_target(
+			beast::string_view target,
+			beast::string_view& query)
 	{
-		if (base.empty())
-			return std::string(path.data());
-		std::string result = std::string(base.data());
-#ifdef BOOST_MSVC
-		char constexpr path_separator = '\\';
-		if (result.back() == path_separator)
-			result.resize(result.size() - 1);
-		result.append(path.data(), path.size());
-		for (auto& c : result)
-			if (c == '/')
-				c = path_separator;
-#else
-		char constexpr path_separator = '/';
-		if (result.back() == path_separator)
-			result.resize(result.size() - 1);
-		result.append(path.data(), path.size());
-#endif
+		const std::size_t queryStart = target.find('?');
+		query = queryStart == beast::string_view::npos ? beast::string_view() : target.substr(queryStart + 1);
+		const beast::string_view path = target.substr(0, queryStart);
+
+		std::string result;
+		result.reserve(path.size());
+		for (const char c : path) {
+			if (c != '/' && c != '\\')
+				result.push_back(c);
+			else if (result.empty() || result.back() != '/')
+				result.push_back('/');
+		}
 		return result;
 	}
 
+	// Returns `true` if the value of an If-None-Match header matches an entity tag.
+	// The comparison is the weak one as required by RFC 7232.
+	inline bool
+		if_none_match(
+			beast::string_view header,
+			beast::string_view etag)
+	{
+		while (!header.empty()) {
+			const std::size_t comma = header.find(',');
+			beast::string_view candidate = header.substr(0, comma);
+			header = comma == beast::string_view::npos ? beast::string_view() : header.substr(comma + 1);
+
+			while (!candidate.empty() && (candidate.front() == ' ' || candidate.front() == '\t'))
+				candidate.remove_prefix(1);
+			while (!candidate.empty() && (candidate.back() == ' ' || candidate.back() == '\t'))
+				candidate.remove_suffix(1);
+			if (candidate == "*")
+				return true;
+			if (candidate.substr(0, 2) == "W/")
+				candidate.remove_prefix(2);
+			if (candidate == etag)
+				return true;
+		}
+		return false;
+	}
+
 	// This function produces an HTTP response for the given
 	// request. The type of the response object depends on the
 	// contents of the request, so the interface requires the
@@ -127,6 +162,9 @@ namespace ETP_NS
 			http::request<Body, http::basic_fields<Allocator>>&& req,
 			Send&& send, ServerInitializationParameters* serverInitializationParams)
 	{
+		// No file is served
+		boost::ignore_unused(doc_root);
+
 		// Returns a bad request response
 		auto const bad_request =
 			[&req, serverInitializationParams](beast::string_view why)
@@ -166,17 +204,27 @@ namespace ETP_NS
 			return res;
 		};
 
-		// Returns a server error response
-		auto const server_error =
-			[&req, serverInitializationParams](beast::string_view what)
+		// Returns a successful response, without its body to a HEAD request
+		auto const send_ok =
+			[&req, &send, serverInitializationParams](std::string&& body, beast::string_view contentType)
 		{
-			http::response<http::string_body> res{ http::status::internal_server_error, req.version() };
+			if (req.method() == http::verb::head)
+			{
+				http::response<http::empty_body> res{ http::status::ok, req.version() };
+				res.set(http::field::server, serverInitializationParams->getApplicationName());
+				res.set(http::field::content_type, contentType);
+				res.content_length(body.size());
+				res.keep_alive(req.keep_alive());
+				return send(std::move(res));
+			}
+
+			http::response<http::string_body> res{ http::status::ok, req.version() };
 			res.set(http::field::server, serverInitializationParams->getApplicationName());
-			res.set(http::field::content_type, "text/html");
+			res.set(http::field::content_type, contentType);
 			res.keep_alive(req.keep_alive());
-			res.body() = "An error occurred: '" + std::string(what) + "'";
+			res.body() = std::move(body);
 			res.prepare_payload();
-			return res;
+			return send(std::move(res));
 		};
 
 		// Make sure we can handle the method
@@ -184,281 +232,52 @@ namespace ETP_NS
 			req.method() != http::verb::head)
 			return send(bad_request("Unknown HTTP-method"));
 
+		// The observability routes are only served when the server records some metrics
+		std::shared_ptr<MetricsRegistry> metricsRegistry = serverInitializationParams->getMetricsRegistry();
+		if (metricsRegistry) {
+			const beast::string_view route = req.target().substr(0, req.target().find('?'));
+			if (route == "/metrics") {
+				return send_ok(metricsRegistry->snapshot().toPrometheusText(), "text/plain; version=0.0.4");
+			}
+			if (route == "/health") {
+				// Polled by load balancers : it must neither aggregate all the metrics nor reset the io thread utilization sample of /metrics.
+				return send_ok("{\"status\":\"ok\",\"openSessionCount\":" + std::to_string(metricsRegistry->getOpenSessionCount())
+					+ ",\"ioThreadCount\":" + std::to_string(metricsRegistry->getIoThreadCount()) + "}", mime_type("*.json"));
+			}
+		}
+
 		// Request path must be absolute and not contain "..".
 		if (req.target().empty() ||
 			req.target()[0] != '/' ||
 			req.target().find("..") != beast::string_view::npos)
 			return send(bad_request("Illegal request-target"));
 
-		// Build the path to the requested file
-		std::string path = path_cat(doc_root, req.target());
-		if (req.target().back() == '/')
-			path.append("index.html");
-
-		// Attempt to open the file
-		beast::error_code ec;
-		http::string_body::value_type body;
-		/*
-		body.open(path.c_str(), beast::file_mode::scan, ec);
-
-		// Handle the case where the file doesn't exist
-		if (ec == boost::system::errc::no_such_file_or_directory)
+		beast::string_view query;
+		const std::string route = parse_target(req.target(), query);
+		if (route != "/.well-known/etp-server-capabilities")
 			return send(not_found(req.target()));
-			*/
 
-		while (path.find("//") != std::string::npos) {
-			path = std::regex_replace(path, std::regex("//"), std::string("/"));
-		}
-		while (path.find("\\\\") != std::string::npos) {
-			// See https://stackoverflow.com/questions/4025482/cant-escape-the-backslash-with-regex
-			path = std::regex_replace(path, std::regex("\\\\\\\\"), std::string("\\"));
-		}
-
-		if (path == "./.well-known/etp-server-capabilities" ||
-			path == ".\\.well-known\\etp-server-capabilities") {
+		if (query.empty())
 			return send(unprocessable_entity(req.target()));
-		}
 
-		if (path != "./.well-known/etp-server-capabilities?GetVersion=etp12.energistics.org" &&
-			path != ".\\.well-known\\etp-server-capabilities?GetVersion=etp12.energistics.org" &&
-			path != "./.well-known/etp-server-capabilities?GetVersions=true" &&
-			path != ".\\.well-known\\etp-server-capabilities?GetVersions=true") {
-			return send(not_found(req.target()));
-		}
+		if (query == "GetVersions=true")
+			return send_ok("[ \"etp12.energistics.org\" ]", mime_type("*.json"));
 
-		std::ostringstream oss;
-
-		if (path == "./.well-known/etp-server-capabilities?GetVersion=etp12.energistics.org" ||
-			path == ".\\.well-known\\etp-server-capabilities?GetVersion=etp12.energistics.org") {
-			avro::ValidSchema vs = avro::compileJsonSchemaFromString(
-				"{"
-				"  \"type\": \"record\","
-				"  \"name\": \"ServerCapabilities\","
-				"  \"fields\": ["
-				"	{"
-				"	  \"name\": \"applicationName\","
-				"	  \"type\": \"string\""
-				"	},"
-				"	{"
-				"	  \"name\": \"applicationVersion\","
-				"	  \"type\": \"string\""
-				"	},"
-				"	{"
-				"	  \"name\": \"contactInformation\","
-				"	  \"type\": {"
-				"		\"type\": \"record\","
-				"       \"name\": \"Contact\","
-				"		\"fields\": ["
-				"		  {"
-				"		    \"name\": \"organizationName\","
-				"		    \"type\": \"string\""
-				"		  },"
-				"		  {"
-				"		    \"name\": \"contactName\","
-				"		    \"type\": \"string\""
-				"		  },"
-				"		  {"
-				"		    \"name\": \"contactPhone\","
-				"		    \"type\": \"string\""
-				"		  },"
-				"		  {"
-				"		    \"name\": \"contactEmail\","
-				"		    \"type\": \"string\""
-				"		  }"
-				"		]"
-				"	  }"
-				"	},"
-				"	{"
-				"	  \"name\": \"supportedCompression\","
-				"	  \"type\": {"
-				"		\"type\": \"array\","
-				"		\"items\": \"string\""
-				"	  }"
-				"	},"
-				"	{"
-				"	  \"name\": \"supportedEncodings\","
-				"	  \"type\": {"
-				"		\"type\": \"array\","
-				"		\"items\": \"string\""
-				"	  }"
-				"	},"
-				"	{"
-				"	  \"name\": \"supportedFormats\","
-				"	  \"type\": {"
-				"		\"type\": \"array\","
-				"		\"items\": \"string\""
-				"	  }"
-				"	},"
-				"	{"
-				"	  \"name\": \"supportedDataObjects\","
-				"	  \"type\": {"
-				"		\"type\": \"array\","
-				"		\"items\": {"
-				"		  \"type\": \"record\","
-				"		  \"name\" : \"SupportedDataObject\","
-				"		  \"fields\" : ["
-				"		    {"
-				"			  \"name\": \"qualifiedType\","
-				"			  \"type\" : \"string\""
-				"		    },"
-				"		    {"
-				"			  \"name\": \"dataObjectCapabilities\","
-				"			  \"type\" : {"
-				"			    \"type\": \"map\","
-				"			    \"values\": {"
-				"				  \"type\": \"record\","
-				"				  \"name\": \"DataValue\","
-				"				  \"fields\": ["
-				"					{"
-				"					  \"name\": \"item\","
-				"					  \"type\": ["
-				"						\"null\","
-				"						\"boolean\","
-				"						\"int\","
-				"						\"long\","
-				"						\"float\","
-				"						\"double\","
-				"						\"string\","
-				"						\"bytes\""
-				"					  ]"
-				"					}"
-				"				  ]"
-				"				}"
-				"			  }"
-				"		    }"
-				"		  ]"
-				"	    }"
-				"     }"
-				"	},"
-				"	{"
-				"	  \"name\": \"supportedProtocols\","
-				"	  \"type\": {"
-				"		\"type\": \"array\","
-				"		\"items\": {"
-				"		  \"type\": \"record\","
-				"		  \"name\": \"SupportedProtocol\","
-				"		  \"fields\": ["
-				"			{"
-				"			  \"name\": \"protocol\","
-				"			  \"type\": \"int\""
-				"			},"
-				"			{"
-				"			  \"name\": \"protocolVersion\","
-				"			  \"type\": {"
-				"				\"type\": \"record\","
-				"			    \"name\": \"Version\","
-				"			    \"fields\": ["
-				"				  {"
-				"				    \"name\": \"major\","
-				"				    \"type\": \"int\""
-				"				  },"
-				"				  {"
-				"  				    \"name\": \"minor\","
-				"				    \"type\": \"int\""
-				"				  },"
-				"				  {"
-				"				    \"name\": \"revision\","
-				"				    \"type\": \"int\""
-				"				  },"
-				"				  {"
-				" 				    \"name\": \"patch\","
-				"				    \"type\": \"int\""
-				"				  }"
-				"			    ]"
-				"			  }"
-				"			},"
-				"			{"
-				"			  \"name\": \"role\","
-				"			  \"type\": \"string\""
-				"			},"
-				"			{"
-				"			  \"name\": \"protocolCapabilities\","
-				"			  \"type\": {"
-				"				\"type\": \"map\","
-				"				\"values\": {"
-				"				  \"type\": \"record\","
-				"				  \"name\": \"DataValue\","
-				"				  \"fields\": ["
-				"					{"
-				"					  \"name\": \"item\","
-				"					  \"type\": ["
-				"						\"null\","
-				"						\"boolean\","
-				"						\"int\","
-				"						\"long\","
-				"						\"float\","
-				"						\"double\","
-				"						\"string\","
-				"						\"bytes\""
-				"					  ]"
-				"					}"
-				"				  ]"
-				"				}"
-				"			  }"
-				"			}"
-				"		  ]"
-				"		}"
-				"	  }"
-				"	},"
-				"	{"
-				"	  \"name\": \"endpointCapabilities\","
-				"	  \"type\": {"
-				"		\"type\": \"map\","
-				"		\"values\": {"
-				"		  \"type\": \"record\","
-				"		  \"name\": \"DataValue\","
-				"		  \"fields\": ["
-				"			{"
-				"			  \"name\": \"item\","
-				"			  \"type\": ["
-				"				\"null\","
-				"				\"boolean\","
-				"				\"int\","
-				"				\"long\","
-				"				\"float\","
-				"				\"double\","
-				"				\"string\","
-				"				\"bytes\""
-				"			  ]"
-				"			}"
-				"		  ]"
-				"		}"
-				"	  }"
-				"	}"
-				"  ]"
-				"}"
-			);
-
-			Energistics::Etp::v12::Datatypes::ServerCapabilities serverCap;
-			serverCap.applicationName = serverInitializationParams->getApplicationName();
-			serverCap.applicationVersion = serverInitializationParams->getApplicationVersion();
-			serverCap.contactInformation.contactEmail = serverInitializationParams->getContactEmail();
-			serverCap.contactInformation.contactName = serverInitializationParams->getContactName();
-			serverCap.contactInformation.contactPhone = serverInitializationParams->getContactPhone();
-			serverCap.contactInformation.organizationName = serverInitializationParams->getOrganizationName();
-			serverCap.endpointCapabilities = serverInitializationParams->makeEndpointCapabilities();
-			serverCap.supportedEncodings = serverInitializationParams->makeSupportedEncodings();
-			serverCap.supportedFormats.push_back("xml");
-			serverCap.supportedDataObjects = serverInitializationParams->makeSupportedDataObjects();
-			serverCap.supportedProtocols = serverInitializationParams->makeSupportedProtocols();
-
-			avro::OutputStreamPtr out = avro::ostreamOutputStream(oss);
-			avro::EncoderPtr e = avro::jsonPrettyEncoder(vs);
-			e->init(*out);
-			avro::encode(*e, serverCap);
-			e->flush();
-			body = oss.str();
-		}
-		else {
-			body = "[ \"etp12.energistics.org\" ]";
-		}
+		if (query != "GetVersion=etp12.energistics.org")
+			return send(not_found(req.target()));
 
-		// Handle an unknown error
-		if (ec)
-			return send(server_error(ec.message()));
+		// The response is only built again when the capabilities have changed
+		const std::shared_ptr<const ServerCapabilitiesResponse> capabilities = serverInitializationParams->getServerCapabilitiesResponse();
 
-		// Cache the size since we need it after the move
-		auto const size = body.size();
+		// Respond to a conditional request when the client already has the current capabilities
+		if (if_none_match(req[http::field::if_none_match], capabilities->etag))
+		{
+			http::response<http::empty_body> res{ http::status::not_modified, req.version() };
+			res.set(http::field::server, serverInitializationParams->getApplicationName());
+			res.set(http::field::etag, capabilities->etag);
+			res.keep_alive(req.keep_alive());
+			return send(std::move(res));
+		}
 
 		// Respond to HEAD request
 		if (req.method() == http::verb::head)
@@ -466,20 +285,20 @@ namespace ETP_NS
 			http::response<http::empty_body> res{ http::status::ok, req.version() };
 			res.set(http::field::server, serverInitializationParams->getApplicationName());
 			res.set(http::field::content_type, mime_type("*.json"));
-			res.content_length(size);
+			res.set(http::field::etag, capabilities->etag);
+			res.content_length(capabilities->json.size());
 			res.keep_alive(req.keep_alive());
 			return send(std::move(res));
 		}
 
 		// Respond to GET request
-		http::response<http::string_body> res{
-			std::piecewise_construct,
-			std::make_tuple(std::move(body)),
-			std::make_tuple(http::status::ok, req.version()) };
+		http::response<http::string_body> res{ http::status::ok, req.version() };
 		res.set(http::field::server, serverInitializationParams->getApplicationName());
 		res.set(http::field::content_type, mime_type("*.json"));
-		res.content_length(size);
+		res.set(http::field::etag, capabilities->etag);
 		res.keep_alive(req.keep_alive());
+		res.body() = capabilities->json;
+		res.prepare_payload();
 		return send(std::move(res));
 	}
 
@@ -488,21 +307,21 @@ namespace ETP_NS
 	private:
 
 		ServerInitializationParameters* serverInitializationParams_;
-		std::vector< std::shared_ptr<AbstractSession> > sessions_;
+		std::shared_ptr<SessionRegistry> sessions_;
 
 		template<class Body, class Allocator>
 		static void
 			make_websocket_session(
 				tcp::socket socket,
 				http::request<Body, http::basic_fields<Allocator>> req,
-				std::vector< std::shared_ptr<AbstractSession> >& sessions,
+				SessionRegistry& sessions,
 				ServerInitializationParameters* serverInitializationParams)
 		{
 			auto session = std::make_shared<PlainServerSession>(std::move(socket), serverInitializationParams);
 			serverInitializationParams->postSessionCreationOperation(session.get());
+			sessions.add(session);
+			FETPAPI_LOG(session, Info, "Opening the plain websocket session", sessions.size());
 			session->run(std::move(req));
-			session->fesapi_log("Opening the plain websocket session", std::to_string(sessions.size()));
-			sessions.push_back(session);
 		}
 
 #ifdef WITH_ETP_SSL
@@ -511,14 +330,14 @@ namespace ETP_NS
 			make_websocket_session(
 				boost::beast::ssl_stream<tcp::socket> stream,
 				http::request<Body, http::basic_fields<Allocator>> req,
-				std::vector< std::shared_ptr<AbstractSession> >& sessions,
+				SessionRegistry& sessions,
 				ServerInitializationParameters* serverInitializationParams)
 		{
 			auto session = std::make_shared<SslServerSession>(std::move(stream), serverInitializationParams);
 			serverInitializationParams->postSessionCreationOperation(session.get());
+			sessions.add(session);
+			FETPAPI_LOG(session, Info, "Opening the secured websocket session", sessions.size());
 			session->run(std::move(req));
-			session->fesapi_log("Opening the secured websocket session", std::to_string(sessions.size()));
-			sessions.push_back(session);
 		}
 #endif
 
@@ -633,7 +452,7 @@ namespace ETP_NS
 			std::shared_ptr<std::string const> doc_root_;
 			http::request<http::string_body> req_;
 			queue queue_;
-			std::vector< std::shared_ptr<AbstractSession> >& sessions_;
+			SessionRegistry& sessions_;
 			ServerInitializationParameters* serverInitializationParams_;
 
 		protected:
@@ -642,13 +461,22 @@ namespace ETP_NS
 				boost::asio::io_context::executor_type> strand_;
 			beast::flat_buffer buffer_;
 
+			void
+				recordFailedHandshake()
+			{
+				std::shared_ptr<MetricsRegistry> metricsRegistry = serverInitializationParams_->getMetricsRegistry();
+				if (metricsRegistry) {
+					metricsRegistry->recordHandshake(false);
+				}
+			}
+
 		public:
 			// Take ownership of the socket
 			explicit
 				http_session(
 					boost::asio::io_context& ioc,
 					std::shared_ptr<std::string const> const& doc_root,
-					std::vector< std::shared_ptr<AbstractSession> >& sessions,
+					SessionRegistry& sessions,
 					ServerInitializationParameters* serverInitializationParams
 				)
 				: doc_root_(doc_root)
@@ -732,6 +560,7 @@ namespace ETP_NS
 				{
 					if (req_.count(boost::beast::http::field::sec_websocket_protocol) != 1 ||
 						req_.at(boost::beast::http::field::sec_websocket_protocol).find("etp12.energistics.org") == std::string::npos) {
+						recordFailedHandshake();
 						auto const precondition_failed = [this]()
 						{
 							http::response<http::string_body> res{ http::status::precondition_failed, req_.version() };
@@ -809,7 +638,7 @@ namespace ETP_NS
 			plain_http_session(
 				tcp::socket socket,
 				std::shared_ptr<std::string const> const& doc_root,
-				std::vector< std::shared_ptr<AbstractSession> >& sessions,
+				SessionRegistry& sessions,
 				ServerInitializationParameters* serverInitializationParams)
 				: http_session<plain_http_session>(
 #if BOOST_VERSION < 107000
@@ -901,7 +730,7 @@ namespace ETP_NS
 				tcp::socket socket,
 				ssl::context& ctx,
 				std::shared_ptr<std::string const> const& doc_root,
-				std::vector< std::shared_ptr<AbstractSession> >& sessions,
+				SessionRegistry& sessions,
 				ServerInitializationParameters* serverInitializationParams)
 				: http_session<ssl_http_session>(
 #if BOOST_VERSION < 107000
@@ -980,6 +809,7 @@ namespace ETP_NS
 
 				if (ec) {
 					std::cerr << "handshake : " << ec.message() << std::endl;
+					recordFailedHandshake();
 					return;
 				}
 
@@ -1042,30 +872,17 @@ namespace ETP_NS
 		{
 			tcp::acceptor acceptor_;
 			tcp::socket socket_;
-			std::vector< std::shared_ptr<AbstractSession> >& sessions_;
+			SessionRegistry& sessions_;
 			ServerInitializationParameters* serverInitializationParams_;
+			/// The io contexts the accepted connections are given to in turn
+			std::vector<boost::asio::io_context*> sessionContexts_;
+			size_t nextSessionContext_;
 #ifdef WITH_ETP_SSL
 			ssl::context& ctx_;
 			bool useSsl_;
 #endif
 
-		public:
-#ifdef WITH_ETP_SSL
-			listener(
-				boost::asio::io_context& ioc,
-				tcp::endpoint endpoint,
-				std::vector< std::shared_ptr<AbstractSession> >& sessions,
-				ServerInitializationParameters* serverInitializationParams,
-				ssl::context& ctx,
-				bool useSsl
-			)
-				: acceptor_(ioc)
-				, socket_(ioc)
-				, sessions_(sessions)
-				, serverInitializationParams_(serverInitializationParams)
-				, ctx_(ctx)
-				, useSsl_(useSsl)
-			{
+			void open(tcp::endpoint endpoint, bool reusePort) {
 				beast::error_code ec;
 
 				// Open the acceptor
@@ -1082,6 +899,19 @@ namespace ETP_NS
 					return;
 				}
 
+#ifdef FETPAPI_REUSE_PORT
+				// Let the kernel balance the connections between the acceptors bound to the same port
+				if (reusePort) {
+					acceptor_.set_option(reuse_port(true), ec);
+					if (ec) {
+						FETPAPI_LOG(&Logger::getInstance(), Error, "listener set_option reuse_port :", ec.message());
+						return;
+					}
+				}
+#else
+				boost::ignore_unused(reusePort);
+#endif
+
 				// Bind to the server address
 				acceptor_.bind(endpoint, ec);
 				if (ec) {
@@ -1097,48 +927,47 @@ namespace ETP_NS
 					return;
 				}
 			}
+
+		public:
+#ifdef WITH_ETP_SSL
+			listener(
+				boost::asio::io_context& ioc,
+				tcp::endpoint endpoint,
+				SessionRegistry& sessions,
+				ServerInitializationParameters* serverInitializationParams,
+				const std::vector<boost::asio::io_context*>& sessionContexts,
+				bool reusePort,
+				ssl::context& ctx,
+				bool useSsl
+			)
+				: acceptor_(ioc)
+				, socket_(ioc)
+				, sessions_(sessions)
+				, serverInitializationParams_(serverInitializationParams)
+				, sessionContexts_(sessionContexts)
+				, nextSessionContext_(0)
+				, ctx_(ctx)
+				, useSsl_(useSsl)
+			{
+				open(endpoint, reusePort);
+			}
 #else
 			listener(
 				boost::asio::io_context& ioc,
 				tcp::endpoint endpoint,
-				std::vector< std::shared_ptr<AbstractSession> >& sessions,
-				ServerInitializationParameters* serverInitializationParams
+				SessionRegistry& sessions,
+				ServerInitializationParameters* serverInitializationParams,
+				const std::vector<boost::asio::io_context*>& sessionContexts,
+				bool reusePort
 			)
 				: acceptor_(ioc)
 				, socket_(ioc)
 				, sessions_(sessions)
 				, serverInitializationParams_(serverInitializationParams)
+				, sessionContexts_(sessionContexts)
+				, nextSessionContext_(0)
 			{
-				beast::error_code ec;
-
-				// Open the acceptor
-				acceptor_.open(endpoint.protocol(), ec);
-				if (ec) {
-					std::cerr << "listener open : " << ec.message() << std::endl;
-					return;
-				}
-
-				// Allow address reuse
-				acceptor_.set_option(boost::asio::socket_base::reuse_address(true), ec);
-				if (ec) {
-					std::cerr << "listener set_option : " << ec.message() << std::endl;
-					return;
-				}
-
-				// Bind to the server address
-				acceptor_.bind(endpoint, ec);
-				if (ec) {
-					std::cerr << "listener bind : " << ec.message() << std::endl;
-					return;
-				}
-
-				// Start listening for connections
-				acceptor_.listen(
-					boost::asio::socket_base::max_listen_connections, ec);
-				if (ec) {
-					std::cerr << "listener listen : " << ec.message() << std::endl;
-					return;
-				}
+				open(endpoint, reusePort);
 			}
 #endif
 
@@ -1149,6 +978,10 @@ namespace ETP_NS
 			}
 
 			void do_accept() {
+				// The session of the next connection runs on the io context of its socket
+				socket_ = tcp::socket(*sessionContexts_[nextSessionContext_]);
+				nextSessionContext_ = (nextSessionContext_ + 1) % sessionContexts_.size();
+
 				acceptor_.async_accept(
 					socket_,
 					std::bind(
@@ -1162,6 +995,11 @@ namespace ETP_NS
 					std::cerr << "listener on_accept : " << ec.message() << std::endl;
 				}
 				else {
+					std::shared_ptr<MetricsRegistry> metricsRegistry = serverInitializationParams_->getMetricsRegistry();
+					if (metricsRegistry) {
+						metricsRegistry->recordAcceptedConnection();
+					}
+
 					// Create the http session and run it
 #ifdef WITH_ETP_SSL
 					if (useSsl_) {
@@ -1177,10 +1015,41 @@ namespace ETP_NS
 			}
 		};
 
+		/**
+		* Pin the current thread to a CPU. It does nothing on the platforms other than Linux and Windows.
+		*/
+		static void pinCurrentThread(size_t cpuIndex) {
+			const unsigned int cpuCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+#if defined(__linux__)
+			cpu_set_t cpuSet;
+			CPU_ZERO(&cpuSet);
+			CPU_SET(cpuIndex % cpuCount, &cpuSet);
+			const int error = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+			if (error != 0) {
+				FETPAPI_LOG(&Logger::getInstance(), Warning, "Cannot pin the server thread to the CPU", cpuIndex % cpuCount, ": error", error);
+			}
+#elif defined(_WIN32)
+			const unsigned int maskBitCount = sizeof(DWORD_PTR) * 8;
+			if (SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << (cpuIndex % (std::min)(cpuCount, maskBitCount))) == 0) {
+				FETPAPI_LOG(&Logger::getInstance(), Warning, "Cannot pin the server thread to the CPU", cpuIndex % cpuCount);
+			}
+#else
+			boost::ignore_unused(cpuIndex, cpuCount);
+#endif
+		}
+
 	public:
-		Server() : serverInitializationParams_(nullptr) {}
+		Server() : serverInitializationParams_(nullptr), sessions_(std::make_shared<SessionRegistry>()) {}
+
+		/**
+		* @return A snapshot of the sessions of the server. The closed sessions are not part of it.
+		*/
+		std::vector< std::shared_ptr<AbstractSession> > getSessions() const { return sessions_->getSessions(); }
 
-		std::vector< std::shared_ptr<AbstractSession> >& getSessions() { return sessions_; }
+		/**
+		* The registry of the sessions of the server which allows to look them up by identifier, to iterate over them and to count them.
+		*/
+		SessionRegistry& getSessionRegistry() { return *sessions_; }
 
 #ifdef WITH_ETP_SSL
 		void listen(ServerInitializationParameters* serverInitializationParams, int threadCount,
@@ -1192,16 +1061,24 @@ namespace ETP_NS
 			if (threadCount < 1) {
 				throw std::invalid_argument("You need to run your server on at least one thread.");
 			}
+			// Build the capabilities response before the first HTTP request
+			serverInitializationParams->getServerCapabilitiesResponse();
 			auto const address = boost::asio::ip::make_address(serverInitializationParams->getHost());
-
-			// The io_context is required for all I/O
-			boost::asio::io_context ioc{ threadCount };
+			const tcp::endpoint endpoint{ address, serverInitializationParams->getPort() };
+
+			// The io_contexts are required for all I/O : either one shared by all threads or one per thread
+			const bool ioContextPerThread = serverInitializationParams->isIoContextPerThread() && threadCount > 1;
+			std::vector<std::unique_ptr<boost::asio::io_context>> iocs;
+			std::vector<boost::asio::io_context*> sessionContexts;
+			for (int i = 0; i < (ioContextPerThread ? threadCount : 1); ++i) {
+				iocs.emplace_back(new boost::asio::io_context{ ioContextPerThread ? 1 : threadCount });
+				sessionContexts.push_back(iocs.back().get());
+			}
 
 #ifdef WITH_ETP_SSL
 			// The context life scope must the server life scope. That's why it is not inside the below condition.
 			ssl::context ctx{ ssl::context::tlsv12_server };
 
-			// Create and launch a listening port
 			if (!dh.empty()) {
 
 				ctx.set_password_callback(
@@ -1227,37 +1104,94 @@ namespace ETP_NS
 				ctx.use_tmp_dh(
 					boost::asio::buffer(dh.data(), dh.size()));
 
-				std::make_shared<Server::listener>(ioc, tcp::endpoint{ address, serverInitializationParams->getPort() }, sessions_, serverInitializationParams_, ctx, true)->run();
-			}
-			else {
-				std::make_shared<Server::listener>(ioc, tcp::endpoint{ address, serverInitializationParams->getPort() }, sessions_, serverInitializationParams_, ctx, false)->run();
+				// TLS session resumption, by session id thanks to the session cache or by session ticket
+				SSL_CTX* nativeContext = ctx.native_handle();
+				static const unsigned char sessionIdContext[] = "fetpapi";
+				SSL_CTX_set_session_id_context(nativeContext, sessionIdContext, sizeof(sessionIdContext) - 1);
+				if (serverInitializationParams->getTlsSessionCacheSize() > 0) {
+					SSL_CTX_set_session_cache_mode(nativeContext, SSL_SESS_CACHE_SERVER);
+					SSL_CTX_sess_set_cache_size(nativeContext, static_cast<long>(serverInitializationParams->getTlsSessionCacheSize()));
+					SSL_CTX_set_timeout(nativeContext, static_cast<long>(serverInitializationParams->getTlsSessionTimeout().count()));
+				}
+				else {
+					SSL_CTX_set_session_cache_mode(nativeContext, SSL_SESS_CACHE_OFF);
+					SSL_CTX_set_options(nativeContext, SSL_OP_NO_TICKET);
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+					SSL_CTX_set_num_tickets(nativeContext, 0);
+#endif
+				}
 			}
+
+			auto launchListener = [&](boost::asio::io_context& ioc, const std::vector<boost::asio::io_context*>& contexts, bool reusePort) {
+				std::make_shared<Server::listener>(ioc, endpoint, *sessions_, serverInitializationParams_, contexts, reusePort, ctx, !dh.empty())->run();
+			};
 #else
-				// Create and launch a listening port
-			std::make_shared<Server::listener>(ioc, tcp::endpoint{ address, serverInitializationParams->getPort() }, sessions_, serverInitializationParams_)->run();
+			auto launchListener = [&](boost::asio::io_context& ioc, const std::vector<boost::asio::io_context*>& contexts, bool reusePort) {
+				std::make_shared<Server::listener>(ioc, endpoint, *sessions_, serverInitializationParams_, contexts, reusePort)->run();
+			};
 #endif
 
+			// Create and launch the listening ports
+#ifdef FETPAPI_REUSE_PORT
+			if (ioContextPerThread) {
+				// One acceptor per io_context : a connection is accepted and served by the same thread
+				for (auto* ioc : sessionContexts) {
+					launchListener(*ioc, { ioc }, true);
+				}
+			}
+			else
+#endif
+			// A single acceptor which gives the accepted connections to the io_contexts in turn
+			launchListener(*iocs.front(), sessionContexts, false);
+
+			// Keep each io_context running until the shutdown, even without any listener of its own :
+			// the single acceptor gives it some connections later on and an acceptor which failed to open gives it none.
+			std::vector<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> workGuards;
+			workGuards.reserve(iocs.size());
+			for (auto& ioc : iocs) {
+				workGuards.push_back(boost::asio::make_work_guard(*ioc));
+			}
+
 			// Capture SIGINT and SIGTERM to perform a clean shutdown
-			boost::asio::signal_set signals(ioc, SIGINT, SIGTERM);
+			boost::asio::signal_set signals(*iocs.front(), SIGINT, SIGTERM);
 			signals.async_wait(
 				[&](beast::error_code const&, int)
 			{
-				// Stop the `io_context`. This will cause `run()`
+				for (auto& workGuard : workGuards) {
+					workGuard.reset();
+				}
+				// Stop the `io_context`s. This will cause `run()`
 				// to return immediately, eventually destroying the
-				// `io_context` and all of the sockets in it.
-				ioc.stop();
+				// `io_context`s and all of the sockets in them.
+				for (auto& ioc : iocs) {
+					ioc->stop();
+				}
 			});
 
 			// Run the I/O service on the requested number of threads
+			std::shared_ptr<MetricsRegistry> metricsRegistry = serverInitializationParams->getMetricsRegistry();
+			const bool cpuAffinity = serverInitializationParams->hasCpuAffinity();
+			auto runIoContext = [&iocs, metricsRegistry, cpuAffinity](size_t threadIndex)
+			{
+				if (cpuAffinity) {
+					pinCurrentThread(threadIndex);
+				}
+				if (metricsRegistry) {
+					metricsRegistry->getIoThreadUtilization().registerCurrentThread();
+				}
+				iocs[threadIndex % iocs.size()]->run();
+				if (metricsRegistry) {
+					metricsRegistry->getIoThreadUtilization().unregisterCurrentThread();
+				}
+			};
 			std::vector<std::thread> v;
 			v.reserve(threadCount - 1);
 			for (auto i = threadCount - 1; i > 0; --i)
-				v.emplace_back(
-					[&ioc]
-			{
-				ioc.run();
-			});
-			ioc.run();
+				v.emplace_back(runIoContext, i);
+			runIoContext(0);
+			for (auto& thread : v) {
+				thread.join();
+			}
 		}
 	};
 }
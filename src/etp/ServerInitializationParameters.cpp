@@ -18,8 +18,232 @@ under the License.
 -----------------------------------------------------------------------*/
 #include "ServerInitializationParameters.h"
 
+#include <iomanip>
+#include <sstream>
+
+#include "avro/Compiler.hh"
+
 using namespace ETP_NS;
 
+namespace {
+	const avro::ValidSchema& getServerCapabilitiesSchema()
+	{
+		static const avro::ValidSchema result = avro::compileJsonSchemaFromString(
+			"{"
+			"  \"type\": \"record\","
+			"  \"name\": \"ServerCapabilities\","
+			"  \"fields\": ["
+			"	{"
+			"	  \"name\": \"applicationName\","
+			"	  \"type\": \"string\""
+			"	},"
+			"	{"
+			"	  \"name\": \"applicationVersion\","
+			"	  \"type\": \"string\""
+			"	},"
+			"	{"
+			"	  \"name\": \"contactInformation\","
+			"	  \"type\": {"
+			"		\"type\": \"record\","
+			"       \"name\": \"Contact\","
+			"		\"fields\": ["
+			"		  {"
+			"		    \"name\": \"organizationName\","
+			"		    \"type\": \"string\""
+			"		  },"
+			"		  {"
+			"		    \"name\": \"contactName\","
+			"		    \"type\": \"string\""
+			"		  },"
+			"		  {"
+			"		    \"name\": \"contactPhone\","
+			"		    \"type\": \"string\""
+			"		  },"
+			"		  {"
+			"		    \"name\": \"contactEmail\","
+			"		    \"type\": \"string\""
+			"		  }"
+			"		]"
+			"	  }"
+			"	},"
+			"	{"
+			"	  \"name\": \"supportedCompression\","
+			"	  \"type\": {"
+			"		\"type\": \"array\","
+			"		\"items\": \"string\""
+			"	  }"
+			"	},"
+			"	{"
+			"	  \"name\": \"supportedEncodings\","
+			"	  \"type\": {"
+			"		\"type\": \"array\","
+			"		\"items\": \"string\""
+			"	  }"
+			"	},"
+			"	{"
+			"	  \"name\": \"supportedFormats\","
+			"	  \"type\": {"
+			"		\"type\": \"array\","
+			"		\"items\": \"string\""
+			"	  }"
+			"	},"
+			"	{"
+			"	  \"name\": \"supportedDataObjects\","
+			"	  \"type\": {"
+			"		\"type\": \"array\","
+			"		\"items\": {"
+			"		  \"type\": \"record\","
+			"		  \"name\" : \"SupportedDataObject\","
+			"		  \"fields\" : ["
+			"		    {"
+			"			  \"name\": \"qualifiedType\","
+			"			  \"type\" : \"string\""
+			"		    },"
+			"		    {"
+			"			  \"name\": \"dataObjectCapabilities\","
+			"			  \"type\" : {"
+			"			    \"type\": \"map\","
+			"			    \"values\": {"
+			"				  \"type\": \"record\","
+			"				  \"name\": \"DataValue\","
+			"				  \"fields\": ["
+			"					{"
+			"					  \"name\": \"item\","
+			"					  \"type\": ["
+			"						\"null\","
+			"						\"boolean\","
+			"						\"int\","
+			"						\"long\","
+			"						\"float\","
+			"						\"double\","
+			"						\"string\","
+			"						\"bytes\""
+			"					  ]"
+			"					}"
+			"				  ]"
+			"				}"
+			"			  }"
+			"		    }"
+			"		  ]"
+			"	    }"
+			"     }"
+			"	},"
+			"	{"
+			"	  \"name\": \"supportedProtocols\","
+			"	  \"type\": {"
+			"		\"type\": \"array\","
+			"		\"items\": {"
+			"		  \"type\": \"record\","
+			"		  \"name\": \"SupportedProtocol\","
+			"		  \"fields\": ["
+			"			{"
+			"			  \"name\": \"protocol\","
+			"			  \"type\": \"int\""
+			"			},"
+			"			{"
+			"			  \"name\": \"protocolVersion\","
+			"			  \"type\": {"
+			"				\"type\": \"record\","
+			"			    \"name\": \"Version\","
+			"			    \"fields\": ["
+			"				  {"
+			"				    \"name\": \"major\","
+			"				    \"type\": \"int\""
+			"				  },"
+			"				  {"
+			"  				    \"name\": \"minor\","
+			"				    \"type\": \"int\""
+			"				  },"
+			"				  {"
+			"				    \"name\": \"revision\","
+			"				    \"type\": \"int\""
+			"				  },"
+			"				  {"
+			" 				    \"name\": \"patch\","
+			"				    \"type\": \"int\""
+			"				  }"
+			"			    ]"
+			"			  }"
+			"			},"
+			"			{"
+			"			  \"name\": \"role\","
+			"			  \"type\": \"string\""
+			"			},"
+			"			{"
+			"			  \"name\": \"protocolCapabilities\","
+			"			  \"type\": {"
+			"				\"type\": \"map\","
+			"				\"values\": {"
+			"				  \"type\": \"record\","
+			"				  \"name\": \"DataValue\","
+			"				  \"fields\": ["
+			"					{"
+			"					  \"name\": \"item\","
+			"					  \"type\": ["
+			"						\"null\","
+			"						\"boolean\","
+			"						\"int\","
+			"						\"long\","
+			"						\"float\","
+			"						\"double\","
+			"						\"string\","
+			"						\"bytes\""
+			"					  ]"
+			"					}"
+			"				  ]"
+			"				}"
+			"			  }"
+			"			}"
+			"		  ]"
+			"		}"
+			"	  }"
+			"	},"
+			"	{"
+			"	  \"name\": \"endpointCapabilities\","
+			"	  \"type\": {"
+			"		\"type\": \"map\","
+			"		\"values\": {"
+			"		  \"type\": \"record\","
+			"		  \"name\": \"DataValue\","
+			"		  \"fields\": ["
+			"			{"
+			"			  \"name\": \"item\","
+			"			  \"type\": ["
+			"				\"null\","
+			"				\"boolean\","
+			"				\"int\","
+			"				\"long\","
+			"				\"float\","
+			"				\"double\","
+			"				\"string\","
+			"				\"bytes\""
+			"			  ]"
+			"			}"
+			"		  ]"
+			"		}"
+			"	  }"
+			"	}"
+			"  ]"
+			"}"
+		);
+		return result;
+	}
+
+	/**
+	* @return The 64 bits FNV-1a hash of a content, in hexadecimal and between double quotes as an HTTP entity tag.
+	*/
+	std::string makeEntityTag(const std::string& content)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		for (const char c : content) {
+			hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+		}
+		std::ostringstream oss;
+		oss << '"' << std::hex << std::setfill('0') << std::setw(16) << hash << '"';
+		return oss.str();
+	}
+}
+
 std::vector<std::string> ServerInitializationParameters::makeSupportedEncodings() const
 {
 	return std::vector<std::string>(1, "binary");
@@ -61,3 +285,45 @@ std::vector<Energistics::Etp::v12::Datatypes::SupportedProtocol> ServerInitializ
 
 	return result;
 }
+
+std::shared_ptr<const ServerCapabilitiesResponse> ServerInitializationParameters::getServerCapabilitiesResponse() const
+{
+	const uint64_t revision = capabilitiesRevision_;
+	{
+		std::lock_guard<std::mutex> lock(serverCapabilitiesResponseMutex_);
+		if (serverCapabilitiesResponse_ != nullptr && serverCapabilitiesResponseRevision_ == revision) {
+			return serverCapabilitiesResponse_;
+		}
+	}
+
+	// Build the response outside of the lock since the overriden make... methods may be slow.
+	const std::shared_ptr<const SessionCapabilities> capabilities = getSessionCapabilities();
+	Energistics::Etp::v12::Datatypes::ServerCapabilities serverCap;
+	serverCap.applicationName = getApplicationName();
+	serverCap.applicationVersion = getApplicationVersion();
+	serverCap.contactInformation.contactEmail = getContactEmail();
+	serverCap.contactInformation.contactName = getContactName();
+	serverCap.contactInformation.contactPhone = getContactPhone();
+	serverCap.contactInformation.organizationName = getOrganizationName();
+	serverCap.endpointCapabilities = capabilities->getEndpointCapabilities();
+	serverCap.supportedEncodings = makeSupportedEncodings();
+	serverCap.supportedFormats.push_back("xml");
+	serverCap.supportedDataObjects = capabilities->getSupportedDataObjects();
+	serverCap.supportedProtocols = capabilities->getSupportedProtocols();
+
+	std::ostringstream oss;
+	avro::OutputStreamPtr out = avro::ostreamOutputStream(oss);
+	avro::EncoderPtr e = avro::jsonPrettyEncoder(getServerCapabilitiesSchema());
+	e->init(*out);
+	avro::encode(*e, serverCap);
+	e->flush();
+
+	auto result = std::make_shared<ServerCapabilitiesResponse>();
+	result->json = oss.str();
+	result->etag = makeEntityTag(result->json);
+
+	std::lock_guard<std::mutex> lock(serverCapabilitiesResponseMutex_);
+	serverCapabilitiesResponse_ = result;
+	serverCapabilitiesResponseRevision_ = revision;
+	return result;
+}
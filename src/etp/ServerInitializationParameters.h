@@ -18,10 +18,22 @@ under the License.
 -----------------------------------------------------------------------*/
 #pragma once
 
+#include <chrono>
+#include <mutex>
+
 #include "InitializationParameters.h"
 
 namespace ETP_NS
 {
+	/**
+	* The JSON document a server answers to the HTTP discovery of its ETP 1.2 capabilities, with the entity tag identifying its content.
+	*/
+	struct ServerCapabilitiesResponse {
+		std::string json;
+		/// Already between double quotes as expected in the ETag and If-None-Match HTTP headers
+		std::string etag;
+	};
+
 	class ServerInitializationParameters : public InitializationParameters
 	{
 	public:
@@ -45,5 +57,60 @@ namespace ETP_NS
 		FETPAPI_DLL_IMPORT_OR_EXPORT virtual std::vector<std::string> makeSupportedEncodings() const;
 		FETPAPI_DLL_IMPORT_OR_EXPORT std::vector<Energistics::Etp::v12::Datatypes::SupportedProtocol> makeSupportedProtocols() const override;
 
+		/**
+		* Get the response to GET .well-known/etp-server-capabilities?GetVersion=etp12.energistics.org
+		* It is built once from the above methods and built again only after the capabilities have been invalidated (see invalidateCapabilities).
+		* This method is thread safe.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::shared_ptr<const ServerCapabilitiesResponse> getServerCapabilitiesResponse() const;
+
+		/**
+		* Give each server thread its own io_context instead of sharing a single io_context between all the server threads.
+		* On Linux, each io_context also gets its own acceptor on the server port (SO_REUSEPORT) and the kernel balances the connections between them.
+		* Elsewhere, a single acceptor gives the accepted connections to the io_contexts in turn.
+		* A session always runs on the io_context which has accepted its connection.
+		* It removes the contention on a single reactor when there are many sessions but an idle thread can no more help a busy one.
+		*/
+		void setIoContextPerThread(bool value) { ioContextPerThread_ = value; }
+		bool isIoContextPerThread() const { return ioContextPerThread_; }
+
+		/**
+		* Pin the n-th server thread to the n-th CPU (modulo the CPU count).
+		* It is ignored on the platforms other than Linux and Windows.
+		*/
+		void setCpuAffinity(bool value) { cpuAffinity_ = value; }
+		bool hasCpuAffinity() const { return cpuAffinity_; }
+
+		/**
+		* Set how many TLS sessions a TLS server remembers so that its clients resume them with an abbreviated handshake,
+		* by session id or by session ticket. 0 disables the TLS session resumption. It is ignored by a server without TLS.
+		*/
+		void setTlsSessionCacheSize(std::size_t value) { tlsSessionCacheSize_ = value; }
+		std::size_t getTlsSessionCacheSize() const { return tlsSessionCacheSize_; }
+
+		/**
+		* Set how long a TLS session can be resumed after its full handshake.
+		*/
+		void setTlsSessionTimeout(std::chrono::seconds value) { tlsSessionTimeout_ = value; }
+		std::chrono::seconds getTlsSessionTimeout() const { return tlsSessionTimeout_; }
+
+		/**
+		* Set how long a session may stay without receiving any message, except pongs, before the server closes it : see AbstractSession::setIdleTimeOut.
+		* It prevents dead or forgotten client sessions from holding the server resources forever. Zero (default) disables the idle time out.
+		*/
+		void setIdleTimeOut(std::chrono::milliseconds value) { idleTimeOut_ = value; }
+		std::chrono::milliseconds getIdleTimeOut() const { return idleTimeOut_; }
+
+	private:
+		bool ioContextPerThread_ = false;
+		bool cpuAffinity_ = false;
+		std::size_t tlsSessionCacheSize_ = 20480;
+		std::chrono::seconds tlsSessionTimeout_{ 3600 };
+		std::chrono::milliseconds idleTimeOut_{ 0 };
+
+		mutable std::mutex serverCapabilitiesResponseMutex_;
+		mutable std::shared_ptr<const ServerCapabilitiesResponse> serverCapabilitiesResponse_;
+		/// The capabilities revision serverCapabilitiesResponse_ has been built from
+		mutable uint64_t serverCapabilitiesResponseRevision_ = 0;
 	};
 }
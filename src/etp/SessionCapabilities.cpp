@@ -0,0 +1,123 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "SessionCapabilities.h"
+
+#include <unordered_set>
+
+#include <boost/functional/hash.hpp>
+
+#include "InitializationParameters.h"
+
+using namespace ETP_NS;
+
+namespace {
+	/**
+	* @return The family of a qualified type i.e. what is before its dot, for example "resqml20" for "resqml20.obj_IjkGridRepresentation".
+	*/
+	std::string getFamily(const std::string& qualifiedType)
+	{
+		return qualifiedType.substr(0, qualifiedType.find('.'));
+	}
+
+	bool isWildcard(const std::string& qualifiedType)
+	{
+		return qualifiedType.size() > 2 && qualifiedType.compare(qualifiedType.size() - 2, 2, ".*") == 0;
+	}
+}
+
+SessionCapabilities::SessionCapabilities(const InitializationParameters& initializationParams) :
+	supportedProtocols(initializationParams.makeSupportedProtocols()),
+	supportedDataObjects(initializationParams.makeSupportedDataObjects()),
+	endpointCapabilities(initializationParams.makeEndpointCapabilities())
+{
+	protocolIndices.reserve(supportedProtocols.size());
+	for (std::size_t i = 0; i < supportedProtocols.size(); ++i) {
+		// The first one wins as with a linear search
+		protocolIndices.emplace(makeProtocolKey(supportedProtocols[i]), i);
+	}
+
+	dataObjectIndices.reserve(supportedDataObjects.size());
+	for (std::size_t i = 0; i < supportedDataObjects.size(); ++i) {
+		const std::string& qualifiedType = supportedDataObjects[i].qualifiedType;
+		if (dataObjectIndices.emplace(qualifiedType, i).second && !isWildcard(qualifiedType)) {
+			dataObjectFamilyIndices[getFamily(qualifiedType)].push_back(i);
+		}
+	}
+}
+
+std::size_t SessionCapabilities::ProtocolKeyHash::operator()(const ProtocolKey& key) const
+{
+	std::size_t result = std::hash<std::string>()(key.role);
+	boost::hash_combine(result, key.protocol);
+	boost::hash_combine(result, key.major);
+	boost::hash_combine(result, key.minor);
+	boost::hash_combine(result, key.revision);
+	boost::hash_combine(result, key.patch);
+	return result;
+}
+
+SessionCapabilities::ProtocolKey SessionCapabilities::makeProtocolKey(const Energistics::Etp::v12::Datatypes::SupportedProtocol& protocol)
+{
+	return ProtocolKey{ protocol.protocol, protocol.role,
+		protocol.protocolVersion.major, protocol.protocolVersion.minor, protocol.protocolVersion.revision, protocol.protocolVersion.patch };
+}
+
+const Energistics::Etp::v12::Datatypes::SupportedProtocol* SessionCapabilities::findProtocol(const Energistics::Etp::v12::Datatypes::SupportedProtocol& requested) const
+{
+	const auto it = protocolIndices.find(makeProtocolKey(requested));
+	return it == protocolIndices.end() ? nullptr : &supportedProtocols[it->second];
+}
+
+std::vector<Energistics::Etp::v12::Datatypes::SupportedDataObject> SessionCapabilities::matchDataObjects(
+	const std::vector<Energistics::Etp::v12::Datatypes::SupportedDataObject>& requested) const
+{
+	std::vector<Energistics::Etp::v12::Datatypes::SupportedDataObject> result;
+	std::unordered_set<std::string> matchedQualifiedTypes;
+	for (const auto& requestedDataObject : requested) {
+		const std::string& qualifiedType = requestedDataObject.qualifiedType;
+		const auto exactIt = dataObjectIndices.find(qualifiedType);
+		if (exactIt != dataObjectIndices.end()) {
+			if (matchedQualifiedTypes.insert(qualifiedType).second) {
+				result.push_back(supportedDataObjects[exactIt->second]);
+			}
+			continue;
+		}
+
+		const std::string family = getFamily(qualifiedType);
+		if (isWildcard(qualifiedType)) {
+			const auto familyIt = dataObjectFamilyIndices.find(family);
+			if (familyIt != dataObjectFamilyIndices.end()) {
+				for (const std::size_t index : familyIt->second) {
+					if (matchedQualifiedTypes.insert(supportedDataObjects[index].qualifiedType).second) {
+						result.push_back(supportedDataObjects[index]);
+					}
+				}
+			}
+		}
+		else {
+			const auto wildcardIt = dataObjectIndices.find(family + ".*");
+			if (wildcardIt != dataObjectIndices.end() && matchedQualifiedTypes.insert(qualifiedType).second) {
+				result.push_back(supportedDataObjects[wildcardIt->second]);
+				result.back().qualifiedType = qualifiedType;
+			}
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,114 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../nsDefinitions.h"
+#include "EtpMessages.h"
+
+#if defined(_WIN32) && !defined(FETPAPI_STATIC)
+#ifndef FETPAPI_DLL_IMPORT_OR_EXPORT
+#if defined(Fetpapi_EXPORTS)
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllexport)
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllimport)
+#endif
+#endif
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT
+#endif
+
+namespace ETP_NS
+{
+	class InitializationParameters;
+
+	/**
+	* The protocols, data objects and endpoint capabilities of an endpoint, built once from its InitializationParameters
+	* and then shared, read only, by all the sessions negotiated with these parameters.
+	* The protocols and data objects are indexed in hash tables so that negotiating a session does not depend on how many of them are supported.
+	*/
+	class SessionCapabilities
+	{
+	public:
+		/**
+		* Build the capabilities from the make...Capabilities(), makeSupported...() methods of some initialization parameters.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT explicit SessionCapabilities(const InitializationParameters& initializationParams);
+		~SessionCapabilities() = default;
+
+		const std::vector<Energistics::Etp::v12::Datatypes::SupportedProtocol>& getSupportedProtocols() const { return supportedProtocols; }
+		const std::vector<Energistics::Etp::v12::Datatypes::SupportedDataObject>& getSupportedDataObjects() const { return supportedDataObjects; }
+		const std::map<std::string, Energistics::Etp::v12::Datatypes::DataValue>& getEndpointCapabilities() const { return endpointCapabilities; }
+
+		/**
+		* @return The supported protocol which has the same protocol, role and version as the requested one. nullptr if there is none.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT const Energistics::Etp::v12::Datatypes::SupportedProtocol* findProtocol(const Energistics::Etp::v12::Datatypes::SupportedProtocol& requested) const;
+
+		/**
+		* Get the supported data objects matching the data object types requested by the other endpoint.
+		* - An exactly supported qualified type matches itself.
+		* - A qualified type such as "resqml20.obj_IjkGridRepresentation" is also matched by a supported wildcard such as "resqml20.*".
+		*   It is then returned with the requested qualified type and the capabilities of the wildcard.
+		* - A requested wildcard such as "resqml20.*" which is not supported as such matches all the supported qualified types of its family.
+		* A qualified type is returned only once, even if several requested types match it.
+		*
+		* @param requested	The data object types requested by the other endpoint.
+		* @return			The matching supported data objects, in the order of the requested ones.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::vector<Energistics::Etp::v12::Datatypes::SupportedDataObject> matchDataObjects(
+			const std::vector<Energistics::Etp::v12::Datatypes::SupportedDataObject>& requested) const;
+
+	private:
+		struct ProtocolKey {
+			int32_t protocol;
+			std::string role;
+			int32_t major;
+			int32_t minor;
+			int32_t revision;
+			int32_t patch;
+
+			bool operator==(const ProtocolKey& other) const {
+				return protocol == other.protocol && role == other.role &&
+					major == other.major && minor == other.minor && revision == other.revision && patch == other.patch;
+			}
+		};
+
+		struct ProtocolKeyHash {
+			std::size_t operator()(const ProtocolKey& key) const;
+		};
+
+		static ProtocolKey makeProtocolKey(const Energistics::Etp::v12::Datatypes::SupportedProtocol& protocol);
+
+		std::vector<Energistics::Etp::v12::Datatypes::SupportedProtocol> supportedProtocols;
+		std::vector<Energistics::Etp::v12::Datatypes::SupportedDataObject> supportedDataObjects;
+		std::map<std::string, Energistics::Etp::v12::Datatypes::DataValue> endpointCapabilities;
+
+		/// The index of each supported protocol in supportedProtocols
+		std::unordered_map<ProtocolKey, std::size_t, ProtocolKeyHash> protocolIndices;
+		/// The index of each supported qualified type (including the wildcards) in supportedDataObjects
+		std::unordered_map<std::string, std::size_t> dataObjectIndices;
+		/// The indices in supportedDataObjects of the supported qualified types of each family (for example "resqml20")
+		std::unordered_map<std::string, std::vector<std::size_t>> dataObjectFamilyIndices;
+	};
+}
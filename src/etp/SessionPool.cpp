@@ -0,0 +1,229 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "SessionPool.h"
+
+#include <deque>
+#include <stdexcept>
+
+using namespace ETP_NS;
+
+namespace {
+	/// The count of consecutive failed openings of every session after which the pool gives up.
+	const unsigned int maxOpeningAttempts = 5;
+	/// The delay before opening again a session, multiplied by the count of its consecutive failed openings.
+	const std::chrono::milliseconds retryDelay(200);
+	/// How long a session must have stayed opened, unless it has answered a request, for its failure not to count as a failed opening.
+	const std::chrono::milliseconds stableSessionDuration(10000);
+
+	template<class SessionType> std::shared_ptr<AbstractSession> connect(std::shared_ptr<SessionType> session, std::function<void(AbstractSession&, bool)> onReady)
+	{
+		if (session != nullptr) {
+			session->asyncConnect(onReady);
+		}
+		return session;
+	}
+}
+
+SessionPool::SessionOpener SessionPool::makeWsSessionOpener(InitializationParameters* initializationParams, const std::string & authorization,
+	std::shared_ptr<boost::asio::io_context> ioContext,
+	const std::map<std::string, std::string>& additionalHandshakeHeaderFields, std::size_t preferredMaxFrameSize)
+{
+	if (ioContext == nullptr) {
+		throw std::invalid_argument("The sessions of a pool must share an io context.");
+	}
+	return [=](std::function<void(AbstractSession&, bool)> onReady) {
+		return connect(ClientSessionLaunchers::createWsClientSession(initializationParams, authorization, additionalHandshakeHeaderFields, preferredMaxFrameSize, ioContext), onReady);
+	};
+}
+
+#ifdef WITH_ETP_SSL
+SessionPool::SessionOpener SessionPool::makeWssSessionOpener(InitializationParameters* initializationParams, const std::string & authorization,
+	std::shared_ptr<boost::asio::io_context> ioContext,
+	const std::map<std::string, std::string>& additionalHandshakeHeaderFields, std::size_t preferredMaxFrameSize, const std::string & additionalCertificates)
+{
+	if (ioContext == nullptr) {
+		throw std::invalid_argument("The sessions of a pool must share an io context.");
+	}
+	return [=](std::function<void(AbstractSession&, bool)> onReady) {
+		return connect(ClientSessionLaunchers::createWssClientSession(initializationParams, authorization, additionalHandshakeHeaderFields, preferredMaxFrameSize, additionalCertificates, ioContext), onReady);
+	};
+}
+#endif
+
+SessionPool::SessionPool(SessionOpener opener, std::size_t sessionCount, std::size_t maxInFlightPerSession) :
+	opener(opener), maxInFlightPerSession(maxInFlightPerSession), slots(sessionCount), wakeUp(std::make_shared<WakeUp>())
+{
+	if (sessionCount == 0 || maxInFlightPerSession == 0) {
+		throw std::invalid_argument("A session pool needs at least one session and one request in flight per session.");
+	}
+	for (auto& slot : slots) {
+		open(slot);
+	}
+}
+
+SessionPool::~SessionPool()
+{
+	const std::lock_guard<std::mutex> lock(slotsMutex);
+	for (auto& slot : slots) {
+		if (slot.session != nullptr && !slot.session->isWebSocketSessionClosed()) {
+			slot.session->close();
+		}
+	}
+}
+
+std::size_t SessionPool::getOpenedSessionCount() const
+{
+	const std::lock_guard<std::mutex> lock(slotsMutex);
+	std::size_t result = 0;
+	for (const auto& slot : slots) {
+		if (slot.state->load() == Opened && !slot.session->isWebSocketSessionClosed()) {
+			++result;
+		}
+	}
+	return result;
+}
+
+void SessionPool::open(Slot& slot)
+{
+	std::shared_ptr<std::atomic<int>> state = std::make_shared<std::atomic<int>>(Opening);
+	std::shared_ptr<WakeUp> sharedWakeUp = wakeUp;
+	std::shared_ptr<AbstractSession> session = opener([state, sharedWakeUp](AbstractSession&, bool opened) {
+		*state = opened ? Opened : Failed;
+		sharedWakeUp->signal();
+	});
+	if (session == nullptr) {
+		*state = Failed;
+	}
+	else {
+		// No request is sent on the session before it is opened : the listener is always set in time.
+		session->setAnswerListener([sharedWakeUp] { sharedWakeUp->signal(); });
+	}
+
+	const std::lock_guard<std::mutex> lock(slotsMutex);
+	if (slot.session != nullptr && !slot.session->isWebSocketSessionClosed()) {
+		slot.session->close();
+	}
+	slot.session = session;
+	slot.state = state;
+	slot.openingTime = Clock::time_point::max();
+	slot.hasAnswered = false;
+}
+
+void SessionPool::run(std::size_t requestCount, const RequestSender& sendRequest)
+{
+	const std::lock_guard<std::mutex> runLock(runMutex);
+
+	std::deque<std::size_t> pendingRequests;
+	for (std::size_t i = 0; i < requestCount; ++i) {
+		pendingRequests.push_back(i);
+	}
+
+	std::size_t answeredRequestCount = 0;
+	while (answeredRequestCount < requestCount) {
+		bool hasProgressed = false;
+		bool isAlive = false;
+		const Clock::time_point now = Clock::now();
+		// The next time at which a request times out or a session must be opened again, if nothing wakes run up before.
+		Clock::time_point deadline = Clock::time_point::max();
+		for (auto& slot : slots) {
+			if (slot.state->load() == Opened && slot.session->isWebSocketSessionClosed()) {
+				// The session failed after having been opened : replace it right now if it has been working,
+				// otherwise go on with the backoff as if the opening had failed, the server accepting the sessions without serving them for example.
+				*slot.state = Failed;
+				if (slot.hasAnswered || (slot.openingTime != Clock::time_point::max() && now - slot.openingTime >= stableSessionDuration)) {
+					slot.failureCount = 0;
+					slot.retryTime = now;
+				}
+			}
+
+			const int state = slot.state->load();
+			if (state == Failed) {
+				// Send again the requests which have not been answered
+				for (auto it = slot.inFlight.rbegin(); it != slot.inFlight.rend(); ++it) {
+					pendingRequests.push_front(it->requestIndex);
+				}
+				slot.inFlight.clear();
+
+				if (slot.failureCount < maxOpeningAttempts) {
+					isAlive = true;
+					if (now >= slot.retryTime) {
+						++slot.failureCount;
+						slot.retryTime = now + retryDelay * slot.failureCount;
+						++replacedSessionCount;
+						open(slot);
+					}
+					deadline = (std::min)(deadline, slot.retryTime);
+				}
+				continue;
+			}
+			isAlive = true;
+			if (state == Opening) {
+				continue;
+			}
+			if (slot.openingTime == Clock::time_point::max()) {
+				slot.openingTime = now;
+			}
+
+			// Forget the answered requests
+			const auto timeOut = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(slot.session->getTimeOut()));
+			for (auto it = slot.inFlight.begin(); it != slot.inFlight.end();) {
+				if (!slot.session->isMessageStillProcessing(it->messageId)) {
+					it = slot.inFlight.erase(it);
+					++answeredRequestCount;
+					slot.hasAnswered = true;
+					hasProgressed = true;
+				}
+				else if (now - it->sendingTime > timeOut) {
+					throw std::runtime_error("Time out waiting for a response of message id " + std::to_string(it->messageId));
+				}
+				else {
+					deadline = (std::min)(deadline, it->sendingTime + timeOut);
+					++it;
+				}
+			}
+
+			// Send some pending requests
+			while (slot.inFlight.size() < maxInFlightPerSession && !pendingRequests.empty()) {
+				const std::size_t requestIndex = pendingRequests.front();
+				pendingRequests.pop_front();
+				InFlightRequest request;
+				request.messageId = sendRequest(*slot.session, requestIndex);
+				request.requestIndex = requestIndex;
+				request.sendingTime = Clock::now();
+				slot.inFlight.push_back(request);
+				hasProgressed = true;
+			}
+		}
+
+		if (!isAlive) {
+			throw std::runtime_error("No session of the pool can be opened anymore.");
+		}
+		if (!hasProgressed) {
+			// The sessions signal each opening, each answer and each closing : nothing needs to be checked before one of them or before the deadline.
+			std::unique_lock<std::mutex> wakeUpLock(wakeUp->mutex);
+			if (deadline == Clock::time_point::max()) {
+				wakeUp->condition.wait(wakeUpLock, [this] { return wakeUp->isSignaled; });
+			}
+			else {
+				wakeUp->condition.wait_until(wakeUpLock, deadline, [this] { return wakeUp->isSignaled; });
+			}
+			wakeUp->isSignaled = false;
+		}
+	}
+}
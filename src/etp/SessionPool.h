@@ -0,0 +1,175 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ClientSessionLaunchers.h"
+
+namespace ETP_NS
+{
+	/**
+	* Several client sessions opened to the same store, on which independent requests are spread.
+	* A single websocket connection is limited by the bandwidth delay product of a single TCP stream :
+	* spreading the blocks of a large data array over several sessions multiplies the throughput.
+	* Each session has at most a given count of requests in flight. A session which fails is closed, its requests in flight
+	* are sent again on the other sessions and a new session replaces it.
+	*/
+	class SessionPool
+	{
+	public:
+		/**
+		* Creates a client session and starts to open it without blocking, calling onReady once it is opened or once it failed
+		* exactly as AbstractClientSession::asyncConnect does. It may return nullptr if the session cannot be created.
+		*/
+		typedef std::function<std::shared_ptr<AbstractSession>(std::function<void(AbstractSession&, bool)> onReady)> SessionOpener;
+
+		/**
+		* Sends a request on a session and returns the ID of the sent message, typically by means of AbstractSession::sendWithSpecificHandler.
+		* The second argument is the index of the request to send.
+		*/
+		typedef std::function<int64_t(AbstractSession&, std::size_t)> RequestSender;
+
+		/**
+		* @return A session opener based on ClientSessionLaunchers::createWsClientSession.
+		*
+		* @param initializationParams	They must live as long as the pool.
+		* @param ioContext				The io context shared by the sessions of the pool, typically the one of an IoContextPool. It cannot be nullptr.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT static SessionOpener makeWsSessionOpener(InitializationParameters* initializationParams, const std::string & authorization,
+			std::shared_ptr<boost::asio::io_context> ioContext,
+			const std::map<std::string, std::string>& additionalHandshakeHeaderFields = {}, std::size_t preferredMaxFrameSize = 4096);
+
+#ifdef WITH_ETP_SSL
+		/**
+		* @return A session opener based on ClientSessionLaunchers::createWssClientSession.
+		*
+		* @param initializationParams	They must live as long as the pool.
+		* @param ioContext				The io context shared by the sessions of the pool, typically the one of an IoContextPool. It cannot be nullptr.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT static SessionOpener makeWssSessionOpener(InitializationParameters* initializationParams, const std::string & authorization,
+			std::shared_ptr<boost::asio::io_context> ioContext,
+			const std::map<std::string, std::string>& additionalHandshakeHeaderFields = {}, std::size_t preferredMaxFrameSize = 4096, const std::string & additionalCertificates = "");
+#endif
+
+		/**
+		* Start to open the sessions of the pool. It does not block.
+		*
+		* @param opener					Opens each session of the pool and each replacing session.
+		* @param sessionCount			The count of sessions of the pool.
+		* @param maxInFlightPerSession	The maximum count of requests waiting for their response on each session.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT SessionPool(SessionOpener opener, std::size_t sessionCount, std::size_t maxInFlightPerSession = 4);
+
+		/**
+		* Close all the sessions of the pool.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT ~SessionPool();
+
+		SessionPool(const SessionPool&) = delete;
+		SessionPool& operator=(const SessionPool&) = delete;
+
+		std::size_t getSessionCount() const { return slots.size(); }
+		std::size_t getMaxInFlightPerSession() const { return maxInFlightPerSession; }
+
+		/**
+		* @return The count of sessions which are currently opened.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::size_t getOpenedSessionCount() const;
+
+		/**
+		* @return How many sessions have been opened again after a failure since the creation of the pool.
+		*/
+		std::size_t getReplacedSessionCount() const { return replacedSessionCount; }
+
+		/**
+		* Send some independent requests spread over the opened sessions of the pool and block until all of them are answered.
+		* A request is sent again on another session if its session fails before answering it : requests must be idempotent,
+		* which is the case of GetDataSubarrays and PutDataSubarrays for example.
+		* Concurrent calls are processed one after the other.
+		*
+		* @param requestCount	The count of requests to send.
+		* @param sendRequest	Sends a request given its index on a session.
+		* @throw std::runtime_error	if a request is not answered within the time out of its session (see AbstractSession::setTimeOut)
+		*							or if no session of the pool can be opened anymore.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void run(std::size_t requestCount, const RequestSender& sendRequest);
+
+	private:
+		typedef std::chrono::steady_clock Clock;
+
+		enum SlotState : int { Opening, Opened, Failed };
+
+		struct InFlightRequest {
+			int64_t messageId;
+			std::size_t requestIndex;
+			Clock::time_point sendingTime;
+		};
+
+		struct Slot {
+			std::shared_ptr<AbstractSession> session;
+			/// Shared with the ready callback of the session, which may be called after the slot has been opened again.
+			std::shared_ptr<std::atomic<int>> state;
+			std::vector<InFlightRequest> inFlight;
+			/// The count of consecutive failed openings, including the sessions which failed before having answered a request or stayed opened long enough
+			unsigned int failureCount = 0;
+			Clock::time_point retryTime;
+			/// When run has seen the current session opened for the first time. The maximum time point until then.
+			Clock::time_point openingTime = Clock::time_point::max();
+			/// True if the current session has answered at least one request
+			bool hasAnswered = false;
+		};
+
+		/**
+		* Wakes up run when a session gets opened or fails to open, when a request gets answered or when a websocket gets closed.
+		* Shared with the ready callbacks and the answer listeners of the sessions, which may be called after the destruction of the pool.
+		*/
+		struct WakeUp {
+			std::mutex mutex;
+			std::condition_variable condition;
+			bool isSignaled = false;
+
+			void signal() {
+				{
+					const std::lock_guard<std::mutex> lock(mutex);
+					isSignaled = true;
+				} // Scope for lock
+				condition.notify_one();
+			}
+		};
+
+		void open(Slot& slot);
+
+		SessionOpener opener;
+		const std::size_t maxInFlightPerSession;
+		std::vector<Slot> slots;
+		std::atomic<std::size_t> replacedSessionCount{ 0 };
+		std::shared_ptr<WakeUp> wakeUp;
+		/// Serializes the calls to run
+		std::mutex runMutex;
+		/// Protects the sessions and states of the slots, which are read by getOpenedSessionCount
+		mutable std::mutex slotsMutex;
+	};
+}
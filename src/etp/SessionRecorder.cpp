@@ -0,0 +1,105 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "SessionRecorder.h"
+
+#include <stdexcept>
+
+using namespace ETP_NS;
+
+namespace {
+	const char MAGIC[] = "FETPREC1";
+	const std::size_t MAGIC_SIZE = sizeof(MAGIC) - 1;
+	const std::size_t RECORD_HEADER_SIZE = 8 + 4 + 1 + 4;
+
+	void writeLittleEndian(uint8_t* buffer, uint64_t value, std::size_t byteCount)
+	{
+		for (std::size_t i = 0; i < byteCount; ++i) {
+			buffer[i] = static_cast<uint8_t>(value >> (8 * i));
+		}
+	}
+
+	uint64_t readLittleEndian(const uint8_t* buffer, std::size_t byteCount)
+	{
+		uint64_t result = 0;
+		for (std::size_t i = 0; i < byteCount; ++i) {
+			result |= static_cast<uint64_t>(buffer[i]) << (8 * i);
+		}
+		return result;
+	}
+}
+
+SessionRecorder::SessionRecorder(const std::string& filePath) :
+	file(filePath, std::ios::out | std::ios::trunc | std::ios::binary),
+	origin(std::chrono::steady_clock::now())
+{
+	if (!file) {
+		throw std::runtime_error("Cannot open the recording file " + filePath);
+	}
+	file.write(MAGIC, MAGIC_SIZE);
+}
+
+void SessionRecorder::record(const void* session, RecordedDirection direction, const uint8_t* data, std::size_t size)
+{
+	const uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+
+	const std::lock_guard<std::mutex> fileLock(fileMutex);
+	const uint32_t stream = streams.emplace(session, static_cast<uint32_t>(streams.size())).first->second;
+
+	uint8_t recordHeader[RECORD_HEADER_SIZE];
+	writeLittleEndian(recordHeader, time, 8);
+	writeLittleEndian(recordHeader + 8, stream, 4);
+	recordHeader[12] = static_cast<uint8_t>(direction);
+	writeLittleEndian(recordHeader + 13, size, 4);
+	file.write(reinterpret_cast<const char*>(recordHeader), RECORD_HEADER_SIZE);
+	file.write(reinterpret_cast<const char*>(data), size);
+}
+
+void SessionRecorder::flush()
+{
+	const std::lock_guard<std::mutex> fileLock(fileMutex);
+	file.flush();
+}
+
+SessionRecordingReader::SessionRecordingReader(const std::string& filePath) :
+	file(filePath, std::ios::in | std::ios::binary)
+{
+	if (!file) {
+		throw std::runtime_error("Cannot open the recording file " + filePath);
+	}
+	char magic[MAGIC_SIZE];
+	if (!file.read(magic, MAGIC_SIZE) || std::string(magic, MAGIC_SIZE) != MAGIC) {
+		throw std::runtime_error("The file " + filePath + " is not a FETPAPI session recording.");
+	}
+}
+
+bool SessionRecordingReader::next(RecordedMessage& result)
+{
+	uint8_t recordHeader[RECORD_HEADER_SIZE];
+	if (!file.read(reinterpret_cast<char*>(recordHeader), RECORD_HEADER_SIZE)) {
+		return false;
+	}
+	result.time = std::chrono::nanoseconds(readLittleEndian(recordHeader, 8));
+	result.stream = static_cast<uint32_t>(readLittleEndian(recordHeader + 8, 4));
+	result.direction = static_cast<RecordedDirection>(recordHeader[12]);
+	result.data.resize(readLittleEndian(recordHeader + 13, 4));
+	if (!file.read(reinterpret_cast<char*>(result.data.data()), result.data.size())) {
+		throw std::runtime_error("The session recording is truncated.");
+	}
+	return true;
+}
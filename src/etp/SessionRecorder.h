@@ -0,0 +1,129 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../nsDefinitions.h"
+
+#if defined(_WIN32) && !defined(FETPAPI_STATIC)
+#ifndef FETPAPI_DLL_IMPORT_OR_EXPORT
+#if defined(Fetpapi_EXPORTS)
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllexport)
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllimport)
+#endif
+#endif
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT
+#endif
+
+namespace ETP_NS
+{
+	enum class RecordedDirection : uint8_t {
+		/// The message has been read from the websocket.
+		Received = 0,
+		/// The message has been completely written on the websocket.
+		Sent = 1
+	};
+
+	struct RecordedMessage
+	{
+		/// The time of the reception or of the sending, relative to the creation of the recorder
+		std::chrono::nanoseconds time;
+		/// A small identifier of the session which has received or sent the message, unique in a recording
+		uint32_t stream;
+		RecordedDirection direction;
+		/// The whole websocket message payload i.e. the encoded message header followed by the encoded message body
+		std::vector<uint8_t> data;
+	};
+
+	/**
+	* Records the raw messages received and sent by the sessions it is set on into a compact binary file
+	* which can later be read with SessionRecordingReader, for example to replay the traffic of a client against a local server.
+	*
+	* The file starts with the 8 bytes "FETPREC1" followed by the records. Each record is made of, in little endian :
+	* - the time in nanoseconds relative to the creation of the recorder (uint64),
+	* - the stream identifier (uint32),
+	* - the direction (uint8),
+	* - the size of the message (uint32),
+	* - the message itself.
+	*
+	* It is thread safe : several sessions can share the same recorder. The writes are buffered, use flush to force them.
+	*/
+	class SessionRecorder
+	{
+	public:
+		/**
+		* @param filePath	The path of the recording file to create. It is overwritten if it already exists.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT SessionRecorder(const std::string& filePath);
+
+		/**
+		* Record a message.
+		*
+		* @param session	The session which has received or sent the message. It is only meant to distinguish sessions.
+		* @param direction	Indicates if the message has been received or sent.
+		* @param data		The whole websocket message payload.
+		* @param size		The size in bytes of data.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void record(const void* session, RecordedDirection direction, const uint8_t* data, std::size_t size);
+
+		/**
+		* Write the buffered records to the file.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void flush();
+
+	private:
+		std::ofstream file;
+		std::mutex fileMutex;
+		/// All times are relative to the creation of the recorder
+		const std::chrono::steady_clock::time_point origin;
+		std::unordered_map<const void*, uint32_t> streams;
+	};
+
+	/**
+	* Reads the records of a file written by a SessionRecorder, in their recording order.
+	*/
+	class SessionRecordingReader
+	{
+	public:
+		/**
+		* @param filePath	The path of the recording file to read.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT SessionRecordingReader(const std::string& filePath);
+
+		/**
+		* Read the next record of the file.
+		*
+		* @param result	The read record. Its data buffer is reused.
+		* @return False if the end of the file has been reached.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT bool next(RecordedMessage& result);
+
+	private:
+		std::ifstream file;
+	};
+}
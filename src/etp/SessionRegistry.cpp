@@ -0,0 +1,116 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "SessionRegistry.h"
+
+#include <stdexcept>
+
+using namespace ETP_NS;
+
+void SessionRegistry::add(std::shared_ptr<AbstractSession> session)
+{
+	const boost::uuids::uuid sessionId = session->identifier;
+	if (sessionId.is_nil()) {
+		throw std::invalid_argument("A session must have an identifier in order to be registered.");
+	}
+
+	{
+		const std::lock_guard<std::mutex> lock(mutex);
+		if (!sessions.emplace(sessionId, session).second) {
+			throw std::invalid_argument("A session with the same identifier is already registered.");
+		}
+		++registeredSessionCount;
+	}
+
+	std::weak_ptr<SessionRegistry> weakRegistry = shared_from_this();
+	try {
+		session->addClosedCallback([weakRegistry, sessionId](AbstractSession&) {
+			std::shared_ptr<SessionRegistry> registry = weakRegistry.lock();
+			if (registry) {
+				registry->remove(sessionId);
+			}
+		});
+	}
+	catch (...) {
+		remove(sessionId);
+		throw;
+	}
+}
+
+bool SessionRegistry::remove(const boost::uuids::uuid& sessionId)
+{
+	std::shared_ptr<AbstractSession> removedSession;
+	const std::lock_guard<std::mutex> lock(mutex);
+	auto it = sessions.find(sessionId);
+	if (it == sessions.end()) {
+		return false;
+	}
+	// The session must not be destroyed while the registry is locked since its destructor may use the registry
+	removedSession = it->second;
+	sessions.erase(it);
+	return true;
+}
+
+std::shared_ptr<AbstractSession> SessionRegistry::find(const boost::uuids::uuid& sessionId) const
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	auto it = sessions.find(sessionId);
+	return it == sessions.end() ? nullptr : it->second;
+}
+
+std::vector<std::shared_ptr<AbstractSession>> SessionRegistry::getSessions() const
+{
+	std::vector<std::shared_ptr<AbstractSession>> result;
+	const std::lock_guard<std::mutex> lock(mutex);
+	result.reserve(sessions.size());
+	for (const auto& entry : sessions) {
+		result.push_back(entry.second);
+	}
+	return result;
+}
+
+void SessionRegistry::forEach(const std::function<void(AbstractSession&)>& function) const
+{
+	for (const auto& session : getSessions()) {
+		function(*session);
+	}
+}
+
+size_t SessionRegistry::size() const
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	return sessions.size();
+}
+
+size_t SessionRegistry::getEtpSessionCount() const
+{
+	size_t result = 0;
+	const std::lock_guard<std::mutex> lock(mutex);
+	for (const auto& entry : sessions) {
+		if (!entry.second->isEtpSessionClosed()) {
+			++result;
+		}
+	}
+	return result;
+}
+
+uint64_t SessionRegistry::getRegisteredSessionCount() const
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	return registeredSessionCount;
+}
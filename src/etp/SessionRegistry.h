@@ -0,0 +1,111 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/uuid/uuid.hpp>
+
+#include "AbstractSession.h"
+
+namespace ETP_NS
+{
+	/**
+	* A thread safe registry of the sessions of a server, indexed by their identifier.
+	* A session is unregistered as soon as its websocket session is closed, whatever the reason.
+	* It must be owned by a std::shared_ptr : the sessions only keep a weak reference to it in order to unregister themselves.
+	*/
+	class SessionRegistry : public std::enable_shared_from_this<SessionRegistry>
+	{
+	public:
+		SessionRegistry() = default;
+		~SessionRegistry() = default;
+
+		/**
+		* Register a session which does not run yet.
+		*
+		* @param session	The session to register. It must have an identifier.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void add(std::shared_ptr<AbstractSession> session);
+
+		/**
+		* Unregister a session before its websocket session closes.
+		*
+		* @return False if no session is registered with this identifier
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT bool remove(const boost::uuids::uuid& sessionId);
+
+		/**
+		* @return The registered session having this identifier, nullptr if there is none.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::shared_ptr<AbstractSession> find(const boost::uuids::uuid& sessionId) const;
+
+		/**
+		* @return A snapshot of the registered sessions. It does not prevent the sessions from being unregistered.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::vector<std::shared_ptr<AbstractSession>> getSessions() const;
+
+		/**
+		* Call a function on each registered session, for example to broadcast a notification.
+		* The function is called on a snapshot of the sessions without locking the registry : it can register or unregister some sessions.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void forEach(const std::function<void(AbstractSession&)>& function) const;
+
+		/**
+		* Send a message to all the registered sessions whose ETP session is opened.
+		*
+		* @return The count of sessions the message has been sent to.
+		*/
+		template<typename T> size_t broadcast(const T& message, int32_t messageFlags = 0x02) const {
+			size_t result = 0;
+			forEach([&](AbstractSession& session) {
+				if (!session.isEtpSessionClosed()) {
+					session.send(message, 0, messageFlags);
+					++result;
+				}
+			});
+			return result;
+		}
+
+		/**
+		* @return The count of registered sessions, including the ones whose ETP session is not opened yet.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT size_t size() const;
+
+		/**
+		* @return The count of registered sessions whose ETP session is opened.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT size_t getEtpSessionCount() const;
+
+		/**
+		* @return The count of sessions which have ever been registered.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT uint64_t getRegisteredSessionCount() const;
+
+	private:
+		mutable std::mutex mutex;
+		std::unordered_map<boost::uuids::uuid, std::shared_ptr<AbstractSession>, boost::hash<boost::uuids::uuid>> sessions;
+		uint64_t registeredSessionCount = 0;
+	};
+}
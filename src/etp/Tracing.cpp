@@ -0,0 +1,99 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "Tracing.h"
+
+#include <stdexcept>
+
+using namespace ETP_NS;
+
+ChromeTraceFileExporter::ChromeTraceFileExporter(const std::string& filePath) :
+	file(filePath, std::ios::out | std::ios::trunc),
+	origin(std::chrono::steady_clock::now())
+{
+	if (!file) {
+		throw std::runtime_error("Cannot open the trace file " + filePath);
+	}
+	file << "[\n";
+}
+
+ChromeTraceFileExporter::~ChromeTraceFileExporter()
+{
+	const std::lock_guard<std::mutex> fileLock(fileMutex);
+	file << "\n]\n";
+}
+
+void ChromeTraceFileExporter::flush()
+{
+	const std::lock_guard<std::mutex> fileLock(fileMutex);
+	file.flush();
+}
+
+void ChromeTraceFileExporter::writeEventStart(const char* name, const char* phase, std::chrono::steady_clock::time_point time, const TraceRecord& traceRecord)
+{
+	auto inserted = threadIds.emplace(std::this_thread::get_id(), threadIds.size() + 1);
+
+	if (!isFirstEvent) {
+		file << ",\n";
+	}
+	isFirstEvent = false;
+
+	file << "{\"name\":\"" << name << "\",\"ph\":\"" << phase
+		<< "\",\"ts\":" << std::chrono::duration<double, std::micro>(time - origin).count()
+		<< ",\"pid\":1,\"tid\":" << inserted.first->second
+		<< ",\"args\":{\"session\":\"" << traceRecord.session
+		<< "\",\"messageId\":" << traceRecord.messageId
+		<< ",\"correlationId\":" << traceRecord.correlationId
+		<< ",\"protocol\":" << traceRecord.protocol
+		<< ",\"messageType\":" << traceRecord.messageType
+		<< ",\"messageFlags\":" << traceRecord.messageFlags
+		<< ",\"byteCount\":" << traceRecord.byteCount << '}';
+}
+
+void ChromeTraceFileExporter::record(const TraceRecord& traceRecord)
+{
+	const std::lock_guard<std::mutex> fileLock(fileMutex);
+
+	switch (traceRecord.event) {
+	case TraceEvent::MessageQueued:
+		writeEventStart("Queued", "i", traceRecord.time, traceRecord);
+		file << ",\"cat\":\"message\",\"s\":\"t\"}";
+		if (traceRecord.correlationId == 0) {
+			// A request : open a span which is closed when its final response has been handled.
+			writeEventStart("Request", "b", traceRecord.time, traceRecord);
+			file << ",\"cat\":\"request\",\"id\":\"" << traceRecord.session << '-' << traceRecord.messageId << "\"}";
+		}
+		break;
+	case TraceEvent::MessageWritten:
+		writeEventStart("Written", "i", traceRecord.time, traceRecord);
+		file << ",\"cat\":\"message\",\"s\":\"t\"}";
+		break;
+	case TraceEvent::MessageReceived:
+		writeEventStart("Received", "i", traceRecord.time, traceRecord);
+		file << ",\"cat\":\"message\",\"s\":\"t\"}";
+		break;
+	case TraceEvent::HandlerCompleted:
+		writeEventStart("Handle", "X", traceRecord.receptionTime, traceRecord);
+		file << ",\"cat\":\"handler\",\"dur\":" << std::chrono::duration<double, std::micro>(traceRecord.time - traceRecord.receptionTime).count() << '}';
+		if (traceRecord.correlationId != 0 && (traceRecord.messageFlags & 0x02) != 0) {
+			writeEventStart("Request", "e", traceRecord.time, traceRecord);
+			file << ",\"cat\":\"request\",\"id\":\"" << traceRecord.session << '-' << traceRecord.correlationId << "\"}";
+		}
+		break;
+	}
+}
@@ -0,0 +1,129 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "../nsDefinitions.h"
+
+#if defined(_WIN32) && !defined(FETPAPI_STATIC)
+#ifndef FETPAPI_DLL_IMPORT_OR_EXPORT
+#if defined(Fetpapi_EXPORTS)
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllexport)
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllimport)
+#endif
+#endif
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT
+#endif
+
+namespace ETP_NS
+{
+	/**
+	* The steps of the life of an ETP message which are traced.
+	*/
+	enum class TraceEvent : int {
+		/// The message has been encoded and put in the sending queue.
+		MessageQueued = 0,
+		/// The message has been completely written on the websocket.
+		MessageWritten = 1,
+		/// The message has been read from the websocket and its header has been decoded.
+		MessageReceived = 2,
+		/// The handlers of a received message have returned.
+		HandlerCompleted = 3
+	};
+
+	struct TraceRecord
+	{
+		TraceEvent event;
+		/// The time of the event
+		std::chrono::steady_clock::time_point time;
+		/// Only for HandlerCompleted : the time when the handled message has been received
+		std::chrono::steady_clock::time_point receptionTime;
+		/// The session where the event happened. It is only meant to distinguish sessions.
+		const void* session;
+		int64_t messageId;
+		int64_t correlationId;
+		int32_t protocol;
+		int32_t messageType;
+		int32_t messageFlags;
+		/// The size in bytes of the whole message, including its header
+		std::size_t byteCount;
+	};
+
+	/**
+	* Receives the trace records of the sessions it is set on.
+	* Implementations must be thread safe since they are called from the io context and the handler dispatcher threads.
+	*/
+	class Tracer
+	{
+	public:
+		virtual ~Tracer() = default;
+
+		virtual void record(const TraceRecord& traceRecord) = 0;
+	};
+
+	/**
+	* Writes the trace records into a file which can be loaded in chrome://tracing or https://ui.perfetto.dev
+	* Each event is an instant event; requests are also drawn as asynchronous spans going from their queuing to the completion of the handler of their final response,
+	* and the handling of each received message is drawn as a complete event.
+	*/
+	class ChromeTraceFileExporter : public Tracer
+	{
+	public:
+		/**
+		* @param filePath	The path of the JSON file to create. It is overwritten if it already exists.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT ChromeTraceFileExporter(const std::string& filePath);
+
+		/**
+		* Terminate the JSON array and close the file.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT ~ChromeTraceFileExporter();
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT void record(const TraceRecord& traceRecord) final;
+
+		/**
+		* Write the buffered events to the file.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void flush();
+
+	private:
+		/**
+		* Write the beginning of a trace event, up to its arguments.
+		* Must be called with fileMutex locked.
+		*/
+		void writeEventStart(const char* name, const char* phase, std::chrono::steady_clock::time_point time, const TraceRecord& traceRecord);
+
+		std::ofstream file;
+		std::mutex fileMutex;
+		bool isFirstEvent = true;
+		/// All timestamps are relative to the creation of the exporter
+		const std::chrono::steady_clock::time_point origin;
+		/// Small and stable identifiers of the threads, as expected by the trace viewers
+		std::map<std::thread::id, std::size_t> threadIds;
+	};
+}
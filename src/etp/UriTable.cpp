@@ -0,0 +1,120 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "UriTable.h"
+
+#include <boost/functional/hash.hpp>
+
+using namespace ETP_NS;
+
+std::size_t UriTable::StringViewHash::operator()(boost::string_view value) const
+{
+	return boost::hash_range(value.begin(), value.end());
+}
+
+UriTable::Id UriTable::intern(boost::string_view uri)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	const auto it = ids.find(uri);
+	if (it != ids.end()) {
+		return it->second;
+	}
+	if (uris.size() > (std::numeric_limits<Id>::max)()) {
+		throw std::length_error("The URI table is full.");
+	}
+	const Id result = static_cast<Id>(uris.size());
+	uris.emplace_back(uri.data(), uri.size());
+	ids.emplace(boost::string_view(uris.back()), result);
+	return result;
+}
+
+bool UriTable::find(boost::string_view uri, Id& id) const
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	const auto it = ids.find(uri);
+	if (it == ids.end()) {
+		return false;
+	}
+	id = it->second;
+	return true;
+}
+
+const std::string& UriTable::getUri(Id id) const
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	if (id >= uris.size()) {
+		throw std::out_of_range("No URI has been interned with the identifier " + std::to_string(id));
+	}
+	return uris[id];
+}
+
+std::size_t UriTable::size() const
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	return uris.size();
+}
+
+void UriTable::fillUriMap(const std::vector<Id>& idsToFill, std::map<std::string, std::string>& result) const
+{
+	CompactKeyMapBuilder<std::string> builder(result, idsToFill.size());
+	const std::lock_guard<std::mutex> lock(mutex);
+	for (const Id id : idsToFill) {
+		if (id >= uris.size()) {
+			throw std::out_of_range("No URI has been interned with the identifier " + std::to_string(id));
+		}
+		builder.append() = uris[id];
+	}
+}
+
+unsigned int ETP_NS::getCompactKeyWidth(std::size_t entryCount)
+{
+	unsigned int result = 1;
+	for (std::size_t greatestIndex = entryCount > 0 ? entryCount - 1 : 0; greatestIndex >= 10; greatestIndex /= 10) {
+		++result;
+	}
+	return result;
+}
+
+std::string ETP_NS::makeCompactKey(std::size_t index, unsigned int width)
+{
+	std::string result(width, '0');
+	for (std::size_t i = width; i > 0 && index > 0; --i) {
+		result[i - 1] = static_cast<char>('0' + index % 10);
+		index /= 10;
+	}
+	if (index > 0) {
+		throw std::out_of_range("The index does not fit in a compact key of width " + std::to_string(width));
+	}
+	return result;
+}
+
+bool ETP_NS::parseCompactKey(boost::string_view key, std::size_t& index)
+{
+	if (key.empty() || key.size() > std::numeric_limits<std::size_t>::digits10) {
+		return false;
+	}
+	std::size_t result = 0;
+	for (const char c : key) {
+		if (c < '0' || c > '9') {
+			return false;
+		}
+		result = result * 10 + static_cast<std::size_t>(c - '0');
+	}
+	index = result;
+	return true;
+}
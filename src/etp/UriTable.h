@@ -0,0 +1,183 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/utility/string_view.hpp>
+
+#include "../nsDefinitions.h"
+
+#if defined(_WIN32) && !defined(FETPAPI_STATIC)
+#ifndef FETPAPI_DLL_IMPORT_OR_EXPORT
+#if defined(Fetpapi_EXPORTS)
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllexport)
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllimport)
+#endif
+#endif
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT
+#endif
+
+namespace ETP_NS
+{
+	/**
+	* A thread safe table of interned URIs : each distinct URI is stored once and identified by a small integer.
+	* The requests which use the same URIs over and over (for example GetDataArrays on the arrays of a few data objects)
+	* can keep the identifiers instead of the strings, and the answers can be matched back to the URIs without comparing them.
+	* The interned URIs are never removed : the references returned by getUri stay valid as long as the table.
+	*/
+	class UriTable
+	{
+	public:
+		typedef uint32_t Id;
+
+		UriTable() = default;
+		~UriTable() = default;
+		UriTable(const UriTable&) = delete;
+		UriTable& operator=(const UriTable&) = delete;
+
+		/**
+		* Intern a URI.
+		*
+		* @return The identifier of the URI, which is the same for all the calls with the same URI.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT Id intern(boost::string_view uri);
+
+		/**
+		* Look for an already interned URI without interning it.
+		*
+		* @param id	Set to the identifier of the URI if it is found.
+		* @return False if the URI has not been interned.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT bool find(boost::string_view uri, Id& id) const;
+
+		/**
+		* @return The interned URI having this identifier.
+		* @throw std::out_of_range if no URI has been interned with this identifier.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT const std::string& getUri(Id id) const;
+
+		/**
+		* @return The count of interned URIs.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::size_t size() const;
+
+		/**
+		* Fill the uris map of a GetDataObjects or DeleteDataObjects message with some interned URIs.
+		* The key of each URI is the compact key of its index in ids (see makeCompactKey),
+		* so that the response maps can be matched back to ids with parseCompactKey.
+		*
+		* @param ids	The identifiers of the URIs to put in the map.
+		* @param uris	The map to fill. It is cleared first.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void fillUriMap(const std::vector<Id>& ids, std::map<std::string, std::string>& uris) const;
+
+	private:
+		struct StringViewHash {
+			std::size_t operator()(boost::string_view value) const;
+		};
+
+		mutable std::mutex mutex;
+		/// The interned URIs, indexed by their identifier. A deque never moves its elements when it grows.
+		std::deque<std::string> uris;
+		/// The identifiers of the interned URIs. The keys are views on the elements of uris.
+		std::unordered_map<boost::string_view, Id, StringViewHash> ids;
+	};
+
+	/**
+	* The compact keys of the maps of the ETP messages (GetDataObjects, DeleteDataObjects, GetDataArrays...).
+	* ETP lets the requester choose these keys and echoes them in the responses. A compact key is the decimal index of the entry,
+	* zero padded to the count of digits of the greatest index of the map : it is short enough to be stored in a std::string without any allocation
+	* and the order of the keys is the order of the indices, which allows to append the entries at the end of the map without any key comparison.
+	*/
+
+	/**
+	* @return The count of digits of the compact keys of a map having this count of entries.
+	*/
+	FETPAPI_DLL_IMPORT_OR_EXPORT unsigned int getCompactKeyWidth(std::size_t entryCount);
+
+	/**
+	* @return The compact key of the entry at this index.
+	*/
+	FETPAPI_DLL_IMPORT_OR_EXPORT std::string makeCompactKey(std::size_t index, unsigned int width);
+
+	/**
+	* Get back the index of an entry from its compact key, whatever its width.
+	*
+	* @return False if the key is not a compact key.
+	*/
+	FETPAPI_DLL_IMPORT_OR_EXPORT bool parseCompactKey(boost::string_view key, std::size_t& index);
+
+	/**
+	* Append the entries of a map of an ETP message with compact keys.
+	* The map is cleared at construction and each entry is inserted at the end of the map in constant time.
+	* Example :
+	*	Energistics::Etp::v12::Protocol::DataArray::GetDataArrays msg;
+	*	CompactKeyMapBuilder<Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier> builder(msg.dataArrays, pathsInResource.size());
+	*	for (const auto& path : pathsInResource) {
+	*		auto& dai = builder.append();
+	*		dai.uri = uriTable.getUri(uriId);
+	*		dai.pathInResource = path;
+	*	}
+	*/
+	template<typename T> class CompactKeyMapBuilder
+	{
+	public:
+		/**
+		* @param entryCount	The count of entries which will be appended. More entries cannot be appended.
+		*/
+		CompactKeyMapBuilder(std::map<std::string, T>& map, std::size_t entryCount) :
+			map(map), entryCount(entryCount), width(getCompactKeyWidth(entryCount)) {
+			map.clear();
+		}
+
+		/**
+		* Append a default constructed value.
+		*
+		* @return The appended value, to be filled by the caller.
+		*/
+		T& append() {
+			if (index >= entryCount) {
+				throw std::out_of_range("Cannot append more than " + std::to_string(entryCount) + " entries to this map.");
+			}
+			return map.emplace_hint(map.end(), makeCompactKey(index++, width), T())->second;
+		}
+
+		/**
+		* @return The index of the next appended entry.
+		*/
+		std::size_t getIndex() const { return index; }
+
+	private:
+		std::map<std::string, T>& map;
+		const std::size_t entryCount;
+		const unsigned int width;
+		std::size_t index = 0;
+	};
+}
@@ -133,39 +133,16 @@ void FesapiHdfProxy::writeSubArrayNd(
 
 	// [Base Condition] Array size is OK to be transmitted.
 	if ((totalCount * sizeof(T)) <= maxArraySize_) {
-
-		// PUT DATA SUBARRAYS
-		Energistics::Etp::v12::Protocol::DataArray::PutDataSubarrays pdsa{};
-		pdsa.dataSubarrays["0"].uid.uri = uri;
-		pdsa.dataSubarrays["0"].uid.pathInResource = pathInResource;
-		pdsa.dataSubarrays["0"].starts = starts;
-		pdsa.dataSubarrays["0"].counts = counts;
-
-		// Cast values in T values.
-		const T* typeValues{ static_cast<const T*>(values) };
-
-		// Create 1D Array for Sub Values.
-		T* subValues = new T[totalCount];
-		size_t valueIndex{ 0 };
-
-		// Recursively populate subValues starting from first dimension.
-		populateSubValuesNd<T>(
-			0,
-			totalCounts, starts, counts,
-			valueIndex, typeValues, subValues);
-
-		// Create AVRO Array
-		Energistics::Etp::v12::Datatypes::AnyArray data;
-		createAnyArray<T>(data, totalCount, subValues); // Type-specific code is written in explicit specializations for createAnyArray().
-		pdsa.dataSubarrays["0"].data = data;
+		if (collectedSubarrays_ != nullptr) {
+			// The subarrays are sent later on the sessions of the pool.
+			collectedSubarrays_->push_back(std::make_pair(starts, counts));
+			return;
+		}
 
 		std::cout << "Writing subarray..." << std::endl;
 
 		// Send putDataSubarrays Message
-		session_->sendAndBlock(pdsa, 0, 0x02);
-
-		// Delete Array
-		delete[] subValues;
+		session_->sendAndBlock(buildPutDataSubarraysMessage<T>(uri, pathInResource, totalCounts, starts, counts, values), 0, 0x02);
 	}
 	// [Divide and Conquer Approach] If sub array is still large, partition it into more sub arrays.
 	else {
@@ -177,6 +154,79 @@ void FesapiHdfProxy::writeSubArrayNd(
 	}
 }
 
+template<typename T>
+Energistics::Etp::v12::Protocol::DataArray::PutDataSubarrays FesapiHdfProxy::buildPutDataSubarraysMessage(
+	const std::string& uri,
+	const std::string& pathInResource,
+	std::vector<int64_t>& totalCounts,
+	std::vector<int64_t> starts,
+	std::vector<int64_t> counts,
+	const void* values)
+{
+	size_t totalCount{ 1 };
+	for (const auto& count : counts) {
+		totalCount *= count;
+	}
+
+	// PUT DATA SUBARRAYS
+	Energistics::Etp::v12::Protocol::DataArray::PutDataSubarrays pdsa{};
+	pdsa.dataSubarrays["0"].uid.uri = uri;
+	pdsa.dataSubarrays["0"].uid.pathInResource = pathInResource;
+	pdsa.dataSubarrays["0"].starts = starts;
+	pdsa.dataSubarrays["0"].counts = counts;
+
+	// Cast values in T values.
+	const T* typeValues{ static_cast<const T*>(values) };
+
+	// Create 1D Array for Sub Values.
+	std::unique_ptr<T[]> subValues(new T[totalCount]);
+	size_t valueIndex{ 0 };
+
+	// Recursively populate subValues starting from first dimension.
+	populateSubValuesNd<T>(
+		0,
+		totalCounts, starts, counts,
+		valueIndex, typeValues, subValues.get());
+
+	// Create AVRO Array
+	createAnyArray<T>(pdsa.dataSubarrays["0"].data, totalCount, subValues.get()); // Type-specific code is written in explicit specializations for createAnyArray().
+
+	return pdsa;
+}
+
+template<typename T>
+void FesapiHdfProxy::writeSubArraysNd(
+	const std::string& uri,
+	const std::string& pathInResource,
+	std::vector<int64_t>& totalCounts,
+	const void* values)
+{
+	const std::vector<int64_t> starts(totalCounts.size(), 0);
+	if (sessionPool_ == nullptr) {
+		writeSubArrayNd<T>(uri, pathInResource, totalCounts, starts, totalCounts, values);
+		return;
+	}
+
+	// Collect all the subarrays first and then spread them over the sessions of the pool.
+	std::vector<std::pair<std::vector<int64_t>, std::vector<int64_t>>> subarrays;
+	collectedSubarrays_ = &subarrays;
+	try {
+		writeSubArrayNd<T>(uri, pathInResource, totalCounts, starts, totalCounts, values);
+	}
+	catch (...) {
+		collectedSubarrays_ = nullptr;
+		throw;
+	}
+	collectedSubarrays_ = nullptr;
+
+	std::cout << "Writing " << subarrays.size() << " subarrays on " << sessionPool_->getSessionCount() << " sessions..." << std::endl;
+	sessionPool_->run(subarrays.size(), [&](AbstractSession& session, size_t index) {
+		return session.send(
+			buildPutDataSubarraysMessage<T>(uri, pathInResource, totalCounts, subarrays[index].first, subarrays[index].second, values),
+			0, 0x02);
+	});
+}
+
 template<typename T>
 void FesapiHdfProxy::populateSubValuesNd(
 	size_t dimensionIndex,
@@ -532,57 +582,35 @@ void FesapiHdfProxy::writeArrayNd(const std::string & groupName,
 		std::cout << "Writing Subarrays: This may take some time." << std::endl;
 		std::cout << "Please wait..." << std::endl;
 
-		// Initial Starts and Counts
-		std::vector<int64_t> starts{};
+		// Initial Counts
 		std::vector<int64_t> counts{};
 
 		for (size_t i = 0; i < numDimensions; ++i) {
-			starts.push_back(0);
 			counts.push_back(numValuesInEachDimension[i]);
 		}
 
 		// Recursively Write Subarrays
 		if (datatype == COMMON_NS::AbstractObject::numericalDatatypeEnum::DOUBLE) {
-			writeSubArrayNd<double>(uri, pathInResource, counts,
-				starts,
-				counts,
-				values);
+			writeSubArraysNd<double>(uri, pathInResource, counts, values);
 		}
 		else if (datatype == COMMON_NS::AbstractObject::numericalDatatypeEnum::FLOAT) {
-			writeSubArrayNd<float>(uri, pathInResource, counts,
-				starts,
-				counts,
-				values);
+			writeSubArraysNd<float>(uri, pathInResource, counts, values);
 		}
 		else if (datatype == COMMON_NS::AbstractObject::numericalDatatypeEnum::INT64 || 
 			datatype == COMMON_NS::AbstractObject::numericalDatatypeEnum::UINT64) {
-			writeSubArrayNd<int64_t>(uri, pathInResource, counts,
-				starts,
-				counts,
-				values);
+			writeSubArraysNd<int64_t>(uri, pathInResource, counts, values);
 		}
 		else if (datatype == COMMON_NS::AbstractObject::numericalDatatypeEnum::INT32 || 
 			datatype == COMMON_NS::AbstractObject::numericalDatatypeEnum::UINT32) {
-			writeSubArrayNd<int32_t>(uri, pathInResource, counts,
-				starts,
-				counts,
-				values);
+			writeSubArraysNd<int32_t>(uri, pathInResource, counts, values);
 		}
 		else if (datatype == COMMON_NS::AbstractObject::numericalDatatypeEnum::INT16 || 
 			datatype == COMMON_NS::AbstractObject::numericalDatatypeEnum::UINT16) {
-			writeSubArrayNd<short>(
-				uri, pathInResource, counts,
-				starts,
-				counts,
-				values);
+			writeSubArraysNd<short>(uri, pathInResource, counts, values);
 		}
 		else if (datatype == COMMON_NS::AbstractObject::numericalDatatypeEnum::INT8 || 
 			datatype == COMMON_NS::AbstractObject::numericalDatatypeEnum::UINT8) {
-			writeSubArrayNd<char>(
-				uri, pathInResource, counts,
-				starts,
-				counts,
-				values);
+			writeSubArraysNd<char>(uri, pathInResource, counts, values);
 		}
 		else {
 			throw logic_error(
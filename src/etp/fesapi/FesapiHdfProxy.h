@@ -22,6 +22,7 @@ under the License.
 
 #include "../AbstractSession.h"
 #include "../ProtocolHandlers/GetFullDataArrayHandlers.h"
+#include "../SessionPool.h"
 
 #include <type_traits>
 
@@ -71,6 +72,14 @@ namespace ETP_NS
 
 		AbstractSession* getSession() { return session_; }
 
+		/**
+		* Spread the data subarrays which are read or written on the sessions of a pool instead of sending them all on the session of this proxy.
+		* The session of this proxy is still used for all other messages, the data array metadata for example.
+		* @param sessionPool	Sessions opened to the same store as the session of this proxy. nullptr stops using a pool.
+		*/
+		void setSessionPool(std::shared_ptr<SessionPool> sessionPool) { sessionPool_ = sessionPool; }
+		std::shared_ptr<SessionPool> getSessionPool() const { return sessionPool_; }
+
 		/**
 		* Does nothing since the ETP session must already be opened.
 		*/
@@ -148,6 +157,38 @@ namespace ETP_NS
 			std::vector<int64_t> counts,
 			const void* values);
 
+		/**
+		* Build the message putting a sub array of a specific datatype.
+		* @param uri							The uri of the original array.
+		* @param pathInResource					The path of the original array.
+		* @param totalCounts					The total number of values in each dimension of the original array.
+		* @param starts							The starting indices in each dimension of the subarray to be written.
+		* @param counts							The number of values in each dimension of the subarray to be written.
+		* @param values							1d array of specific datatype ordered firstly by fastest direction.
+		*/
+		template<typename T>
+		Energistics::Etp::v12::Protocol::DataArray::PutDataSubarrays buildPutDataSubarraysMessage(
+			const std::string& uri,
+			const std::string& pathInResource,
+			std::vector<int64_t>& totalCounts,
+			std::vector<int64_t> starts,
+			std::vector<int64_t> counts,
+			const void* values);
+
+		/**
+		* Write a whole array of a specific datatype by means of sub arrays, spread over the session pool if any.
+		* @param uri							The uri of the original array.
+		* @param pathInResource					The path of the original array.
+		* @param totalCounts					The total number of values in each dimension of the original array.
+		* @param values							1d array of specific datatype ordered firstly by fastest direction.
+		*/
+		template<typename T>
+		void writeSubArraysNd(
+			const std::string& uri,
+			const std::string& pathInResource,
+			std::vector<int64_t>& totalCounts,
+			const void* values);
+
 		/**
 		* Recursively populate subValues array from original values array.
 		* @param dimensionIndex					The index of dimension in nD array.
@@ -576,6 +617,9 @@ namespace ETP_NS
 		unsigned int compressionLevel;
 		std::string xmlNs_;
 		int maxArraySize_{ 4000000 }; // Bytes
+		std::shared_ptr<SessionPool> sessionPool_;
+		/// When not null, writeSubArrayNd collects the starts and counts of the subarrays here instead of sending them
+		std::vector<std::pair<std::vector<int64_t>, std::vector<int64_t>>>* collectedSubarrays_ = nullptr;
 
 		Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier buildDataArrayIdentifier(const std::string & datasetName) const;
 		Energistics::Etp::v12::Protocol::DataArray::GetDataArrays buildGetDataArraysMessage(const std::string & datasetName) const;
@@ -680,6 +724,22 @@ namespace ETP_NS
 					specializedHandler->setDataSubarrays(subArrayIndexStr, msg.dataSubarrays[subArrayIndexStr]);
 				}
 
+				if (sessionPool_ != nullptr) {
+					// One message per subarray, spread over the sessions of the pool
+					std::vector<const Energistics::Etp::v12::Datatypes::DataArrayTypes::GetDataSubarraysType*> subarrays;
+					for (const auto& subarray : msg.dataSubarrays) {
+						subarrays.push_back(&subarray.second);
+					}
+					sessionPool_->run(subarrays.size(), [&](AbstractSession& session, size_t index) {
+						auto handlers = std::make_shared<GetFullDataArrayHandlers<T>>(&session, values);
+						Energistics::Etp::v12::Protocol::DataArray::GetDataSubarrays request;
+						request.dataSubarrays["0"] = *subarrays[index];
+						handlers->setDataSubarrays("0", *subarrays[index]);
+						return session.sendWithSpecificHandler(request, handlers, 0, 0x02);
+					});
+					return;
+				}
+
 				// Send message
 				const int64_t msgId = session_->sendWithSpecificHandler(
 					msg,
@@ -697,11 +757,18 @@ namespace ETP_NS
 	public:
 		FesapiHdfProxyFactory(AbstractSession* session) : session_(session) {}
 
+		/**
+		* Set the session pool of all the proxies which are made afterwards.
+		* @see FesapiHdfProxy::setSessionPool
+		*/
+		void setSessionPool(std::shared_ptr<SessionPool> sessionPool) { sessionPool_ = sessionPool; }
+
 		/**
 		* Only to be used in partial transfer context
 		*/
 		EML2_NS::AbstractHdfProxy* make(const COMMON_NS::DataObjectReference& dor) {
 			FesapiHdfProxy* result = new FesapiHdfProxy(session_, dor);
+			result->setSessionPool(sessionPool_);
 			return result;
 		}
 
@@ -710,6 +777,7 @@ namespace ETP_NS
 		*/
 		EML2_NS::AbstractHdfProxy* make(gsoap_resqml2_0_1::_eml20__EpcExternalPartReference* fromGsoap) {
 			FesapiHdfProxy* result = new FesapiHdfProxy(session_, fromGsoap);
+			result->setSessionPool(sessionPool_);
 			return result;
 		}
 
@@ -717,10 +785,12 @@ namespace ETP_NS
 			const std::string & packageDirAbsolutePath, const std::string & externalFilePath,
 			COMMON_NS::DataObjectRepository::openingMode hdfPermissionAccess = COMMON_NS::DataObjectRepository::openingMode::READ_ONLY) {
 			FesapiHdfProxy* result = new FesapiHdfProxy(session_, repo, guid, title, packageDirAbsolutePath, externalFilePath, hdfPermissionAccess);
+			result->setSessionPool(sessionPool_);
 			return result;
 		}
 
 	private:
 		AbstractSession* session_;
+		std::shared_ptr<SessionPool> sessionPool_;
 	};
 }
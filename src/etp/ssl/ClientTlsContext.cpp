@@ -0,0 +1,168 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "ClientTlsContext.h"
+
+#include <stdexcept>
+
+using namespace ETP_NS;
+
+namespace {
+	void freeHostKey(void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*)
+	{
+		delete static_cast<std::string*>(ptr);
+	}
+
+	/// The index of the host:port a connection has been prepared for, in the extra data of the connection
+	int getHostKeyIndex()
+	{
+		static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, freeHostKey);
+		return index;
+	}
+
+	/// The index of the ClientTlsContext instance, in the extra data of its native context
+	int getInstanceIndex()
+	{
+		static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+		return index;
+	}
+}
+
+ClientTlsContext::ClientTlsContext(const std::string & additionalCertificates) :
+	context(boost::asio::ssl::context::sslv23_client)
+{
+	context.set_default_verify_paths();
+	context.set_options(
+		boost::asio::ssl::context::default_workarounds
+		| boost::asio::ssl::context::no_sslv2
+		| boost::asio::ssl::context::no_sslv3
+		| boost::asio::ssl::context::single_dh_use
+	);
+
+	if (!additionalCertificates.empty()) {
+		boost::system::error_code ec;
+		context.add_certificate_authority(
+			boost::asio::buffer(additionalCertificates.data(), additionalCertificates.size()), ec);
+		if (ec) {
+			throw std::invalid_argument("Cannot add certificates : " + ec.message());
+		}
+	}
+
+	// The sessions are remembered per host:port by this instance instead of by the OpenSSL internal cache, which is keyed by session id.
+	SSL_CTX* nativeContext = context.native_handle();
+	SSL_CTX_set_ex_data(nativeContext, getInstanceIndex(), this);
+	SSL_CTX_set_session_cache_mode(nativeContext, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+	SSL_CTX_sess_set_new_cb(nativeContext, &ClientTlsContext::onNewSession);
+}
+
+ClientTlsContext::~ClientTlsContext()
+{
+	clearSessions();
+}
+
+std::shared_ptr<ClientTlsContext> ClientTlsContext::getInstance(const std::string & additionalCertificates)
+{
+	static std::mutex instancesMutex;
+	// Never destroyed : the contexts would otherwise be freed at exit after the cleanup of OpenSSL.
+	static auto* instances = new std::map<std::string, std::shared_ptr<ClientTlsContext>>();
+
+	const std::lock_guard<std::mutex> lock(instancesMutex);
+	auto& result = (*instances)[additionalCertificates];
+	if (result == nullptr) {
+		try {
+			result = std::make_shared<ClientTlsContext>(additionalCertificates);
+		}
+		catch (...) {
+			instances->erase(additionalCertificates);
+			throw;
+		}
+	}
+	return result;
+}
+
+bool ClientTlsContext::prepare(SSL* ssl, const std::string & host, const std::string & port)
+{
+	// Set SNI Hostname (many hosts need this to handshake successfully)
+	if (!SSL_set_tlsext_host_name(ssl, host.c_str())) {
+		return false;
+	}
+
+	const std::string hostKey = host + ':' + port;
+	delete static_cast<std::string*>(SSL_get_ex_data(ssl, getHostKeyIndex()));
+	SSL_set_ex_data(ssl, getHostKeyIndex(), new std::string(hostKey));
+
+	if (sessionResumption) {
+		const std::lock_guard<std::mutex> lock(sessionsMutex);
+		const auto it = sessions.find(hostKey);
+		if (it != sessions.end()) {
+			// OpenSSL checks by itself that the session has not expired and makes a full handshake otherwise.
+			SSL_set_session(ssl, it->second);
+		}
+	}
+	return true;
+}
+
+void ClientTlsContext::recordHandshake(SSL* ssl)
+{
+	if (SSL_session_reused(ssl)) {
+		++resumedHandshakeCount;
+	}
+	else {
+		++fullHandshakeCount;
+	}
+}
+
+void ClientTlsContext::setSessionResumption(bool enabled)
+{
+	sessionResumption = enabled;
+	if (!enabled) {
+		clearSessions();
+	}
+}
+
+void ClientTlsContext::clearSessions()
+{
+	const std::lock_guard<std::mutex> lock(sessionsMutex);
+	for (auto& session : sessions) {
+		SSL_SESSION_free(session.second);
+	}
+	sessions.clear();
+}
+
+int ClientTlsContext::onNewSession(SSL* ssl, SSL_SESSION* session)
+{
+	auto* instance = static_cast<ClientTlsContext*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), getInstanceIndex()));
+	const auto* hostKey = static_cast<const std::string*>(SSL_get_ex_data(ssl, getHostKeyIndex()));
+	if (instance == nullptr || hostKey == nullptr || !instance->sessionResumption) {
+		return 0;
+	}
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+	if (!SSL_SESSION_is_resumable(session)) {
+		return 0;
+	}
+#endif
+
+	const std::lock_guard<std::mutex> lock(instance->sessionsMutex);
+	SSL_SESSION*& remembered = instance->sessions[*hostKey];
+	if (remembered != nullptr) {
+		SSL_SESSION_free(remembered);
+	}
+	// Returning 1 keeps the reference OpenSSL gives to the callback.
+	remembered = session;
+	return 1;
+}
@@ -0,0 +1,114 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <boost/asio/ssl.hpp>
+
+#include "../../nsDefinitions.h"
+
+#if defined(_WIN32) && !defined(FETPAPI_STATIC)
+#ifndef FETPAPI_DLL_IMPORT_OR_EXPORT
+#if defined(Fetpapi_EXPORTS)
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllexport)
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllimport)
+#endif
+#endif
+#else
+#define FETPAPI_DLL_IMPORT_OR_EXPORT
+#endif
+
+namespace ETP_NS
+{
+	/**
+	* A TLS context shared by the client connections which trust the same certificate authorities.
+	* It remembers the last TLS session negotiated with each host:port so that the next connection to the same server
+	* resumes it, by session ticket or by session id, with an abbreviated handshake instead of a full one.
+	* This class is thread safe.
+	*/
+	class ClientTlsContext
+	{
+	public:
+		/**
+		* @param additionalCertificates	PEM certificate authorities to trust in addition to the default ones. It may be empty.
+		* @throw std::invalid_argument	if the additional certificates cannot be added.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT explicit ClientTlsContext(const std::string & additionalCertificates = "");
+		FETPAPI_DLL_IMPORT_OR_EXPORT ~ClientTlsContext();
+
+		ClientTlsContext(const ClientTlsContext&) = delete;
+		ClientTlsContext& operator=(const ClientTlsContext&) = delete;
+
+		/**
+		* @return The context shared by the whole process for these additional certificates.
+		* @throw std::invalid_argument	if the additional certificates cannot be added.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT static std::shared_ptr<ClientTlsContext> getInstance(const std::string & additionalCertificates = "");
+
+		boost::asio::ssl::context& getContext() { return context; }
+
+		/**
+		* Prepare a connection to host:port before its TLS handshake : set its SNI host name and offer the last TLS session negotiated with host:port, if any.
+		* The session negotiated by the handshake is then remembered for host:port.
+		*
+		* @param ssl	The native handle of a TLS stream created with the context of this instance.
+		* @return		false if the SNI host name cannot be set.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT bool prepare(SSL* ssl, const std::string & host, const std::string & port);
+
+		/**
+		* Count a successful handshake of a connection as a full or as a resumed one.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void recordHandshake(SSL* ssl);
+
+		uint64_t getFullHandshakeCount() const { return fullHandshakeCount; }
+		uint64_t getResumedHandshakeCount() const { return resumedHandshakeCount; }
+
+		/**
+		* The TLS sessions are resumed by default. Disabling it also forgets the remembered sessions.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void setSessionResumption(bool enabled);
+		bool isSessionResumption() const { return sessionResumption; }
+
+		/**
+		* Forget the remembered TLS sessions.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void clearSessions();
+
+	private:
+		/// Called by OpenSSL when a connection got a new session, possibly after its handshake with TLS 1.3
+		static int onNewSession(SSL* ssl, SSL_SESSION* session);
+
+		boost::asio::ssl::context context;
+		std::atomic<bool> sessionResumption{ true };
+		std::atomic<uint64_t> fullHandshakeCount{ 0 };
+		std::atomic<uint64_t> resumedHandshakeCount{ 0 };
+
+		mutable std::mutex sessionsMutex;
+		/// The last session negotiated with each host:port. A reference of each session is owned by this map.
+		std::map<std::string, SSL_SESSION*> sessions;
+	};
+}
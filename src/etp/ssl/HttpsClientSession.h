@@ -206,5 +206,9 @@ namespace ETP_NS
 		const http::response<http::string_body>& getResponse() const {
 			return res_;
 		}
+
+		ssl::stream<tcp::socket>& getStream() {
+			return stream_;
+		}
 	};
 }
@@ -23,9 +23,37 @@ using namespace ETP_NS;
 
 SslClientSession::SslClientSession(boost::asio::ssl::context& ctx,
 	InitializationParameters* initializationParams, const std::string& target, const std::string& authorization,
-	const std::map<std::string, std::string>& additionalHandshakeHeaderFields, std::size_t frameSize)
-	: AbstractClientSession<SslClientSession>(initializationParams, target, authorization),
+	const std::map<std::string, std::string>& additionalHandshakeHeaderFields, std::size_t frameSize,
+	std::shared_ptr<boost::asio::io_context> ioContext)
+	: AbstractClientSession<SslClientSession>(initializationParams, target, authorization, ioContext),
+#if BOOST_VERSION < 107000
+		// No strand : the io context must be run by a single thread (see IoContextPool).
 		ws_(ioc, ctx)
+#else
+		// The strand serializes the completion handlers of this session when several threads run its io context.
+		ws_(boost::asio::make_strand(ioc), ctx)
+#endif
+{
+	init(additionalHandshakeHeaderFields, frameSize);
+}
+
+SslClientSession::SslClientSession(std::shared_ptr<ClientTlsContext> tlsContext,
+	InitializationParameters* initializationParams, const std::string& target, const std::string& authorization,
+	const std::map<std::string, std::string>& additionalHandshakeHeaderFields, std::size_t frameSize,
+	std::shared_ptr<boost::asio::io_context> ioContext)
+	: AbstractClientSession<SslClientSession>(initializationParams, target, authorization, ioContext),
+		tlsContext_(tlsContext),
+#if BOOST_VERSION < 107000
+		// No strand : the io context must be run by a single thread (see IoContextPool).
+		ws_(ioc, tlsContext->getContext())
+#else
+		ws_(boost::asio::make_strand(ioc), tlsContext->getContext())
+#endif
+{
+	init(additionalHandshakeHeaderFields, frameSize);
+}
+
+void SslClientSession::init(const std::map<std::string, std::string>& additionalHandshakeHeaderFields, std::size_t frameSize)
 {
 	ws_.binary(true);
 #if BOOST_VERSION < 107000
@@ -19,7 +19,9 @@ under the License.
 #pragma once
 
 #include "../AbstractClientSession.h"
+#include "ClientTlsContext.h"
 
+#include <boost/asio/strand.hpp>
 #include <boost/version.hpp>
 #if BOOST_VERSION < 106800
 #include "ssl_stream.h"
@@ -35,15 +37,35 @@ namespace ETP_NS
 	class SslClientSession : public AbstractClientSession<SslClientSession>
 	{
 	private:
+		/// Keeps the TLS context alive and resumes the TLS sessions. It is nullptr if the session has been given a bare ssl::context.
+		std::shared_ptr<ClientTlsContext> tlsContext_;
 		websocket::stream<boost::beast::ssl_stream<tcp::socket>> ws_;
 
+		void init(const std::map<std::string, std::string>& additionalHandshakeHeaderFields, std::size_t frameSize);
+
 	public:
 		/*
+		* @param ctx					It must live as long as the session. Prefer the constructor with a ClientTlsContext which also resumes the TLS sessions.
 		* @param frameSize				Sets the size of the write buffer used by the implementation to send frames : https://www.boost.org/doc/libs/1_75_0/libs/beast/doc/html/beast/ref/boost__beast__websocket__stream/write_buffer_bytes/overload1.html.
+		* @param ioContext				The io context processing this session, which may be shared with other sessions (see IoContextPool).
+		*								nullptr (default) means that the session owns an io context, run by run().
 		*/
 		FETPAPI_DLL_IMPORT_OR_EXPORT SslClientSession(boost::asio::ssl::context& ctx,
 			InitializationParameters* initializationParams, const std::string& target, const std::string& authorization,
-			const std::map<std::string, std::string>& additionalHandshakeHeaderFields = {}, std::size_t frameSize = 4096);
+			const std::map<std::string, std::string>& additionalHandshakeHeaderFields = {}, std::size_t frameSize = 4096,
+			std::shared_ptr<boost::asio::io_context> ioContext = nullptr);
+
+		/*
+		* @param tlsContext				The TLS context, typically shared with other sessions (see ClientTlsContext::getInstance), which resumes the TLS session
+		*								previously negotiated with the same server, if any.
+		* @param frameSize				Sets the size of the write buffer used by the implementation to send frames : https://www.boost.org/doc/libs/1_75_0/libs/beast/doc/html/beast/ref/boost__beast__websocket__stream/write_buffer_bytes/overload1.html.
+		* @param ioContext				The io context processing this session, which may be shared with other sessions (see IoContextPool).
+		*								nullptr (default) means that the session owns an io context, run by run().
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT SslClientSession(std::shared_ptr<ClientTlsContext> tlsContext,
+			InitializationParameters* initializationParams, const std::string& target, const std::string& authorization,
+			const std::map<std::string, std::string>& additionalHandshakeHeaderFields = {}, std::size_t frameSize = 4096,
+			std::shared_ptr<boost::asio::io_context> ioContext = nullptr);
 
 		virtual ~SslClientSession() {}
 
@@ -54,6 +76,8 @@ namespace ETP_NS
 		{
 			if (ec) {
 				std::cerr << "on_resolve : " << ec.message() << std::endl;
+				notifyReady(false);
+				return;
 			}
 
 			// Make the connection on the IP address we get from a lookup
@@ -70,15 +94,30 @@ namespace ETP_NS
 		void on_ssl_connect(boost::system::error_code ec) {
 			if (ec) {
 				std::cerr << "on_ssl_connect : " << ec.message() << std::endl;
+				notifyReady(false);
+				return;
+			}
+
+			if (tlsContext_ != nullptr && !tlsContext_->prepare(ws_.next_layer().native_handle(), host, port)) {
+				std::cerr << "on_ssl_connect : Cannot set the SNI host name " << host << std::endl;
+				notifyReady(false);
+				return;
 			}
 
 			// Perform the SSL handshake
 			ws_.next_layer().async_handshake(
 				boost::asio::ssl::stream_base::client,
 				std::bind(
-					&AbstractClientSession::on_connect,
-					std::static_pointer_cast<AbstractClientSession>(shared_from_this()),
+					&SslClientSession::on_ssl_handshake,
+					std::static_pointer_cast<SslClientSession>(shared_from_this()),
 					std::placeholders::_1));
 		}
+
+		void on_ssl_handshake(boost::system::error_code ec) {
+			if (!ec && tlsContext_ != nullptr) {
+				tlsContext_->recordHandshake(ws_.next_layer().native_handle());
+			}
+			on_connect(ec);
+		}
 	};
 }
@@ -0,0 +1,119 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "FileDataArrayHandlers.h"
+
+#include "../AbstractSession.h"
+#include "../EtpException.h"
+#include "StoreHelpers.h"
+
+using namespace ETP_NS;
+using namespace ETP_NS::StoreHelpers;
+
+void FileDataArrayHandlers::on_GetDataArrays(const Energistics::Etp::v12::Protocol::DataArray::GetDataArrays& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::DataArray::GetDataArraysResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.dataArrays) {
+		try {
+			appendEntry(response.dataArrays, entry.first, store->getDataArray(entry.second, session->getMaxWebSocketMessagePayloadSize()));
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.dataArrays.empty(), errors, correlationId);
+}
+
+void FileDataArrayHandlers::on_PutDataArrays(const Energistics::Etp::v12::Protocol::DataArray::PutDataArrays& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::DataArray::PutDataArraysResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.dataArrays) {
+		try {
+			store->putDataArray(entry.second.uid, entry.second.array);
+			appendEntry(response.success, entry.first);
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.success.empty(), errors, correlationId);
+}
+
+void FileDataArrayHandlers::on_GetDataSubarrays(const Energistics::Etp::v12::Protocol::DataArray::GetDataSubarrays& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::DataArray::GetDataSubarraysResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.dataSubarrays) {
+		try {
+			appendEntry(response.dataSubarrays, entry.first, store->getDataSubarray(entry.second.uid, entry.second.starts, entry.second.counts, session->getMaxWebSocketMessagePayloadSize()));
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.dataSubarrays.empty(), errors, correlationId);
+}
+
+void FileDataArrayHandlers::on_PutDataSubarrays(const Energistics::Etp::v12::Protocol::DataArray::PutDataSubarrays& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::DataArray::PutDataSubarraysResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.dataSubarrays) {
+		try {
+			store->putDataSubarray(entry.second.uid, entry.second.data, entry.second.starts, entry.second.counts);
+			appendEntry(response.success, entry.first);
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.success.empty(), errors, correlationId);
+}
+
+void FileDataArrayHandlers::on_GetDataArrayMetadata(const Energistics::Etp::v12::Protocol::DataArray::GetDataArrayMetadata& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::DataArray::GetDataArrayMetadataResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.dataArrays) {
+		try {
+			appendEntry(response.arrayMetadata, entry.first, store->getDataArrayMetadata(entry.second));
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.arrayMetadata.empty(), errors, correlationId);
+}
+
+void FileDataArrayHandlers::on_PutUninitializedDataArrays(const Energistics::Etp::v12::Protocol::DataArray::PutUninitializedDataArrays& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::DataArray::PutUninitializedDataArraysResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.dataArrays) {
+		try {
+			store->putUninitializedDataArray(entry.second.uid, entry.second.metadata);
+			appendEntry(response.success, entry.first);
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.success.empty(), errors, correlationId);
+}
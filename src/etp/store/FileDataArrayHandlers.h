@@ -0,0 +1,49 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include "../ProtocolHandlers/DataArrayHandlers.h"
+
+#include "FileDataArrayStore.h"
+
+namespace ETP_NS
+{
+	/**
+	* Server side DataArray protocol handlers which answer from a FileDataArrayStore.
+	* The same store can be shared by all the sessions of a server : install these handlers in
+	* ServerInitializationParameters::postSessionCreationOperation, for example after the ones of InMemoryStoreServerInitializationParameters.
+	*/
+	class FETPAPI_DLL_IMPORT_OR_EXPORT FileDataArrayHandlers : public DataArrayHandlers
+	{
+	public:
+		FileDataArrayHandlers(AbstractSession* mySession, std::shared_ptr<FileDataArrayStore> store) :
+			DataArrayHandlers(mySession), store(store) {}
+		virtual ~FileDataArrayHandlers() = default;
+
+		void on_GetDataArrays(const Energistics::Etp::v12::Protocol::DataArray::GetDataArrays& msg, int64_t correlationId) override;
+		void on_PutDataArrays(const Energistics::Etp::v12::Protocol::DataArray::PutDataArrays& msg, int64_t correlationId) override;
+		void on_GetDataSubarrays(const Energistics::Etp::v12::Protocol::DataArray::GetDataSubarrays& msg, int64_t correlationId) override;
+		void on_PutDataSubarrays(const Energistics::Etp::v12::Protocol::DataArray::PutDataSubarrays& msg, int64_t correlationId) override;
+		void on_GetDataArrayMetadata(const Energistics::Etp::v12::Protocol::DataArray::GetDataArrayMetadata& msg, int64_t correlationId) override;
+		void on_PutUninitializedDataArrays(const Energistics::Etp::v12::Protocol::DataArray::PutUninitializedDataArrays& msg, int64_t correlationId) override;
+
+	protected:
+		std::shared_ptr<FileDataArrayStore> store;
+	};
+}
@@ -0,0 +1,580 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "FileDataArrayStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "../EtpException.h"
+#include "StoreHelpers.h"
+
+using namespace ETP_NS;
+using namespace ETP_NS::StoreHelpers;
+
+namespace ETP_NS
+{
+	/**
+	* An opened data array file.
+	*/
+	struct FileDataArray {
+		/// Protects the mapping and the content of the file
+		std::mutex mutex;
+		std::string path;
+		/// The file has been replaced by the one of another instance which must be used instead
+		bool replaced = false;
+		boost::interprocess::file_mapping file;
+		boost::interprocess::mapped_region region;
+
+		// Copies of the header
+		std::vector<int64_t> dimensions;
+		std::vector<int64_t> chunkDimensions;
+		Energistics::Etp::v12::Datatypes::AnyArrayType transportArrayType;
+
+		// Computed from the header
+		std::vector<int64_t> chunkGridDimensions;
+		uint64_t chunkByteCount = 0;
+	};
+}
+
+namespace {
+	const char fileMagic[8] = { 'F', 'E', 'T', 'P', 'A', 'R', 'R', '1' };
+	const uint64_t pageByteCount = 4096;
+	/// Limit the size of the files which are grown geometrically
+	const uint64_t maxFileGrowth = 256 * 1024 * 1024;
+
+	/**
+	* The header at the beginning of a data array file.
+	* It is followed by the dimensions, the chunk dimensions, the data array key, the chunk index and the chunks.
+	* The chunk index contains the offset of each chunk in the row major order of the chunks, zero meaning a chunk which has never been written.
+	*/
+	struct FileDataArrayHeader {
+		char magic[8];
+		int32_t transportArrayType;
+		int32_t logicalArrayType;
+		uint64_t rank;
+		int64_t storeCreated;
+		int64_t storeLastWrite;
+		uint64_t keyByteCount;
+		uint64_t chunkIndexOffset;
+		uint64_t dataOffset;
+		/// The end of the last allocated chunk
+		uint64_t allocatedByteCount;
+	};
+
+	int64_t nowInMicroseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+
+	uint64_t alignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	int64_t getStoredElementByteCount(Energistics::Etp::v12::Datatypes::AnyArrayType type)
+	{
+		if (type == Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfString) {
+			throw EtpException(7, "The file data array store does not support string arrays.");
+		}
+		return getElementByteCount(type);
+	}
+
+	FileDataArrayHeader& getHeader(const FileDataArray& fileDataArray)
+	{
+		return *static_cast<FileDataArrayHeader*>(fileDataArray.region.get_address());
+	}
+
+	uint64_t* getChunkIndex(const FileDataArray& fileDataArray)
+	{
+		return reinterpret_cast<uint64_t*>(static_cast<char*>(fileDataArray.region.get_address()) + getHeader(fileDataArray).chunkIndexOffset);
+	}
+
+	char* getChunk(const FileDataArray& fileDataArray, uint64_t offset)
+	{
+		return static_cast<char*>(fileDataArray.region.get_address()) + offset;
+	}
+
+	/*************
+	*** FILES ***
+	*************/
+
+	void map(FileDataArray& fileDataArray)
+	{
+		try {
+			boost::interprocess::file_mapping file(fileDataArray.path.c_str(), boost::interprocess::read_write);
+			boost::interprocess::mapped_region region(file, boost::interprocess::read_write);
+			fileDataArray.file.swap(file);
+			fileDataArray.region.swap(region);
+		}
+		catch (const boost::interprocess::interprocess_exception& e) {
+			throw EtpException(8, "Cannot map the file " + fileDataArray.path + " : " + e.what());
+		}
+	}
+
+	void unmap(FileDataArray& fileDataArray)
+	{
+		boost::interprocess::mapped_region().swap(fileDataArray.region);
+		boost::interprocess::file_mapping().swap(fileDataArray.file);
+	}
+
+	/**
+	* Grow a file with zeros. The file must not be mapped.
+	*/
+	void resizeFile(const std::string& path, uint64_t byteCount, bool truncate)
+	{
+		std::filebuf file;
+		const std::ios_base::openmode mode = std::ios_base::out | std::ios_base::binary | (truncate ? std::ios_base::trunc : std::ios_base::in);
+		if (file.open(path, mode) == nullptr ||
+			std::streamoff(file.pubseekoff(static_cast<std::streamoff>(byteCount) - 1, std::ios_base::beg)) < 0 ||
+			file.sputc('\0') == std::filebuf::traits_type::eof() ||
+			file.close() == nullptr) {
+			throw EtpException(8, "Cannot resize the file " + path);
+		}
+	}
+
+	void computeLayout(FileDataArray& fileDataArray)
+	{
+		fileDataArray.chunkGridDimensions.resize(fileDataArray.dimensions.size());
+		for (size_t i = 0; i < fileDataArray.dimensions.size(); ++i) {
+			fileDataArray.chunkGridDimensions[i] = (fileDataArray.dimensions[i] + fileDataArray.chunkDimensions[i] - 1) / fileDataArray.chunkDimensions[i];
+		}
+		fileDataArray.chunkByteCount = alignUp(getElementCount(fileDataArray.chunkDimensions) * getStoredElementByteCount(fileDataArray.transportArrayType), 8);
+	}
+
+	/**
+	* Open and check an existing data array file.
+	*/
+	std::shared_ptr<FileDataArray> openFileDataArray(const std::string& path, const std::string& key)
+	{
+		auto result = std::make_shared<FileDataArray>();
+		result->path = path;
+		map(*result);
+
+		const uint64_t fileByteCount = result->region.get_size();
+		if (fileByteCount < sizeof(FileDataArrayHeader) || std::memcmp(getHeader(*result).magic, fileMagic, sizeof(fileMagic)) != 0) {
+			throw EtpException(8, "The file " + path + " is not a data array file.");
+		}
+		const FileDataArrayHeader& header = getHeader(*result);
+		const uint64_t keyOffset = sizeof(FileDataArrayHeader) + 2 * header.rank * sizeof(int64_t);
+		if (header.rank == 0 || keyOffset + header.keyByteCount > header.chunkIndexOffset ||
+			header.chunkIndexOffset > header.dataOffset || header.dataOffset > header.allocatedByteCount || header.allocatedByteCount > fileByteCount) {
+			throw EtpException(8, "The data array file " + path + " is corrupted.");
+		}
+		const char* base = static_cast<const char*>(result->region.get_address());
+		if (std::string(base + keyOffset, header.keyByteCount) != key) {
+			throw EtpException(8, "The file " + path + " belongs to another data array.");
+		}
+
+		const int64_t* dimensions = reinterpret_cast<const int64_t*>(base + sizeof(FileDataArrayHeader));
+		result->dimensions.assign(dimensions, dimensions + header.rank);
+		result->chunkDimensions.assign(dimensions + header.rank, dimensions + 2 * header.rank);
+		result->transportArrayType = static_cast<Energistics::Etp::v12::Datatypes::AnyArrayType>(header.transportArrayType);
+		computeLayout(*result);
+		if (header.chunkIndexOffset + getElementCount(result->chunkGridDimensions) * sizeof(uint64_t) > header.dataOffset) {
+			throw EtpException(8, "The data array file " + path + " is corrupted.");
+		}
+		return result;
+	}
+
+	/**
+	* @return The preferred subarray dimensions of the metadata if they are valid, otherwise the dimensions of the chunks keeping the fastest dimensions whole.
+	*/
+	std::vector<int64_t> getChunkDimensions(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata& metadata, int64_t maxChunkByteCount)
+	{
+		const int64_t elementByteCount = getStoredElementByteCount(metadata.transportArrayType);
+		const std::vector<int64_t>& preferred = metadata.preferredSubarrayDimensions;
+		bool isValid = preferred.size() == metadata.dimensions.size();
+		for (size_t i = 0; isValid && i < preferred.size(); ++i) {
+			isValid = preferred[i] > 0 && preferred[i] <= (std::max)(metadata.dimensions[i], static_cast<int64_t>(1));
+		}
+		if (isValid && static_cast<int64_t>(getElementCount(preferred)) * elementByteCount <= maxChunkByteCount) {
+			return preferred;
+		}
+
+		std::vector<int64_t> result = computePreferredSubarrayDimensions(metadata.dimensions, elementByteCount, maxChunkByteCount);
+		for (auto& dimension : result) {
+			dimension = (std::max)(dimension, static_cast<int64_t>(1));
+		}
+		return result;
+	}
+
+	/**
+	* Allocate a chunk at the end of the file, growing it if necessary.
+	*/
+	void allocateChunk(FileDataArray& fileDataArray, uint64_t chunk)
+	{
+		const uint64_t offset = getHeader(fileDataArray).allocatedByteCount;
+		const uint64_t requiredByteCount = offset + fileDataArray.chunkByteCount;
+		const uint64_t fileByteCount = fileDataArray.region.get_size();
+		if (requiredByteCount > fileByteCount) {
+			unmap(fileDataArray);
+			resizeFile(fileDataArray.path, alignUp((std::max)(requiredByteCount, fileByteCount + (std::min)(fileByteCount, maxFileGrowth)), pageByteCount), false);
+			map(fileDataArray);
+		}
+		getChunkIndex(fileDataArray)[chunk] = offset;
+		getHeader(fileDataArray).allocatedByteCount = requiredByteCount;
+	}
+
+	/*************
+	*** CHUNKS ***
+	*************/
+
+	/**
+	* Call a function for each chunk intersecting a subarray.
+	* The function receives the index of the chunk, the starts of the intersection in the chunk and in the subarray, and the counts of the intersection.
+	*/
+	template<class Function> void forEachChunk(const FileDataArray& fileDataArray, const std::vector<int64_t>& starts, const std::vector<int64_t>& counts, const Function& function)
+	{
+		const size_t rank = counts.size();
+		if (std::find(counts.begin(), counts.end(), 0) != counts.end()) {
+			return;
+		}
+
+		std::vector<int64_t> firstChunk(rank);
+		std::vector<int64_t> lastChunk(rank);
+		for (size_t i = 0; i < rank; ++i) {
+			firstChunk[i] = starts[i] / fileDataArray.chunkDimensions[i];
+			lastChunk[i] = (starts[i] + counts[i] - 1) / fileDataArray.chunkDimensions[i];
+		}
+
+		std::vector<int64_t> chunk = firstChunk;
+		std::vector<int64_t> chunkStarts(rank);
+		std::vector<int64_t> subarrayStarts(rank);
+		std::vector<int64_t> intersectionCounts(rank);
+		while (true) {
+			uint64_t chunkIndex = 0;
+			for (size_t i = 0; i < rank; ++i) {
+				chunkIndex = chunkIndex * fileDataArray.chunkGridDimensions[i] + chunk[i];
+				const int64_t chunkOrigin = chunk[i] * fileDataArray.chunkDimensions[i];
+				const int64_t start = (std::max)(starts[i], chunkOrigin);
+				const int64_t end = (std::min)(starts[i] + counts[i], chunkOrigin + fileDataArray.chunkDimensions[i]);
+				chunkStarts[i] = start - chunkOrigin;
+				subarrayStarts[i] = start - starts[i];
+				intersectionCounts[i] = end - start;
+			}
+			function(chunkIndex, chunkStarts, subarrayStarts, intersectionCounts);
+
+			size_t dim = rank;
+			while (true) {
+				if (dim == 0) {
+					return;
+				}
+				--dim;
+				if (++chunk[dim] <= lastChunk[dim]) {
+					break;
+				}
+				chunk[dim] = firstChunk[dim];
+			}
+		}
+	}
+
+	/**
+	* Copy the values of a subarray from the chunks of a file.
+	*/
+	struct ChunkReader {
+		const FileDataArray& fileDataArray;
+		const std::vector<int64_t>& starts;
+		const std::vector<int64_t>& counts;
+
+		template<class Stored, class Iterator> void apply(Iterator values) const {
+			const uint64_t* chunkIndex = getChunkIndex(fileDataArray);
+			forEachChunk(fileDataArray, starts, counts, [&](uint64_t chunk, const std::vector<int64_t>& chunkStarts, const std::vector<int64_t>& subarrayStarts, const std::vector<int64_t>& intersectionCounts) {
+				// The values of a chunk which has never been written are the zeros the subarray is initialized with
+				if (chunkIndex[chunk] != 0) {
+					copyBlock(reinterpret_cast<const Stored*>(getChunk(fileDataArray, chunkIndex[chunk])), fileDataArray.chunkDimensions, chunkStarts,
+						values, counts, subarrayStarts, intersectionCounts);
+				}
+			});
+		}
+	};
+
+	/**
+	* Copy the values of a subarray to the chunks of a file, which must have been allocated.
+	*/
+	struct ChunkWriter {
+		FileDataArray& fileDataArray;
+		const std::vector<int64_t>& starts;
+		const std::vector<int64_t>& counts;
+
+		template<class Stored, class Iterator> void apply(Iterator values) const {
+			const uint64_t* chunkIndex = getChunkIndex(fileDataArray);
+			forEachChunk(fileDataArray, starts, counts, [&](uint64_t chunk, const std::vector<int64_t>& chunkStarts, const std::vector<int64_t>& subarrayStarts, const std::vector<int64_t>& intersectionCounts) {
+				copyBlock(values, counts, subarrayStarts,
+					reinterpret_cast<Stored*>(getChunk(fileDataArray, chunkIndex[chunk])), fileDataArray.chunkDimensions, chunkStarts, intersectionCounts);
+			});
+		}
+	};
+
+	/**
+	* Apply an operation to the values of an array with the type the values are stored with in the files.
+	*/
+	template<class Values, class Operation> void applyToValues(Values& values, const Operation& operation)
+	{
+		switch (values.item.idx()) {
+		case 0: operation.template apply<uint8_t>(values.item.get_ArrayOfBoolean().values.begin()); break;
+		case 1: operation.template apply<int32_t>(values.item.get_ArrayOfInt().values.begin()); break;
+		case 2: operation.template apply<int64_t>(values.item.get_ArrayOfLong().values.begin()); break;
+		case 3: operation.template apply<float>(values.item.get_ArrayOfFloat().values.begin()); break;
+		case 4: operation.template apply<double>(values.item.get_ArrayOfDouble().values.begin()); break;
+		case 5: throw EtpException(7, "The file data array store does not support string arrays.");
+		default: operation.template apply<char>(values.item.get_bytes().begin());
+		}
+	}
+
+	Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray readSubarray(const FileDataArray& fileDataArray, const std::vector<int64_t>& starts, const std::vector<int64_t>& counts,
+		int64_t maxByteCount)
+	{
+		checkSubarray(fileDataArray.dimensions, starts, counts);
+		checkReadByteCount(counts, fileDataArray.transportArrayType, maxByteCount);
+		Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray result;
+		result.dimensions = counts;
+		result.data = makeValues(fileDataArray.transportArrayType, getElementCount(counts));
+		applyToValues(result.data, ChunkReader{ fileDataArray, starts, counts });
+		return result;
+	}
+
+	/**
+	* Allocate all the chunks of a subarray before writing in any of them in order not to leave a partially written subarray if the file cannot grow.
+	*/
+	void writeSubarray(FileDataArray& fileDataArray, const Energistics::Etp::v12::Datatypes::AnyArray& data, const std::vector<int64_t>& starts, const std::vector<int64_t>& counts)
+	{
+		forEachChunk(fileDataArray, starts, counts, [&fileDataArray](uint64_t chunk, const std::vector<int64_t>&, const std::vector<int64_t>&, const std::vector<int64_t>&) {
+			if (getChunkIndex(fileDataArray)[chunk] == 0) {
+				allocateChunk(fileDataArray, chunk);
+			}
+		});
+		applyToValues(data, ChunkWriter{ fileDataArray, starts, counts });
+		getHeader(fileDataArray).storeLastWrite = nowInMicroseconds();
+	}
+}
+
+FileDataArrayStore::FileDataArrayStore(const std::string& directory, int64_t maxChunkByteCount) :
+	directory(directory), maxChunkByteCount(maxChunkByteCount)
+{
+	if (maxChunkByteCount < 1) {
+		throw std::invalid_argument("The maximal chunk byte count must be positive.");
+	}
+}
+
+FileDataArrayStore::~FileDataArrayStore() = default;
+
+std::string FileDataArrayStore::getPath(const std::string& key) const
+{
+	// FNV-1a hash of the key. The key is stored in the file in order to detect the collisions.
+	uint64_t hash = 14695981039346656037ULL;
+	for (const char c : key) {
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ULL;
+	}
+	std::ostringstream result;
+	result << directory << '/' << std::hex << std::setw(16) << std::setfill('0') << hash << ".etparray";
+	return result.str();
+}
+
+std::shared_ptr<FileDataArray> FileDataArrayStore::getFileDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid, std::unique_lock<std::mutex>& lock) const
+{
+	const std::string key = getDataArrayKey(uid);
+	while (true) {
+		std::shared_ptr<FileDataArray> result;
+		{
+			const std::lock_guard<std::mutex> storeLock(mutex);
+			auto it = fileDataArrays.find(key);
+			if (it != fileDataArrays.end()) {
+				result = it->second;
+			}
+			else {
+				const std::string path = getPath(key);
+				if (!std::ifstream(path).good()) {
+					throw EtpException(11, "The data array " + uid.pathInResource + " of " + uid.uri + " does not exist.");
+				}
+				result = openFileDataArray(path, key);
+				fileDataArrays[key] = result;
+			}
+		}
+
+		lock = std::unique_lock<std::mutex>(result->mutex);
+		if (!result->replaced) {
+			return result;
+		}
+		lock.unlock();
+	}
+}
+
+std::shared_ptr<FileDataArray> FileDataArrayStore::createFileDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+	const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata& metadata, std::unique_lock<std::mutex>& lock)
+{
+	// Throws if the dimensions are empty, negative or too big
+	getByteCount(metadata.dimensions, metadata.transportArrayType);
+
+	const std::string key = getDataArrayKey(uid);
+	auto result = std::make_shared<FileDataArray>();
+	result->path = getPath(key);
+	result->dimensions = metadata.dimensions;
+	result->chunkDimensions = getChunkDimensions(metadata, maxChunkByteCount);
+	result->transportArrayType = metadata.transportArrayType;
+	computeLayout(*result);
+
+	const uint64_t rank = result->dimensions.size();
+	const uint64_t keyOffset = sizeof(FileDataArrayHeader) + 2 * rank * sizeof(int64_t);
+	const uint64_t chunkIndexOffset = alignUp(keyOffset + key.size(), sizeof(uint64_t));
+	const uint64_t dataOffset = alignUp(chunkIndexOffset + getElementCount(result->chunkGridDimensions) * sizeof(uint64_t), pageByteCount);
+	int64_t storeCreated = nowInMicroseconds();
+
+	const std::lock_guard<std::mutex> storeLock(mutex);
+	// Invalidate the previous data array before replacing its file
+	std::shared_ptr<FileDataArray> previous;
+	auto it = fileDataArrays.find(key);
+	if (it != fileDataArrays.end()) {
+		previous = it->second;
+		fileDataArrays.erase(it);
+	}
+	else if (std::ifstream(result->path).good()) {
+		try {
+			previous = openFileDataArray(result->path, key);
+		}
+		catch (const EtpException&) {
+			// An unreadable file is simply replaced
+		}
+	}
+	if (previous != nullptr) {
+		const std::lock_guard<std::mutex> previousLock(previous->mutex);
+		storeCreated = getHeader(*previous).storeCreated;
+		previous->replaced = true;
+		unmap(*previous);
+	}
+
+	resizeFile(result->path, dataOffset, true);
+	map(*result);
+	char* base = static_cast<char*>(result->region.get_address());
+	FileDataArrayHeader& header = getHeader(*result);
+	std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+	header.transportArrayType = static_cast<int32_t>(metadata.transportArrayType);
+	header.logicalArrayType = static_cast<int32_t>(metadata.logicalArrayType);
+	header.rank = rank;
+	header.storeCreated = storeCreated;
+	header.storeLastWrite = nowInMicroseconds();
+	header.keyByteCount = key.size();
+	header.chunkIndexOffset = chunkIndexOffset;
+	header.dataOffset = dataOffset;
+	header.allocatedByteCount = dataOffset;
+	std::memcpy(base + sizeof(FileDataArrayHeader), result->dimensions.data(), rank * sizeof(int64_t));
+	std::memcpy(base + sizeof(FileDataArrayHeader) + rank * sizeof(int64_t), result->chunkDimensions.data(), rank * sizeof(int64_t));
+	std::memcpy(base + keyOffset, key.data(), key.size());
+
+	// Lock the new data array before publishing it in order for it to be written before any other access.
+	lock = std::unique_lock<std::mutex>(result->mutex);
+	fileDataArrays[key] = result;
+	return result;
+}
+
+Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray FileDataArrayStore::getDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid, int64_t maxByteCount) const
+{
+	std::unique_lock<std::mutex> lock;
+	std::shared_ptr<FileDataArray> fileDataArray = getFileDataArray(uid, lock);
+	return readSubarray(*fileDataArray, std::vector<int64_t>(fileDataArray->dimensions.size(), 0), fileDataArray->dimensions, maxByteCount);
+}
+
+Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata FileDataArrayStore::getDataArrayMetadata(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid) const
+{
+	std::unique_lock<std::mutex> lock;
+	std::shared_ptr<FileDataArray> fileDataArray = getFileDataArray(uid, lock);
+	const FileDataArrayHeader& header = getHeader(*fileDataArray);
+	Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata result;
+	result.dimensions = fileDataArray->dimensions;
+	result.preferredSubarrayDimensions = fileDataArray->chunkDimensions;
+	result.transportArrayType = fileDataArray->transportArrayType;
+	result.logicalArrayType = static_cast<Energistics::Etp::v12::Datatypes::AnyLogicalArrayType>(header.logicalArrayType);
+	result.storeLastWrite = header.storeLastWrite;
+	result.storeCreated = header.storeCreated;
+	return result;
+}
+
+Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray FileDataArrayStore::getDataSubarray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+	const std::vector<int64_t>& starts, const std::vector<int64_t>& counts, int64_t maxByteCount) const
+{
+	std::unique_lock<std::mutex> lock;
+	std::shared_ptr<FileDataArray> fileDataArray = getFileDataArray(uid, lock);
+	return readSubarray(*fileDataArray, starts, counts, maxByteCount);
+}
+
+void FileDataArrayStore::putDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+	const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray& dataArray)
+{
+	if (getValueCount(dataArray.data) != getElementCount(dataArray.dimensions)) {
+		throw EtpException(5, "The value count of the data array " + uid.pathInResource + " does not match its dimensions.");
+	}
+
+	Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata metadata;
+	metadata.dimensions = dataArray.dimensions;
+	metadata.transportArrayType = static_cast<Energistics::Etp::v12::Datatypes::AnyArrayType>(dataArray.data.item.idx());
+	metadata.logicalArrayType = getLogicalArrayType(metadata.transportArrayType);
+
+	std::unique_lock<std::mutex> lock;
+	std::shared_ptr<FileDataArray> fileDataArray = createFileDataArray(uid, metadata, lock);
+	writeSubarray(*fileDataArray, dataArray.data, std::vector<int64_t>(dataArray.dimensions.size(), 0), dataArray.dimensions);
+}
+
+void FileDataArrayStore::putDataSubarray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+	const Energistics::Etp::v12::Datatypes::AnyArray& data, const std::vector<int64_t>& starts, const std::vector<int64_t>& counts)
+{
+	if (getValueCount(data) != getElementCount(counts)) {
+		throw EtpException(5, "The value count of the subarray of " + uid.pathInResource + " does not match its counts.");
+	}
+
+	std::unique_lock<std::mutex> lock;
+	std::shared_ptr<FileDataArray> fileDataArray = getFileDataArray(uid, lock);
+	checkSubarray(fileDataArray->dimensions, starts, counts);
+	if (static_cast<size_t>(fileDataArray->transportArrayType) != data.item.idx()) {
+		throw EtpException(5, "The values do not have the transport type of the data array " + uid.pathInResource + '.');
+	}
+	writeSubarray(*fileDataArray, data, starts, counts);
+}
+
+void FileDataArrayStore::putUninitializedDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+	const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata& metadata)
+{
+	std::unique_lock<std::mutex> lock;
+	createFileDataArray(uid, metadata, lock);
+}
+
+void FileDataArrayStore::flush()
+{
+	std::vector<std::shared_ptr<FileDataArray>> openedDataArrays;
+	{
+		const std::lock_guard<std::mutex> lock(mutex);
+		for (const auto& entry : fileDataArrays) {
+			openedDataArrays.push_back(entry.second);
+		}
+	}
+
+	for (const auto& fileDataArray : openedDataArrays) {
+		const std::lock_guard<std::mutex> lock(fileDataArray->mutex);
+		if (!fileDataArray->replaced && !fileDataArray->region.flush()) {
+			throw EtpException(8, "Cannot flush the file " + fileDataArray->path);
+		}
+	}
+}
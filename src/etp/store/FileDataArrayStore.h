@@ -0,0 +1,142 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "../../nsDefinitions.h"
+#include "../EtpMessages.h"
+
+#if defined(_WIN32) && !defined(FETPAPI_STATIC)
+	#ifndef FETPAPI_DLL_IMPORT_OR_EXPORT
+		#if defined(Fetpapi_EXPORTS)
+			#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllexport)
+		#else
+			#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllimport)
+		#endif
+	#endif
+#else
+	#define FETPAPI_DLL_IMPORT_OR_EXPORT
+#endif
+
+namespace ETP_NS
+{
+	struct FileDataArray;
+
+	/**
+	* A thread safe store of data arrays persisted in a directory, one memory mapped file per data array.
+	* It is meant to serve the DataArray protocol of a server whose arrays do not fit in memory (see FileDataArrayHandlers.h).
+	*
+	* A data array is split in chunks having the shape of its preferred subarray dimensions.
+	* Its file contains a header (dimensions, chunk shape, transport and logical types, timestamps, URI and path in resource),
+	* a chunk index and the chunks themselves, each chunk being a row major block of values in the byte order of the machine.
+	* The chunks are only allocated at their first write : a chunk which has never been written is read as zeros.
+	* Reading or writing a subarray only maps and copies the values of the chunks it intersects.
+	*
+	* The writes to a data array are serialized by a lock of the data array. The writes to different data arrays do not wait for each other.
+	* String arrays and custom data are not supported.
+	*
+	* All the methods report their failures by throwing an EtpException carrying the ETP error code to send back.
+	*/
+	class FileDataArrayStore
+	{
+	public:
+
+		/**
+		* @param directory			The existing directory where the data array files are stored. The data arrays already stored in it are served.
+		* @param maxChunkByteCount	The maximal byte count of a chunk when the preferred subarray dimensions of a data array are not given by the client.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT FileDataArrayStore(const std::string& directory, int64_t maxChunkByteCount = 4000000);
+		FETPAPI_DLL_IMPORT_OR_EXPORT ~FileDataArrayStore();
+
+		const std::string& getDirectory() const { return directory; }
+
+		/**
+		* Read all the values of a data array.
+		*
+		* @param maxByteCount	The maximal byte count of the values, typically the MaxWebSocketMessagePayloadSize of the session which is going to send them.
+		* @throw EtpException 17 if the values are bigger : they must be read by subarrays.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray getDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+			int64_t maxByteCount = (std::numeric_limits<int64_t>::max)()) const;
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata getDataArrayMetadata(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid) const;
+
+		/**
+		* Read the values of a subarray.
+		*
+		* @param maxByteCount	The maximal byte count of the values, typically the MaxWebSocketMessagePayloadSize of the session which is going to send them.
+		* @throw EtpException 17 if the values are bigger : they must be read by smaller subarrays.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray getDataSubarray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+			const std::vector<int64_t>& starts, const std::vector<int64_t>& counts, int64_t maxByteCount = (std::numeric_limits<int64_t>::max)()) const;
+
+		/**
+		* Create or replace a data array with some values.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void putDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+			const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray& dataArray);
+
+		/**
+		* Write some values in an existing data array. All the chunks of the subarray are allocated before any value is written.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void putDataSubarray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+			const Energistics::Etp::v12::Datatypes::AnyArray& data, const std::vector<int64_t>& starts, const std::vector<int64_t>& counts);
+
+		/**
+		* Create or replace a data array without allocating any chunk.
+		* The preferred subarray dimensions of the metadata become the chunk shape if they fit in the data array and in the maximal chunk byte count.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void putUninitializedDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+			const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata& metadata);
+
+		/**
+		* Synchronously write the modified pages of the opened data arrays to their files.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void flush();
+
+	private:
+		/**
+		* @param lock	Receives the lock of the returned data array
+		* @return		The data array, which is opened from its file if it is not opened yet.
+		*/
+		std::shared_ptr<FileDataArray> getFileDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid, std::unique_lock<std::mutex>& lock) const;
+
+		/**
+		* Create or replace the file of a data array.
+		*
+		* @param lock	Receives the lock of the returned data array
+		*/
+		std::shared_ptr<FileDataArray> createFileDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+			const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata& metadata, std::unique_lock<std::mutex>& lock);
+
+		std::string getPath(const std::string& key) const;
+
+		const std::string directory;
+		const int64_t maxChunkByteCount;
+
+		/// Protects the opened data arrays map but not the content of the data arrays
+		mutable std::mutex mutex;
+		mutable std::unordered_map<std::string, std::shared_ptr<FileDataArray>> fileDataArrays;
+	};
+}
@@ -0,0 +1,765 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "InMemoryStore.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <new>
+#include <stdexcept>
+
+#include "../EtpException.h"
+#include "../EtpHelpers.h"
+#include "StoreHelpers.h"
+
+using namespace ETP_NS;
+using namespace ETP_NS::StoreHelpers;
+
+namespace {
+	const std::string defaultDataspaceUri = "eml:///";
+
+	int64_t nowInMicroseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+
+	void checkWritable(const InMemoryStore::Transaction* transaction)
+	{
+		if (transaction != nullptr && transaction->isOpen() && transaction->readOnly) {
+			throw EtpException(6, "The store cannot be modified in a read only transaction.");
+		}
+	}
+
+	bool isDataspaceUri(const std::string& uri)
+	{
+		return uri == defaultDataspaceUri || (uri.compare(0, 18, "eml:///dataspace('") == 0 && uri.size() > 20 && uri.compare(uri.size() - 2, 2, "')") == 0);
+	}
+
+	bool isUuid(const std::string& str, size_t start)
+	{
+		if (start + 36 > str.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < 36; ++i) {
+			const char c = str[start + i];
+			if (i == 8 || i == 13 || i == 18 || i == 23 ? c != '-' : !std::isxdigit(static_cast<unsigned char>(c))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	* @return The UUIDs which are the values of some UUID (RESQML 2.0) or Uuid (EML 2.3) elements of an XML document, except its own UUID.
+	*/
+	std::vector<std::string> extractReferencedUuids(const std::string& xml, const std::string& ownUuid)
+	{
+		std::vector<std::string> result;
+		for (const char* tagNameEnd : { "UUID>", "Uuid>" }) {
+			size_t pos = xml.find(tagNameEnd);
+			while (pos != std::string::npos) {
+				const size_t valueStart = pos + 5;
+				const size_t tagStart = xml.rfind('<', pos);
+				if (tagStart != std::string::npos && xml[tagStart + 1] != '/' && isUuid(xml, valueStart)) {
+					const std::string uuid = xml.substr(valueStart, 36);
+					if (uuid != ownUuid && std::find(result.begin(), result.end(), uuid) == result.end()) {
+						result.push_back(uuid);
+					}
+				}
+				pos = xml.find(tagNameEnd, valueStart);
+			}
+		}
+		return result;
+	}
+
+	/**
+	* @param dataObjectTypes	Qualified types such as resqml20.obj_IjkGridRepresentation or wildcards such as resqml20.*
+	*/
+	bool matchesType(const std::string& type, const std::vector<std::string>& dataObjectTypes)
+	{
+		if (dataObjectTypes.empty()) {
+			return true;
+		}
+		for (const auto& dataObjectType : dataObjectTypes) {
+			if (dataObjectType.size() > 1 && dataObjectType.compare(dataObjectType.size() - 2, 2, ".*") == 0
+				? type.compare(0, dataObjectType.size() - 1, dataObjectType, 0, dataObjectType.size() - 1) == 0
+				: type == dataObjectType) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	struct BlockCopy {
+		const std::vector<int64_t>& sourceDimensions;
+		const std::vector<int64_t>& sourceStarts;
+		const std::vector<int64_t>& destinationDimensions;
+		const std::vector<int64_t>& destinationStarts;
+		const std::vector<int64_t>& counts;
+
+		template<class Values> void operator()(const Values& source, Values& destination) const {
+			StoreHelpers::copyBlock(source.begin(), sourceDimensions, sourceStarts, destination.begin(), destinationDimensions, destinationStarts, counts);
+		}
+	};
+
+	/**
+	* Apply an operation to the values of two arrays which must have the same transport type.
+	*/
+	template<class Operation> void applyToValues(const Energistics::Etp::v12::Datatypes::AnyArray& source, Energistics::Etp::v12::Datatypes::AnyArray& destination, const Operation& operation)
+	{
+		if (source.item.idx() != destination.item.idx()) {
+			throw EtpException(5, "The values do not have the transport type of the data array.");
+		}
+		switch (source.item.idx()) {
+		case 0: operation(source.item.get_ArrayOfBoolean().values, destination.item.get_ArrayOfBoolean().values); break;
+		case 1: operation(source.item.get_ArrayOfInt().values, destination.item.get_ArrayOfInt().values); break;
+		case 2: operation(source.item.get_ArrayOfLong().values, destination.item.get_ArrayOfLong().values); break;
+		case 3: operation(source.item.get_ArrayOfFloat().values, destination.item.get_ArrayOfFloat().values); break;
+		case 4: operation(source.item.get_ArrayOfDouble().values, destination.item.get_ArrayOfDouble().values); break;
+		case 5: operation(source.item.get_ArrayOfString().values, destination.item.get_ArrayOfString().values); break;
+		default: operation(source.item.get_bytes(), destination.item.get_bytes());
+		}
+	}
+}
+
+InMemoryStore::InMemoryStore(int64_t maxSubarrayByteCount, int64_t maxUninitializedByteCount) :
+	maxSubarrayByteCount(maxSubarrayByteCount), maxUninitializedByteCount(maxUninitializedByteCount)
+{
+	auto defaultDataspace = std::make_shared<Energistics::Etp::v12::Datatypes::Object::Dataspace>();
+	defaultDataspace->uri = defaultDataspaceUri;
+	defaultDataspace->storeCreated = nowInMicroseconds();
+	defaultDataspace->storeLastWrite = defaultDataspace->storeCreated;
+	dataspaces[defaultDataspaceUri] = defaultDataspace;
+}
+
+std::string InMemoryStore::getDataspaceUri(const std::string& uri)
+{
+	try {
+		const std::string result = EtpHelpers::getDataspaceUri(uri);
+		return result.empty() ? defaultDataspaceUri : result;
+	}
+	catch (const std::invalid_argument& e) {
+		throw EtpException(9, e.what());
+	}
+}
+
+/******************
+*** DATASPACES ***
+******************/
+
+std::vector<Energistics::Etp::v12::Datatypes::Object::Dataspace> InMemoryStore::getDataspaces(int64_t storeLastWriteFilter) const
+{
+	std::vector<Energistics::Etp::v12::Datatypes::Object::Dataspace> result;
+	const std::lock_guard<std::mutex> lock(mutex);
+	for (const auto& entry : dataspaces) {
+		if (entry.first != defaultDataspaceUri && entry.second->storeLastWrite > storeLastWriteFilter) {
+			result.push_back(*entry.second);
+		}
+	}
+	return result;
+}
+
+void InMemoryStore::putDataspace(Energistics::Etp::v12::Datatypes::Object::Dataspace dataspace, Transaction* transaction)
+{
+	if (dataspace.uri == defaultDataspaceUri || !isDataspaceUri(dataspace.uri)) {
+		throw EtpException(9, "The URI " + dataspace.uri + " is not the URI of a dataspace which can be put.");
+	}
+	if (dataspace.path.empty()) {
+		dataspace.path = dataspace.uri.substr(18, dataspace.uri.size() - 20);
+	}
+
+	const std::lock_guard<std::mutex> lock(mutex);
+	checkWritable(transaction);
+	const int64_t now = nowInMicroseconds();
+	auto it = dataspaces.find(dataspace.uri);
+	dataspace.storeCreated = it == dataspaces.end() ? now : it->second->storeCreated;
+	dataspace.storeLastWrite = now;
+	const std::string uri = dataspace.uri;
+	replaceDataspace(uri, std::make_shared<Energistics::Etp::v12::Datatypes::Object::Dataspace>(std::move(dataspace)), transaction);
+}
+
+void InMemoryStore::deleteDataspace(const std::string& uri, Transaction* transaction)
+{
+	if (uri == defaultDataspaceUri) {
+		throw EtpException(6, "The default dataspace cannot be deleted.");
+	}
+
+	const std::lock_guard<std::mutex> lock(mutex);
+	checkWritable(transaction);
+	if (dataspaces.find(uri) == dataspaces.end()) {
+		throw EtpException(11, "The dataspace " + uri + " does not exist.");
+	}
+
+	auto indexIt = dataspaceIndexes.find(uri);
+	if (indexIt != dataspaceIndexes.end()) {
+		std::vector<std::string> dataObjectUris;
+		for (const auto& typeEntry : indexIt->second.urisByType) {
+			dataObjectUris.insert(dataObjectUris.end(), typeEntry.second.begin(), typeEntry.second.end());
+		}
+		const std::vector<std::string> dataArrayKeys(indexIt->second.dataArrayKeys.begin(), indexIt->second.dataArrayKeys.end());
+		for (const auto& dataObjectUri : dataObjectUris) {
+			replaceDataObject(dataObjectUri, nullptr, transaction);
+		}
+		for (const auto& dataArrayKey : dataArrayKeys) {
+			replaceDataArray(dataArrayKey, nullptr, transaction);
+		}
+		dataspaceIndexes.erase(uri);
+	}
+	replaceDataspace(uri, nullptr, transaction);
+}
+
+/********************
+*** DATA OBJECTS ***
+********************/
+
+Energistics::Etp::v12::Datatypes::Object::DataObject InMemoryStore::getDataObject(const std::string& uri) const
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	auto it = dataObjects.find(uri);
+	if (it == dataObjects.end()) {
+		throw EtpException(11, "The data object " + uri + " does not exist.");
+	}
+	return it->second->dataObject;
+}
+
+void InMemoryStore::putDataObject(Energistics::Etp::v12::Datatypes::Object::DataObject dataObject, Transaction* transaction)
+{
+	const std::string uri = dataObject.resource.uri;
+	const Energistics::Etp::v12::Datatypes::ErrorInfo error = EtpHelpers::validateDataObjectUri(uri);
+	if (error.code > -1) {
+		throw EtpException(error.code, error.message);
+	}
+
+	// Index the data object before locking the store
+	EtpHelpers::UriView uriView;
+	EtpHelpers::parseUri(uri, uriView);
+	auto entry = std::make_shared<InMemoryDataObjectEntry>();
+	entry->dataspaceUri = uriView.dataspaceUri.empty() ? defaultDataspaceUri : uriView.dataspaceUri.to_string();
+	entry->type = uriView.qualifiedType.to_string();
+	entry->uuid = uriView.uuid.to_string();
+	entry->targetUuids = extractReferencedUuids(dataObject.data, entry->uuid);
+	entry->dataObject = std::move(dataObject);
+
+	const std::lock_guard<std::mutex> lock(mutex);
+	checkWritable(transaction);
+	if (dataspaces.find(entry->dataspaceUri) == dataspaces.end()) {
+		throw EtpException(11, "The dataspace " + entry->dataspaceUri + " does not exist.");
+	}
+	const int64_t now = nowInMicroseconds();
+	auto it = dataObjects.find(uri);
+	entry->dataObject.resource.storeCreated = it == dataObjects.end() ? now : it->second->dataObject.resource.storeCreated;
+	entry->dataObject.resource.storeLastWrite = now;
+	touchDataspace(entry->dataspaceUri, now);
+	replaceDataObject(uri, entry, transaction);
+}
+
+void InMemoryStore::deleteDataObject(const std::string& uri, Transaction* transaction)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	checkWritable(transaction);
+	auto it = dataObjects.find(uri);
+	if (it == dataObjects.end()) {
+		throw EtpException(11, "The data object " + uri + " does not exist.");
+	}
+
+	const std::string dataspaceUri = it->second->dataspaceUri;
+	replaceDataObject(uri, nullptr, transaction);
+
+	Energistics::Etp::v12::Datatypes::Object::DeletedResource deletedResource;
+	deletedResource.uri = uri;
+	deletedResource.deletedTime = nowInMicroseconds();
+	dataspaceIndexes[dataspaceUri].deletedResources[uri] = deletedResource;
+	touchDataspace(dataspaceUri, deletedResource.deletedTime);
+}
+
+std::vector<Energistics::Etp::v12::Datatypes::Object::Resource> InMemoryStore::getResources(const Energistics::Etp::v12::Datatypes::Object::ContextInfo& context,
+	Energistics::Etp::v12::Datatypes::Object::ContextScopeKind scope,
+	int64_t storeLastWriteFilter,
+	boost::optional<Energistics::Etp::v12::Datatypes::Object::ActiveStatusKind> activeStatusFilter,
+	bool countObjects,
+	std::vector<Energistics::Etp::v12::Datatypes::Object::Edge>* edges) const
+{
+	using Energistics::Etp::v12::Datatypes::Object::ContextScopeKind;
+
+	std::vector<const InMemoryDataObjectEntry*> candidates;
+	const std::lock_guard<std::mutex> lock(mutex);
+	if (isDataspaceUri(context.uri)) {
+		if (dataspaces.find(context.uri) == dataspaces.end()) {
+			throw EtpException(11, "The dataspace " + context.uri + " does not exist.");
+		}
+		auto indexIt = dataspaceIndexes.find(context.uri);
+		// A dataspace has no source and is not a resource itself
+		if (indexIt == dataspaceIndexes.end() || scope == ContextScopeKind::self || scope == ContextScopeKind::sources) {
+			return {};
+		}
+
+		// Use the type index instead of filtering all the data objects of the dataspace
+		const auto& urisByType = indexIt->second.urisByType;
+		std::vector<std::pair<std::map<std::string, std::set<std::string>>::const_iterator, std::map<std::string, std::set<std::string>>::const_iterator>> typeRanges;
+		if (context.dataObjectTypes.empty()) {
+			typeRanges.push_back(std::make_pair(urisByType.begin(), urisByType.end()));
+		}
+		for (const auto& dataObjectType : context.dataObjectTypes) {
+			if (dataObjectType.size() > 1 && dataObjectType.compare(dataObjectType.size() - 2, 2, ".*") == 0) {
+				const std::string prefix = dataObjectType.substr(0, dataObjectType.size() - 1);
+				auto end = urisByType.lower_bound(prefix);
+				while (end != urisByType.end() && end->first.compare(0, prefix.size(), prefix) == 0) {
+					++end;
+				}
+				typeRanges.push_back(std::make_pair(urisByType.lower_bound(prefix), end));
+			}
+			else {
+				auto it = urisByType.find(dataObjectType);
+				if (it != urisByType.end()) {
+					typeRanges.push_back(std::make_pair(it, std::next(it)));
+				}
+			}
+		}
+
+		std::unordered_set<std::string> selectedTypes;
+		for (const auto& typeRange : typeRanges) {
+			for (auto it = typeRange.first; it != typeRange.second; ++it) {
+				if (selectedTypes.insert(it->first).second) {
+					for (const auto& uri : it->second) {
+						candidates.push_back(dataObjects.at(uri).get());
+					}
+				}
+			}
+		}
+	}
+	else {
+		auto it = dataObjects.find(context.uri);
+		if (it == dataObjects.end()) {
+			throw EtpException(11, "The data object " + context.uri + " does not exist.");
+		}
+
+		if (scope == ContextScopeKind::self || scope == ContextScopeKind::sourcesOrSelf || scope == ContextScopeKind::targetsOrSelf) {
+			candidates.push_back(it->second.get());
+		}
+		if (scope != ContextScopeKind::self) {
+			// Breadth first traversal of the edges up to the context depth
+			const bool towardsTargets = scope == ContextScopeKind::targets || scope == ContextScopeKind::targetsOrSelf;
+			std::unordered_set<std::string> visitedUris = { context.uri };
+			std::vector<const InMemoryDataObjectEntry*> frontier = { it->second.get() };
+			for (int32_t level = 0; level < (std::max)(context.depth, 1) && !frontier.empty(); ++level) {
+				std::vector<const InMemoryDataObjectEntry*> nextFrontier;
+				for (const auto* entry : frontier) {
+					for (const auto& neighbourUri : towardsTargets ? getTargetUris(*entry) : getSourceUris(*entry)) {
+						if (visitedUris.insert(neighbourUri).second) {
+							const InMemoryDataObjectEntry* neighbour = dataObjects.at(neighbourUri).get();
+							nextFrontier.push_back(neighbour);
+							candidates.push_back(neighbour);
+						}
+					}
+				}
+				frontier.swap(nextFrontier);
+			}
+		}
+	}
+
+	std::vector<Energistics::Etp::v12::Datatypes::Object::Resource> result;
+	std::unordered_set<std::string> resultUris;
+	for (const auto* candidate : candidates) {
+		const auto& resource = candidate->dataObject.resource;
+		if (resource.storeLastWrite > storeLastWriteFilter &&
+			(!activeStatusFilter || resource.activeStatus == activeStatusFilter.get()) &&
+			matchesType(candidate->type, context.dataObjectTypes)) {
+			result.push_back(makeResource(*candidate, countObjects));
+			if (edges != nullptr) {
+				resultUris.insert(resource.uri);
+			}
+		}
+	}
+
+	if (edges != nullptr) {
+		for (const auto* candidate : candidates) {
+			if (resultUris.find(candidate->dataObject.resource.uri) == resultUris.end()) {
+				continue;
+			}
+			for (const auto& targetUri : getTargetUris(*candidate)) {
+				if (resultUris.find(targetUri) != resultUris.end()) {
+					Energistics::Etp::v12::Datatypes::Object::Edge edge;
+					edge.sourceUri = candidate->dataObject.resource.uri;
+					edge.targetUri = targetUri;
+					edges->push_back(edge);
+				}
+			}
+		}
+	}
+
+	return result;
+}
+
+std::vector<Energistics::Etp::v12::Datatypes::Object::DeletedResource> InMemoryStore::getDeletedResources(const std::string& dataspaceUri,
+	int64_t deleteTimeFilter, const std::vector<std::string>& dataObjectTypes) const
+{
+	std::vector<Energistics::Etp::v12::Datatypes::Object::DeletedResource> result;
+	const std::lock_guard<std::mutex> lock(mutex);
+	if (dataspaces.find(dataspaceUri) == dataspaces.end()) {
+		throw EtpException(11, "The dataspace " + dataspaceUri + " does not exist.");
+	}
+	auto indexIt = dataspaceIndexes.find(dataspaceUri);
+	if (indexIt != dataspaceIndexes.end()) {
+		for (const auto& entry : indexIt->second.deletedResources) {
+			if (entry.second.deletedTime > deleteTimeFilter && matchesType(EtpHelpers::getDataObjectType(entry.first), dataObjectTypes)) {
+				result.push_back(entry.second);
+			}
+		}
+	}
+	return result;
+}
+
+/*******************
+*** DATA ARRAYS ***
+*******************/
+
+Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray InMemoryStore::getDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid, int64_t maxByteCount) const
+{
+	Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray result;
+	const std::lock_guard<std::mutex> lock(mutex);
+	auto it = dataArrays.find(getDataArrayKey(uid));
+	if (it == dataArrays.end()) {
+		throw EtpException(11, "The data array " + uid.pathInResource + " of " + uid.uri + " does not exist.");
+	}
+	checkReadByteCount(it->second->metadata.dimensions, it->second->metadata.transportArrayType, maxByteCount);
+	result.dimensions = it->second->metadata.dimensions;
+	try {
+		result.data = it->second->data;
+	}
+	catch (const std::bad_alloc&) {
+		throw EtpException(12, "The store cannot allocate a copy of the data array " + uid.pathInResource + " of " + uid.uri + '.');
+	}
+	return result;
+}
+
+Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata InMemoryStore::getDataArrayMetadata(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid) const
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	auto it = dataArrays.find(getDataArrayKey(uid));
+	if (it == dataArrays.end()) {
+		throw EtpException(11, "The data array " + uid.pathInResource + " of " + uid.uri + " does not exist.");
+	}
+	return it->second->metadata;
+}
+
+Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray InMemoryStore::getDataSubarray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+	const std::vector<int64_t>& starts, const std::vector<int64_t>& counts, int64_t maxByteCount) const
+{
+	Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray result;
+	result.dimensions = counts;
+	const std::vector<int64_t> zeros(counts.size(), 0);
+
+	const std::lock_guard<std::mutex> lock(mutex);
+	auto it = dataArrays.find(getDataArrayKey(uid));
+	if (it == dataArrays.end()) {
+		throw EtpException(11, "The data array " + uid.pathInResource + " of " + uid.uri + " does not exist.");
+	}
+	const InMemoryDataArrayEntry& entry = *it->second;
+	checkSubarray(entry.metadata.dimensions, starts, counts);
+	checkReadByteCount(counts, entry.metadata.transportArrayType, maxByteCount);
+	result.data = makeValues(entry.metadata.transportArrayType, getElementCount(counts));
+	applyToValues(entry.data, result.data, BlockCopy{ entry.metadata.dimensions, starts, counts, zeros, counts });
+	return result;
+}
+
+void InMemoryStore::putDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+	const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray& dataArray, Transaction* transaction)
+{
+	if (getValueCount(dataArray.data) != getElementCount(dataArray.dimensions)) {
+		throw EtpException(5, "The value count of the data array " + uid.pathInResource + " does not match its dimensions.");
+	}
+
+	// Copy the values before locking the store
+	auto entry = std::make_shared<InMemoryDataArrayEntry>();
+	entry->metadata.dimensions = dataArray.dimensions;
+	entry->metadata.transportArrayType = static_cast<Energistics::Etp::v12::Datatypes::AnyArrayType>(dataArray.data.item.idx());
+	entry->metadata.logicalArrayType = getLogicalArrayType(entry->metadata.transportArrayType);
+	entry->metadata.preferredSubarrayDimensions = computePreferredSubarrayDimensions(dataArray.dimensions, getElementByteCount(entry->metadata.transportArrayType), maxSubarrayByteCount);
+	entry->data = dataArray.data;
+	const std::string dataspaceUri = getDataspaceUri(uid.uri);
+
+	const std::lock_guard<std::mutex> lock(mutex);
+	checkWritable(transaction);
+	if (dataspaces.find(dataspaceUri) == dataspaces.end()) {
+		throw EtpException(11, "The dataspace " + dataspaceUri + " does not exist.");
+	}
+	const std::string key = getDataArrayKey(uid);
+	const int64_t now = nowInMicroseconds();
+	auto it = dataArrays.find(key);
+	entry->metadata.storeCreated = it == dataArrays.end() ? now : it->second->metadata.storeCreated;
+	entry->metadata.storeLastWrite = now;
+	touchDataspace(dataspaceUri, now);
+	replaceDataArray(key, entry, transaction);
+}
+
+void InMemoryStore::putDataSubarray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+	const Energistics::Etp::v12::Datatypes::AnyArray& data, const std::vector<int64_t>& starts, const std::vector<int64_t>& counts, Transaction* transaction)
+{
+	if (getValueCount(data) != getElementCount(counts)) {
+		throw EtpException(5, "The value count of the subarray of " + uid.pathInResource + " does not match its counts.");
+	}
+	const std::vector<int64_t> zeros(counts.size(), 0);
+
+	const std::lock_guard<std::mutex> lock(mutex);
+	checkWritable(transaction);
+	const std::string key = getDataArrayKey(uid);
+	auto it = dataArrays.find(key);
+	if (it == dataArrays.end()) {
+		throw EtpException(11, "The data array " + uid.pathInResource + " of " + uid.uri + " does not exist.");
+	}
+	checkSubarray(it->second->metadata.dimensions, starts, counts);
+	if (static_cast<size_t>(it->second->metadata.transportArrayType) != data.item.idx()) {
+		throw EtpException(5, "The values do not have the transport type of the data array " + uid.pathInResource + '.');
+	}
+
+	std::shared_ptr<InMemoryDataArrayEntry> entry = getWritableDataArray(key, transaction);
+	applyToValues(data, entry->data, BlockCopy{ counts, zeros, entry->metadata.dimensions, starts, counts });
+	entry->metadata.storeLastWrite = nowInMicroseconds();
+	touchDataspace(getDataspaceUri(uid.uri), entry->metadata.storeLastWrite);
+}
+
+void InMemoryStore::putUninitializedDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+	Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata metadata, Transaction* transaction)
+{
+	if (getByteCount(metadata.dimensions, metadata.transportArrayType) > maxUninitializedByteCount) {
+		throw EtpException(12, "The data array " + uid.pathInResource + " exceeds the maximal size of " + std::to_string(maxUninitializedByteCount) + " bytes of an uninitialized data array in this store.");
+	}
+	auto entry = std::make_shared<InMemoryDataArrayEntry>();
+	entry->data = makeValues(metadata.transportArrayType, getElementCount(metadata.dimensions));
+	if (metadata.preferredSubarrayDimensions.size() != metadata.dimensions.size()) {
+		metadata.preferredSubarrayDimensions = computePreferredSubarrayDimensions(metadata.dimensions, getElementByteCount(metadata.transportArrayType), maxSubarrayByteCount);
+	}
+	entry->metadata = std::move(metadata);
+	const std::string dataspaceUri = getDataspaceUri(uid.uri);
+
+	const std::lock_guard<std::mutex> lock(mutex);
+	checkWritable(transaction);
+	if (dataspaces.find(dataspaceUri) == dataspaces.end()) {
+		throw EtpException(11, "The dataspace " + dataspaceUri + " does not exist.");
+	}
+	const std::string key = getDataArrayKey(uid);
+	const int64_t now = nowInMicroseconds();
+	auto it = dataArrays.find(key);
+	entry->metadata.storeCreated = it == dataArrays.end() ? now : it->second->metadata.storeCreated;
+	entry->metadata.storeLastWrite = now;
+	touchDataspace(dataspaceUri, now);
+	replaceDataArray(key, entry, transaction);
+}
+
+/********************
+*** TRANSACTIONS ***
+********************/
+
+void InMemoryStore::startTransaction(Transaction& transaction, const std::vector<std::string>& dataspaceUris,
+	const Energistics::Etp::v12::Datatypes::Uuid& uuid, bool readOnly) const
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	if (transaction.isOpen()) {
+		throw EtpException(15, "A transaction is already open on this session.");
+	}
+	for (const auto& dataspaceUri : dataspaceUris) {
+		if (dataspaces.find(dataspaceUri) == dataspaces.end()) {
+			throw EtpException(11, "The dataspace " + dataspaceUri + " does not exist.");
+		}
+	}
+	transaction.uuid = uuid;
+	transaction.readOnly = readOnly;
+	transaction.open = true;
+}
+
+void InMemoryStore::commitTransaction(Transaction& transaction)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	if (!transaction.isOpen()) {
+		throw EtpException(8, "There is no open transaction to commit.");
+	}
+	transaction.previousDataspaces.clear();
+	transaction.previousDataObjects.clear();
+	transaction.previousDataArrays.clear();
+	transaction.open = false;
+}
+
+void InMemoryStore::rollbackTransaction(Transaction& transaction)
+{
+	const std::lock_guard<std::mutex> lock(mutex);
+	if (!transaction.isOpen()) {
+		throw EtpException(8, "There is no open transaction to roll back.");
+	}
+
+	// Restore the content before the dataspaces in order to clean the indexes of the dataspaces created in the transaction.
+	for (const auto& entry : transaction.previousDataObjects) {
+		replaceDataObject(entry.first, entry.second, nullptr);
+	}
+	for (const auto& entry : transaction.previousDataArrays) {
+		replaceDataArray(entry.first, entry.second, nullptr);
+	}
+	for (const auto& entry : transaction.previousDataspaces) {
+		replaceDataspace(entry.first, entry.second, nullptr);
+		if (entry.second == nullptr) {
+			dataspaceIndexes.erase(entry.first);
+		}
+	}
+
+	transaction.previousDataspaces.clear();
+	transaction.previousDataObjects.clear();
+	transaction.previousDataArrays.clear();
+	transaction.open = false;
+}
+
+/*****************
+*** INDEXING ***
+*****************/
+
+void InMemoryStore::replaceDataspace(const std::string& uri, std::shared_ptr<const Energistics::Etp::v12::Datatypes::Object::Dataspace> entry, Transaction* transaction)
+{
+	auto it = dataspaces.find(uri);
+	if (transaction != nullptr && transaction->isOpen()) {
+		transaction->previousDataspaces.emplace(uri, it == dataspaces.end() ? nullptr : it->second);
+	}
+
+	if (entry != nullptr) {
+		dataspaces[uri] = entry;
+	}
+	else if (it != dataspaces.end()) {
+		dataspaces.erase(it);
+	}
+}
+
+void InMemoryStore::replaceDataObject(const std::string& uri, std::shared_ptr<const InMemoryDataObjectEntry> entry, Transaction* transaction)
+{
+	auto it = dataObjects.find(uri);
+	if (transaction != nullptr && transaction->isOpen()) {
+		transaction->previousDataObjects.emplace(uri, it == dataObjects.end() ? nullptr : it->second);
+	}
+
+	if (it != dataObjects.end()) {
+		const InMemoryDataObjectEntry& previous = *it->second;
+		DataspaceIndex& index = dataspaceIndexes[previous.dataspaceUri];
+		auto typeIt = index.urisByType.find(previous.type);
+		if (typeIt != index.urisByType.end()) {
+			typeIt->second.erase(uri);
+			if (typeIt->second.empty()) {
+				index.urisByType.erase(typeIt);
+			}
+		}
+		auto uuidIt = index.urisByUuid.find(previous.uuid);
+		if (uuidIt != index.urisByUuid.end() && uuidIt->second == uri) {
+			index.urisByUuid.erase(uuidIt);
+		}
+		for (const auto& targetUuid : previous.targetUuids) {
+			auto sourcesIt = index.sourceUrisByTargetUuid.find(targetUuid);
+			if (sourcesIt != index.sourceUrisByTargetUuid.end()) {
+				sourcesIt->second.erase(uri);
+				if (sourcesIt->second.empty()) {
+					index.sourceUrisByTargetUuid.erase(sourcesIt);
+				}
+			}
+		}
+	}
+
+	if (entry != nullptr) {
+		DataspaceIndex& index = dataspaceIndexes[entry->dataspaceUri];
+		index.urisByType[entry->type].insert(uri);
+		index.urisByUuid[entry->uuid] = uri;
+		for (const auto& targetUuid : entry->targetUuids) {
+			index.sourceUrisByTargetUuid[targetUuid].insert(uri);
+		}
+		index.deletedResources.erase(uri);
+		dataObjects[uri] = entry;
+	}
+	else if (it != dataObjects.end()) {
+		dataObjects.erase(it);
+	}
+}
+
+void InMemoryStore::replaceDataArray(const std::string& key, std::shared_ptr<InMemoryDataArrayEntry> entry, Transaction* transaction)
+{
+	auto it = dataArrays.find(key);
+	if (transaction != nullptr && transaction->isOpen()) {
+		transaction->previousDataArrays.emplace(key, it == dataArrays.end() ? nullptr : it->second);
+	}
+
+	DataspaceIndex& index = dataspaceIndexes[getDataspaceUri(key.substr(0, key.find('\n')))];
+	if (entry != nullptr) {
+		index.dataArrayKeys.insert(key);
+		dataArrays[key] = entry;
+	}
+	else if (it != dataArrays.end()) {
+		index.dataArrayKeys.erase(key);
+		dataArrays.erase(it);
+	}
+}
+
+std::shared_ptr<InMemoryDataArrayEntry> InMemoryStore::getWritableDataArray(const std::string& key, Transaction* transaction)
+{
+	std::shared_ptr<InMemoryDataArrayEntry> result = dataArrays.at(key);
+	if (transaction != nullptr && transaction->isOpen() && transaction->previousDataArrays.find(key) == transaction->previousDataArrays.end()) {
+		// Copy on write in order for the transaction to keep the original entry
+		result = std::make_shared<InMemoryDataArrayEntry>(*result);
+		replaceDataArray(key, result, transaction);
+	}
+	return result;
+}
+
+void InMemoryStore::touchDataspace(const std::string& dataspaceUri, int64_t time)
+{
+	auto it = dataspaces.find(dataspaceUri);
+	if (it != dataspaces.end()) {
+		auto dataspace = std::make_shared<Energistics::Etp::v12::Datatypes::Object::Dataspace>(*it->second);
+		dataspace->storeLastWrite = time;
+		it->second = dataspace;
+	}
+}
+
+Energistics::Etp::v12::Datatypes::Object::Resource InMemoryStore::makeResource(const InMemoryDataObjectEntry& entry, bool countObjects) const
+{
+	Energistics::Etp::v12::Datatypes::Object::Resource result = entry.dataObject.resource;
+	if (countObjects) {
+		result.sourceCount = static_cast<int32_t>(getSourceUris(entry).size());
+		result.targetCount = static_cast<int32_t>(getTargetUris(entry).size());
+	}
+	return result;
+}
+
+std::vector<std::string> InMemoryStore::getTargetUris(const InMemoryDataObjectEntry& entry) const
+{
+	std::vector<std::string> result;
+	auto indexIt = dataspaceIndexes.find(entry.dataspaceUri);
+	if (indexIt != dataspaceIndexes.end()) {
+		for (const auto& targetUuid : entry.targetUuids) {
+			auto uuidIt = indexIt->second.urisByUuid.find(targetUuid);
+			if (uuidIt != indexIt->second.urisByUuid.end()) {
+				result.push_back(uuidIt->second);
+			}
+		}
+	}
+	return result;
+}
+
+std::vector<std::string> InMemoryStore::getSourceUris(const InMemoryDataObjectEntry& entry) const
+{
+	auto indexIt = dataspaceIndexes.find(entry.dataspaceUri);
+	if (indexIt == dataspaceIndexes.end()) {
+		return {};
+	}
+	auto sourcesIt = indexIt->second.sourceUrisByTargetUuid.find(entry.uuid);
+	return sourcesIt == indexIt->second.sourceUrisByTargetUuid.end()
+		? std::vector<std::string>()
+		: std::vector<std::string>(sourcesIt->second.begin(), sourcesIt->second.end());
+}
@@ -0,0 +1,277 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../../nsDefinitions.h"
+#include "../EtpMessages.h"
+
+#if defined(_WIN32) && !defined(FETPAPI_STATIC)
+	#ifndef FETPAPI_DLL_IMPORT_OR_EXPORT
+		#if defined(Fetpapi_EXPORTS)
+			#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllexport)
+		#else
+			#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllimport)
+		#endif
+	#endif
+#else
+	#define FETPAPI_DLL_IMPORT_OR_EXPORT
+#endif
+
+namespace ETP_NS
+{
+	struct InMemoryDataObjectEntry;
+	struct InMemoryDataArrayEntry;
+
+	/**
+	* A thread safe in-memory store of dataspaces, data objects and data arrays.
+	* It is a reference implementation of what the Store, Discovery, DataArray, Dataspace and Transaction protocols
+	* expect from a store and is meant to be a realistic local stand-in for a RDDMS (see InMemoryStoreHandlers.h).
+	*
+	* Data objects are indexed by URI, by dataspace and qualified type, and by dataspace and UUID.
+	* The edges of a data object are the UUID elements (RESQML 2.0 UUID or EML 2.3 Uuid) of its XML content :
+	* they are resolved in the dataspace of the data object when they are queried.
+	* Data arrays are stored as flat row major arrays indexed by URI and path in resource.
+	*
+	* All the methods report their failures by throwing an EtpException carrying the ETP error code to send back.
+	*/
+	class InMemoryStore
+	{
+	public:
+		/**
+		* The state which the store entries had before their first modification in an ETP transaction.
+		* A transaction is not isolated from the other sessions : it only allows to roll back its own modifications.
+		*/
+		class Transaction
+		{
+		public:
+			Energistics::Etp::v12::Datatypes::Uuid uuid = {};
+			bool readOnly = false;
+
+			bool isOpen() const { return open; }
+
+		private:
+			friend class InMemoryStore;
+
+			bool open = false;
+			std::unordered_map<std::string, std::shared_ptr<const Energistics::Etp::v12::Datatypes::Object::Dataspace>> previousDataspaces;
+			std::unordered_map<std::string, std::shared_ptr<const InMemoryDataObjectEntry>> previousDataObjects;
+			std::unordered_map<std::string, std::shared_ptr<InMemoryDataArrayEntry>> previousDataArrays;
+		};
+
+		/**
+		* @param maxSubarrayByteCount		The maximal size of the subarrays the store advertises in the preferredSubarrayDimensions of the data array metadata.
+		* @param maxUninitializedByteCount	The maximal size of a data array created by putUninitializedDataArray, whose values are all allocated at once.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT InMemoryStore(int64_t maxSubarrayByteCount = 4000000, int64_t maxUninitializedByteCount = 1000000000);
+
+		/******************
+		*** DATASPACES ***
+		******************/
+
+		/**
+		* The default dataspace eml:/// always exists and is not returned.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::vector<Energistics::Etp::v12::Datatypes::Object::Dataspace> getDataspaces(int64_t storeLastWriteFilter = -1) const;
+
+		/**
+		* Create or update a dataspace.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void putDataspace(Energistics::Etp::v12::Datatypes::Object::Dataspace dataspace, Transaction* transaction = nullptr);
+
+		/**
+		* Delete a dataspace with all its data objects and data arrays.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void deleteDataspace(const std::string& uri, Transaction* transaction = nullptr);
+
+		/********************
+		*** DATA OBJECTS ***
+		********************/
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT Energistics::Etp::v12::Datatypes::Object::DataObject getDataObject(const std::string& uri) const;
+
+		/**
+		* Create or update a data object. Its dataspace must already exist.
+		* The store sets the storeCreated and storeLastWrite of its resource.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void putDataObject(Energistics::Etp::v12::Datatypes::Object::DataObject dataObject, Transaction* transaction = nullptr);
+
+		/**
+		* Delete a data object and remember it as a deleted resource of its dataspace.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void deleteDataObject(const std::string& uri, Transaction* transaction = nullptr);
+
+		/**
+		* Discover the resources in a context.
+		* The context URI is either a dataspace URI, whose data objects are all returned, or a data object URI which is the start
+		* of a traversal of the edges up to the depth of the context.
+		*
+		* @param edges	If not null, it receives the edges between the returned resources.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::vector<Energistics::Etp::v12::Datatypes::Object::Resource> getResources(const Energistics::Etp::v12::Datatypes::Object::ContextInfo& context,
+			Energistics::Etp::v12::Datatypes::Object::ContextScopeKind scope,
+			int64_t storeLastWriteFilter = -1,
+			boost::optional<Energistics::Etp::v12::Datatypes::Object::ActiveStatusKind> activeStatusFilter = boost::none,
+			bool countObjects = false,
+			std::vector<Energistics::Etp::v12::Datatypes::Object::Edge>* edges = nullptr) const;
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::vector<Energistics::Etp::v12::Datatypes::Object::DeletedResource> getDeletedResources(const std::string& dataspaceUri,
+			int64_t deleteTimeFilter = -1, const std::vector<std::string>& dataObjectTypes = {}) const;
+
+		/*******************
+		*** DATA ARRAYS ***
+		*******************/
+
+		/**
+		* Copy all the values of a data array.
+		*
+		* @param maxByteCount	The maximal byte count of the values, typically the MaxWebSocketMessagePayloadSize of the session which is going to send them.
+		* @throw EtpException 17 if the values are bigger : they must be read by subarrays.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray getDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+			int64_t maxByteCount = (std::numeric_limits<int64_t>::max)()) const;
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata getDataArrayMetadata(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid) const;
+
+		/**
+		* Copy the values of a subarray.
+		*
+		* @param maxByteCount	The maximal byte count of the values, typically the MaxWebSocketMessagePayloadSize of the session which is going to send them.
+		* @throw EtpException 17 if the values are bigger : they must be read by smaller subarrays.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray getDataSubarray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+			const std::vector<int64_t>& starts, const std::vector<int64_t>& counts, int64_t maxByteCount = (std::numeric_limits<int64_t>::max)()) const;
+
+		/**
+		* Create or replace a data array. The dataspace of its URI must already exist.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void putDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+			const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray& dataArray, Transaction* transaction = nullptr);
+
+		/**
+		* Write a subarray in an existing data array. The values must have the transport type of the data array.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void putDataSubarray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+			const Energistics::Etp::v12::Datatypes::AnyArray& data, const std::vector<int64_t>& starts, const std::vector<int64_t>& counts, Transaction* transaction = nullptr);
+
+		/**
+		* Create or replace a data array whose values are zeros, false or empty strings according to the transport type of the metadata.
+		* The preferredSubarrayDimensions of the metadata are computed by the store if they are missing.
+		* @throw EtpException 12 if the data array is bigger than the maxUninitializedByteCount given to the constructor or cannot be allocated.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void putUninitializedDataArray(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid,
+			Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata metadata, Transaction* transaction = nullptr);
+
+		/********************
+		*** TRANSACTIONS ***
+		********************/
+
+		/**
+		* Open a transaction on some dataspaces. They all must exist. No dataspace means the default dataspace.
+		*
+		* @param uuid		The identifier of the transaction
+		* @param readOnly	True if the store cannot be modified in the transaction
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void startTransaction(Transaction& transaction, const std::vector<std::string>& dataspaceUris,
+			const Energistics::Etp::v12::Datatypes::Uuid& uuid, bool readOnly = false) const;
+
+		/**
+		* Keep the modifications of a transaction and close it.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void commitTransaction(Transaction& transaction);
+
+		/**
+		* Restore the entries the transaction has modified and close it.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void rollbackTransaction(Transaction& transaction);
+
+		/**
+		* @return The dataspace URI of a data object URI, eml:/// being the default dataspace.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT static std::string getDataspaceUri(const std::string& uri);
+
+	private:
+		/// The secondary indexes of a dataspace content
+		struct DataspaceIndex {
+			/// Ordered in order to look up the wildcard types such as resqml20.* as a range
+			std::map<std::string, std::set<std::string>> urisByType;
+			std::unordered_map<std::string, std::string> urisByUuid;
+			/// The URIs of the data objects referencing a UUID
+			std::unordered_map<std::string, std::unordered_set<std::string>> sourceUrisByTargetUuid;
+			std::unordered_set<std::string> dataArrayKeys;
+			std::map<std::string, Energistics::Etp::v12::Datatypes::Object::DeletedResource> deletedResources;
+		};
+
+		/**
+		* Replace the entry of a dataspace, a data object or a data array and maintain the indexes.
+		* A null entry removes the existing one. The previous entry is recorded in the transaction if it is open.
+		*/
+		void replaceDataspace(const std::string& uri, std::shared_ptr<const Energistics::Etp::v12::Datatypes::Object::Dataspace> entry, Transaction* transaction);
+		void replaceDataObject(const std::string& uri, std::shared_ptr<const InMemoryDataObjectEntry> entry, Transaction* transaction);
+		void replaceDataArray(const std::string& key, std::shared_ptr<InMemoryDataArrayEntry> entry, Transaction* transaction);
+
+		/**
+		* @return The data array entry which can be modified in place : it is a copy if the transaction has to keep the original one.
+		*/
+		std::shared_ptr<InMemoryDataArrayEntry> getWritableDataArray(const std::string& key, Transaction* transaction);
+
+		void touchDataspace(const std::string& dataspaceUri, int64_t time);
+		Energistics::Etp::v12::Datatypes::Object::Resource makeResource(const InMemoryDataObjectEntry& entry, bool countObjects) const;
+		std::vector<std::string> getTargetUris(const InMemoryDataObjectEntry& entry) const;
+		std::vector<std::string> getSourceUris(const InMemoryDataObjectEntry& entry) const;
+
+		mutable std::mutex mutex;
+		int64_t maxSubarrayByteCount;
+		int64_t maxUninitializedByteCount;
+
+		/// Immutable entries which are shared with the transactions which have modified them
+		std::unordered_map<std::string, std::shared_ptr<const Energistics::Etp::v12::Datatypes::Object::Dataspace>> dataspaces;
+		std::unordered_map<std::string, std::shared_ptr<const InMemoryDataObjectEntry>> dataObjects;
+		/// Indexed by URI and path in resource. Modified in place unless a transaction has to keep the original entry.
+		std::unordered_map<std::string, std::shared_ptr<InMemoryDataArrayEntry>> dataArrays;
+		std::unordered_map<std::string, DataspaceIndex> dataspaceIndexes;
+	};
+
+	/**
+	* A data object with the information the store indexes.
+	*/
+	struct InMemoryDataObjectEntry {
+		Energistics::Etp::v12::Datatypes::Object::DataObject dataObject;
+		std::string dataspaceUri;
+		std::string type;
+		std::string uuid;
+		/// The UUIDs this data object references in its XML content
+		std::vector<std::string> targetUuids;
+	};
+
+	/**
+	* A data array stored as a flat row major array.
+	*/
+	struct InMemoryDataArrayEntry {
+		Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata metadata;
+		Energistics::Etp::v12::Datatypes::AnyArray data;
+	};
+}
@@ -0,0 +1,354 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "InMemoryStoreHandlers.h"
+
+#include <algorithm>
+
+#include <boost/uuid/random_generator.hpp>
+
+#include "../AbstractSession.h"
+#include "../EtpException.h"
+#include "../EtpHelpers.h"
+#include "StoreHelpers.h"
+
+using namespace ETP_NS;
+using namespace ETP_NS::StoreHelpers;
+
+namespace {
+	bool isSameUuid(const Energistics::Etp::v12::Datatypes::Uuid& a, const Energistics::Etp::v12::Datatypes::Uuid& b)
+	{
+		return a.array == b.array;
+	}
+}
+
+/*************
+*** STORE ***
+*************/
+
+void InMemoryStoreHandlers::on_GetDataObjects(const Energistics::Etp::v12::Protocol::Store::GetDataObjects& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::Store::GetDataObjectsResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.uris) {
+		try {
+			appendEntry(response.dataObjects, entry.first, store->getDataObject(entry.second));
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.dataObjects.empty(), errors, correlationId);
+}
+
+void InMemoryStoreHandlers::on_PutDataObjects(const Energistics::Etp::v12::Protocol::Store::PutDataObjects& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::Store::PutDataObjectsResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.dataObjects) {
+		try {
+			store->putDataObject(entry.second, transaction.get());
+			appendEntry(response.success, entry.first);
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.success.empty(), errors, correlationId);
+}
+
+void InMemoryStoreHandlers::on_DeleteDataObjects(const Energistics::Etp::v12::Protocol::Store::DeleteDataObjects& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::Store::DeleteDataObjectsResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.uris) {
+		try {
+			store->deleteDataObject(entry.second, transaction.get());
+			appendEntry(response.deletedUris, entry.first).values.push_back(entry.second);
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.deletedUris.empty(), errors, correlationId);
+}
+
+/*****************
+*** DISCOVERY ***
+*****************/
+
+void InMemoryDiscoveryHandlers::on_GetResources(const Energistics::Etp::v12::Protocol::Discovery::GetResources& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::Discovery::GetResourcesResponse response;
+	Energistics::Etp::v12::Protocol::Discovery::GetResourcesEdgesResponse edgesResponse;
+	try {
+		response.resources = store->getResources(msg.context, msg.scope,
+			msg.storeLastWriteFilter ? msg.storeLastWriteFilter.get() : -1,
+			msg.activeStatusFilter,
+			msg.countObjects,
+			msg.includeEdges ? &edgesResponse.edges : nullptr);
+	}
+	catch (const EtpException& e) {
+		session->send(ETP_NS::EtpHelpers::buildSingleMessageProtocolException(e.getErrorCode(), e.what()), correlationId, 0x02);
+		return;
+	}
+
+	if (msg.includeEdges) {
+		session->send(response, correlationId);
+		session->send(edgesResponse, correlationId, 0x02);
+	}
+	else {
+		session->send(response, correlationId, 0x02);
+	}
+}
+
+void InMemoryDiscoveryHandlers::on_GetDeletedResources(const Energistics::Etp::v12::Protocol::Discovery::GetDeletedResources& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::Discovery::GetDeletedResourcesResponse response;
+	try {
+		response.deletedResources = store->getDeletedResources(msg.dataspaceUri,
+			msg.deleteTimeFilter ? msg.deleteTimeFilter.get() : -1,
+			msg.dataObjectTypes);
+	}
+	catch (const EtpException& e) {
+		session->send(ETP_NS::EtpHelpers::buildSingleMessageProtocolException(e.getErrorCode(), e.what()), correlationId, 0x02);
+		return;
+	}
+	session->send(response, correlationId, 0x02);
+}
+
+/******************
+*** DATA ARRAY ***
+******************/
+
+void InMemoryDataArrayHandlers::on_GetDataArrays(const Energistics::Etp::v12::Protocol::DataArray::GetDataArrays& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::DataArray::GetDataArraysResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.dataArrays) {
+		try {
+			appendEntry(response.dataArrays, entry.first, store->getDataArray(entry.second, session->getMaxWebSocketMessagePayloadSize()));
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.dataArrays.empty(), errors, correlationId);
+}
+
+void InMemoryDataArrayHandlers::on_PutDataArrays(const Energistics::Etp::v12::Protocol::DataArray::PutDataArrays& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::DataArray::PutDataArraysResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.dataArrays) {
+		try {
+			store->putDataArray(entry.second.uid, entry.second.array, transaction.get());
+			appendEntry(response.success, entry.first);
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.success.empty(), errors, correlationId);
+}
+
+void InMemoryDataArrayHandlers::on_GetDataSubarrays(const Energistics::Etp::v12::Protocol::DataArray::GetDataSubarrays& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::DataArray::GetDataSubarraysResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.dataSubarrays) {
+		try {
+			appendEntry(response.dataSubarrays, entry.first, store->getDataSubarray(entry.second.uid, entry.second.starts, entry.second.counts, session->getMaxWebSocketMessagePayloadSize()));
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.dataSubarrays.empty(), errors, correlationId);
+}
+
+void InMemoryDataArrayHandlers::on_PutDataSubarrays(const Energistics::Etp::v12::Protocol::DataArray::PutDataSubarrays& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::DataArray::PutDataSubarraysResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.dataSubarrays) {
+		try {
+			store->putDataSubarray(entry.second.uid, entry.second.data, entry.second.starts, entry.second.counts, transaction.get());
+			appendEntry(response.success, entry.first);
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.success.empty(), errors, correlationId);
+}
+
+void InMemoryDataArrayHandlers::on_GetDataArrayMetadata(const Energistics::Etp::v12::Protocol::DataArray::GetDataArrayMetadata& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::DataArray::GetDataArrayMetadataResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.dataArrays) {
+		try {
+			appendEntry(response.arrayMetadata, entry.first, store->getDataArrayMetadata(entry.second));
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.arrayMetadata.empty(), errors, correlationId);
+}
+
+void InMemoryDataArrayHandlers::on_PutUninitializedDataArrays(const Energistics::Etp::v12::Protocol::DataArray::PutUninitializedDataArrays& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::DataArray::PutUninitializedDataArraysResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.dataArrays) {
+		try {
+			store->putUninitializedDataArray(entry.second.uid, entry.second.metadata, transaction.get());
+			appendEntry(response.success, entry.first);
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.success.empty(), errors, correlationId);
+}
+
+/*****************
+*** DATASPACE ***
+*****************/
+
+void InMemoryDataspaceHandlers::on_GetDataspaces(const Energistics::Etp::v12::Protocol::Dataspace::GetDataspaces& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::Dataspace::GetDataspacesResponse response;
+	response.dataspaces = store->getDataspaces(msg.storeLastWriteFilter ? msg.storeLastWriteFilter.get() : -1);
+	session->send(response, correlationId, 0x02);
+}
+
+void InMemoryDataspaceHandlers::on_PutDataspaces(const Energistics::Etp::v12::Protocol::Dataspace::PutDataspaces& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::Dataspace::PutDataspacesResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.dataspaces) {
+		try {
+			store->putDataspace(entry.second, transaction.get());
+			appendEntry(response.success, entry.first);
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.success.empty(), errors, correlationId);
+}
+
+void InMemoryDataspaceHandlers::on_DeleteDataspaces(const Energistics::Etp::v12::Protocol::Dataspace::DeleteDataspaces& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::Dataspace::DeleteDataspacesResponse response;
+	std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+	for (const auto& entry : msg.uris) {
+		try {
+			store->deleteDataspace(entry.second, transaction.get());
+			appendEntry(response.success, entry.first);
+		}
+		catch (const EtpException& e) {
+			addError(errors, entry.first, e);
+		}
+	}
+	sendMapResponse(session, response, !response.success.empty(), errors, correlationId);
+}
+
+/*******************
+*** TRANSACTION ***
+*******************/
+
+InMemoryTransactionHandlers::~InMemoryTransactionHandlers()
+{
+	if (transaction->isOpen()) {
+		store->rollbackTransaction(*transaction);
+	}
+}
+
+void InMemoryTransactionHandlers::on_StartTransaction(const Energistics::Etp::v12::Protocol::Transaction::StartTransaction& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::Transaction::StartTransactionResponse response;
+	try {
+		const boost::uuids::uuid uuid = boost::uuids::random_generator()();
+		Energistics::Etp::v12::Datatypes::Uuid transactionUuid;
+		std::copy(std::begin(uuid.data), std::end(uuid.data), transactionUuid.array.begin());
+		store->startTransaction(*transaction, msg.dataspaceUris, transactionUuid, msg.readOnly);
+		response.transactionUuid = transactionUuid;
+		response.successful = true;
+	}
+	catch (const EtpException& e) {
+		response.failureReason = e.what();
+	}
+	session->send(response, correlationId, 0x02);
+}
+
+void InMemoryTransactionHandlers::on_CommitTransaction(const Energistics::Etp::v12::Protocol::Transaction::CommitTransaction& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::Transaction::CommitTransactionResponse response;
+	response.transactionUuid = msg.transactionUuid;
+	if (!transaction->isOpen() || !isSameUuid(msg.transactionUuid, transaction->uuid)) {
+		response.failureReason = "The transaction to commit is not the open transaction of the session.";
+	}
+	else {
+		store->commitTransaction(*transaction);
+		response.successful = true;
+	}
+	session->send(response, correlationId, 0x02);
+}
+
+void InMemoryTransactionHandlers::on_RollbackTransaction(const Energistics::Etp::v12::Protocol::Transaction::RollbackTransaction& msg, int64_t correlationId)
+{
+	Energistics::Etp::v12::Protocol::Transaction::RollbackTransactionResponse response;
+	response.transactionUuid = msg.transactionUuid;
+	if (!transaction->isOpen() || !isSameUuid(msg.transactionUuid, transaction->uuid)) {
+		response.failureReason = "The transaction to roll back is not the open transaction of the session.";
+	}
+	else {
+		store->rollbackTransaction(*transaction);
+		response.successful = true;
+	}
+	session->send(response, correlationId, 0x02);
+}
+
+/*********************************
+*** INITIALIZATION PARAMETERS ***
+*********************************/
+
+std::vector<Energistics::Etp::v12::Datatypes::SupportedProtocol> InMemoryStoreServerInitializationParameters::makeSupportedProtocols() const
+{
+	std::vector<Energistics::Etp::v12::Datatypes::SupportedProtocol> result = ServerInitializationParameters::makeSupportedProtocols();
+	result.erase(std::remove_if(result.begin(), result.end(), [](const Energistics::Etp::v12::Datatypes::SupportedProtocol& supportedProtocol) {
+		return supportedProtocol.protocol == static_cast<int32_t>(Energistics::Etp::v12::Datatypes::Protocol::StoreNotification);
+	}), result.end());
+	return result;
+}
+
+void InMemoryStoreServerInitializationParameters::postSessionCreationOperation(AbstractSession* session) const
+{
+	ServerInitializationParameters::postSessionCreationOperation(session);
+
+	auto transaction = std::make_shared<InMemoryStore::Transaction>();
+	session->setStoreProtocolHandlers(std::make_shared<InMemoryStoreHandlers>(session, store, transaction));
+	session->setDiscoveryProtocolHandlers(std::make_shared<InMemoryDiscoveryHandlers>(session, store));
+	session->setDataArrayProtocolHandlers(std::make_shared<InMemoryDataArrayHandlers>(session, store, transaction));
+	session->setDataspaceProtocolHandlers(std::make_shared<InMemoryDataspaceHandlers>(session, store, transaction));
+	session->setTransactionProtocolHandlers(std::make_shared<InMemoryTransactionHandlers>(session, store, transaction));
+}
@@ -0,0 +1,154 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include "../ProtocolHandlers/DataArrayHandlers.h"
+#include "../ProtocolHandlers/DataspaceHandlers.h"
+#include "../ProtocolHandlers/DiscoveryHandlers.h"
+#include "../ProtocolHandlers/StoreHandlers.h"
+#include "../ProtocolHandlers/TransactionHandlers.h"
+#include "../ServerInitializationParameters.h"
+
+#include "InMemoryStore.h"
+
+namespace ETP_NS
+{
+	/**
+	* Server side Store protocol handlers which answer from an InMemoryStore.
+	* The modifications are recorded in the open transaction of the session, if any.
+	*/
+	class FETPAPI_DLL_IMPORT_OR_EXPORT InMemoryStoreHandlers : public StoreHandlers
+	{
+	public:
+		InMemoryStoreHandlers(AbstractSession* mySession, std::shared_ptr<InMemoryStore> store, std::shared_ptr<InMemoryStore::Transaction> transaction) :
+			StoreHandlers(mySession), store(store), transaction(transaction) {}
+		virtual ~InMemoryStoreHandlers() = default;
+
+		void on_GetDataObjects(const Energistics::Etp::v12::Protocol::Store::GetDataObjects& msg, int64_t correlationId) override;
+		void on_PutDataObjects(const Energistics::Etp::v12::Protocol::Store::PutDataObjects& msg, int64_t correlationId) override;
+		void on_DeleteDataObjects(const Energistics::Etp::v12::Protocol::Store::DeleteDataObjects& msg, int64_t correlationId) override;
+
+	protected:
+		std::shared_ptr<InMemoryStore> store;
+		std::shared_ptr<InMemoryStore::Transaction> transaction;
+	};
+
+	/**
+	* Server side Discovery protocol handlers which answer from an InMemoryStore.
+	*/
+	class FETPAPI_DLL_IMPORT_OR_EXPORT InMemoryDiscoveryHandlers : public DiscoveryHandlers
+	{
+	public:
+		InMemoryDiscoveryHandlers(AbstractSession* mySession, std::shared_ptr<InMemoryStore> store) :
+			DiscoveryHandlers(mySession), store(store) {}
+		virtual ~InMemoryDiscoveryHandlers() = default;
+
+		void on_GetResources(const Energistics::Etp::v12::Protocol::Discovery::GetResources& msg, int64_t correlationId) override;
+		void on_GetDeletedResources(const Energistics::Etp::v12::Protocol::Discovery::GetDeletedResources& msg, int64_t correlationId) override;
+
+	protected:
+		std::shared_ptr<InMemoryStore> store;
+	};
+
+	/**
+	* Server side DataArray protocol handlers which answer from an InMemoryStore.
+	*/
+	class FETPAPI_DLL_IMPORT_OR_EXPORT InMemoryDataArrayHandlers : public DataArrayHandlers
+	{
+	public:
+		InMemoryDataArrayHandlers(AbstractSession* mySession, std::shared_ptr<InMemoryStore> store, std::shared_ptr<InMemoryStore::Transaction> transaction) :
+			DataArrayHandlers(mySession), store(store), transaction(transaction) {}
+		virtual ~InMemoryDataArrayHandlers() = default;
+
+		void on_GetDataArrays(const Energistics::Etp::v12::Protocol::DataArray::GetDataArrays& msg, int64_t correlationId) override;
+		void on_PutDataArrays(const Energistics::Etp::v12::Protocol::DataArray::PutDataArrays& msg, int64_t correlationId) override;
+		void on_GetDataSubarrays(const Energistics::Etp::v12::Protocol::DataArray::GetDataSubarrays& msg, int64_t correlationId) override;
+		void on_PutDataSubarrays(const Energistics::Etp::v12::Protocol::DataArray::PutDataSubarrays& msg, int64_t correlationId) override;
+		void on_GetDataArrayMetadata(const Energistics::Etp::v12::Protocol::DataArray::GetDataArrayMetadata& msg, int64_t correlationId) override;
+		void on_PutUninitializedDataArrays(const Energistics::Etp::v12::Protocol::DataArray::PutUninitializedDataArrays& msg, int64_t correlationId) override;
+
+	protected:
+		std::shared_ptr<InMemoryStore> store;
+		std::shared_ptr<InMemoryStore::Transaction> transaction;
+	};
+
+	/**
+	* Server side Dataspace protocol handlers which answer from an InMemoryStore.
+	*/
+	class FETPAPI_DLL_IMPORT_OR_EXPORT InMemoryDataspaceHandlers : public DataspaceHandlers
+	{
+	public:
+		InMemoryDataspaceHandlers(AbstractSession* mySession, std::shared_ptr<InMemoryStore> store, std::shared_ptr<InMemoryStore::Transaction> transaction) :
+			DataspaceHandlers(mySession), store(store), transaction(transaction) {}
+		virtual ~InMemoryDataspaceHandlers() = default;
+
+		void on_GetDataspaces(const Energistics::Etp::v12::Protocol::Dataspace::GetDataspaces& msg, int64_t correlationId) override;
+		void on_PutDataspaces(const Energistics::Etp::v12::Protocol::Dataspace::PutDataspaces& msg, int64_t correlationId) override;
+		void on_DeleteDataspaces(const Energistics::Etp::v12::Protocol::Dataspace::DeleteDataspaces& msg, int64_t correlationId) override;
+
+	protected:
+		std::shared_ptr<InMemoryStore> store;
+		std::shared_ptr<InMemoryStore::Transaction> transaction;
+	};
+
+	/**
+	* Server side Transaction protocol handlers which open, commit and roll back the transaction of a session on an InMemoryStore.
+	* A transaction which is still open when the session is destroyed is rolled back.
+	*/
+	class FETPAPI_DLL_IMPORT_OR_EXPORT InMemoryTransactionHandlers : public TransactionHandlers
+	{
+	public:
+		InMemoryTransactionHandlers(AbstractSession* mySession, std::shared_ptr<InMemoryStore> store, std::shared_ptr<InMemoryStore::Transaction> transaction) :
+			TransactionHandlers(mySession), store(store), transaction(transaction) {}
+		virtual ~InMemoryTransactionHandlers();
+
+		void on_StartTransaction(const Energistics::Etp::v12::Protocol::Transaction::StartTransaction& msg, int64_t correlationId) override;
+		void on_CommitTransaction(const Energistics::Etp::v12::Protocol::Transaction::CommitTransaction& msg, int64_t correlationId) override;
+		void on_RollbackTransaction(const Energistics::Etp::v12::Protocol::Transaction::RollbackTransaction& msg, int64_t correlationId) override;
+
+	protected:
+		std::shared_ptr<InMemoryStore> store;
+		std::shared_ptr<InMemoryStore::Transaction> transaction;
+	};
+
+	/**
+	* Server initialization parameters which register the in-memory store handlers on each session.
+	* All the sessions share the same store whereas each session has its own transaction.
+	*/
+	class InMemoryStoreServerInitializationParameters : public ServerInitializationParameters
+	{
+	public:
+		InMemoryStoreServerInitializationParameters(boost::uuids::uuid instanceUuid, const std::string & host, unsigned short port,
+			std::shared_ptr<InMemoryStore> store = std::make_shared<InMemoryStore>()) :
+			ServerInitializationParameters(instanceUuid, host, port), store(store) {}
+		virtual ~InMemoryStoreServerInitializationParameters() = default;
+
+		std::shared_ptr<InMemoryStore> getStore() const { return store; }
+
+		/**
+		* The StoreNotification protocol is not supported by the in-memory store handlers.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::vector<Energistics::Etp::v12::Datatypes::SupportedProtocol> makeSupportedProtocols() const override;
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT void postSessionCreationOperation(AbstractSession* session) const override;
+
+	private:
+		std::shared_ptr<InMemoryStore> store;
+	};
+}
@@ -0,0 +1,176 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#include "StoreHelpers.h"
+
+#include <limits>
+#include <new>
+#include <stdexcept>
+
+using namespace ETP_NS;
+
+std::string StoreHelpers::getDataArrayKey(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid)
+{
+	return uid.uri + '\n' + uid.pathInResource;
+}
+
+size_t StoreHelpers::getElementCount(const std::vector<int64_t>& dimensions)
+{
+	if (dimensions.empty()) {
+		throw EtpException(5, "A data array must have at least one dimension.");
+	}
+	size_t result = 1;
+	for (const auto dimension : dimensions) {
+		if (dimension < 0) {
+			throw EtpException(5, "A data array cannot have a negative dimension.");
+		}
+		if (dimension != 0 && result > static_cast<size_t>((std::numeric_limits<int64_t>::max)()) / static_cast<size_t>(dimension)) {
+			throw EtpException(5, "The dimensions of a data array are too big : its element count cannot be represented.");
+		}
+		result *= static_cast<size_t>(dimension);
+	}
+	return result;
+}
+
+int64_t StoreHelpers::getByteCount(const std::vector<int64_t>& dimensions, Energistics::Etp::v12::Datatypes::AnyArrayType type)
+{
+	const size_t elementCount = getElementCount(dimensions);
+	const int64_t elementByteCount = getElementByteCount(type);
+	if (elementCount > static_cast<size_t>((std::numeric_limits<int64_t>::max)() / elementByteCount)) {
+		throw EtpException(5, "The dimensions of a data array are too big : its byte count cannot be represented.");
+	}
+	return static_cast<int64_t>(elementCount) * elementByteCount;
+}
+
+void StoreHelpers::checkReadByteCount(const std::vector<int64_t>& counts, Energistics::Etp::v12::Datatypes::AnyArrayType type, int64_t maxByteCount)
+{
+	const int64_t byteCount = getByteCount(counts, type);
+	if (byteCount > maxByteCount) {
+		throw EtpException(17, "The " + std::to_string(byteCount) + " bytes of the requested values exceed the maximal message payload size of "
+			+ std::to_string(maxByteCount) + " bytes. Get them by means of GetDataSubarrays with smaller subarrays.");
+	}
+}
+
+size_t StoreHelpers::getValueCount(const Energistics::Etp::v12::Datatypes::AnyArray& anyArray)
+{
+	switch (anyArray.item.idx()) {
+	case 0: return anyArray.item.get_ArrayOfBoolean().values.size();
+	case 1: return anyArray.item.get_ArrayOfInt().values.size();
+	case 2: return anyArray.item.get_ArrayOfLong().values.size();
+	case 3: return anyArray.item.get_ArrayOfFloat().values.size();
+	case 4: return anyArray.item.get_ArrayOfDouble().values.size();
+	case 5: return anyArray.item.get_ArrayOfString().values.size();
+	default: return anyArray.item.get_bytes().size();
+	}
+}
+
+Energistics::Etp::v12::Datatypes::AnyArray StoreHelpers::makeValues(Energistics::Etp::v12::Datatypes::AnyArrayType type, size_t count)
+{
+	Energistics::Etp::v12::Datatypes::AnyArray result;
+	try {
+		switch (type) {
+		case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfBoolean:
+			result.item.set_ArrayOfBoolean(Energistics::Etp::v12::Datatypes::ArrayOfBoolean());
+			result.item.get_ArrayOfBoolean().values.resize(count);
+			break;
+		case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfInt:
+			result.item.set_ArrayOfInt(Energistics::Etp::v12::Datatypes::ArrayOfInt());
+			result.item.get_ArrayOfInt().values.resize(count);
+			break;
+		case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfLong:
+			result.item.set_ArrayOfLong(Energistics::Etp::v12::Datatypes::ArrayOfLong());
+			result.item.get_ArrayOfLong().values.resize(count);
+			break;
+		case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfFloat:
+			result.item.set_ArrayOfFloat(Energistics::Etp::v12::Datatypes::ArrayOfFloat());
+			result.item.get_ArrayOfFloat().values.resize(count);
+			break;
+		case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfDouble:
+			result.item.set_ArrayOfDouble(Energistics::Etp::v12::Datatypes::ArrayOfDouble());
+			result.item.get_ArrayOfDouble().values.resize(count);
+			break;
+		case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfString:
+			result.item.set_ArrayOfString(Energistics::Etp::v12::Datatypes::ArrayOfString());
+			result.item.get_ArrayOfString().values.resize(count);
+			break;
+		default:
+			result.item.set_bytes(std::string());
+			result.item.get_bytes().resize(count);
+		}
+	}
+	catch (const std::bad_alloc&) {
+		throw EtpException(12, "The store cannot allocate " + std::to_string(count) + " values.");
+	}
+	catch (const std::length_error&) {
+		throw EtpException(12, "The store cannot allocate " + std::to_string(count) + " values.");
+	}
+	return result;
+}
+
+int64_t StoreHelpers::getElementByteCount(Energistics::Etp::v12::Datatypes::AnyArrayType type)
+{
+	switch (type) {
+	case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfInt:
+	case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfFloat: return 4;
+	case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfLong:
+	case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfDouble: return 8;
+	// Rough estimation of an average string
+	case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfString: return 32;
+	default: return 1;
+	}
+}
+
+Energistics::Etp::v12::Datatypes::AnyLogicalArrayType StoreHelpers::getLogicalArrayType(Energistics::Etp::v12::Datatypes::AnyArrayType type)
+{
+	switch (type) {
+	case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfBoolean: return Energistics::Etp::v12::Datatypes::AnyLogicalArrayType::arrayOfBoolean;
+	case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfInt: return Energistics::Etp::v12::Datatypes::AnyLogicalArrayType::arrayOfInt32LE;
+	case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfLong: return Energistics::Etp::v12::Datatypes::AnyLogicalArrayType::arrayOfInt64LE;
+	case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfFloat: return Energistics::Etp::v12::Datatypes::AnyLogicalArrayType::arrayOfFloat32LE;
+	case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfDouble: return Energistics::Etp::v12::Datatypes::AnyLogicalArrayType::arrayOfDouble64LE;
+	case Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfString: return Energistics::Etp::v12::Datatypes::AnyLogicalArrayType::arrayOfString;
+	default: return Energistics::Etp::v12::Datatypes::AnyLogicalArrayType::arrayOfUInt8;
+	}
+}
+
+std::vector<int64_t> StoreHelpers::computePreferredSubarrayDimensions(const std::vector<int64_t>& dimensions, int64_t elementByteCount, int64_t maxSubarrayByteCount)
+{
+	std::vector<int64_t> result(dimensions.size(), 1);
+	int64_t remainingElementCount = (std::max)(maxSubarrayByteCount / elementByteCount, static_cast<int64_t>(1));
+	for (size_t i = dimensions.size(); i-- > 0;) {
+		if (dimensions[i] > remainingElementCount) {
+			result[i] = remainingElementCount;
+			break;
+		}
+		result[i] = dimensions[i];
+		remainingElementCount /= (std::max)(dimensions[i], static_cast<int64_t>(1));
+	}
+	return result;
+}
+
+void StoreHelpers::checkSubarray(const std::vector<int64_t>& dimensions, const std::vector<int64_t>& starts, const std::vector<int64_t>& counts)
+{
+	if (starts.size() != dimensions.size() || counts.size() != dimensions.size()) {
+		throw EtpException(5, "The starts and counts of a subarray must have as many items as the data array has dimensions.");
+	}
+	for (size_t i = 0; i < dimensions.size(); ++i) {
+		if (starts[i] < 0 || counts[i] < 0 || starts[i] + counts[i] > dimensions[i]) {
+			throw EtpException(5, "The subarray is out of the data array dimensions.");
+		}
+	}
+}
@@ -0,0 +1,196 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../../nsDefinitions.h"
+#include "../AbstractSession.h"
+#include "../EtpException.h"
+
+#if defined(_WIN32) && !defined(FETPAPI_STATIC)
+	#ifndef FETPAPI_DLL_IMPORT_OR_EXPORT
+		#if defined(Fetpapi_EXPORTS)
+			#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllexport)
+		#else
+			#define FETPAPI_DLL_IMPORT_OR_EXPORT __declspec(dllimport)
+		#endif
+	#endif
+#else
+	#define FETPAPI_DLL_IMPORT_OR_EXPORT
+#endif
+
+namespace ETP_NS
+{
+	/**
+	* Helpers shared by the store implementations and their protocol handlers.
+	* The failures are reported by throwing an EtpException carrying the ETP error code to send back.
+	*/
+	namespace StoreHelpers {
+
+		/**
+		* @return The key identifying a data array in a store : its URI and its path in resource.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::string getDataArrayKey(const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier& uid);
+
+		/**
+		* @return The count of elements of an array having some dimensions.
+		* @throw EtpException 5 if the dimensions are empty or negative or if the count cannot be represented.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT size_t getElementCount(const std::vector<int64_t>& dimensions);
+
+		/**
+		* @return The byte count of the values of an array having some dimensions. It is an estimation for strings.
+		* @throw EtpException 5 if the dimensions are empty or negative or if the byte count cannot be represented.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT int64_t getByteCount(const std::vector<int64_t>& dimensions, Energistics::Etp::v12::Datatypes::AnyArrayType type);
+
+		/**
+		* Check, before allocating them, that the values of a read can be sent in a single message.
+		*
+		* @param counts			The dimensions of the read array or subarray
+		* @param maxByteCount	Typically the MaxWebSocketMessagePayloadSize of the session which is going to send the values.
+		* @throw EtpException 17 if the values are too big, telling the client to read smaller subarrays.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void checkReadByteCount(const std::vector<int64_t>& counts, Energistics::Etp::v12::Datatypes::AnyArrayType type, int64_t maxByteCount);
+
+		/**
+		* @return The count of values of an array whatever its transport type.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT size_t getValueCount(const Energistics::Etp::v12::Datatypes::AnyArray& anyArray);
+
+		/**
+		* @return An array of zeros, false or empty strings.
+		* @throw EtpException 12 if the values cannot be allocated.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT Energistics::Etp::v12::Datatypes::AnyArray makeValues(Energistics::Etp::v12::Datatypes::AnyArrayType type, size_t count);
+
+		/**
+		* @return The byte count of a value of an array. It is an estimation for strings.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT int64_t getElementByteCount(Energistics::Etp::v12::Datatypes::AnyArrayType type);
+
+		FETPAPI_DLL_IMPORT_OR_EXPORT Energistics::Etp::v12::Datatypes::AnyLogicalArrayType getLogicalArrayType(Energistics::Etp::v12::Datatypes::AnyArrayType type);
+
+		/**
+		* Keep the fastest dimensions whole and split the slowest ones so that a subarray is not bigger than a maximal byte count.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT std::vector<int64_t> computePreferredSubarrayDimensions(const std::vector<int64_t>& dimensions, int64_t elementByteCount, int64_t maxSubarrayByteCount);
+
+		/**
+		* Check that a subarray is inside the dimensions of a data array.
+		*/
+		FETPAPI_DLL_IMPORT_OR_EXPORT void checkSubarray(const std::vector<int64_t>& dimensions, const std::vector<int64_t>& starts, const std::vector<int64_t>& counts);
+
+		/**
+		* Copy a block of values from a row major array to another one.
+		*
+		* @param source					The first value of the source array
+		* @param sourceDimensions		The dimensions of the source array
+		* @param sourceStarts			The position of the block in the source array
+		* @param destination			The first value of the destination array
+		* @param destinationDimensions	The dimensions of the destination array
+		* @param destinationStarts		The position of the block in the destination array
+		* @param counts					The dimensions of the block
+		*/
+		template<class SourceIterator, class DestinationIterator> void copyBlock(SourceIterator source, const std::vector<int64_t>& sourceDimensions, const std::vector<int64_t>& sourceStarts,
+			DestinationIterator destination, const std::vector<int64_t>& destinationDimensions, const std::vector<int64_t>& destinationStarts,
+			const std::vector<int64_t>& counts)
+		{
+			const size_t rank = counts.size();
+			if (std::find(counts.begin(), counts.end(), 0) != counts.end()) {
+				return;
+			}
+
+			std::vector<int64_t> sourceStrides(rank, 1);
+			std::vector<int64_t> destinationStrides(rank, 1);
+			for (size_t i = rank - 1; i > 0; --i) {
+				sourceStrides[i - 1] = sourceStrides[i] * sourceDimensions[i];
+				destinationStrides[i - 1] = destinationStrides[i] * destinationDimensions[i];
+			}
+
+			// Copy the contiguous rows of the fastest dimension one by one
+			const int64_t rowLength = counts[rank - 1];
+			std::vector<int64_t> index(rank, 0);
+			while (true) {
+				int64_t sourceOffset = 0;
+				int64_t destinationOffset = 0;
+				for (size_t i = 0; i < rank; ++i) {
+					sourceOffset += (sourceStarts[i] + index[i]) * sourceStrides[i];
+					destinationOffset += (destinationStarts[i] + index[i]) * destinationStrides[i];
+				}
+				std::copy(source + sourceOffset, source + sourceOffset + rowLength, destination + destinationOffset);
+
+				size_t dim = rank - 1;
+				while (dim > 0) {
+					--dim;
+					if (++index[dim] < counts[dim]) {
+						break;
+					}
+					index[dim] = 0;
+				}
+				if (dim == 0 && index[0] == 0) {
+					return;
+				}
+			}
+		}
+
+		/**
+		* Insert in a map of the response to a map request the value of a key of the request.
+		* The request maps are iterated in the order of their keys : the value is appended at the end of the response map
+		* in constant time, without comparing its key to the other ones.
+		*/
+		template<typename T> T& appendEntry(std::map<std::string, T>& map, const std::string& key, T&& value = T())
+		{
+			return map.emplace_hint(map.end(), key, std::move(value))->second;
+		}
+
+		/**
+		* Record an error in the error map of the response to a map request.
+		*/
+		inline void addError(std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo>& errors, const std::string& key, const EtpException& e)
+		{
+			Energistics::Etp::v12::Datatypes::ErrorInfo& errorInfo = appendEntry(errors, key);
+			errorInfo.code = e.getErrorCode();
+			errorInfo.message = e.what();
+		}
+
+		/**
+		* Send the response to a map request as a multipart message : the successes first if any, then the errors if any.
+		*/
+		template<typename T> void sendMapResponse(AbstractSession* session, const T& response, bool hasSuccess,
+			const std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo>& errors, int64_t correlationId)
+		{
+			if (errors.empty()) {
+				session->send(response, correlationId, 0x02);
+				return;
+			}
+
+			if (hasSuccess) {
+				session->send(response, correlationId);
+			}
+			Energistics::Etp::v12::Protocol::Core::ProtocolException protocolException;
+			protocolException.errors = errors;
+			session->send(protocolException, correlationId, 0x02);
+		}
+	}
+}
@@ -0,0 +1,55 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+#pragma once
+
+/**
+* Minimal checks for the unit test executables run by ctest.
+* A failed check is reported on the error output and the test goes on : the executable returns FETPAPI_TEST_RESULT from main.
+*/
+
+#include <iostream>
+
+namespace fetpapi_test {
+	inline unsigned int& getFailureCount()
+	{
+		static unsigned int failureCount = 0;
+		return failureCount;
+	}
+}
+
+#define FETPAPI_CHECK(CONDITION) \
+	do { \
+		if (!(CONDITION)) { \
+			std::cerr << __FILE__ << ':' << __LINE__ << " : check failed : " << #CONDITION << std::endl; \
+			++fetpapi_test::getFailureCount(); \
+		} \
+	} while (false)
+
+#define FETPAPI_CHECK_THROWS(STATEMENT, EXCEPTION) \
+	do { \
+		bool isThrown = false; \
+		try { STATEMENT; } \
+		catch (const EXCEPTION&) { isThrown = true; } \
+		if (!isThrown) { \
+			std::cerr << __FILE__ << ':' << __LINE__ << " : " << #STATEMENT << " does not throw " << #EXCEPTION << std::endl; \
+			++fetpapi_test::getFailureCount(); \
+		} \
+	} while (false)
+
+#define FETPAPI_TEST_RESULT (fetpapi_test::getFailureCount() == 0 ? 0 : 1)
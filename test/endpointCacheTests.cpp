@@ -0,0 +1,136 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+
+/**
+* Unit tests of the parsing of the server capabilities document and of the cache of the client sessions.
+*/
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <boost/asio/io_context.hpp>
+
+#include "etp/EndpointCache.h"
+
+#include "TestHelpers.h"
+
+using namespace ETP_NS;
+
+namespace {
+	void testParseServerCapabilities()
+	{
+		const ServerCapabilitiesSummary summary = parseServerCapabilities(
+			"{\"applicationName\":\"Server \\u00e9\\ud83d\\ude00\",\"applicationVersion\":\"1.2\","
+			"\"endpointCapabilities\":{"
+			"\"MaxWebSocketFramePayloadSize\":{\"item\":{\"long\":8192}},"
+			"\"MaxWebSocketMessagePayloadSize\":{\"item\":16000000},"
+			"\"ActiveTimeoutPeriod\":3600,"
+			"\"Name\":{\"item\":{\"string\":\"x\"}},"
+			"\"Ratio\":{\"item\":{\"double\":1.5}}},"
+			"\"supportedEncodings\":[\"binary\"],\"ignored\":[1,2,{\"a\":true}],\"none\":null}");
+
+		// UTF-8 encoding of the escaped characters, including a surrogate pair
+		FETPAPI_CHECK(summary.applicationName == "Server \xc3\xa9\xf0\x9f\x98\x80");
+		FETPAPI_CHECK(summary.applicationVersion == "1.2");
+		// Only the integer capabilities are kept, whatever their encoding
+		FETPAPI_CHECK(summary.endpointCapabilities.size() == 3);
+		FETPAPI_CHECK(summary.endpointCapabilities.at("MaxWebSocketFramePayloadSize") == 8192);
+		FETPAPI_CHECK(summary.endpointCapabilities.at("MaxWebSocketMessagePayloadSize") == 16000000);
+		FETPAPI_CHECK(summary.endpointCapabilities.at("ActiveTimeoutPeriod") == 3600);
+
+		FETPAPI_CHECK(parseServerCapabilities("{}").endpointCapabilities.empty());
+
+		const char* invalidDocuments[] = { "", "[]", "{", "{\"a\":}", "{\"a\":1,}", "{\"a\":\"\\q\"}", "{} x", "{\"a\":-}" };
+		for (const char* invalidDocument : invalidDocuments) {
+			FETPAPI_CHECK_THROWS(parseServerCapabilities(invalidDocument), std::invalid_argument);
+		}
+		FETPAPI_CHECK_THROWS(parseServerCapabilities("{\"a\":" + std::string(100000, '[') + std::string(100000, ']') + "}"), std::invalid_argument);
+		// The brackets of the strings do not nest anything
+		FETPAPI_CHECK(parseServerCapabilities("{\"a\":\"\\\"" + std::string(100, '[') + "\"}").endpointCapabilities.empty());
+	}
+
+	boost::asio::ip::tcp::resolver::results_type resolveLocalHost()
+	{
+		boost::asio::io_context ioContext;
+		boost::asio::ip::tcp::resolver resolver(ioContext);
+		return resolver.resolve("127.0.0.1", "8080", boost::asio::ip::tcp::resolver::numeric_host | boost::asio::ip::tcp::resolver::numeric_service);
+	}
+
+	void testEndpoints()
+	{
+		EndpointCache cache(std::chrono::minutes(5));
+		boost::asio::ip::tcp::resolver::results_type endpoints;
+		FETPAPI_CHECK(!cache.findEndpoints("127.0.0.1", "8080", endpoints));
+
+		cache.putEndpoints("127.0.0.1", "8080", resolveLocalHost());
+		FETPAPI_CHECK(cache.findEndpoints("127.0.0.1", "8080", endpoints));
+		FETPAPI_CHECK(endpoints.size() == 1);
+		FETPAPI_CHECK(endpoints.begin()->endpoint().port() == 8080);
+		FETPAPI_CHECK(!cache.findEndpoints("127.0.0.1", "8081", endpoints));
+
+		cache.eraseEndpoints("127.0.0.1", "8080");
+		FETPAPI_CHECK(!cache.findEndpoints("127.0.0.1", "8080", endpoints));
+	}
+
+	void testServerCapabilities()
+	{
+		EndpointCache cache(std::chrono::minutes(5));
+		FETPAPI_CHECK(cache.findServerCapabilities("host", "8080", "/.well-known/etp-server-capabilities?GetVersion=etp12.energistics.org") == nullptr);
+
+		std::shared_ptr<ServerCapabilitiesSummary> summary = std::make_shared<ServerCapabilitiesSummary>();
+		summary->applicationName = "Server";
+		cache.putServerCapabilities("host", "8080", "/.well-known/etp-server-capabilities?GetVersion=etp12.energistics.org", summary);
+		FETPAPI_CHECK(cache.findServerCapabilities("host", "8080", "/.well-known/etp-server-capabilities?GetVersion=etp12.energistics.org") == summary);
+		// Several ETP servers may be served on the same host and port
+		FETPAPI_CHECK(cache.findServerCapabilities("host", "8080", "/other/.well-known/etp-server-capabilities?GetVersion=etp12.energistics.org") == nullptr);
+
+		cache.clear();
+		FETPAPI_CHECK(cache.findServerCapabilities("host", "8080", "/.well-known/etp-server-capabilities?GetVersion=etp12.energistics.org") == nullptr);
+	}
+
+	void testTimeToLive()
+	{
+		EndpointCache cache(std::chrono::milliseconds(20));
+		cache.putEndpoints("127.0.0.1", "8080", resolveLocalHost());
+		cache.putServerCapabilities("host", "8080", "/", std::make_shared<ServerCapabilitiesSummary>());
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		boost::asio::ip::tcp::resolver::results_type endpoints;
+		FETPAPI_CHECK(!cache.findEndpoints("127.0.0.1", "8080", endpoints));
+		FETPAPI_CHECK(cache.findServerCapabilities("host", "8080", "/") == nullptr);
+
+		// A zero time to live disables the caching
+		cache.setTimeToLive(EndpointCache::Clock::duration::zero());
+		FETPAPI_CHECK(cache.getTimeToLive() == EndpointCache::Clock::duration::zero());
+		cache.putEndpoints("127.0.0.1", "8080", resolveLocalHost());
+		FETPAPI_CHECK(!cache.findEndpoints("127.0.0.1", "8080", endpoints));
+	}
+}
+
+int main()
+{
+	testParseServerCapabilities();
+	testEndpoints();
+	testServerCapabilities();
+	testTimeToLive();
+
+	return FETPAPI_TEST_RESULT;
+}
@@ -0,0 +1,202 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+
+/**
+* Unit tests of the in-memory reference store.
+*/
+
+#include <string>
+#include <vector>
+
+#include "etp/store/InMemoryStore.h"
+#include "etp/EtpException.h"
+
+#include "TestHelpers.h"
+
+using namespace ETP_NS;
+
+namespace {
+	const std::string dataspaceUri = "eml:///dataspace('test')";
+	const std::string gridUri = "eml:///dataspace('test')/resqml20.obj_IjkGridRepresentation(2bd5d8f6-2c3f-4b0e-9b5e-5a1c1f2e3d4c)";
+
+	/**
+	* @return The ETP error code of the EtpException thrown by an operation, -1 if it does not throw.
+	*/
+	template<typename Operation>
+	int32_t getErrorCode(Operation operation)
+	{
+		try {
+			operation();
+		}
+		catch (const EtpException& e) {
+			return e.getErrorCode();
+		}
+		return -1;
+	}
+
+	Energistics::Etp::v12::Datatypes::Object::Dataspace makeDataspace()
+	{
+		Energistics::Etp::v12::Datatypes::Object::Dataspace result;
+		result.uri = dataspaceUri;
+		return result;
+	}
+
+	Energistics::Etp::v12::Datatypes::Object::DataObject makeGrid()
+	{
+		Energistics::Etp::v12::Datatypes::Object::DataObject result;
+		result.resource.uri = gridUri;
+		result.data = "<IjkGridRepresentation uuid=\"2bd5d8f6-2c3f-4b0e-9b5e-5a1c1f2e3d4c\"/>";
+		return result;
+	}
+
+	Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier makePointsIdentifier()
+	{
+		Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier result;
+		result.uri = gridUri;
+		result.pathInResource = "/points";
+		return result;
+	}
+
+	Energistics::Etp::v12::Datatypes::AnyArray makeDoubles(const std::vector<double>& values)
+	{
+		Energistics::Etp::v12::Datatypes::ArrayOfDouble doubles;
+		doubles.values = values;
+		Energistics::Etp::v12::Datatypes::AnyArray result;
+		result.item.set_ArrayOfDouble(doubles);
+		return result;
+	}
+
+	void testDataspaces()
+	{
+		InMemoryStore store;
+		FETPAPI_CHECK(store.getDataspaces().empty());
+		store.putDataspace(makeDataspace());
+		const std::vector<Energistics::Etp::v12::Datatypes::Object::Dataspace> dataspaces = store.getDataspaces();
+		FETPAPI_CHECK(dataspaces.size() == 1);
+		FETPAPI_CHECK(dataspaces[0].path == "test");
+		FETPAPI_CHECK(InMemoryStore::getDataspaceUri(gridUri) == dataspaceUri);
+
+		FETPAPI_CHECK(getErrorCode([&]() { store.deleteDataspace("eml:///"); }) == 6);
+		FETPAPI_CHECK(getErrorCode([&]() { store.deleteDataspace("eml:///dataspace('other')"); }) == 11);
+		store.deleteDataspace(dataspaceUri);
+		FETPAPI_CHECK(store.getDataspaces().empty());
+	}
+
+	void testDataObjects()
+	{
+		InMemoryStore store;
+		// The dataspace of a data object must exist
+		FETPAPI_CHECK(getErrorCode([&]() { store.putDataObject(makeGrid()); }) == 11);
+		store.putDataspace(makeDataspace());
+		store.putDataObject(makeGrid());
+		FETPAPI_CHECK(store.getDataObject(gridUri).data == makeGrid().data);
+		FETPAPI_CHECK(store.getDataObject(gridUri).resource.storeLastWrite > 0);
+
+		store.deleteDataObject(gridUri);
+		FETPAPI_CHECK(getErrorCode([&]() { store.getDataObject(gridUri); }) == 11);
+		FETPAPI_CHECK(store.getDeletedResources(dataspaceUri).size() == 1);
+	}
+
+	void testDataArrays()
+	{
+		InMemoryStore store;
+		store.putDataspace(makeDataspace());
+
+		// 2x3 array whose values are 10 * row + column
+		Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray dataArray;
+		dataArray.dimensions = { 2, 3 };
+		dataArray.data = makeDoubles({ 0, 1, 2, 10, 11, 12 });
+		store.putDataArray(makePointsIdentifier(), dataArray);
+		FETPAPI_CHECK(store.getDataArray(makePointsIdentifier()).data.item.get_ArrayOfDouble().values.size() == 6);
+		FETPAPI_CHECK(store.getDataArrayMetadata(makePointsIdentifier()).dimensions == std::vector<int64_t>({ 2, 3 }));
+
+		const Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArray subarray = store.getDataSubarray(makePointsIdentifier(), { 1, 1 }, { 1, 2 });
+		FETPAPI_CHECK(subarray.data.item.get_ArrayOfDouble().values == std::vector<double>({ 11, 12 }));
+
+		store.putDataSubarray(makePointsIdentifier(), makeDoubles({ -1, -2 }), { 0, 0 }, { 2, 1 });
+		FETPAPI_CHECK(store.getDataArray(makePointsIdentifier()).data.item.get_ArrayOfDouble().values == std::vector<double>({ -1, 1, 2, -2, 11, 12 }));
+
+		// The value count must match the counts and the subarray must be inside the array
+		FETPAPI_CHECK(getErrorCode([&]() { store.putDataSubarray(makePointsIdentifier(), makeDoubles({ 1 }), { 0, 0 }, { 1, 2 }); }) == 5);
+		FETPAPI_CHECK(getErrorCode([&]() { store.getDataSubarray(makePointsIdentifier(), { 1, 2 }, { 1, 2 }); }) == 5);
+
+		// The values of a read must fit in a message
+		FETPAPI_CHECK(getErrorCode([&]() { store.getDataArray(makePointsIdentifier(), 47); }) == 17);
+		FETPAPI_CHECK(getErrorCode([&]() { store.getDataSubarray(makePointsIdentifier(), { 0, 0 }, { 2, 2 }, 31); }) == 17);
+		FETPAPI_CHECK(store.getDataSubarray(makePointsIdentifier(), { 0, 0 }, { 2, 2 }, 32).data.item.get_ArrayOfDouble().values.size() == 4);
+
+		Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayMetadata metadata;
+		metadata.dimensions = { 4 };
+		metadata.transportArrayType = Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfDouble;
+		store.putUninitializedDataArray(makePointsIdentifier(), metadata);
+		FETPAPI_CHECK(store.getDataArray(makePointsIdentifier()).data.item.get_ArrayOfDouble().values == std::vector<double>(4, 0));
+
+		// The uninitialized data arrays are bounded and their dimensions must not overflow
+		metadata.dimensions = { 1LL << 40, 1LL << 40 };
+		FETPAPI_CHECK(getErrorCode([&]() { store.putUninitializedDataArray(makePointsIdentifier(), metadata); }) == 5);
+		InMemoryStore smallStore(4000000, 1000);
+		smallStore.putDataspace(makeDataspace());
+		metadata.dimensions = { 126 };
+		FETPAPI_CHECK(getErrorCode([&]() { smallStore.putUninitializedDataArray(makePointsIdentifier(), metadata); }) == 12);
+		metadata.dimensions = { 125 };
+		smallStore.putUninitializedDataArray(makePointsIdentifier(), metadata);
+	}
+
+	void testTransactions()
+	{
+		InMemoryStore store;
+		store.putDataspace(makeDataspace());
+
+		InMemoryStore::Transaction transaction;
+		Energistics::Etp::v12::Datatypes::Uuid uuid = {};
+		uuid.array[0] = 1;
+		store.startTransaction(transaction, { dataspaceUri }, uuid);
+		FETPAPI_CHECK(transaction.isOpen());
+		FETPAPI_CHECK(transaction.uuid.array == uuid.array);
+		FETPAPI_CHECK(getErrorCode([&]() { store.startTransaction(transaction, { dataspaceUri }, uuid); }) == 15);
+		store.putDataObject(makeGrid(), &transaction);
+		store.rollbackTransaction(transaction);
+		FETPAPI_CHECK(!transaction.isOpen());
+		FETPAPI_CHECK(getErrorCode([&]() { store.getDataObject(gridUri); }) == 11);
+
+		store.startTransaction(transaction, { dataspaceUri }, uuid);
+		store.putDataObject(makeGrid(), &transaction);
+		store.commitTransaction(transaction);
+		FETPAPI_CHECK(store.getDataObject(gridUri).data == makeGrid().data);
+		FETPAPI_CHECK(getErrorCode([&]() { store.commitTransaction(transaction); }) == 8);
+
+		// A read only transaction cannot modify the store
+		store.startTransaction(transaction, {}, uuid, true);
+		FETPAPI_CHECK(transaction.readOnly);
+		FETPAPI_CHECK(getErrorCode([&]() { store.deleteDataObject(gridUri, &transaction); }) == 6);
+		store.rollbackTransaction(transaction);
+
+		FETPAPI_CHECK(getErrorCode([&]() { store.startTransaction(transaction, { "eml:///dataspace('other')" }, uuid); }) == 11);
+	}
+}
+
+int main()
+{
+	testDataspaces();
+	testDataObjects();
+	testDataArrays();
+	testTransactions();
+
+	return FETPAPI_TEST_RESULT;
+}
@@ -0,0 +1,132 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+
+/**
+* Unit tests of the single pass ETP 1.2 URI parser and of the URI helpers based on it.
+*/
+
+#include <string>
+
+#include "etp/EtpHelpers.h"
+#include "etp/EtpException.h"
+
+#include "TestHelpers.h"
+
+using namespace ETP_NS;
+using namespace ETP_NS::EtpHelpers;
+
+namespace {
+	const std::string uuid = "2bd5d8f6-2c3f-4b0e-9b5e-5a1c1f2e3d4c";
+
+	bool isValid(const std::string& uri)
+	{
+		UriView view;
+		return parseUri(uri, view);
+	}
+
+	void testDataspaceUris()
+	{
+		UriView view;
+		FETPAPI_CHECK(parseUri("eml:///", view));
+		FETPAPI_CHECK(view.dataspaceUri.empty() && view.qualifiedType.empty() && !view.isDataObject() && !view.hasQuery);
+
+		const std::string dataspaceUri = "eml:///dataspace('demo/Volve')";
+		FETPAPI_CHECK(parseUri(dataspaceUri, view));
+		FETPAPI_CHECK(view.dataspaceUri == dataspaceUri);
+		FETPAPI_CHECK(view.dataspace == "demo/Volve");
+		FETPAPI_CHECK(!view.isDataObject());
+
+		// A quote is escaped by doubling it
+		FETPAPI_CHECK(parseUri("eml:///dataspace('it''s')", view));
+		FETPAPI_CHECK(view.dataspace == "it''s");
+
+		const std::string withQuery = "eml:///dataspace('a')?$filter=x";
+		FETPAPI_CHECK(parseUri(withQuery, view));
+		FETPAPI_CHECK(view.hasQuery && view.query == "$filter=x");
+	}
+
+	void testDataObjectUris()
+	{
+		UriView view;
+		const std::string gridUri = "eml:///dataspace('a')/resqml20.obj_IjkGridRepresentation(" + uuid + ")";
+		FETPAPI_CHECK(parseUri(gridUri, view));
+		FETPAPI_CHECK(view.dataspaceUri == "eml:///dataspace('a')");
+		FETPAPI_CHECK(view.qualifiedType == "resqml20.obj_IjkGridRepresentation");
+		FETPAPI_CHECK(view.domain == "resqml");
+		FETPAPI_CHECK(view.domainVersion == "20");
+		FETPAPI_CHECK(view.objectType == "obj_IjkGridRepresentation");
+		FETPAPI_CHECK(view.uuid == uuid);
+		FETPAPI_CHECK(view.objectVersion.empty());
+		FETPAPI_CHECK(view.isDataObject());
+
+		const std::string wellUri = "eml:///witsml20.Well(" + uuid + ",1.0)";
+		FETPAPI_CHECK(parseUri(wellUri, view));
+		FETPAPI_CHECK(view.dataspaceUri.empty());
+		FETPAPI_CHECK(view.qualifiedType == "witsml20.Well");
+		FETPAPI_CHECK(view.objectVersion == "1.0");
+
+		FETPAPI_CHECK(isValid("eml:///resqml22.IjkGridRepresentation(" + uuid + ")"));
+		FETPAPI_CHECK(isValid("eml:///eml23.Activity(" + uuid + ")"));
+	}
+
+	void testInvalidUris()
+	{
+		FETPAPI_CHECK(!isValid(""));
+		FETPAPI_CHECK(!isValid("http:///"));
+		FETPAPI_CHECK(!isValid("eml:///dataspace('a"));
+		FETPAPI_CHECK(!isValid("eml:///dataspace('a')/"));
+		// Unknown domain
+		FETPAPI_CHECK(!isValid("eml:///foo20.Bar(" + uuid + ")"));
+		// The resqml20 types start with obj_
+		FETPAPI_CHECK(!isValid("eml:///resqml20.IjkGridRepresentation(" + uuid + ")"));
+		// Truncated uuid
+		FETPAPI_CHECK(!isValid("eml:///resqml20.obj_IjkGridRepresentation(" + uuid.substr(1) + ")"));
+		// Trailing characters
+		FETPAPI_CHECK(!isValid("eml:///resqml20.obj_IjkGridRepresentation(" + uuid + ")x"));
+	}
+
+	void testHelpers()
+	{
+		const std::string wellUri = "eml:///dataspace('a')/witsml20.Well(" + uuid + ",1.0)";
+		FETPAPI_CHECK(getDataspaceUri(wellUri) == "eml:///dataspace('a')");
+		FETPAPI_CHECK(getDataspaceUri("eml:///witsml20.Well(" + uuid + ")").empty());
+		FETPAPI_CHECK(getDataObjectType(wellUri) == "witsml20.Well");
+
+		const std::pair<std::string, std::string> uuidAndVersion = getUuidAndVersionFromUri(wellUri);
+		FETPAPI_CHECK(uuidAndVersion.first == uuid);
+		FETPAPI_CHECK(uuidAndVersion.second == "1.0");
+		FETPAPI_CHECK_THROWS(getUuidAndVersionFromUri("eml:///dataspace('a')"), EtpException);
+
+		FETPAPI_CHECK(validateUri("eml:///dataspace('a')").code == -1);
+		// A canonical URI has no query
+		FETPAPI_CHECK(validateUri("eml:///dataspace('a')?x").code == 9);
+		FETPAPI_CHECK(validateDataObjectUri(wellUri).code == -1);
+		FETPAPI_CHECK(validateDataObjectUri("eml:///dataspace('a')").code == 9);
+	}
+}
+
+int main()
+{
+	testDataspaceUris();
+	testDataObjectUris();
+	testInvalidUris();
+	testHelpers();
+
+	return FETPAPI_TEST_RESULT;
+}
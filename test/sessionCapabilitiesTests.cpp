@@ -0,0 +1,132 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+
+/**
+* Unit tests of the capabilities the sessions negotiate with : protocol lookup and data object type matching.
+*/
+
+#include <string>
+#include <vector>
+
+#include <boost/uuid/random_generator.hpp>
+
+#include "etp/InitializationParameters.h"
+#include "etp/SessionCapabilities.h"
+
+#include "TestHelpers.h"
+
+using namespace ETP_NS;
+
+namespace {
+	Energistics::Etp::v12::Datatypes::SupportedDataObject makeDataObject(const std::string& qualifiedType)
+	{
+		Energistics::Etp::v12::Datatypes::SupportedDataObject result;
+		result.qualifiedType = qualifiedType;
+		return result;
+	}
+
+	/**
+	* Supports a resqml20 wildcard, a few witsml20 types and an eml23 type.
+	*/
+	class TestInitializationParameters : public InitializationParameters
+	{
+	public:
+		TestInitializationParameters() : InitializationParameters(boost::uuids::random_generator()(), "127.0.0.1", 8080) {}
+
+		std::vector<Energistics::Etp::v12::Datatypes::SupportedDataObject> makeSupportedDataObjects() const override {
+			std::vector<Energistics::Etp::v12::Datatypes::SupportedDataObject> result;
+			result.push_back(makeDataObject("resqml20.*"));
+			result.push_back(makeDataObject("witsml20.Well"));
+			result.push_back(makeDataObject("witsml20.Wellbore"));
+			result.push_back(makeDataObject("eml23.Activity"));
+			return result;
+		}
+	};
+
+	std::vector<std::string> match(const SessionCapabilities& capabilities, const std::vector<std::string>& requested)
+	{
+		std::vector<Energistics::Etp::v12::Datatypes::SupportedDataObject> requestedDataObjects;
+		for (const auto& qualifiedType : requested) {
+			requestedDataObjects.push_back(makeDataObject(qualifiedType));
+		}
+		std::vector<std::string> result;
+		for (const auto& dataObject : capabilities.matchDataObjects(requestedDataObjects)) {
+			result.push_back(dataObject.qualifiedType);
+		}
+		return result;
+	}
+
+	void testMatchDataObjects()
+	{
+		const TestInitializationParameters params;
+		const SessionCapabilities capabilities(params);
+
+		// Exact matches
+		FETPAPI_CHECK(match(capabilities, { "witsml20.Well" }) == std::vector<std::string>({ "witsml20.Well" }));
+		FETPAPI_CHECK(match(capabilities, { "resqml20.*" }) == std::vector<std::string>({ "resqml20.*" }));
+		// A supported wildcard matches a qualified type of its family
+		FETPAPI_CHECK(match(capabilities, { "resqml20.obj_IjkGridRepresentation" }) == std::vector<std::string>({ "resqml20.obj_IjkGridRepresentation" }));
+		// A requested wildcard matches all the supported types of its family
+		FETPAPI_CHECK(match(capabilities, { "witsml20.*" }) == std::vector<std::string>({ "witsml20.Well", "witsml20.Wellbore" }));
+		// No match
+		FETPAPI_CHECK(match(capabilities, { "witsml20.Trajectory", "prodml22.*", "foo" }).empty());
+		// Each type is matched only once, in the order of the requested ones
+		FETPAPI_CHECK(match(capabilities, { "eml23.Activity", "witsml20.Wellbore", "witsml20.*", "eml23.Activity", "resqml20.obj_Grid2dRepresentation", "resqml20.obj_Grid2dRepresentation" })
+			== std::vector<std::string>({ "eml23.Activity", "witsml20.Wellbore", "witsml20.Well", "resqml20.obj_Grid2dRepresentation" }));
+	}
+
+	void testFindProtocol()
+	{
+		const TestInitializationParameters params;
+		const SessionCapabilities capabilities(params);
+
+		FETPAPI_CHECK(!capabilities.getSupportedProtocols().empty());
+		for (const auto& protocol : capabilities.getSupportedProtocols()) {
+			FETPAPI_CHECK(capabilities.findProtocol(protocol) == &protocol);
+		}
+
+		Energistics::Etp::v12::Datatypes::SupportedProtocol otherRole = capabilities.getSupportedProtocols().front();
+		otherRole.role = "unknown";
+		FETPAPI_CHECK(capabilities.findProtocol(otherRole) == nullptr);
+
+		Energistics::Etp::v12::Datatypes::SupportedProtocol otherVersion = capabilities.getSupportedProtocols().front();
+		++otherVersion.protocolVersion.minor;
+		FETPAPI_CHECK(capabilities.findProtocol(otherVersion) == nullptr);
+	}
+
+	void testCapabilitiesCache()
+	{
+		TestInitializationParameters params;
+		const std::shared_ptr<const SessionCapabilities> capabilities = params.getSessionCapabilities();
+		FETPAPI_CHECK(capabilities != nullptr);
+		FETPAPI_CHECK(params.getSessionCapabilities() == capabilities);
+
+		params.invalidateCapabilities();
+		FETPAPI_CHECK(params.getSessionCapabilities() != capabilities);
+	}
+}
+
+int main()
+{
+	testMatchDataObjects();
+	testFindProtocol();
+	testCapabilitiesCache();
+
+	return FETPAPI_TEST_RESULT;
+}
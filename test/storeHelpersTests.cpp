@@ -0,0 +1,167 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+
+/**
+* Unit tests of the helpers shared by the store implementations and their protocol handlers.
+*/
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "etp/store/StoreHelpers.h"
+
+#include "TestHelpers.h"
+
+using namespace ETP_NS;
+using namespace ETP_NS::StoreHelpers;
+
+namespace {
+	void testElementCount()
+	{
+		FETPAPI_CHECK(getElementCount({ 3 }) == 3);
+		FETPAPI_CHECK(getElementCount({ 2, 3, 4 }) == 24);
+		FETPAPI_CHECK(getElementCount({ 2, 0, 4 }) == 0);
+		FETPAPI_CHECK_THROWS(getElementCount({}), EtpException);
+		FETPAPI_CHECK_THROWS(getElementCount({ 2, -1 }), EtpException);
+		// The element count would overflow
+		FETPAPI_CHECK_THROWS(getElementCount({ 1LL << 40, 1LL << 40 }), EtpException);
+	}
+
+	void testByteCount()
+	{
+		FETPAPI_CHECK(getByteCount({ 2, 3 }, Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfDouble) == 48);
+		// The element count fits but not the byte count
+		FETPAPI_CHECK_THROWS(getByteCount({ 1LL << 31, 1LL << 31 }, Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfDouble), EtpException);
+
+		checkReadByteCount({ 2, 3 }, Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfDouble, 48);
+		bool isTooBig = false;
+		try {
+			checkReadByteCount({ 2, 3 }, Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfDouble, 47);
+		}
+		catch (const EtpException& e) {
+			isTooBig = e.getErrorCode() == 17;
+		}
+		FETPAPI_CHECK(isTooBig);
+	}
+
+	void testValues()
+	{
+		const Energistics::Etp::v12::Datatypes::AnyArray doubles = makeValues(Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfDouble, 5);
+		FETPAPI_CHECK(getValueCount(doubles) == 5);
+		FETPAPI_CHECK(doubles.item.get_ArrayOfDouble().values[4] == 0);
+
+		const Energistics::Etp::v12::Datatypes::AnyArray strings = makeValues(Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfString, 2);
+		FETPAPI_CHECK(getValueCount(strings) == 2);
+		FETPAPI_CHECK(strings.item.get_ArrayOfString().values[1].empty());
+
+		FETPAPI_CHECK(getValueCount(makeValues(Energistics::Etp::v12::Datatypes::AnyArrayType::bytes, 7)) == 7);
+		FETPAPI_CHECK(getElementByteCount(Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfFloat) == 4);
+		FETPAPI_CHECK(getLogicalArrayType(Energistics::Etp::v12::Datatypes::AnyArrayType::arrayOfLong) == Energistics::Etp::v12::Datatypes::AnyLogicalArrayType::arrayOfInt64LE);
+	}
+
+	void testDataArrayKey()
+	{
+		Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier a;
+		a.uri = "eml:///resqml20.obj_IjkGridRepresentation(2bd5d8f6-2c3f-4b0e-9b5e-5a1c1f2e3d4c)";
+		a.pathInResource = "/points";
+		Energistics::Etp::v12::Datatypes::DataArrayTypes::DataArrayIdentifier b = a;
+		b.pathInResource = "/triangles";
+		FETPAPI_CHECK(getDataArrayKey(a) != getDataArrayKey(b));
+		FETPAPI_CHECK(getDataArrayKey(a) == getDataArrayKey(a));
+	}
+
+	void testPreferredSubarrayDimensions()
+	{
+		// The whole array fits
+		FETPAPI_CHECK(computePreferredSubarrayDimensions({ 10, 20 }, 8, 8000) == std::vector<int64_t>({ 10, 20 }));
+		// The fastest dimension is kept whole and the slowest one is split
+		FETPAPI_CHECK(computePreferredSubarrayDimensions({ 100, 20 }, 8, 8000) == std::vector<int64_t>({ 50, 20 }));
+		// The fastest dimension itself is too big
+		FETPAPI_CHECK(computePreferredSubarrayDimensions({ 100, 2000 }, 8, 8000) == std::vector<int64_t>({ 1, 1000 }));
+		// A single value is always allowed
+		FETPAPI_CHECK(computePreferredSubarrayDimensions({ 5 }, 8, 1) == std::vector<int64_t>({ 1 }));
+	}
+
+	void testCheckSubarray()
+	{
+		checkSubarray({ 10, 20 }, { 0, 0 }, { 10, 20 });
+		checkSubarray({ 10, 20 }, { 9, 19 }, { 1, 1 });
+		FETPAPI_CHECK_THROWS(checkSubarray({ 10, 20 }, { 0 }, { 10 }), EtpException);
+		FETPAPI_CHECK_THROWS(checkSubarray({ 10, 20 }, { 5, 0 }, { 6, 20 }), EtpException);
+		FETPAPI_CHECK_THROWS(checkSubarray({ 10, 20 }, { -1, 0 }, { 1, 1 }), EtpException);
+	}
+
+	void testCopyBlock()
+	{
+		// 3x4 source, values are 10 * row + column
+		std::vector<int> source;
+		for (int row = 0; row < 3; ++row) {
+			for (int column = 0; column < 4; ++column) {
+				source.push_back(10 * row + column);
+			}
+		}
+
+		// Copy the 2x2 block starting at (1, 2) to the position (0, 1) of a 2x3 destination
+		std::vector<int> destination(6, -1);
+		copyBlock(source.begin(), { 3, 4 }, { 1, 2 }, destination.begin(), { 2, 3 }, { 0, 1 }, { 2, 2 });
+		FETPAPI_CHECK(destination == std::vector<int>({ -1, 12, 13, -1, 22, 23 }));
+
+		// An empty block does not copy anything
+		std::vector<int> untouched(6, -1);
+		copyBlock(source.begin(), { 3, 4 }, { 0, 0 }, untouched.begin(), { 2, 3 }, { 0, 0 }, { 0, 3 });
+		FETPAPI_CHECK(untouched == std::vector<int>(6, -1));
+
+		// One dimensional copy
+		std::vector<int> row(3, 0);
+		copyBlock(source.begin(), { 12 }, { 5 }, row.begin(), { 3 }, { 0 }, { 3 });
+		FETPAPI_CHECK(row == std::vector<int>({ 11, 12, 13 }));
+	}
+
+	void testMapResponse()
+	{
+		std::map<std::string, std::string> values;
+		appendEntry(values, "0", std::string("a"));
+		appendEntry(values, "1", std::string("b"));
+		appendEntry(values, "2");
+		FETPAPI_CHECK(values.size() == 3);
+		FETPAPI_CHECK(values["1"] == "b");
+		FETPAPI_CHECK(values["2"].empty());
+
+		std::map<std::string, Energistics::Etp::v12::Datatypes::ErrorInfo> errors;
+		addError(errors, "3", EtpException(11, "Not found"));
+		FETPAPI_CHECK(errors.size() == 1);
+		FETPAPI_CHECK(errors["3"].code == 11);
+		FETPAPI_CHECK(errors["3"].message == "Not found");
+	}
+}
+
+int main()
+{
+	testElementCount();
+	testByteCount();
+	testValues();
+	testDataArrayKey();
+	testPreferredSubarrayDimensions();
+	testCheckSubarray();
+	testCopyBlock();
+	testMapResponse();
+
+	return FETPAPI_TEST_RESULT;
+}
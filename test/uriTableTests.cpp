@@ -0,0 +1,119 @@
+/*-----------------------------------------------------------------------
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"; you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+-----------------------------------------------------------------------*/
+
+/**
+* Unit tests of the URI table and of the compact keys of the ETP message maps.
+*/
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "etp/UriTable.h"
+
+#include "TestHelpers.h"
+
+using namespace ETP_NS;
+
+namespace {
+	void testCompactKeys()
+	{
+		FETPAPI_CHECK(getCompactKeyWidth(0) == 1);
+		FETPAPI_CHECK(getCompactKeyWidth(10) == 1);
+		FETPAPI_CHECK(getCompactKeyWidth(11) == 2);
+		FETPAPI_CHECK(getCompactKeyWidth(100000) == 5);
+		FETPAPI_CHECK(getCompactKeyWidth(100001) == 6);
+
+		FETPAPI_CHECK(makeCompactKey(7, 3) == "007");
+		FETPAPI_CHECK_THROWS(makeCompactKey(100, 2), std::out_of_range);
+
+		std::size_t index = 0;
+		FETPAPI_CHECK(parseCompactKey("042", index) && index == 42);
+		FETPAPI_CHECK(parseCompactKey("7", index) && index == 7);
+		FETPAPI_CHECK(!parseCompactKey("4a", index));
+		FETPAPI_CHECK(!parseCompactKey("", index));
+
+		// The order of the keys is the order of the indices
+		FETPAPI_CHECK(makeCompactKey(9, 2) < makeCompactKey(10, 2));
+	}
+
+	void testIntern()
+	{
+		UriTable table;
+		const UriTable::Id a = table.intern("eml:///dataspace('a')");
+		const UriTable::Id b = table.intern(std::string("eml:///dataspace('b')"));
+		FETPAPI_CHECK(a != b);
+		FETPAPI_CHECK(table.intern("eml:///dataspace('a')") == a);
+		FETPAPI_CHECK(table.size() == 2);
+		FETPAPI_CHECK(table.getUri(b) == "eml:///dataspace('b')");
+		FETPAPI_CHECK_THROWS(table.getUri(2), std::out_of_range);
+
+		UriTable::Id found = 0;
+		FETPAPI_CHECK(table.find("eml:///dataspace('b')", found) && found == b);
+		FETPAPI_CHECK(!table.find("eml:///dataspace('c')", found));
+		FETPAPI_CHECK(table.size() == 2);
+
+		// The interned URIs never move
+		const std::string& uriOfA = table.getUri(a);
+		for (int i = 0; i < 10000; ++i) {
+			table.intern("eml:///dataspace('" + std::to_string(i) + "')");
+		}
+		FETPAPI_CHECK(&uriOfA == &table.getUri(a));
+	}
+
+	void testFillUriMap()
+	{
+		UriTable table;
+		std::vector<UriTable::Id> ids;
+		for (int i = 0; i < 12; ++i) {
+			ids.push_back(table.intern("eml:///dataspace('" + std::to_string(i) + "')"));
+		}
+
+		std::map<std::string, std::string> uris{ { "stale", "eml:///" } };
+		table.fillUriMap(ids, uris);
+		FETPAPI_CHECK(uris.size() == 12);
+		FETPAPI_CHECK(uris.begin()->first == "00");
+		FETPAPI_CHECK(uris.rbegin()->first == "11");
+		FETPAPI_CHECK(uris["01"] == "eml:///dataspace('1')");
+	}
+
+	void testMapBuilder()
+	{
+		std::map<std::string, int> map{ { "stale", 0 } };
+		CompactKeyMapBuilder<int> builder(map, 2);
+		FETPAPI_CHECK(map.empty());
+		builder.append() = 1;
+		builder.append() = 2;
+		FETPAPI_CHECK(builder.getIndex() == 2);
+		FETPAPI_CHECK_THROWS(builder.append(), std::out_of_range);
+		FETPAPI_CHECK(map.size() == 2);
+		FETPAPI_CHECK(map["0"] == 1 && map["1"] == 2);
+	}
+}
+
+int main()
+{
+	testCompactKeys();
+	testIntern();
+	testFillUriMap();
+	testMapBuilder();
+
+	return FETPAPI_TEST_RESULT;
+}